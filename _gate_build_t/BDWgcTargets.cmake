@@ -0,0 +1,113 @@
+# Generated by CMake
+
+if("${CMAKE_MAJOR_VERSION}.${CMAKE_MINOR_VERSION}" LESS 2.8)
+   message(FATAL_ERROR "CMake >= 2.8.0 required")
+endif()
+if(CMAKE_VERSION VERSION_LESS "2.8.3")
+   message(FATAL_ERROR "CMake >= 2.8.3 required")
+endif()
+cmake_policy(PUSH)
+cmake_policy(VERSION 2.8.3...3.23)
+#----------------------------------------------------------------
+# Generated CMake target import file.
+#----------------------------------------------------------------
+
+# Commands may need to know the format version.
+set(CMAKE_IMPORT_FILE_VERSION 1)
+
+# Protect against multiple inclusion, which would fail when already imported targets are added once more.
+set(_cmake_targets_defined "")
+set(_cmake_targets_not_defined "")
+set(_cmake_expected_targets "")
+foreach(_cmake_expected_target IN ITEMS cord gc gccpp gctba)
+  list(APPEND _cmake_expected_targets "${_cmake_expected_target}")
+  if(TARGET "${_cmake_expected_target}")
+    list(APPEND _cmake_targets_defined "${_cmake_expected_target}")
+  else()
+    list(APPEND _cmake_targets_not_defined "${_cmake_expected_target}")
+  endif()
+endforeach()
+unset(_cmake_expected_target)
+if(_cmake_targets_defined STREQUAL _cmake_expected_targets)
+  unset(_cmake_targets_defined)
+  unset(_cmake_targets_not_defined)
+  unset(_cmake_expected_targets)
+  unset(CMAKE_IMPORT_FILE_VERSION)
+  cmake_policy(POP)
+  return()
+endif()
+if(NOT _cmake_targets_defined STREQUAL "")
+  string(REPLACE ";" ", " _cmake_targets_defined_text "${_cmake_targets_defined}")
+  string(REPLACE ";" ", " _cmake_targets_not_defined_text "${_cmake_targets_not_defined}")
+  message(FATAL_ERROR "Some (but not all) targets in this export set were already defined.\nTargets Defined: ${_cmake_targets_defined_text}\nTargets not yet defined: ${_cmake_targets_not_defined_text}\n")
+endif()
+unset(_cmake_targets_defined)
+unset(_cmake_targets_not_defined)
+unset(_cmake_expected_targets)
+
+
+# Create imported target cord
+add_library(cord SHARED IMPORTED)
+
+set_target_properties(cord PROPERTIES
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/include"
+)
+
+# Create imported target gc
+add_library(gc SHARED IMPORTED)
+
+set_target_properties(gc PROPERTIES
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/include"
+)
+
+# Create imported target gccpp
+add_library(gccpp SHARED IMPORTED)
+
+set_target_properties(gccpp PROPERTIES
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/include"
+)
+
+# Create imported target gctba
+add_library(gctba SHARED IMPORTED)
+
+set_target_properties(gctba PROPERTIES
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/include"
+)
+
+# Import target "cord" for configuration "RelWithDebInfo"
+set_property(TARGET cord APPEND PROPERTY IMPORTED_CONFIGURATIONS RELWITHDEBINFO)
+set_target_properties(cord PROPERTIES
+  IMPORTED_LINK_DEPENDENT_LIBRARIES_RELWITHDEBINFO "gc"
+  IMPORTED_LOCATION_RELWITHDEBINFO "/root/repo/_gate_build_t/libcord.so.1.5.0"
+  IMPORTED_SONAME_RELWITHDEBINFO "libcord.so.1"
+  )
+
+# Import target "gc" for configuration "RelWithDebInfo"
+set_property(TARGET gc APPEND PROPERTY IMPORTED_CONFIGURATIONS RELWITHDEBINFO)
+set_target_properties(gc PROPERTIES
+  IMPORTED_LOCATION_RELWITHDEBINFO "/root/repo/_gate_build_t/libgc.so.1.5.1"
+  IMPORTED_SONAME_RELWITHDEBINFO "libgc.so.1"
+  )
+
+# Import target "gccpp" for configuration "RelWithDebInfo"
+set_property(TARGET gccpp APPEND PROPERTY IMPORTED_CONFIGURATIONS RELWITHDEBINFO)
+set_target_properties(gccpp PROPERTIES
+  IMPORTED_LINK_DEPENDENT_LIBRARIES_RELWITHDEBINFO "gc"
+  IMPORTED_LOCATION_RELWITHDEBINFO "/root/repo/_gate_build_t/libgccpp.so.1.5.0"
+  IMPORTED_SONAME_RELWITHDEBINFO "libgccpp.so.1"
+  )
+
+# Import target "gctba" for configuration "RelWithDebInfo"
+set_property(TARGET gctba APPEND PROPERTY IMPORTED_CONFIGURATIONS RELWITHDEBINFO)
+set_target_properties(gctba PROPERTIES
+  IMPORTED_LINK_DEPENDENT_LIBRARIES_RELWITHDEBINFO "gc"
+  IMPORTED_LOCATION_RELWITHDEBINFO "/root/repo/_gate_build_t/libgctba.so.1.5.0"
+  IMPORTED_SONAME_RELWITHDEBINFO "libgctba.so.1"
+  )
+
+# This file does not depend on other imported targets which have
+# been exported from the same project but in a separate export set.
+
+# Commands beyond this point should not need to know the version.
+set(CMAKE_IMPORT_FILE_VERSION)
+cmake_policy(POP)
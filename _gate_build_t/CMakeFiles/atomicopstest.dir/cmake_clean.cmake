@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/atomicopstest.dir/tests/atomicops.c.o"
+  "CMakeFiles/atomicopstest.dir/tests/atomicops.c.o.d"
+  "atomicopstest"
+  "atomicopstest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/atomicopstest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
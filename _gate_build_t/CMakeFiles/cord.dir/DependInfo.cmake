@@ -0,0 +1,29 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/cord/cordbscs.c" "CMakeFiles/cord.dir/cord/cordbscs.c.o" "gcc" "CMakeFiles/cord.dir/cord/cordbscs.c.o.d"
+  "/root/repo/cord/cordprnt.c" "CMakeFiles/cord.dir/cord/cordprnt.c.o" "gcc" "CMakeFiles/cord.dir/cord/cordprnt.c.o.d"
+  "/root/repo/cord/cordxtra.c" "CMakeFiles/cord.dir/cord/cordxtra.c.o" "gcc" "CMakeFiles/cord.dir/cord/cordxtra.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_gate_build_t/libcord.so" "/root/repo/_gate_build_t/libcord.so.1.5.0"
+  "/root/repo/_gate_build_t/libcord.so.1" "/root/repo/_gate_build_t/libcord.so.1.5.0"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_gate_build_t/CMakeFiles/gc.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cord.dir/cord/cordbscs.c.o"
+  "CMakeFiles/cord.dir/cord/cordbscs.c.o.d"
+  "CMakeFiles/cord.dir/cord/cordprnt.c.o"
+  "CMakeFiles/cord.dir/cord/cordprnt.c.o.d"
+  "CMakeFiles/cord.dir/cord/cordxtra.c.o"
+  "CMakeFiles/cord.dir/cord/cordxtra.c.o.d"
+  "libcord.pdb"
+  "libcord.so"
+  "libcord.so.1"
+  "libcord.so.1.5.0"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/cord.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
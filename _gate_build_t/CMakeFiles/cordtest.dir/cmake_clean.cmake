@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cordtest.dir/cord/tests/cordtest.c.o"
+  "CMakeFiles/cordtest.dir/cord/tests/cordtest.c.o.d"
+  "cordtest"
+  "cordtest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/cordtest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpptest.dir/tests/cpp.cc.o"
+  "CMakeFiles/cpptest.dir/tests/cpp.cc.o.d"
+  "cpptest"
+  "cpptest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/cpptest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
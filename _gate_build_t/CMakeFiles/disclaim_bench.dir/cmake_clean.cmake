@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/disclaim_bench.dir/tests/disclaim_bench.c.o"
+  "CMakeFiles/disclaim_bench.dir/tests/disclaim_bench.c.o.d"
+  "disclaim_bench"
+  "disclaim_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/disclaim_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/disclaimtest.dir/tests/disclaim.c.o"
+  "CMakeFiles/disclaimtest.dir/tests/disclaim.c.o.d"
+  "disclaimtest"
+  "disclaimtest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/disclaimtest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
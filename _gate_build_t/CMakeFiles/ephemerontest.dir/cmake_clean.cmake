@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ephemerontest.dir/tests/ephemeron.c.o"
+  "CMakeFiles/ephemerontest.dir/tests/ephemeron.c.o.d"
+  "ephemerontest"
+  "ephemerontest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ephemerontest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/extra/gc.c" "CMakeFiles/gc.dir/extra/gc.c.o" "gcc" "CMakeFiles/gc.dir/extra/gc.c.o.d"
+  "/root/repo/pthread_start.c" "CMakeFiles/gc.dir/pthread_start.c.o" "gcc" "CMakeFiles/gc.dir/pthread_start.c.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_gate_build_t/libgc.so" "/root/repo/_gate_build_t/libgc.so.1.5.1"
+  "/root/repo/_gate_build_t/libgc.so.1" "/root/repo/_gate_build_t/libgc.so.1.5.1"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
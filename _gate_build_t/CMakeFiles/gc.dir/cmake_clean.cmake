@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gc.dir/extra/gc.c.o"
+  "CMakeFiles/gc.dir/extra/gc.c.o.d"
+  "CMakeFiles/gc.dir/pthread_start.c.o"
+  "CMakeFiles/gc.dir/pthread_start.c.o.d"
+  "libgc.pdb"
+  "libgc.so"
+  "libgc.so.1"
+  "libgc.so.1.5.1"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/gc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,28 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/gc_badalc.cc" "CMakeFiles/gccpp.dir/gc_badalc.cc.o" "gcc" "CMakeFiles/gccpp.dir/gc_badalc.cc.o.d"
+  "/root/repo/gc_cpp.cc" "CMakeFiles/gccpp.dir/gc_cpp.cc.o" "gcc" "CMakeFiles/gccpp.dir/gc_cpp.cc.o.d"
+  )
+
+# Pairs of files generated by the same build rule.
+set(CMAKE_MULTIPLE_OUTPUT_PAIRS
+  "/root/repo/_gate_build_t/libgccpp.so" "/root/repo/_gate_build_t/libgccpp.so.1.5.0"
+  "/root/repo/_gate_build_t/libgccpp.so.1" "/root/repo/_gate_build_t/libgccpp.so.1.5.0"
+  )
+
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_gate_build_t/CMakeFiles/gc.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
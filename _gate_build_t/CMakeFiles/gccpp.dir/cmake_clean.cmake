@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gccpp.dir/gc_badalc.cc.o"
+  "CMakeFiles/gccpp.dir/gc_badalc.cc.o.d"
+  "CMakeFiles/gccpp.dir/gc_cpp.cc.o"
+  "CMakeFiles/gccpp.dir/gc_cpp.cc.o.d"
+  "libgccpp.pdb"
+  "libgccpp.so"
+  "libgccpp.so.1"
+  "libgccpp.so.1.5.0"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gccpp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
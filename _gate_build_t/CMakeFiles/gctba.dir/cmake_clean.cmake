@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gctba.dir/gc_badalc.cc.o"
+  "CMakeFiles/gctba.dir/gc_badalc.cc.o.d"
+  "libgctba.pdb"
+  "libgctba.so"
+  "libgctba.so.1"
+  "libgctba.so.1.5.0"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gctba.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
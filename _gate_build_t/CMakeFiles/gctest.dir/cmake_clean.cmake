@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gctest.dir/tests/gctest.c.o"
+  "CMakeFiles/gctest.dir/tests/gctest.c.o.d"
+  "gctest"
+  "gctest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gctest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
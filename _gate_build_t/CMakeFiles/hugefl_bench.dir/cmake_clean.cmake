@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hugefl_bench.dir/tests/hugefl_bench.c.o"
+  "CMakeFiles/hugefl_bench.dir/tests/hugefl_bench.c.o.d"
+  "hugefl_bench"
+  "hugefl_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/hugefl_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
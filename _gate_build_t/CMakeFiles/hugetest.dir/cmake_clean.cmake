@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hugetest.dir/tests/huge.c.o"
+  "CMakeFiles/hugetest.dir/tests/huge.c.o.d"
+  "hugetest"
+  "hugetest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/hugetest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/initfromthreadtest.dir/tests/initfromthread.c.o"
+  "CMakeFiles/initfromthreadtest.dir/tests/initfromthread.c.o.d"
+  "initfromthreadtest"
+  "initfromthreadtest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/initfromthreadtest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/leaktest.dir/tests/leak.c.o"
+  "CMakeFiles/leaktest.dir/tests/leak.c.o.d"
+  "leaktest"
+  "leaktest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/leaktest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/middletest.dir/tests/middle.c.o"
+  "CMakeFiles/middletest.dir/tests/middle.c.o.d"
+  "middletest"
+  "middletest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/middletest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
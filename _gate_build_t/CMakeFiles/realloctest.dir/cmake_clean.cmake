@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/realloctest.dir/tests/realloc.c.o"
+  "CMakeFiles/realloctest.dir/tests/realloc.c.o.d"
+  "realloctest"
+  "realloctest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/realloctest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/smashtest.dir/tests/smash.c.o"
+  "CMakeFiles/smashtest.dir/tests/smash.c.o.d"
+  "smashtest"
+  "smashtest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/smashtest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/staticroots_lib_test.dir/tests/staticroots_lib.c.o"
+  "CMakeFiles/staticroots_lib_test.dir/tests/staticroots_lib.c.o.d"
+  "libstaticroots_lib_test.pdb"
+  "libstaticroots_lib_test.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/staticroots_lib_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
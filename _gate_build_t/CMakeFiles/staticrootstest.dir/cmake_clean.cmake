@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/staticrootstest.dir/tests/staticroots.c.o"
+  "CMakeFiles/staticrootstest.dir/tests/staticroots.c.o.d"
+  "staticrootstest"
+  "staticrootstest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/staticrootstest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
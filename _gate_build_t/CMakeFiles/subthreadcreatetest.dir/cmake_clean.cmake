@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/subthreadcreatetest.dir/tests/subthreadcreate.c.o"
+  "CMakeFiles/subthreadcreatetest.dir/tests/subthreadcreate.c.o.d"
+  "subthreadcreatetest"
+  "subthreadcreatetest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/subthreadcreatetest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
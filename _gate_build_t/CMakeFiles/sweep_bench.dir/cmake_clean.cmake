@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sweep_bench.dir/tests/sweep_bench.c.o"
+  "CMakeFiles/sweep_bench.dir/tests/sweep_bench.c.o.d"
+  "sweep_bench"
+  "sweep_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/sweep_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/threadkeytest.dir/tests/threadkey.c.o"
+  "CMakeFiles/threadkeytest.dir/tests/threadkey.c.o.d"
+  "threadkeytest"
+  "threadkeytest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/threadkeytest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/threadleaktest.dir/tests/threadleak.c.o"
+  "CMakeFiles/threadleaktest.dir/tests/threadleak.c.o.d"
+  "threadleaktest"
+  "threadleaktest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/threadleaktest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
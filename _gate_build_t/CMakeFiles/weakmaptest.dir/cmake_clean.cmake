@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/weakmaptest.dir/tests/weakmap.c.o"
+  "CMakeFiles/weakmaptest.dir/tests/weakmap.c.o.d"
+  "weakmaptest"
+  "weakmaptest.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/weakmaptest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
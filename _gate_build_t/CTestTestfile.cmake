@@ -0,0 +1,46 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_gate_build_t
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(cordtest "/root/repo/_gate_build_t/cordtest")
+set_tests_properties(cordtest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;837;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(gctest "/root/repo/_gate_build_t/gctest")
+set_tests_properties(gctest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;863;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(hugetest "/root/repo/_gate_build_t/hugetest")
+set_tests_properties(hugetest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;873;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(leaktest "/root/repo/_gate_build_t/leaktest")
+set_tests_properties(leaktest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;877;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(middletest "/root/repo/_gate_build_t/middletest")
+set_tests_properties(middletest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;881;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(realloctest "/root/repo/_gate_build_t/realloctest")
+set_tests_properties(realloctest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;885;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(smashtest "/root/repo/_gate_build_t/smashtest")
+set_tests_properties(smashtest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;889;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(sweep_bench "/root/repo/_gate_build_t/sweep_bench")
+set_tests_properties(sweep_bench PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;893;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(hugefl_bench "/root/repo/_gate_build_t/hugefl_bench")
+set_tests_properties(hugefl_bench PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;897;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(ephemerontest "/root/repo/_gate_build_t/ephemerontest")
+set_tests_properties(ephemerontest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;902;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(staticrootstest "/root/repo/_gate_build_t/staticrootstest")
+set_tests_properties(staticrootstest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;914;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(atomicopstest "/root/repo/_gate_build_t/atomicopstest")
+set_tests_properties(atomicopstest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;927;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(initfromthreadtest "/root/repo/_gate_build_t/initfromthreadtest")
+set_tests_properties(initfromthreadtest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;931;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(subthreadcreatetest "/root/repo/_gate_build_t/subthreadcreatetest")
+set_tests_properties(subthreadcreatetest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;936;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(threadleaktest "/root/repo/_gate_build_t/threadleaktest")
+set_tests_properties(threadleaktest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;940;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(threadkeytest "/root/repo/_gate_build_t/threadkeytest")
+set_tests_properties(threadkeytest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;945;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(cpptest "/root/repo/_gate_build_t/cpptest")
+set_tests_properties(cpptest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;952;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(disclaim_bench "/root/repo/_gate_build_t/disclaim_bench")
+set_tests_properties(disclaim_bench PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;958;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(disclaimtest "/root/repo/_gate_build_t/disclaimtest")
+set_tests_properties(disclaimtest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;962;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(weakmaptest "/root/repo/_gate_build_t/weakmaptest")
+set_tests_properties(weakmaptest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;967;add_test;/root/repo/CMakeLists.txt;0;")
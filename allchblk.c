@@ -77,6 +77,144 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
   word MANAGED_STACK_ADDRESS_BOEHM_GC_free_bytes[N_HBLK_FLS+1] = { 0 };
         /* Number of free bytes on each list.  Remains visible to GCJ.  */
 
+#define HBLK_FL_BITMAP_SZ ((N_HBLK_FLS + CPP_WORDSZ) / CPP_WORDSZ)
+
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfl_nonempty[HBLK_FL_BITMAP_SZ] = { 0 };
+        /* Bit i is set iff MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfreelist[i] is non-empty.  Lets     */
+        /* MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk skip empty free lists without touching them.    */
+
+#define HBLK_FL_SET_NONEMPTY(i) \
+        (void)(MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfl_nonempty[(i) / CPP_WORDSZ] \
+                |= (word)1 << ((i) % CPP_WORDSZ))
+#define HBLK_FL_CLEAR_NONEMPTY(i) \
+        (void)(MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfl_nonempty[(i) / CPP_WORDSZ] \
+                &= ~((word)1 << ((i) % CPP_WORDSZ)))
+#define HBLK_FL_IS_NONEMPTY(i) \
+        ((MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfl_nonempty[(i) / CPP_WORDSZ] \
+          >> ((i) % CPP_WORDSZ)) & 1)
+
+/* Return the smallest index not less than n of a non-empty free list,  */
+/* or N_HBLK_FLS+1 if there is none.                                    */
+STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_next_nonempty_hblk_fl(int n)
+{
+    int i = n / CPP_WORDSZ;
+    word bits;
+
+    if (n > N_HBLK_FLS) return N_HBLK_FLS + 1;
+    bits = MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfl_nonempty[i] & ((word)-1 << (n % CPP_WORDSZ));
+    while (0 == bits) {
+      if (++i >= HBLK_FL_BITMAP_SZ) return N_HBLK_FLS + 1;
+      bits = MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfl_nonempty[i];
+    }
+    n = i * CPP_WORDSZ;
+#   if defined(__GNUC__) && !defined(CPPCHECK)
+      n += __builtin_ctzll((unsigned long long)bits);
+#   else
+      for (; (bits & 1) == 0; bits >>= 1) ++n;
+#   endif
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(n <= N_HBLK_FLS && MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfreelist[n] != NULL);
+    return n;
+}
+
+/* An index of the blocks on the last free list (that holding the huge  */
+/* blocks of any size) ordered by size (and then by header address), so */
+/* that MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth finds the best fit by a binary search instead  */
+/* of walking the whole list.  The list itself is maintained as before. */
+/* The index is allocated from the scratch memory (a grown index is not */
+/* recycled, as it would be added to the heap while the free lists are  */
+/* being updated); if it cannot be grown, then it is abandoned and the  */
+/* list is walked again.                                                */
+struct hblk_fl_entry_s {
+    word sz;            /* the same as hhdr -> hb_sz    */
+    hdr *hhdr;
+    struct hblk *h;
+};
+
+STATIC struct hblk_fl_entry_s *MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index = NULL;
+STATIC size_t MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n = 0;   /* number of entries    */
+STATIC size_t MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_cap = 0;
+STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_lost = FALSE;
+
+#define HUGE_FL_INDEX_MIN_CAP 64
+
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_indexed() (!MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_lost)
+
+/* Return the position of the first entry not less than (sz, hhdr).     */
+STATIC size_t MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_lower_bound(word sz, const hdr *hhdr)
+{
+    size_t lo = 0;
+    size_t hi = MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n;
+
+    while (lo < hi) {
+      size_t mid = (lo + hi) >> 1;
+      const struct hblk_fl_entry_s *e = &MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[mid];
+
+      if (e -> sz < sz
+          || (e -> sz == sz && (word)(e -> hhdr) < (word)hhdr)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+}
+
+/* Return the block of the entry at the given position, or NULL if      */
+/* there is no such entry.                                              */
+MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_at(size_t pos)
+{
+    return pos < MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n ? MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos].h : NULL;
+}
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_insert(struct hblk *h, hdr *hhdr)
+{
+    size_t pos;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    if (!MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_indexed()) return;
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n == MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_cap) {
+      size_t new_cap = MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_cap > 0 ? 2 * MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_cap
+                                                : HUGE_FL_INDEX_MIN_CAP;
+      struct hblk_fl_entry_s *new_index = (struct hblk_fl_entry_s *)
+                MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc(new_cap * sizeof(struct hblk_fl_entry_s));
+
+      if (EXPECT(NULL == new_index, FALSE)) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_lost = TRUE;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n = 0;
+        return;
+      }
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n > 0)
+        BCOPY(MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index, new_index,
+              MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n * sizeof(struct hblk_fl_entry_s));
+      MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index = new_index;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_cap = new_cap;
+    }
+    pos = MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_lower_bound(hhdr -> hb_sz, hhdr);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(pos == MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n
+              || MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos].hhdr != hhdr);
+    memmove(&MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos + 1], &MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos],
+            (MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n - pos) * sizeof(struct hblk_fl_entry_s));
+    MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos].sz = hhdr -> hb_sz;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos].hhdr = hhdr;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos].h = h;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n++;
+}
+
+/* sz is the size of the block when it was inserted.    */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_remove(hdr *hhdr, word sz)
+{
+    size_t pos;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    if (!MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_indexed()) return;
+    pos = MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_lower_bound(sz, hhdr);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(pos < MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n
+              && MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos].hhdr == hhdr);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n--;
+    memmove(&MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos], &MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index[pos + 1],
+            (MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_index_n - pos) * sizeof(struct hblk_fl_entry_s));
+}
+
 /* Return the largest n such that the number of free bytes on lists     */
 /* n .. N_HBLK_FLS is greater or equal to MANAGED_STACK_ADDRESS_BOEHM_GC_max_large_allocd_bytes     */
 /* minus MANAGED_STACK_ADDRESS_BOEHM_GC_large_allocd_bytes.  If there is no such n, return 0.       */
@@ -111,6 +249,30 @@ STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_fl_from_blocks(size_t blocks_need
 #   define IS_MAPPED(hhdr) TRUE
 # endif /* !USE_MUNMAP */
 
+/* The block resulting from merging of two free ones is known to be    */
+/* zero-filled only if both of them are.                                */
+# define MERGE_ZERO_BLK_FLAG(hhdr, otherhdr) \
+        (void)((hhdr) -> hb_flags &= \
+                (unsigned char)((otherhdr) -> hb_flags | ~ZERO_BLK))
+
+# ifdef UNMAP_DISCARDS_CONTENT
+#   ifdef USE_MADV_FREE
+#     define UNMAP_IS_LAZY() MANAGED_STACK_ADDRESS_BOEHM_GC_lazy_unmap
+#   else
+#     define UNMAP_IS_LAZY() FALSE
+#   endif
+    /* The block has just been remapped; if all of its pages were       */
+    /* unmapped (i.e. it is page-aligned), then it is zero-filled now   */
+    /* (unless the pages were just marked as lazily freeable).          */
+    /* Otherwise the flag remains valid as unmapping never adds data.   */
+#   define SET_ZERO_BLK_IF_DISCARDED(h, hhdr) \
+        (void)((((word)(h) | (word)(hhdr) -> hb_sz) \
+                & (MANAGED_STACK_ADDRESS_BOEHM_GC_page_size - 1)) == 0 && !UNMAP_IS_LAZY() \
+               ? ((hhdr) -> hb_flags |= ZERO_BLK) : 0)
+# else
+#   define SET_ZERO_BLK_IF_DISCARDED(h, hhdr) (void)0
+# endif
+
 #if !defined(NO_DEBUGGING) || defined(MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERTIONS)
   static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK add_hb_sz(struct hblk *h, int i, MANAGED_STACK_ADDRESS_BOEHM_GC_word client_data)
   {
@@ -248,7 +410,7 @@ static MANAGED_STACK_ADDRESS_BOEHM_GC_bool setup_header(hdr *hhdr, struct hblk *
 #   endif
     ok = &MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[kind];
 #   ifdef ENABLE_DISCLAIM
-      if (ok -> ok_disclaim_proc)
+      if (ok -> ok_disclaim_proc || ok -> ok_disclaim_block_proc)
         flags |= HAS_DISCLAIM;
       if (ok -> ok_mark_unconditionally)
         flags |= MARK_UNCONDITIONALLY;
@@ -324,6 +486,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_remove_from_fl_at(hdr *hhdr, int inde
     if (hhdr -> hb_prev == 0) {
         MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(HDR(MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfreelist[index]) == hhdr);
         MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfreelist[index] = hhdr -> hb_next;
+        if (NULL == hhdr -> hb_next) HBLK_FL_CLEAR_NONEMPTY(index);
     } else {
         hdr *phdr;
         GET_HDR(hhdr -> hb_prev, phdr);
@@ -338,6 +501,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_remove_from_fl_at(hdr *hhdr, int inde
         GET_HDR(hhdr -> hb_next, nhdr);
         nhdr -> hb_prev = hhdr -> hb_prev;
     }
+    if (N_HBLK_FLS == index) MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_remove(hhdr, hhdr -> hb_sz);
 }
 
 /* Remove hhdr from the appropriate free list (we assume it is on the   */
@@ -410,6 +574,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_fl(struct hblk *h, hdr *hhdr)
 #   endif
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(modHBLKSZ(hhdr -> hb_sz) == 0);
     MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfreelist[index] = h;
+    HBLK_FL_SET_NONEMPTY(index);
     MANAGED_STACK_ADDRESS_BOEHM_GC_free_bytes[index] += hhdr -> hb_sz;
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_free_bytes[index] <= MANAGED_STACK_ADDRESS_BOEHM_GC_large_free_bytes);
     hhdr -> hb_next = second;
@@ -421,6 +586,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_fl(struct hblk *h, hdr *hhdr)
       second_hdr -> hb_prev = h;
     }
     hhdr -> hb_flags |= FREE_BLK;
+    if (N_HBLK_FLS == index) MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_insert(h, hhdr);
 }
 
 #ifdef USE_MUNMAP
@@ -482,10 +648,12 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_adjust
 }
 
 /* Unmap blocks that haven't been recently touched.  This is the only   */
-/* way blocks are ever unmapped.                                        */
+/* way blocks are ever unmapped (besides MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_aged invoked by the   */
+/* scavenger thread).                                                   */
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_old(unsigned threshold)
 {
     int i;
+    EVTRACE_SPAN(sp)
 
 # ifdef COUNT_UNMAPPED_REGIONS
     /* Skip unmapping if we have already exceeded the soft limit.       */
@@ -494,6 +662,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_o
       return;
 # endif
 
+    EVTRACE_BEGIN(sp);
     for (i = 0; i <= N_HBLK_FLS; ++i) {
       struct hblk * h;
       hdr * hhdr;
@@ -515,6 +684,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_o
 
             if (delta >= 0 && regions >= MANAGED_STACK_ADDRESS_BOEHM_GC_UNMAPPED_REGIONS_SOFT_LIMIT) {
               MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Unmapped regions limit reached!\n");
+              EVTRACE_END(sp, 0, EVTRACE_UNMAP, MANAGED_STACK_ADDRESS_BOEHM_GC_unmapped_bytes, 0);
               return;
             }
             MANAGED_STACK_ADDRESS_BOEHM_GC_num_unmapped_regions = regions;
@@ -524,8 +694,55 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_o
         }
       }
     }
+    EVTRACE_END(sp, 0, EVTRACE_UNMAP, MANAGED_STACK_ADDRESS_BOEHM_GC_unmapped_bytes, 0);
 }
 
+#ifdef SCAVENGER_THREAD
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER word MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_aged(unsigned32 age_ms, word max_bytes)
+  {
+    word unmapped = 0;
+    int i;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+#   ifdef COUNT_UNMAPPED_REGIONS
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_num_unmapped_regions >= MANAGED_STACK_ADDRESS_BOEHM_GC_UNMAPPED_REGIONS_SOFT_LIMIT)
+        return 0;
+#   endif
+
+    /* Start from the largest blocks, so that the budget is spent on    */
+    /* the minimal number of system calls.                              */
+    for (i = N_HBLK_FLS; i >= 0; --i) {
+      struct hblk * h;
+      hdr * hhdr;
+
+      for (h = MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfreelist[i]; 0 != h; h = hhdr -> hb_next) {
+        hhdr = HDR(h);
+        if (!IS_MAPPED(hhdr)) continue;
+
+        /* The wrapping of the clock is handled the same way as in      */
+        /* MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_old (for hb_last_reclaimed).                        */
+        if ((unsigned32)(MANAGED_STACK_ADDRESS_BOEHM_GC_scavenge_ms - hhdr -> hb_free_ms) >= age_ms) {
+#         ifdef COUNT_UNMAPPED_REGIONS
+            int delta = calc_num_unmapped_regions_delta(h, hhdr);
+            signed_word regions = MANAGED_STACK_ADDRESS_BOEHM_GC_num_unmapped_regions + delta;
+
+            if (delta >= 0 && regions >= MANAGED_STACK_ADDRESS_BOEHM_GC_UNMAPPED_REGIONS_SOFT_LIMIT) {
+              MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Unmapped regions limit reached!\n");
+              return unmapped;
+            }
+            MANAGED_STACK_ADDRESS_BOEHM_GC_num_unmapped_regions = regions;
+#         endif
+          MANAGED_STACK_ADDRESS_BOEHM_GC_unmap((ptr_t)h, (size_t)(hhdr -> hb_sz));
+          hhdr -> hb_flags |= WAS_UNMAPPED;
+          unmapped += hhdr -> hb_sz;
+          if (max_bytes != 0 && unmapped >= max_bytes) return unmapped;
+        }
+      }
+    }
+    return unmapped;
+  }
+#endif /* SCAVENGER_THREAD */
+
 /* Merge all unmapped blocks that are adjacent to other free            */
 /* blocks.  This may involve remapping, since all blocks are either     */
 /* fully mapped or fully unmapped.                                      */
@@ -559,6 +776,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_merge_u
                 if (size > nextsize) {
                   MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_num_unmapped(next, nexthdr);
                   MANAGED_STACK_ADDRESS_BOEHM_GC_remap((ptr_t)next, nextsize);
+                  SET_ZERO_BLK_IF_DISCARDED(next, nexthdr);
                 } else {
                   MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_num_unmapped(h, hhdr);
                   MANAGED_STACK_ADDRESS_BOEHM_GC_unmap((ptr_t)h, size);
@@ -574,7 +792,11 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_merge_u
                 MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_num_unmapped(h, hhdr);
                 MANAGED_STACK_ADDRESS_BOEHM_GC_remap((ptr_t)h, size);
                 hhdr -> hb_flags &= (unsigned char)~WAS_UNMAPPED;
+                SET_ZERO_BLK_IF_DISCARDED(h, hhdr);
                 hhdr -> hb_last_reclaimed = nexthdr -> hb_last_reclaimed;
+#               ifdef SCAVENGER_THREAD
+                  hhdr -> hb_free_ms = nexthdr -> hb_free_ms;
+#               endif
               }
             } else if (!IS_MAPPED(hhdr) && !IS_MAPPED(nexthdr)) {
               /* Unmap any gap in the middle */
@@ -584,6 +806,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_merge_u
             MANAGED_STACK_ADDRESS_BOEHM_GC_remove_from_fl_at(hhdr, i);
             MANAGED_STACK_ADDRESS_BOEHM_GC_remove_from_fl(nexthdr);
             hhdr -> hb_sz += nexthdr -> hb_sz;
+            MERGE_ZERO_BLK_FLAG(hhdr, nexthdr);
             MANAGED_STACK_ADDRESS_BOEHM_GC_remove_header(next);
             MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_fl(h, hhdr);
             /* Start over at beginning of list */
@@ -628,7 +851,7 @@ STATIC struct hblk * MANAGED_STACK_ADDRESS_BOEHM_GC_get_first_part(struct hblk *
         return NULL;
     }
     rest_hdr -> hb_sz = total_size - bytes;
-    rest_hdr -> hb_flags = 0;
+    rest_hdr -> hb_flags = hhdr -> hb_flags & ZERO_BLK;
 #   ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERTIONS
       /* Mark h not free, to avoid assertion about adjacent free blocks. */
         hhdr -> hb_flags &= (unsigned char)~FREE_BLK;
@@ -663,7 +886,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_split_block(struct hblk *h, hdr *hhdr
       nhdr -> hb_prev = prev;
       nhdr -> hb_next = next;
       nhdr -> hb_sz = total_size - h_size;
-      nhdr -> hb_flags = 0;
+      nhdr -> hb_flags = hhdr -> hb_flags & ZERO_BLK;
       if (prev /* != NULL */) { /* CPPCHECK */
         HDR(prev) -> hb_next = n;
       } else {
@@ -674,8 +897,13 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_split_block(struct hblk *h, hdr *hhdr
       }
       MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_free_bytes[index] > h_size);
       MANAGED_STACK_ADDRESS_BOEHM_GC_free_bytes[index] -= h_size;
+      if (N_HBLK_FLS == index) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_remove(hhdr, total_size);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_insert(n, nhdr);
+      }
 #   ifdef USE_MUNMAP
       hhdr -> hb_last_reclaimed = (unsigned short)MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+      SET_FREE_BLK_TIME(hhdr);
 #   endif
     hhdr -> hb_sz = h_size;
     MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_fl(h, hhdr);
@@ -709,8 +937,11 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC
 
     start_list = MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_fl_from_blocks(blocks);
     /* Try for an exact match first. */
-    result = MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(sz, kind, flags, start_list, FALSE, align_m1);
-    if (result != NULL) return result;
+    if (HBLK_FL_IS_NONEMPTY(start_list)) {
+      result = MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(sz, kind, flags, start_list, FALSE,
+                                align_m1);
+      if (result != NULL) return result;
+    }
 
     may_split = TRUE;
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_use_entire_heap || MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc
@@ -740,7 +971,12 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC
       /* matches.                                                       */
       ++start_list;
     }
-    for (; start_list <= split_limit; ++start_list) {
+    /* Visit only the non-empty lists; under fragmentation most of the */
+    /* intermediate ones are typically empty.                           */
+    result = NULL;
+    for (start_list = MANAGED_STACK_ADDRESS_BOEHM_GC_next_nonempty_hblk_fl(start_list);
+         start_list <= split_limit;
+         start_list = MANAGED_STACK_ADDRESS_BOEHM_GC_next_nonempty_hblk_fl(start_list + 1)) {
       result = MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(sz, kind, flags, start_list, may_split,
                                 align_m1);
       if (result != NULL) break;
@@ -826,13 +1062,21 @@ STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(size_t sz, int
     hdr *hhdr; /* header corresponding to hbp */
     word size_needed = HBLKSIZE * OBJ_SZ_TO_BLOCKS_CHECKED(sz);
                                 /* number of bytes in requested objects */
+    unsigned char zero_flag;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool use_index = N_HBLK_FLS == n && MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_indexed();
+                                /* the blocks are visited by size       */
+    size_t pos = 0;             /* the current entry of the index       */
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(((align_m1 + 1) & align_m1) == 0 && sz > 0);
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(0 == align_m1 || modHBLKSZ(align_m1 + 1) == 0);
   retry:
-    /* Search for a big enough block in free list.      */
-    for (hbp = MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfreelist[n];; hbp = hhdr -> hb_next) {
+    /* Search for a big enough block in free list.  In case of the      */
+    /* index, skip the blocks which are too small; thus the first one   */
+    /* that fits is the best fit.                                       */
+    if (use_index) pos = MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_lower_bound(size_needed, NULL);
+    for (hbp = use_index ? MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_at(pos) : MANAGED_STACK_ADDRESS_BOEHM_GC_hblkfreelist[n];;
+         hbp = use_index ? MANAGED_STACK_ADDRESS_BOEHM_GC_huge_fl_at(++pos) : hhdr -> hb_next) {
       word size_avail; /* bytes available in this block */
       size_t align_ofs;
 
@@ -843,7 +1087,10 @@ STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(size_t sz, int
       }
       GET_HDR(hbp, hhdr); /* set hhdr value */
       size_avail = hhdr -> hb_sz;
-      if (!may_split && size_avail != size_needed) continue;
+      if (!may_split && size_avail != size_needed) {
+        if (use_index) return NULL; /* the rest are larger */
+        continue;
+      }
 
       align_ofs = ALIGN_PAD_SZ(hbp, align_m1);
       if (size_avail < size_needed + align_ofs)
@@ -853,7 +1100,9 @@ STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(size_t sz, int
         /* If the next heap block is obviously better, go on.   */
         /* This prevents us from disassembling a single large   */
         /* block to get tiny blocks.                            */
-        if (next_hblk_fits_better(hhdr, size_avail, size_needed, align_m1))
+        if (!use_index
+            && next_hblk_fits_better(hhdr, size_avail, size_needed,
+                                     align_m1))
           continue;
       }
 
@@ -887,7 +1136,7 @@ STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(size_t sz, int
         struct hblk *prev = hhdr -> hb_prev;
 
         drop_hblk_in_chunks(n, hbp, hhdr);
-        if (NULL == prev) goto retry;
+        if (NULL == prev || use_index) goto retry;
         /* Restore hhdr to point at free block. */
         hhdr = HDR(prev);
         continue;
@@ -919,6 +1168,7 @@ STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(size_t sz, int
           MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_num_unmapped(hbp, hhdr);
           MANAGED_STACK_ADDRESS_BOEHM_GC_remap((ptr_t)hbp, (size_t)(hhdr -> hb_sz));
           hhdr -> hb_flags &= (unsigned char)~WAS_UNMAPPED;
+          SET_ZERO_BLK_IF_DISCARDED(hbp, hhdr);
         }
 #     endif
       /* Split the block at last_hbp. */
@@ -935,6 +1185,7 @@ STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(size_t sz, int
         MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_num_unmapped(hbp, hhdr);
         MANAGED_STACK_ADDRESS_BOEHM_GC_remap((ptr_t)hbp, (size_t)(hhdr -> hb_sz));
         hhdr -> hb_flags &= (unsigned char)~WAS_UNMAPPED;
+        SET_ZERO_BLK_IF_DISCARDED(hbp, hhdr);
         /* Note: This may leave adjacent, mapped free blocks. */
       }
 #   endif
@@ -948,10 +1199,12 @@ STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(size_t sz, int
 
     /* Set up the header.       */
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(HDR(hbp) == hhdr);
+    zero_flag = hhdr -> hb_flags & ZERO_BLK;
     if (EXPECT(!setup_header(hhdr, hbp, sz, kind, flags), FALSE)) {
       MANAGED_STACK_ADDRESS_BOEHM_GC_remove_counts(hbp, (size_t)size_needed);
       return NULL; /* ditto */
     }
+    hhdr -> hb_flags |= zero_flag; /* to be taken by the caller */
 
 #   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_DISABLE_INCREMENTAL
       /* Notify virtual dirty bit implementation that we are about to */
@@ -972,14 +1225,59 @@ STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk_nth(size_t sz, int
     return hbp;
 }
 
-/*
- * Free a heap block.
- *
- * Coalesce the block with its neighbors if possible.
- *
- * All mark words are assumed to be cleared.
- */
-MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk(struct hblk *hbp)
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_extend_hblk(struct hblk *h, size_t new_bytes,
+                                   MANAGED_STACK_ADDRESS_BOEHM_GC_bool *pzeroed)
+{
+    hdr *hhdr, *nexthdr;
+    struct hblk *next;
+    size_t old_bytes, extra;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(modHBLKSZ(new_bytes) == 0);
+    GET_HDR(h, hhdr);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(!HBLK_IS_FREE(hhdr) && hhdr -> hb_sz > MAXOBJBYTES);
+    old_bytes = HBLKSIZE * OBJ_SZ_TO_BLOCKS(hhdr -> hb_sz);
+    if (new_bytes <= old_bytes) return TRUE;
+    extra = new_bytes - old_bytes;
+    if ((new_bytes & SIGNB) != 0) return FALSE; /* too big */
+
+    next = (struct hblk *)((ptr_t)h + old_bytes);
+    GET_HDR(next, nexthdr);
+    if (NULL == nexthdr || IS_FORWARDING_ADDR_OR_NIL(nexthdr)
+        || !HBLK_IS_FREE(nexthdr) || nexthdr -> hb_sz < extra)
+      return FALSE;
+    if (!IS_UNCOLLECTABLE(hhdr -> hb_obj_kind)
+        && (hhdr -> hb_flags & IGNORE_OFF_PAGE) == 0
+        && MANAGED_STACK_ADDRESS_BOEHM_GC_is_black_listed(next, extra) != NULL)
+      return FALSE;
+
+#   ifdef USE_MUNMAP
+      if (!IS_MAPPED(nexthdr)) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_num_unmapped(next, nexthdr);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_remap((ptr_t)next, (size_t)(nexthdr -> hb_sz));
+        nexthdr -> hb_flags &= (unsigned char)~WAS_UNMAPPED;
+        SET_ZERO_BLK_IF_DISCARDED(next, nexthdr);
+      }
+#   endif
+    *pzeroed = (nexthdr -> hb_flags & ZERO_BLK) != 0;
+    next = MANAGED_STACK_ADDRESS_BOEHM_GC_get_first_part(next, nexthdr, extra,
+                MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_fl_from_blocks((size_t)divHBLKSZ(nexthdr -> hb_sz)));
+    if (EXPECT(NULL == next, FALSE)) return FALSE;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_remove_header(next);
+    if (EXPECT(!MANAGED_STACK_ADDRESS_BOEHM_GC_install_counts(h, new_bytes), FALSE))
+      return FALSE; /* This leaks memory under very rare conditions. */
+
+#   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_DISABLE_INCREMENTAL
+      MANAGED_STACK_ADDRESS_BOEHM_GC_remove_protection(next, divHBLKSZ(extra),
+                           0 == hhdr -> hb_descr /* pointer-free */);
+#   endif
+    MANAGED_STACK_ADDRESS_BOEHM_GC_large_free_bytes -= extra;
+    return TRUE;
+}
+
+/* Free a heap block (as MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk does).  Returns the resulting      */
+/* (possibly coalesced) free block.                                     */
+STATIC struct hblk *MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk_inner(struct hblk *hbp)
 {
     struct hblk *next, *prev;
     hdr *hhdr, *prevhdr, *nexthdr;
@@ -996,6 +1294,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehbl
     hhdr -> hb_sz = size;
 #   ifdef USE_MUNMAP
       hhdr -> hb_last_reclaimed = (unsigned short)MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+      SET_FREE_BLK_TIME(hhdr);
 #   endif
 
     /* Check for duplicate deallocation in the easy case */
@@ -1014,6 +1313,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehbl
           && !((hhdr -> hb_sz + nexthdr -> hb_sz) & SIGNB) /* no overflow */) {
         MANAGED_STACK_ADDRESS_BOEHM_GC_remove_from_fl(nexthdr);
         hhdr -> hb_sz += nexthdr -> hb_sz;
+        MERGE_ZERO_BLK_FLAG(hhdr, nexthdr);
         MANAGED_STACK_ADDRESS_BOEHM_GC_remove_header(next);
       }
     /* Coalesce with predecessor, if possible. */
@@ -1023,8 +1323,10 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehbl
             && !((hhdr -> hb_sz + prevhdr -> hb_sz) & SIGNB)) {
           MANAGED_STACK_ADDRESS_BOEHM_GC_remove_from_fl(prevhdr);
           prevhdr -> hb_sz += hhdr -> hb_sz;
+          MERGE_ZERO_BLK_FLAG(prevhdr, hhdr);
 #         ifdef USE_MUNMAP
             prevhdr -> hb_last_reclaimed = (unsigned short)MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+            SET_FREE_BLK_TIME(prevhdr);
 #         endif
           MANAGED_STACK_ADDRESS_BOEHM_GC_remove_header(hbp);
           hbp = prev;
@@ -1037,4 +1339,41 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehbl
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_large_free_bytes += size;
     MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_fl(hbp, hhdr);
+    return hbp;
+}
+
+/*
+ * Free a heap block.
+ *
+ * Coalesce the block with its neighbors if possible.
+ *
+ * All mark words are assumed to be cleared.
+ */
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk(struct hblk *hbp)
+{
+    (void)MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk_inner(hbp);
 }
+
+#ifdef USE_MUNMAP
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk_and_unmap(struct hblk *hbp)
+  {
+    hdr *hhdr;
+
+    hbp = MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk_inner(hbp);
+    if (0 == MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold) return; /* unmapping is disabled */
+    hhdr = HDR(hbp);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(IS_MAPPED(hhdr));
+#   ifdef COUNT_UNMAPPED_REGIONS
+      {
+        int delta = calc_num_unmapped_regions_delta(hbp, hhdr);
+
+        if (delta >= 0 && MANAGED_STACK_ADDRESS_BOEHM_GC_num_unmapped_regions + delta
+                          >= MANAGED_STACK_ADDRESS_BOEHM_GC_UNMAPPED_REGIONS_SOFT_LIMIT)
+          return; /* leave it to MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_old */
+        MANAGED_STACK_ADDRESS_BOEHM_GC_num_unmapped_regions += delta;
+      }
+#   endif
+    MANAGED_STACK_ADDRESS_BOEHM_GC_unmap((ptr_t)hbp, (size_t)(hhdr -> hb_sz));
+    hhdr -> hb_flags |= WAS_UNMAPPED;
+  }
+#endif /* USE_MUNMAP */
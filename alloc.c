@@ -293,6 +293,93 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API size_t MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MA
     return min_bytes_allocd_minimum;
 }
 
+#ifndef NO_CLOCK
+  /* The default target share (in percent) of the collector in the      */
+  /* process time for the pacer.                                        */
+# ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_PACER_PERCENT
+#   define MANAGED_STACK_ADDRESS_BOEHM_GC_PACER_PERCENT 25
+# endif
+
+  /* The upper bound of MANAGED_STACK_ADDRESS_BOEHM_GC_rate chosen by the pacer (so that the value  */
+  /* multiplied by the collect_a_little argument does not overflow).    */
+# ifndef MAX_PACER_RATE
+#   define MAX_PACER_RATE 0x10000
+# endif
+
+  STATIC struct MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats_s MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats;
+                        /* The latest pacer decision; the pacer is on   */
+                        /* if max_pause_us is non-zero.  Accessed with  */
+                        /* the allocation lock held (except for the     */
+                        /* setter and getter of the public API).        */
+
+  STATIC unsigned long MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns = 0;
+                        /* Total time of marking (world-stopped and     */
+                        /* incremental) since the latest collection.    */
+  STATIC unsigned long MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_pause_ns = 0;
+                        /* The longest marking pause since then.        */
+
+  STATIC struct MANAGED_STACK_ADDRESS_BOEHM_GC_timeval_s MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_saved_time_limit;
+  STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_saved_rate = 0;
+                        /* The time limit and MANAGED_STACK_ADDRESS_BOEHM_GC_rate values set by the */
+                        /* client before the pacer has been turned on;  */
+                        /* restored when it is turned off.              */
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target(unsigned long max_pause_us,
+                                          unsigned gc_percent)
+  {
+    if (EXPECT(gc_percent >= 100, FALSE)) {
+      WARN("Pacer gc_percent (%" WARN_PRIuPTR ") is too big, using 99\n",
+           (word)gc_percent);
+      gc_percent = 99;
+    }
+    if (0 == max_pause_us) {
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_set_time_limit_tv(MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_saved_time_limit);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_set_rate(MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_saved_rate);
+      }
+      BZERO(&MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats, sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats));
+      return;
+    }
+    if (0 == MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_saved_time_limit = MANAGED_STACK_ADDRESS_BOEHM_GC_get_time_limit_tv();
+      MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_saved_rate = MANAGED_STACK_ADDRESS_BOEHM_GC_get_rate();
+    }
+    if (max_pause_us >= (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_TIME_UNLIMITED * 1000)
+      max_pause_us = (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_TIME_UNLIMITED * 1000 - 1;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us = max_pause_us;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.gc_percent = gc_percent > 0 ? gc_percent
+                                               : MANAGED_STACK_ADDRESS_BOEHM_GC_PACER_PERCENT;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_time_limit = max_pause_us / 1000;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_time_lim_nsec = (max_pause_us % 1000) * 1000;
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_pacer_stats(struct MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats_s *pstats)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(NONNULL_ARG_NOT_NULL(pstats));
+    *pstats = MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats;
+  }
+
+  /* Same as MS_TIME_DIFF(a,b)*1000000+NS_FRAC_TIME_DIFF(a,b) but       */
+  /* saturated on overflow.                                             */
+  static unsigned long pacer_ns_diff(CLOCK_TYPE a, CLOCK_TYPE b)
+  {
+    unsigned long ms = MS_TIME_DIFF(a, b);
+
+    if (ms >= ((unsigned long)-1) / 1000000UL - 1)
+      return (unsigned long)-1;
+    return ms * 1000000UL + NS_FRAC_TIME_DIFF(a, b);
+  }
+
+  /* Account a marking pause of the given duration.     */
+  static void pacer_note_pause(unsigned long ns)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns = MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns + ns >= ns ? MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns + ns
+                                                   : (unsigned long)-1;
+    if (ns > MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_pause_ns)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_pause_ns = ns;
+  }
+#endif /* !NO_CLOCK */
+
 /* Return the minimum number of bytes that must be allocated between    */
 /* collections to amortize the collection cost.  Should be non-zero.    */
 static word min_bytes_allocd(void)
@@ -305,6 +392,13 @@ static word min_bytes_allocd(void)
     word scan_size;             /* Estimate of memory to be scanned     */
                                 /* during normal GC.                    */
 
+#   ifndef NO_CLOCK
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.trigger_bytes != 0) {
+        /* The pacer has chosen the amount already.     */
+        return MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.trigger_bytes > min_bytes_allocd_minimum
+                ? MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.trigger_bytes : min_bytes_allocd_minimum;
+      }
+#   endif
 #   ifdef THREADS
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_need_to_lock) {
         /* We are multi-threaded... */
@@ -432,6 +526,10 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_last_heap_growth_gc_no == MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no)
       return TRUE; /* avoid expanding past limits used by blacklisting  */
 
+#   ifdef MEMORY_CONTROLLER
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_memory_pressure)
+        return MANAGED_STACK_ADDRESS_BOEHM_GC_adj_bytes_allocd() >= last_min_bytes_allocd / 4;
+#   endif
     return MANAGED_STACK_ADDRESS_BOEHM_GC_adj_bytes_allocd() >= last_min_bytes_allocd;
 }
 
@@ -470,8 +568,9 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_stoppe
 STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection(void);
 
 /* Initiate a garbage collection if appropriate.  Choose judiciously    */
-/* between partial, full, and stop-world collections.                   */
-STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_maybe_gc(void)
+/* between partial, full, and stop-world collections.  stop_func limits */
+/* the initial world-stopped marking in the incremental mode.           */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_maybe_gc(MANAGED_STACK_ADDRESS_BOEHM_GC_stop_func stop_func)
 {
   static int n_partial_gcs = 0;
 
@@ -508,7 +607,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_maybe_gc(void)
 # ifndef NO_CLOCK
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_time_limit != MANAGED_STACK_ADDRESS_BOEHM_GC_TIME_UNLIMITED) GET_TIME(MANAGED_STACK_ADDRESS_BOEHM_GC_start_time);
 # endif
-  if (MANAGED_STACK_ADDRESS_BOEHM_GC_stopped_mark(MANAGED_STACK_ADDRESS_BOEHM_GC_timeout_stop_func)) {
+  if (MANAGED_STACK_ADDRESS_BOEHM_GC_stopped_mark(stop_func)) {
 #   ifdef SAVE_CALL_CHAIN
       MANAGED_STACK_ADDRESS_BOEHM_GC_save_callers(MANAGED_STACK_ADDRESS_BOEHM_GC_last_stack);
 #   endif
@@ -548,11 +647,13 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
       CLOCK_TYPE start_time = CLOCK_TYPE_INITIALIZER;
       MANAGED_STACK_ADDRESS_BOEHM_GC_bool start_time_valid;
 #   endif
+    EVTRACE_SPAN(sp)
 
     ASSERT_CANCEL_DISABLED();
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized);
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc || (*stop_func)()) return FALSE;
+    EVTRACE_BEGIN(sp);
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
       MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_START);
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress()) {
@@ -636,6 +737,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
                         time_diff, ns_frac_diff);
       }
 #   endif
+    EVTRACE_END(sp, 0, EVTRACE_COLLECTION, MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no, 0);
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
       MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_END);
     return TRUE;
@@ -698,6 +800,12 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_collect
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress()) {
         int i;
         int max_deficit = MANAGED_STACK_ADDRESS_BOEHM_GC_rate * n;
+#       ifndef NO_CLOCK
+            CLOCK_TYPE start_time = CLOCK_TYPE_INITIALIZER;
+
+            if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0)
+                GET_TIME(start_time);
+#       endif
 
 #       ifdef PARALLEL_MARK
             if (MANAGED_STACK_ADDRESS_BOEHM_GC_time_limit != MANAGED_STACK_ADDRESS_BOEHM_GC_TIME_UNLIMITED)
@@ -710,6 +818,14 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_collect
 #       ifdef PARALLEL_MARK
             MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_disabled = FALSE;
 #       endif
+#       ifndef NO_CLOCK
+            if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0) {
+                CLOCK_TYPE done_time;
+
+                GET_TIME(done_time);
+                pacer_note_pause(pacer_ns_diff(done_time, start_time));
+            }
+#       endif
 
         if (i < max_deficit && !MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc) {
             MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(!MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress());
@@ -739,11 +855,106 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_collect
                 MANAGED_STACK_ADDRESS_BOEHM_GC_deficit = 0;
         }
     } else if (!MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc) {
-        MANAGED_STACK_ADDRESS_BOEHM_GC_maybe_gc();
+        MANAGED_STACK_ADDRESS_BOEHM_GC_maybe_gc(MANAGED_STACK_ADDRESS_BOEHM_GC_timeout_stop_func);
     }
     RESTORE_CANCEL(cancel_state);
 }
 
+/* The maximum number of MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner units a thread does  */
+/* at a time to pay its marking debt; the rest of the debt is paid on   */
+/* the subsequent allocations (or before the heap is grown by them).    */
+/* Only the pause is bounded, not the debt.                             */
+#ifndef MAX_MARK_ASSIST_UNITS
+# define MAX_MARK_ASSIST_UNITS 4
+#endif
+
+#ifndef THREADS
+  STATIC struct mark_assist_s MANAGED_STACK_ADDRESS_BOEHM_GC_mark_assist_state;
+#endif
+
+/* Return the mark assist state of the current thread (or NULL).  The   */
+/* credit of a previous collection is dropped, but the debt is carried  */
+/* over to the collection in progress.                                  */
+static struct mark_assist_s *self_mark_assist(void)
+{
+  struct mark_assist_s *ma;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+# ifdef THREADS
+    ma = MANAGED_STACK_ADDRESS_BOEHM_GC_self_mark_assist();
+    if (EXPECT(NULL == ma, FALSE)) return NULL;
+# else
+    ma = &MANAGED_STACK_ADDRESS_BOEHM_GC_mark_assist_state;
+# endif
+  if (ma -> gc_no != MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no) {
+    if (ma -> balance < 0 || !MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress())
+      ma -> balance = 0;
+    ma -> gc_no = MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+  }
+  return ma;
+}
+
+/* Credit the current thread with the marking work done by it other     */
+/* than in MANAGED_STACK_ADDRESS_BOEHM_GC_mark_assist (i.e. explicitly requested by the client).    */
+static void mark_assist_credit(word bytes)
+{
+  struct mark_assist_s *ma;
+
+  if (!MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress()) return;
+  ma = self_mark_assist();
+  if (ma != NULL)
+    ma -> balance -= (signed_word)bytes;
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_assist(word bytes)
+{
+  struct mark_assist_s *ma;
+  word units;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  if (!MANAGED_STACK_ADDRESS_BOEHM_GC_incremental || !MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress()
+      || NULL == (ma = self_mark_assist())) {
+    /* Either no marking to help (but a collection might be started),   */
+    /* or an unregistered thread which cannot be charged.               */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner(1);
+    return;
+  }
+
+  ma -> balance += (signed_word)bytes;
+  if (ma -> balance < (signed_word)HBLKSIZE)
+    return; /* in credit, or the debt is too small */
+  units = (word)(ma -> balance) / HBLKSIZE;
+  if (units > MAX_MARK_ASSIST_UNITS)
+    units = MAX_MARK_ASSIST_UNITS;
+  ma -> balance -= (signed_word)(units * HBLKSIZE);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner((int)units);
+}
+
+/* Pay the whole marking debt of the current thread (in bounded steps)  */
+/* or until the collection is finished.  Called instead of growing the  */
+/* heap, so that an allocating thread cannot get ahead of the marker.   */
+/* Returns FALSE if there is no debt to pay.                            */
+static MANAGED_STACK_ADDRESS_BOEHM_GC_bool pay_mark_assist_debt(void)
+{
+  struct mark_assist_s *ma;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  if (!MANAGED_STACK_ADDRESS_BOEHM_GC_incremental || MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc || !MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress()
+      || NULL == (ma = self_mark_assist())
+      || ma -> balance < (signed_word)HBLKSIZE)
+    return FALSE;
+  do {
+    word units = (word)(ma -> balance) / HBLKSIZE;
+
+    if (units > MAX_MARK_ASSIST_UNITS)
+      units = MAX_MARK_ASSIST_UNITS;
+    ma -> balance -= (signed_word)(units * HBLKSIZE);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner((int)units);
+  } while (ma -> balance >= (signed_word)HBLKSIZE
+           && MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress());
+  return TRUE;
+}
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void (*MANAGED_STACK_ADDRESS_BOEHM_GC_check_heap)(void) = 0;
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void (*MANAGED_STACK_ADDRESS_BOEHM_GC_print_all_smashed)(void) = 0;
 
@@ -756,6 +967,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
     ENTER_GC();
     /* Note: if the collection is in progress, this may do marking (not */
     /* stopping the world) even in case of disabled GC.                 */
+    mark_assist_credit(HBLKSIZE);
     MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner(1);
     EXIT_GC();
     result = (int)MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress();
@@ -764,6 +976,191 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
     return result;
 }
 
+#ifdef USE_MUNMAP
+  STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_defer_unmap = FALSE;
+                        /* Unmap the free blocks in MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle     */
+                        /* instead of at the end of a collection.       */
+
+  STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_pending = FALSE;
+                        /* The unmapping is deferred by the last        */
+                        /* collection and not done yet.                 */
+#endif
+
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_idle_swept_gc_no = 0;
+                        /* The last collection MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle swept    */
+                        /* all the blocks after.                        */
+
+#ifndef NO_CLOCK
+  STATIC CLOCK_TYPE MANAGED_STACK_ADDRESS_BOEHM_GC_idle_start_time = CLOCK_TYPE_INITIALIZER;
+  STATIC unsigned long MANAGED_STACK_ADDRESS_BOEHM_GC_idle_budget_ns = 0;
+#else
+  STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_idle_steps_left = 0;
+#endif
+
+/* The stop function used by MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle.  Called holding the lock. */
+/* A concurrent call of MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle restarts the budget.            */
+STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func(void)
+{
+# ifndef NO_CLOCK
+    CLOCK_TYPE current_time;
+# endif
+
+  if (MANAGED_STACK_ADDRESS_BOEHM_GC_default_stop_func())
+    return TRUE;
+# ifdef NO_CLOCK
+    /* Do roughly the amount of work of MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little.    */
+    return --MANAGED_STACK_ADDRESS_BOEHM_GC_idle_steps_left < 0;
+# else
+    GET_TIME(current_time);
+    return pacer_ns_diff(current_time, MANAGED_STACK_ADDRESS_BOEHM_GC_idle_start_time)
+            >= MANAGED_STACK_ADDRESS_BOEHM_GC_idle_budget_ns;
+# endif
+}
+
+/* Is it worth starting a collection while idle?  In the incremental    */
+/* mode, it is started ahead of time, so that the marking is done while */
+/* idle rather than in the allocation calls.                            */
+static MANAGED_STACK_ADDRESS_BOEHM_GC_bool idle_collection_due(void)
+{
+  word min_bytes = min_bytes_allocd();
+
+  if (MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc || MANAGED_STACK_ADDRESS_BOEHM_GC_disable_automatic_collection) return FALSE;
+  if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental) min_bytes /= 2;
+  return MANAGED_STACK_ADDRESS_BOEHM_GC_adj_bytes_allocd() >= min_bytes;
+}
+
+/* Mark (incrementally) until done, or the time is over.  Then finish   */
+/* the collection with the world stopped.                               */
+static void idle_mark(void)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_bool done = FALSE;
+  word steps = 0;
+# ifndef NO_CLOCK
+    CLOCK_TYPE start_time = CLOCK_TYPE_INITIALIZER;
+
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0)
+      GET_TIME(start_time);
+# endif
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+# ifdef PARALLEL_MARK
+    MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_disabled = TRUE;
+# endif
+  while (!MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func()) {
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_mark_some(NULL)) {
+      done = TRUE;
+      break;
+    }
+    steps++;
+  }
+  /* The marking done while idle is credited to the thread.     */
+  mark_assist_credit(steps / (word)MANAGED_STACK_ADDRESS_BOEHM_GC_rate * HBLKSIZE);
+# ifdef PARALLEL_MARK
+    MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_disabled = FALSE;
+# endif
+# ifndef NO_CLOCK
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0) {
+      CLOCK_TYPE done_time;
+
+      GET_TIME(done_time);
+      pacer_note_pause(pacer_ns_diff(done_time, start_time));
+    }
+# endif
+  if (done && !MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(!MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress());
+#   ifdef SAVE_CALL_CHAIN
+      MANAGED_STACK_ADDRESS_BOEHM_GC_save_callers(MANAGED_STACK_ADDRESS_BOEHM_GC_last_stack);
+#   endif
+#   ifdef PARALLEL_MARK
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_wait_for_reclaim();
+#   endif
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_stopped_mark(MANAGED_STACK_ADDRESS_BOEHM_GC_n_attempts < max_prior_attempts ?
+                        MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func : MANAGED_STACK_ADDRESS_BOEHM_GC_never_stop_func)) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection();
+    } else {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_n_attempts++;
+    }
+  }
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API unsigned MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle(unsigned long budget_ns)
+{
+    unsigned pending = 0;
+    IF_CANCEL(int cancel_state;)
+
+    if (!EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized, TRUE)) MANAGED_STACK_ADDRESS_BOEHM_GC_init();
+    LOCK();
+#   ifndef NO_CLOCK
+      GET_TIME(MANAGED_STACK_ADDRESS_BOEHM_GC_idle_start_time);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_idle_budget_ns = budget_ns;
+#   else
+      MANAGED_STACK_ADDRESS_BOEHM_GC_idle_steps_left = MANAGED_STACK_ADDRESS_BOEHM_GC_rate;
+      UNUSED_ARG(budget_ns);
+#   endif
+    DISABLE_CANCEL(cancel_state);
+    ENTER_GC();
+#   ifdef USE_MUNMAP
+      MANAGED_STACK_ADDRESS_BOEHM_GC_defer_unmap = TRUE;
+#   endif
+    for (;;) {
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress()) {
+        idle_mark();
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress()) break;
+      }
+
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_idle_swept_gc_no != MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no) {
+#       ifdef PARALLEL_MARK
+          if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel)
+            MANAGED_STACK_ADDRESS_BOEHM_GC_wait_for_reclaim();
+#       endif
+        if (!MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_all(MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func, FALSE)) break;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_idle_swept_gc_no = MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+      }
+
+#     ifdef USE_MUNMAP
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_pending) {
+          if (MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func()) break;
+          MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_pending = FALSE;
+          if (MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold > 0)
+            MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_old(MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold);
+        }
+#     endif
+
+      if (!idle_collection_due() || MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func()) break;
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental) {
+#       ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_DISABLE_INCREMENTAL
+          MANAGED_STACK_ADDRESS_BOEHM_GC_should_start_incremental_collection = TRUE;
+#       endif
+        MANAGED_STACK_ADDRESS_BOEHM_GC_maybe_gc(MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func);
+      } else if (!MANAGED_STACK_ADDRESS_BOEHM_GC_try_to_collect_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func)) {
+        break;
+      }
+    }
+
+    if ((MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress())
+        || idle_collection_due())
+      pending |= MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_MARK;
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_idle_swept_gc_no != MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no)
+      pending |= MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_SWEEP;
+#   ifdef USE_MUNMAP
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_pending)
+        pending |= MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_UNMAP;
+#   endif
+    EXIT_GC();
+    RESTORE_CANCEL(cancel_state);
+    UNLOCK();
+#   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_should_invoke_finalizers()) {
+        if (!MANAGED_STACK_ADDRESS_BOEHM_GC_finalize_on_demand)
+          (void)MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_some_finalizers(MANAGED_STACK_ADDRESS_BOEHM_GC_idle_stop_func);
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_should_invoke_finalizers())
+          pending |= MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_FINALIZE;
+      }
+#   endif
+    return pending;
+}
+
 #ifdef THREADS
   MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_stop_world_external(void)
   {
@@ -829,6 +1226,9 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_stoppe
       CLOCK_TYPE start_time = CLOCK_TYPE_INITIALIZER;
       MANAGED_STACK_ADDRESS_BOEHM_GC_bool start_time_valid = FALSE;
 #   endif
+    EVTRACE_SPAN(pause_sp)
+    EVTRACE_SPAN(world_sp)
+    EVTRACE_SPAN(mark_sp)
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized);
@@ -848,16 +1248,20 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_stoppe
               "\n--> Marking for collection #%lu after %lu allocated bytes\n",
               (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no + 1, (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_allocd);
 #   ifndef NO_CLOCK
-      if (MANAGED_STACK_ADDRESS_BOEHM_GC_PRINT_STATS_FLAG || measure_performance) {
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_PRINT_STATS_FLAG || measure_performance
+          || MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0) {
         GET_TIME(start_time);
         start_time_valid = TRUE;
       }
 #   endif
+    EVTRACE_BEGIN(pause_sp);
 #   ifdef THREADS
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
         MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_PRE_STOP_WORLD);
 #   endif
+    EVTRACE_BEGIN(world_sp);
     STOP_WORLD();
+    EVTRACE_END(world_sp, 0, EVTRACE_STOP_WORLD, 0, 0);
 #   ifdef THREADS
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
         MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_POST_STOP_WORLD);
@@ -875,6 +1279,7 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_stoppe
     /* Notify about marking from all roots.     */
         if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
           MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_MARK_START);
+        EVTRACE_BEGIN(mark_sp);
 
     /* Minimize junk left in my registers and on the stack.     */
             MANAGED_STACK_ADDRESS_BOEHM_GC_clear_a_few_frames();
@@ -907,6 +1312,12 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_stoppe
       /* TODO: Notify MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_MARK_ABANDON */
     } else {
       MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no++;
+#     ifdef LOCK_FREE_WEAK_DEREF
+        /* The links to the unmarked objects are not safe to read until */
+        /* they are cleared by MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection.                    */
+        MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq & 1) == 0);
+        AO_store_release(&MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq, MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq + 1);
+#     endif
       /* Check all debugged objects for consistency.    */
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started) {
         (*MANAGED_STACK_ADDRESS_BOEHM_GC_check_heap)();
@@ -914,6 +1325,7 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_stoppe
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
         MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_MARK_END);
     }
+    EVTRACE_END(mark_sp, 0, EVTRACE_MARK, MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no, abandoned_at >= 0);
 
 #   ifdef THREADS
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
@@ -922,11 +1334,14 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_stoppe
 #   ifdef THREAD_LOCAL_ALLOC
       MANAGED_STACK_ADDRESS_BOEHM_GC_world_stopped = FALSE;
 #   endif
+    EVTRACE_BEGIN(world_sp);
     START_WORLD();
+    EVTRACE_END(world_sp, 0, EVTRACE_START_WORLD, 0, 0);
 #   ifdef THREADS
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
         MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_POST_START_WORLD);
 #   endif
+    EVTRACE_END(pause_sp, 0, EVTRACE_PAUSE, MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no, 0);
 
 #   ifndef NO_CLOCK
       if (start_time_valid) {
@@ -937,6 +1352,8 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_stoppe
         GET_TIME(current_time);
         time_diff = MS_TIME_DIFF(current_time, start_time);
         ns_frac_diff = NS_FRAC_TIME_DIFF(current_time, start_time);
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0)
+          pacer_note_pause(pacer_ns_diff(current_time, start_time));
         if (measure_performance) {
           stopped_mark_total_time += time_diff; /* may wrap */
           stopped_mark_total_ns_frac += (unsigned32)ns_frac_diff;
@@ -1125,6 +1542,107 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE int MANAGED_STACK_ADDRESS_BOEHM_GC_compute
                    TO_KiB_UL(MANAGED_STACK_ADDRESS_BOEHM_GC_composite_in_use), \
                    TO_KiB_UL(MANAGED_STACK_ADDRESS_BOEHM_GC_atomic_in_use + MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_allocd))
 
+#ifndef NO_CLOCK
+  /* Return a*b/c (approximately if the product overflows). */
+  static word mul_div_approx(word a, word b, word c)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(c != 0);
+    if (b != 0 && a > MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX / b)
+      return a / c > MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX / b ? MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX : a / c * b;
+    return a * b / c;
+  }
+
+  /* Average the new sample with the previous ones.     */
+# define PACER_SMOOTH(old, sample) \
+                ((old) != 0 ? (old) - (old) / 4 + (sample) / 4 : (sample))
+
+  /* Measure the marking and allocation rates of the cycle being        */
+  /* finished, and choose the amount of allocation till the next        */
+  /* collection and the incremental work size to meet the targets set   */
+  /* by MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target.  gc_start_time is the time the sweep of    */
+  /* this cycle has been started at.  Called before resetting the       */
+  /* allocation counters.                                               */
+  STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_update(CLOCK_TYPE gc_start_time)
+  {
+    static CLOCK_TYPE last_gc_time = CLOCK_TYPE_INITIALIZER;
+    static MANAGED_STACK_ADDRESS_BOEHM_GC_bool last_gc_time_valid = FALSE;
+    struct MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats_s *ps = &MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats;
+    CLOCK_TYPE current_time;
+    unsigned long gc_ns;
+    word live_bytes = MANAGED_STACK_ADDRESS_BOEHM_GC_composite_in_use + MANAGED_STACK_ADDRESS_BOEHM_GC_atomic_in_use;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    GET_TIME(current_time);
+    gc_ns = pacer_ns_diff(current_time, gc_start_time);
+    gc_ns = MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns + gc_ns >= gc_ns ? MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns + gc_ns
+                                              : (unsigned long)-1;
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns != 0) {
+      word sample = mul_div_approx(live_bytes, 1000000UL, MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns);
+
+      ps -> mark_rate = PACER_SMOOTH(ps -> mark_rate, sample);
+    }
+    if (last_gc_time_valid) {
+      unsigned long elapsed_ns = pacer_ns_diff(current_time, last_gc_time);
+
+      if (elapsed_ns > gc_ns) {
+        word sample = mul_div_approx(MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_allocd, 1000000UL,
+                                     elapsed_ns - gc_ns);
+
+        ps -> alloc_rate = PACER_SMOOTH(ps -> alloc_rate, sample);
+        ps -> measured_percent = (unsigned)mul_div_approx(gc_ns, 100,
+                                                          elapsed_ns);
+      } else {
+        ps -> measured_percent = 100;
+      }
+    }
+    last_gc_time = current_time;
+    last_gc_time_valid = TRUE;
+
+    if (ps -> mark_rate != 0 && ps -> alloc_rate != 0) {
+      /* The collector takes live_bytes/mark_rate, the mutator runs     */
+      /* for trigger_bytes/alloc_rate; the share of the former should   */
+      /* not exceed gc_percent.                                         */
+      word trigger = mul_div_approx(mul_div_approx(live_bytes,
+                                        100 - ps -> gc_percent,
+                                        ps -> gc_percent),
+                                    ps -> alloc_rate, ps -> mark_rate);
+
+      if (trigger < MINHINCR * HBLKSIZE)
+        trigger = MINHINCR * HBLKSIZE;
+      ps -> trigger_bytes = trigger;
+      ps -> heap_goal = live_bytes + trigger >= trigger ? live_bytes + trigger
+                                                         : MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX;
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental) {
+        /* A unit of the incremental work scans about HBLKSIZE bytes    */
+        /* (see the credit in MANAGED_STACK_ADDRESS_BOEHM_GC_mark_from).                            */
+        word units = mul_div_approx(ps -> mark_rate, ps -> max_pause_us,
+                                    1000 * HBLKSIZE);
+
+        MANAGED_STACK_ADDRESS_BOEHM_GC_rate = units == 0 ? 1 : units < MAX_PACER_RATE ? (int)units
+                                                          : MAX_PACER_RATE;
+      }
+    }
+    ps -> gc_no = MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+    ps -> pause_ns = MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_pause_ns;
+    ps -> gc_ns = gc_ns;
+    ps -> rate = MANAGED_STACK_ADDRESS_BOEHM_GC_rate;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Pacer: GC #%lu took %lu us (max pause %lu us),"
+                       " %u%% of time; mark rate %lu, alloc rate %lu"
+                       " bytes/ms -> trigger %lu KiB, heap goal %lu KiB,"
+                       " rate %d\n",
+                       (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no, gc_ns / 1000,
+                       MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_pause_ns / 1000, ps -> measured_percent,
+                       (unsigned long)(ps -> mark_rate),
+                       (unsigned long)(ps -> alloc_rate),
+                       TO_KiB_UL(ps -> trigger_bytes),
+                       TO_KiB_UL(ps -> heap_goal), MANAGED_STACK_ADDRESS_BOEHM_GC_rate);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_mark_ns = 0;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_pause_ns = 0;
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_PACER_UPDATE);
+  }
+#endif /* !NO_CLOCK */
+
 /* Finish up a collection.  Assumes mark bits are consistent, but the   */
 /* world is otherwise running.                                          */
 STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection(void)
@@ -1133,8 +1651,10 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection(void)
       CLOCK_TYPE start_time = CLOCK_TYPE_INITIALIZER;
       CLOCK_TYPE finalize_time = CLOCK_TYPE_INITIALIZER;
 #   endif
+    EVTRACE_SPAN(sp)
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    EVTRACE_BEGIN(sp);
 #   if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERTIONS) \
        && defined(THREAD_LOCAL_ALLOC) && !defined(DBG_HDRS_ALL)
         /* Check that we marked some of our own data.           */
@@ -1143,7 +1663,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection(void)
 #   endif
 
 #   ifndef NO_CLOCK
-      if (MANAGED_STACK_ADDRESS_BOEHM_GC_print_stats)
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_print_stats || MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0)
         GET_TIME(start_time);
 #   endif
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
@@ -1217,14 +1737,25 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection(void)
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_VERBOSE_LOG_PRINTF("Bytes recovered before sweep - f.l. count = %ld\n",
                           (long)MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_found);
+#   ifdef ENABLE_HEAP_PROFILE
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_live != 0)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sweep(); /* forget the sampled objects to be reclaimed */
+#   endif
 
     /* Reconstruct free lists to contain everything not marked */
     MANAGED_STACK_ADDRESS_BOEHM_GC_start_reclaim(FALSE);
 
 #   ifdef USE_MUNMAP
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold > 0 /* unmapping enabled? */
-          && EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no != 1, TRUE)) /* do not unmap during GC init */
-        MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_old(MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold);
+          && EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no != 1, TRUE)) {
+                                /* do not unmap during GC init */
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_defer_unmap && !MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_pending) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_pending = TRUE; /* leave it to MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle */
+        } else {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_pending = FALSE;
+          MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_old(MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold);
+        }
+      }
 
       MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize >= MANAGED_STACK_ADDRESS_BOEHM_GC_unmapped_bytes);
 #   endif
@@ -1246,6 +1777,11 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection(void)
                           > min_bytes_allocd() + MANAGED_STACK_ADDRESS_BOEHM_GC_large_free_bytes;
     }
 
+#   ifndef NO_CLOCK
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.max_pause_us != 0)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_update(start_time);
+#   endif
+
     /* Reset or increment counters for next cycle */
     MANAGED_STACK_ADDRESS_BOEHM_GC_n_attempts = 0;
     MANAGED_STACK_ADDRESS_BOEHM_GC_is_full_gc = FALSE;
@@ -1256,6 +1792,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_finish_collection(void)
     MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_freed = 0;
     MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_bytes_freed = 0;
 
+    EVTRACE_END(sp, 0, EVTRACE_FINISH_COLLECTION, MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no, 0);
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event)
       MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event(MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_RECLAIM_END);
 #   ifndef NO_CLOCK
@@ -1346,28 +1883,38 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
     (void)MANAGED_STACK_ADDRESS_BOEHM_GC_try_to_collect_general(MANAGED_STACK_ADDRESS_BOEHM_GC_never_stop_func, TRUE);
 }
 
-MANAGED_STACK_ADDRESS_BOEHM_GC_INNER ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_os_get_mem(size_t bytes)
+/* Account the memory chunk obtained from the OS.      */
+static void add_to_our_memory(ptr_t space, size_t bytes)
 {
-  struct hblk *space = GET_MEM(bytes); /* HBLKSIZE-aligned */
-
-  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
-  if (EXPECT(NULL == space, FALSE)) return NULL;
 # ifdef USE_PROC_FOR_LIBRARIES
     /* Add HBLKSIZE aligned, GET_MEM-generated block to MANAGED_STACK_ADDRESS_BOEHM_GC_our_memory. */
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_n_memory >= MAX_HEAP_SECTS)
       ABORT("Too many GC-allocated memory sections: Increase MAX_HEAP_SECTS");
-    MANAGED_STACK_ADDRESS_BOEHM_GC_our_memory[MANAGED_STACK_ADDRESS_BOEHM_GC_n_memory].hs_start = (ptr_t)space;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_our_memory[MANAGED_STACK_ADDRESS_BOEHM_GC_n_memory].hs_start = space;
     MANAGED_STACK_ADDRESS_BOEHM_GC_our_memory[MANAGED_STACK_ADDRESS_BOEHM_GC_n_memory].hs_bytes = bytes;
     MANAGED_STACK_ADDRESS_BOEHM_GC_n_memory++;
+# else
+    UNUSED_ARG(space);
 # endif
   MANAGED_STACK_ADDRESS_BOEHM_GC_our_mem_bytes += bytes;
   MANAGED_STACK_ADDRESS_BOEHM_GC_VERBOSE_LOG_PRINTF("Got %lu bytes from OS\n", (unsigned long)bytes);
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_os_get_mem(size_t bytes)
+{
+  struct hblk *space = GET_MEM(bytes); /* HBLKSIZE-aligned */
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  if (EXPECT(NULL == space, FALSE)) return NULL;
+  add_to_our_memory((ptr_t)space, bytes);
   return (ptr_t)space;
 }
 
 /* Use the chunk of memory starting at p of size bytes as part of the heap. */
 /* Assumes p is HBLKSIZE aligned, bytes argument is a multiple of HBLKSIZE. */
-STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap(struct hblk *p, size_t bytes)
+/* The zeroed argument tells whether the chunk is known to be 0-filled.     */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap(struct hblk *p, size_t bytes,
+                                MANAGED_STACK_ADDRESS_BOEHM_GC_bool zeroed)
 {
     hdr * phdr;
     word endp;
@@ -1449,7 +1996,7 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap(struct hblk *p, size_t by
     MANAGED_STACK_ADDRESS_BOEHM_GC_heap_sects[MANAGED_STACK_ADDRESS_BOEHM_GC_n_heap_sects].hs_bytes = bytes;
     MANAGED_STACK_ADDRESS_BOEHM_GC_n_heap_sects++;
     phdr -> hb_sz = bytes;
-    phdr -> hb_flags = 0;
+    phdr -> hb_flags = zeroed ? ZERO_BLK : 0;
     MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk(p);
     MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize += bytes;
 
@@ -1524,6 +2071,49 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
     MANAGED_STACK_ADDRESS_BOEHM_GC_max_heapsize = n;
 }
 
+#ifdef MEMORY_CONTROLLER
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER word MANAGED_STACK_ADDRESS_BOEHM_GC_soft_max_heapsize = 0;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_memory_pressure = FALSE;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_to_memory_limit(word limit, word current,
+                                          unsigned headroom_percent,
+                                          MANAGED_STACK_ADDRESS_BOEHM_GC_bool psi_pressure)
+  {
+    word mapped = MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize - MANAGED_STACK_ADDRESS_BOEHM_GC_unmapped_bytes;
+    word soft_max = 0;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool pressure = psi_pressure;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    if (limit != 0) {
+      word target = limit - limit / 100 * headroom_percent;
+      word others = current > mapped ? current - mapped : 0;
+                        /* memory of the cgroup not used by the heap */
+
+      if (current >= target) pressure = TRUE;
+      soft_max = target > others + MINHINCR * HBLKSIZE ? target - others
+                                                       : MINHINCR * HBLKSIZE;
+    }
+    if (pressure && (0 == soft_max || soft_max > mapped)) {
+      /* Do not grow at all while under pressure.       */
+      soft_max = mapped;
+    }
+    if (pressure != MANAGED_STACK_ADDRESS_BOEHM_GC_memory_pressure) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Memory pressure %s (cgroup usage: %lu of %lu KiB,"
+                         " heap: %lu KiB)\n", pressure ? "on" : "off",
+                         TO_KiB_UL(current), TO_KiB_UL(limit),
+                         TO_KiB_UL(mapped));
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_memory_pressure = pressure;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_soft_max_heapsize = soft_max;
+#   ifdef USE_MUNMAP
+      if (pressure && MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold > 0) {
+        /* Return all the free blocks to the OS.        */
+        MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_old(0);
+      }
+#   endif
+  }
+#endif /* MEMORY_CONTROLLER */
+
 word MANAGED_STACK_ADDRESS_BOEHM_GC_max_retries = 0;
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_recycle_inner(void *ptr, size_t bytes)
@@ -1545,7 +2135,8 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_scratch
   MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Recycle %lu/%lu scratch-allocated bytes at %p\n",
                 (unsigned long)recycled_bytes, (unsigned long)bytes, ptr);
   if (recycled_bytes > 0)
-    MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap((struct hblk *)((word)ptr + displ), recycled_bytes);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap((struct hblk *)((word)ptr + displ), recycled_bytes,
+                       FALSE);
 }
 
 /* This explicitly increases the size of the heap.  It is used          */
@@ -1558,6 +2149,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
     struct hblk * space;
     word expansion_slop;        /* Number of bytes by which we expect   */
                                 /* the heap to expand soon.             */
+    EVTRACE_SPAN(sp)
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_page_size != 0);
@@ -1570,6 +2162,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
         /* Exceeded self-imposed limit */
         return FALSE;
     }
+    EVTRACE_BEGIN(sp);
     space = (struct hblk *)MANAGED_STACK_ADDRESS_BOEHM_GC_os_get_mem(bytes);
     if (EXPECT(NULL == space, FALSE)) {
         WARN("Failed to expand heap by %" WARN_PRIuPTR " KiB\n", bytes >> 10);
@@ -1601,13 +2194,45 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
     }
     MANAGED_STACK_ADDRESS_BOEHM_GC_last_heap_addr = (ptr_t)space;
 
-    MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap(space, bytes);
+#   ifdef GET_MEM_ZEROED
+      MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap(space, bytes, TRUE);
+#   else
+      MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap(space, bytes, FALSE);
+#   endif
+    EVTRACE_END(sp, 0, EVTRACE_EXPAND_HEAP, bytes, MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize);
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_heap_resize)
         (*MANAGED_STACK_ADDRESS_BOEHM_GC_on_heap_resize)(MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize);
 
     return TRUE;
 }
 
+#ifdef GROW_HEAP_IN_PLACE
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_expand_hp_at(struct hblk *h, word n)
+  {
+    size_t bytes;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_page_size != 0);
+    if (0 == n) n = 1;
+    bytes = ROUNDUP_PAGESIZE((size_t)n * HBLKSIZE);
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_max_heapsize != 0
+        && (MANAGED_STACK_ADDRESS_BOEHM_GC_max_heapsize < (word)bytes
+            || MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize > MANAGED_STACK_ADDRESS_BOEHM_GC_max_heapsize - (word)bytes))
+      return FALSE;
+    if ((word)h + bytes <= (word)h /* overflow */
+        || !MANAGED_STACK_ADDRESS_BOEHM_GC_unix_get_mem_at((ptr_t)h, bytes))
+      return FALSE;
+    add_to_our_memory((ptr_t)h, bytes);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_last_heap_growth_gc_no = MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INFOLOG_PRINTF("Grow heap in place to %lu KiB at %p\n",
+                      TO_KiB_UL(MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize + bytes), (void *)h);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_add_to_heap(h, bytes, TRUE /* fresh mapping */);
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_on_heap_resize)
+      (*MANAGED_STACK_ADDRESS_BOEHM_GC_on_heap_resize)(MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize);
+    return TRUE;
+  }
+#endif /* GROW_HEAP_IN_PLACE */
+
 /* Really returns a bool, but it's externally visible, so that's clumsy. */
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_expand_hp(size_t bytes)
 {
@@ -1697,9 +2322,26 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
       }
     }
 
-    blocks_to_get = (MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize - MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize_at_forced_unmap)
+    if (pay_mark_assist_debt()) {
+      /* In the incremental mode, the marking debt of the thread is     */
+      /* paid before the heap is grown.                                 */
+      RESTORE_CANCEL(cancel_state);
+      return TRUE;
+    }
+
+#   ifndef NO_CLOCK
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.heap_goal != 0) {
+        /* Grow toward the heap size chosen by the pacer.       */
+        blocks_to_get = (MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.heap_goal > MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize
+                         ? divHBLKSZ(MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats.heap_goal - MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize)
+                         : 0) + needed_blocks;
+      } else
+#   endif
+    /* else */ {
+      blocks_to_get = (MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize - MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize_at_forced_unmap)
                         / (HBLKSIZE * MANAGED_STACK_ADDRESS_BOEHM_GC_free_space_divisor)
-                    + needed_blocks;
+                      + needed_blocks;
+    }
     if (blocks_to_get > MAXHINCR) {
       word slop;
 
@@ -1730,6 +2372,30 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
                         ? max_get_blocks : needed_blocks;
     }
 
+#   ifdef MEMORY_CONTROLLER
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_soft_max_heapsize != 0) {
+        word mapped = MANAGED_STACK_ADDRESS_BOEHM_GC_heapsize - MANAGED_STACK_ADDRESS_BOEHM_GC_unmapped_bytes;
+        word max_get_blocks = MANAGED_STACK_ADDRESS_BOEHM_GC_soft_max_heapsize > mapped
+                        ? divHBLKSZ(MANAGED_STACK_ADDRESS_BOEHM_GC_soft_max_heapsize - mapped) : 0;
+
+        if (blocks_to_get > max_get_blocks) {
+          if (max_get_blocks >= needed_blocks) {
+            blocks_to_get = max_get_blocks;
+          } else if (MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_allocd > 0 && !MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc) {
+            /* Refuse the expansion, collect instead.  The heap is      */
+            /* grown past the limit only if nothing has been allocated  */
+            /* since the latest collection.                             */
+            MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Heap expansion refused by memory"
+                               " controller (soft limit: %lu KiB)\n",
+                               TO_KiB_UL(MANAGED_STACK_ADDRESS_BOEHM_GC_soft_max_heapsize));
+            MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect_inner();
+            RESTORE_CANCEL(cancel_state);
+            return TRUE;
+          }
+        }
+      }
+#   endif
+
 #   ifdef USE_MUNMAP
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold > 1) {
         /* Return as much memory to the OS as possible before   */
@@ -1796,8 +2462,9 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_alloco
         if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && MANAGED_STACK_ADDRESS_BOEHM_GC_time_limit != MANAGED_STACK_ADDRESS_BOEHM_GC_TIME_UNLIMITED
             && !MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc) {
           /* True incremental mode, not just generational.      */
-          /* Do our share of marking work.                      */
-          MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner(1);
+          /* Do our share of marking work (about a block of     */
+          /* objects is going to be allocated from the list).   */
+          MANAGED_STACK_ADDRESS_BOEHM_GC_mark_assist(HBLKSIZE);
         }
 #     endif
       /* Sweep blocks for objects of this size */
@@ -0,0 +1,394 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+#include "private/gc_priv.h"
+
+#ifdef ENABLE_EVENT_TRACE
+
+/*
+ * The collector event tracing.  A span is recorded when it ends, to the
+ * ring buffer of a slot: slot 0 is written by the thread holding the
+ * allocation lock (whichever it is), slot i (i > 0) is written by the
+ * parallel mark helper with id i while holding the mark lock (the id
+ * of a finished helper might be taken by a late one).  Thus each ring
+ * has one writer at a time, and the writers need neither a lock nor an
+ * atomic update.  The helpers run only while the initiating thread
+ * holds the allocation lock, so the rings are read (and cleared) with
+ * just the allocation lock held.  The rings are allocated by
+ * MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc (never freed); the one of slot 0 is bigger since
+ * most of the spans (including the lazy sweeping ones) go to it.
+ */
+
+#include "gc/gc_event_trace.h"
+
+#ifdef PARALLEL_MARK
+# include "private/pthread_support.h" /* for MAX_MARKERS */
+# define EVTRACE_N_SLOTS MAX_MARKERS
+#else
+# define EVTRACE_N_SLOTS 1
+#endif
+
+#ifndef DONT_USE_ATEXIT
+# include <stdio.h>
+#endif
+
+#ifndef LOG_EVENT_TRACE_RING_SZ
+# define LOG_EVENT_TRACE_RING_SZ 12
+#endif
+
+#ifndef LOG_EVENT_TRACE_HELPER_RING_SZ
+# define LOG_EVENT_TRACE_HELPER_RING_SZ 8
+#endif
+
+struct evtrace_event_s {
+  CLOCK_TYPE ev_start;
+  unsigned long ev_dur_ns;      /* saturated */
+  unsigned short ev_kind;
+  unsigned short ev_slot;
+  word ev_args[2];
+};
+
+struct evtrace_ring_s {
+  word er_mask;         /* the capacity minus one (a power of two)      */
+  word er_count;        /* the number of the spans ever recorded        */
+  struct evtrace_event_s er_events[1];
+};
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_on = FALSE;
+
+STATIC struct evtrace_ring_s *MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[EVTRACE_N_SLOTS] = { NULL };
+
+STATIC CLOCK_TYPE MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_base = CLOCK_TYPE_INITIALIZER;
+                        /* The time the tracing was turned on first.    */
+
+STATIC unsigned long MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_ns_diff(CLOCK_TYPE a, CLOCK_TYPE b)
+{
+  unsigned long ms = MS_TIME_DIFF(a, b);
+
+  if (ms >= ((unsigned long)-1) / 1000000UL - 1)
+    return (unsigned long)-1;
+  return ms * 1000000UL + NS_FRAC_TIME_DIFF(a, b);
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_start(CLOCK_TYPE *pstart)
+{
+  GET_TIME(*pstart);
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_record(unsigned slot, unsigned kind,
+                                const CLOCK_TYPE *pstart,
+                                word arg1, word arg2)
+{
+  CLOCK_TYPE now;
+  struct evtrace_ring_s *r;
+  struct evtrace_event_s *ev;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(kind < EVTRACE_N_KINDS);
+  if (EXPECT(slot >= EVTRACE_N_SLOTS, FALSE)) return;
+  r = MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[slot];
+  if (EXPECT(NULL == r, FALSE)) return; /* the allocation failed */
+
+  GET_TIME(now);
+  ev = &(r -> er_events[r -> er_count & r -> er_mask]);
+  ev -> ev_start = *pstart;
+  ev -> ev_dur_ns = MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_ns_diff(now, *pstart);
+  ev -> ev_kind = (unsigned short)kind;
+  ev -> ev_slot = (unsigned short)slot;
+  ev -> ev_args[0] = arg1;
+  ev -> ev_args[1] = arg2;
+  r -> er_count++;
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_event_tracing(int on)
+{
+  if (!EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized, TRUE)) MANAGED_STACK_ADDRESS_BOEHM_GC_init();
+  LOCK();
+  if (on && NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[0]) {
+    unsigned i;
+
+    for (i = 0; i < EVTRACE_N_SLOTS; i++) {
+      unsigned log_sz = 0 == i ? LOG_EVENT_TRACE_RING_SZ
+                               : LOG_EVENT_TRACE_HELPER_RING_SZ;
+      struct evtrace_ring_s *r = (struct evtrace_ring_s *)
+                MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc(sizeof(struct evtrace_ring_s)
+                                 + (((size_t)1 << log_sz) - 1)
+                                   * sizeof(struct evtrace_event_s));
+
+      if (NULL == r) break;
+      r -> er_mask = ((word)1 << log_sz) - 1;
+      r -> er_count = 0;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[i] = r;
+    }
+    if (NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[0]) {
+      WARN("Failed to allocate event trace buffers\n", 0);
+    } else {
+      GET_TIME(MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_base);
+    }
+  }
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_on = on && MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[0] != NULL;
+  UNLOCK();
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_event_tracing(void)
+{
+  return (int)MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_on;
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_clear_event_trace(void)
+{
+  unsigned i;
+
+  LOCK();
+  for (i = 0; i < EVTRACE_N_SLOTS; i++) {
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[i] != NULL)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[i] -> er_count = 0;
+  }
+  UNLOCK();
+}
+
+/* The names of the spans and of their arguments (a NULL name means     */
+/* the argument is not written).                                        */
+static const struct {
+  const char *name;
+  const char *arg_names[2];
+} evtrace_kinds[EVTRACE_N_KINDS] = {
+  { "collection", { "gc_no", NULL } },
+  { "pause", { "gc_no", NULL } },
+  { "stop_world", { NULL, NULL } },
+  { "mark", { "gc_no", "abandoned" } },
+  { "start_world", { NULL, NULL } },
+  { "push_roots", { "all", NULL } },
+  { "mark_helper", { "steals", "stolen_entries" } },
+  { "parallel_task", { NULL, NULL } },
+  { "finish_collection", { "gc_no", NULL } },
+  { "finalize", { "enqueued", NULL } },
+  { "start_reclaim", { "report_if_found", NULL } },
+  { "reclaim_all", { "completed", NULL } },
+  { "sweep", { "granules", "kind" } },
+  { "unmap", { "unmapped_bytes", NULL } },
+  { "expand_heap", { "bytes", "heapsize" } }
+};
+
+#define EVTRACE_OUT_BUF_SZ 1024
+
+struct evtrace_out_s {
+  MANAGED_STACK_ADDRESS_BOEHM_GC_event_trace_write_proc proc;
+  void *client_data;
+  int status;
+  size_t pos;
+  char buf[EVTRACE_OUT_BUF_SZ];
+};
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_flush(struct evtrace_out_s *out)
+{
+  if (out -> pos > 0 && MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS == out -> status)
+    out -> status = out -> proc(out -> client_data, out -> buf, out -> pos);
+  out -> pos = 0;
+}
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(struct evtrace_out_s *out, const char *s)
+{
+  for (; *s != '\0'; s++) {
+    out -> buf[out -> pos++] = *s;
+    if (EVTRACE_OUT_BUF_SZ == out -> pos) MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_flush(out);
+  }
+}
+
+/* Write v in decimal, zero-padded to at least min_digits.      */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_word(struct evtrace_out_s *out, word v,
+                                unsigned min_digits)
+{
+  char b[sizeof(word) * 3 + 2];
+  char *p = &b[sizeof(b) - 1];
+
+  *p = '\0';
+  do {
+    *--p = (char)('0' + v % 10);
+    v /= 10;
+  } while (v != 0 || (unsigned)(&b[sizeof(b) - 1] - p) < min_digits);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, p);
+}
+
+/* Write the given time (in ms and ns) in microseconds. */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_us(struct evtrace_out_s *out, unsigned long ms,
+                              unsigned long ns_frac)
+{
+  if (ms > 0) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_word(out, (word)ms, 1);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_word(out, (word)(ns_frac / 1000), 3);
+  } else {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_word(out, (word)(ns_frac / 1000), 1);
+  }
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ".");
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_word(out, (word)(ns_frac % 1000), 3);
+}
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_header(struct evtrace_out_s *out, const char *ph,
+                                  const char *name, unsigned slot)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "{\"name\":\"");
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, name);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "\",\"ph\":\"");
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ph);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "\",\"pid\":1,\"tid\":");
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_word(out, (word)slot, 1);
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_write_event_trace(MANAGED_STACK_ADDRESS_BOEHM_GC_event_trace_write_proc proc,
+                                        void *client_data)
+{
+  struct evtrace_event_s *snap = NULL;
+  size_t snap_cap = 0, n_events, i;
+  CLOCK_TYPE base;
+  word slot_counts[EVTRACE_N_SLOTS];
+  struct evtrace_out_s *out;
+  unsigned slot;
+
+  /* Take a snapshot of the rings, oldest spans first.  */
+  for (;;) {
+    LOCK();
+    n_events = 0;
+    for (slot = 0; slot < EVTRACE_N_SLOTS; slot++) {
+      struct evtrace_ring_s *r = MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[slot];
+
+      slot_counts[slot] = 0;
+      if (r != NULL) {
+        slot_counts[slot] = r -> er_count <= r -> er_mask ? r -> er_count
+                                : r -> er_mask + 1;
+        n_events += (size_t)slot_counts[slot];
+      }
+    }
+    if (n_events <= snap_cap) {
+      i = 0;
+      for (slot = 0; slot < EVTRACE_N_SLOTS; slot++) {
+        struct evtrace_ring_s *r = MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_rings[slot];
+        word j;
+
+        for (j = r != NULL ? r -> er_count - slot_counts[slot] : 0;
+             r != NULL && j < r -> er_count; j++) {
+          snap[i++] = r -> er_events[j & r -> er_mask];
+        }
+      }
+      base = MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_base;
+      UNLOCK();
+      break;
+    }
+    UNLOCK();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(snap);
+    snap_cap = n_events + n_events / 4 + 16;
+    snap = (struct evtrace_event_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic(snap_cap
+                                        * sizeof(struct evtrace_event_s));
+    if (NULL == snap) return MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY;
+  }
+  out = (struct evtrace_out_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic(
+                                        sizeof(struct evtrace_out_s));
+  if (NULL == out) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(snap);
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY;
+  }
+
+  out -> proc = proc;
+  out -> client_data = client_data;
+  out -> status = MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+  out -> pos = 0;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "{\"traceEvents\":[\n");
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_header(out, "M", "process_name", 0);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",\"args\":{\"name\":\"libgc\"}}");
+  for (slot = 0; slot < EVTRACE_N_SLOTS; slot++) {
+    if (0 == slot_counts[slot]) continue;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",\n");
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_header(out, "M", "thread_name", slot);
+    if (0 == slot) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",\"args\":{\"name\":\"collector\"}}");
+    } else {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",\"args\":{\"name\":\"mark helper ");
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_word(out, (word)slot, 1);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "\"}}");
+    }
+  }
+
+  for (i = 0; i < n_events && MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS == out -> status; i++) {
+    const struct evtrace_event_s *ev = &snap[i];
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool arg_written = FALSE;
+    unsigned k;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",\n");
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_header(out, "X", evtrace_kinds[ev -> ev_kind].name,
+                          ev -> ev_slot);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",\"cat\":\"gc\",\"ts\":");
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_us(out, MS_TIME_DIFF(ev -> ev_start, base),
+                      NS_FRAC_TIME_DIFF(ev -> ev_start, base));
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",\"dur\":");
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_us(out, ev -> ev_dur_ns / 1000000UL,
+                      ev -> ev_dur_ns % 1000000UL);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",\"args\":{");
+    for (k = 0; k < 2; k++) {
+      const char *arg_name = evtrace_kinds[ev -> ev_kind].arg_names[k];
+
+      if (NULL == arg_name) continue;
+      if (arg_written) MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, ",");
+      arg_written = TRUE;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "\"");
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, arg_name);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "\":");
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_word(out, ev -> ev_args[k], 1);
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "}}");
+  }
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_put_str(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_flush(out);
+
+  i = (size_t)(out -> status);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_free(snap);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_free(out);
+  return (int)i;
+}
+
+#ifndef DONT_USE_ATEXIT
+  STATIC const char *MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_path = NULL;
+
+  STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_fwrite(void *f, const void *buf,
+                                           size_t len)
+  {
+    return fwrite(buf, 1, len, (FILE *)f) == len ? 0 : 1;
+  }
+
+  STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_exit_proc(void)
+  {
+    FILE *f = fopen(MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_path, "w");
+    int res;
+
+    if (NULL == f) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_err_printf("Cannot open %s to write event trace\n",
+                    MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_path);
+      return;
+    }
+    res = MANAGED_STACK_ADDRESS_BOEHM_GC_write_event_trace(MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_fwrite, f);
+    if (fclose(f) != 0 || res != MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_err_printf("Failed to write event trace to %s\n", MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_path);
+  }
+#endif /* !DONT_USE_ATEXIT */
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_write_at_exit(const char *path)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_set_event_tracing(1);
+# ifndef DONT_USE_ATEXIT
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_on && NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_path) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_path = path;
+      atexit(MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_exit_proc);
+    }
+# else
+    UNUSED_ARG(path);
+    WARN("Event trace is not written at exit (no atexit)\n", 0);
+# endif
+}
+
+#endif /* ENABLE_EVENT_TRACE */
@@ -49,8 +49,10 @@
 #include "../allchblk.c"
 #include "../alloc.c"
 #include "../dbg_mlc.c"
+#include "../evtrace.c"
 #include "../finalize.c"
 #include "../fnlz_mlc.c"
+#include "../heapprof.c"
 #include "../malloc.c"
 #include "../mallocx.c"
 #include "../mark.c"
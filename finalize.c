@@ -68,15 +68,94 @@ struct finalizable_object {
 # define SET_FINALIZE_NOW(fo) (void)(MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now = (fo))
 #endif /* !THREADS */
 
+#ifdef STRIPED_FNLZ_TABLES
+  /* The stripe is selected by the high bits of the key multiplied by   */
+  /* the golden ratio (the low bits of the key are used by HASH2).      */
+# if CPP_WORDSZ == 64
+#   define FNLZ_STRIPE_MULT MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_C(0x9e3779b97f4a7c15)
+# else
+#   define FNLZ_STRIPE_MULT MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_C(0x9e3779b9)
+# endif
+# define FNLZ_STRIPE_INDEX(addr) \
+        (unsigned)((((word)(addr) >> 3) * FNLZ_STRIPE_MULT) \
+                   >> (CPP_WORDSZ - LOG_FNLZ_STRIPES))
+# define LOCK_FNLZ_STRIPE(s) MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_fnlz_stripe_lock(s)
+# define UNLOCK_FNLZ_STRIPE(s) MANAGED_STACK_ADDRESS_BOEHM_GC_release_fnlz_stripe_lock(s)
+# define LOCK_ALL_FNLZ_STRIPES() MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_all_fnlz_stripe_locks()
+# define UNLOCK_ALL_FNLZ_STRIPES() MANAGED_STACK_ADDRESS_BOEHM_GC_release_all_fnlz_stripe_locks()
+  /* MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries is updated atomically by the clients holding the     */
+  /* locks of different stripes (but a plain update is fine if the      */
+  /* locks of all the stripes are held).                                */
+# define FO_ENTRIES_INC() \
+            (void)AO_fetch_and_add1((volatile AO_t *)&MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries)
+# define FO_ENTRIES_DEC() \
+            (void)AO_fetch_and_add((volatile AO_t *)&MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries, \
+                                   ~(AO_t)0)
+#else
+  /* The only stripe is protected by the allocation lock.       */
+# define FNLZ_STRIPE_INDEX(addr) 0U
+# define LOCK_FNLZ_STRIPE(s) LOCK()
+# define UNLOCK_FNLZ_STRIPE(s) UNLOCK()
+# define LOCK_ALL_FNLZ_STRIPES() (void)0
+# define UNLOCK_ALL_FNLZ_STRIPES() (void)0
+# define FO_ENTRIES_INC() (void)(MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries++)
+# define FO_ENTRIES_DEC() (void)(MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries--)
+#endif /* !STRIPED_FNLZ_TABLES */
+
+/* The number of hash headers of the given stripe (of any table).       */
+#define FNLZ_STRIPE_SIZE(t) \
+        ((t) -> head == NULL ? (size_t)0 : (size_t)1 << (t) -> log_size)
+
+/* Returns the number of entries in all stripes of a dl table.  */
+MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE word MANAGED_STACK_ADDRESS_BOEHM_GC_dl_table_entries(const struct dl_hashtbl_s *dl_hashtbl)
+{
+  word entries = 0;
+  unsigned s;
+
+  for (s = 0; s < FNLZ_STRIPES; s++)
+    entries += dl_hashtbl[s].entries;
+  return entries;
+}
+
+/* The finalization statistics; protected by the allocation lock.       */
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count = 0; /* the length of finalize_now */
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_max_ready_count = 0;
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_finalizers_run = 0;
+                        /* The number of finalizers invoked by          */
+                        /* MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_some_finalizers.                   */
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_backlog_run = 0;
+#ifndef NO_CLOCK
+  STATIC CLOCK_TYPE MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_enqueue_time;
+                        /* The time of the collection which has made    */
+                        /* finalize_now non-empty.                      */
+#endif
+
+/* Update the statistics after enqueueing the objects for finalization. */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_note_enqueued(word ready_before)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  if (MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count > MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_max_ready_count)
+    MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_max_ready_count = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count;
+# ifndef NO_CLOCK
+    if (0 == ready_before && MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count != 0)
+      GET_TIME(MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_enqueue_time);
+# else
+    UNUSED_ARG(ready_before);
+# endif
+}
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_push_finalizer_structures(void)
 {
-  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)(&MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl.head) % sizeof(word) == 0);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)(&MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl) % sizeof(word) == 0);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)(&MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl) % sizeof(word) == 0);
   MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)(&MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots) % sizeof(word) == 0);
+  /* The stripes are pushed entirely (including the free lists).       */
 # ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_LONG_REFS_NOT_NEEDED
-    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)(&MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl.head) % sizeof(word) == 0);
-    MANAGED_STACK_ADDRESS_BOEHM_GC_PUSH_ALL_SYM(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl.head);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)(&MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl) % sizeof(word) == 0);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_PUSH_ALL_SYM(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl);
 # endif
-  MANAGED_STACK_ADDRESS_BOEHM_GC_PUSH_ALL_SYM(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl.head);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_PUSH_ALL_SYM(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_PUSH_ALL_SYM(MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl);
   MANAGED_STACK_ADDRESS_BOEHM_GC_PUSH_ALL_SYM(MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots);
   /* MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr is pushed specially by MANAGED_STACK_ADDRESS_BOEHM_GC_mark_togglerefs.        */
 }
@@ -87,66 +166,164 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
 # define MANAGED_STACK_ADDRESS_BOEHM_GC_ON_GROW_LOG_SIZE_MIN CPP_LOG_HBLKSIZE
 #endif
 
-/* Double the size of a hash table. *log_size_ptr is the log of its     */
-/* current size.  May be a no-op.  *table is a pointer to an array of   */
-/* hash headers.  We update both *table and *log_size_ptr on success.   */
-STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_grow_table(struct hash_chain_entry ***table,
-                          unsigned *log_size_ptr, const word *entries_ptr)
+/* The number of the entries allocated at once to refill the free list */
+/* of a stripe, and the maximum length of the list.                     */
+#ifndef FNLZ_REFILL_ENTRIES
+# define FNLZ_REFILL_ENTRIES 16
+#endif
+#define FNLZ_FREE_ENTRIES_MAX (2 * FNLZ_REFILL_ENTRIES)
+
+/* The value of MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no after the latest collection enforced on a     */
+/* stripe growth.  Protected by the allocation lock.                    */
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_grow_gc_no = 0;
+
+/* Make sure the given stripe of a hash table has room for one more     */
+/* entry: double its size if the entries outnumber the hash headers     */
+/* (*table is a pointer to an array of hash headers, *log_size_ptr is   */
+/* the log of its current size) and refill its free list of entries     */
+/* (of entry_sz bytes) if the list is empty.  Called holding the lock   */
+/* of the stripe s which is temporarily released to acquire the         */
+/* allocation lock (thus the caller should recheck the stripe content). */
+/* The stripes grow independently, thus the rehashing pause is bounded  */
+/* by the stripe size.  Returns FALSE if no free entry is available.    */
+STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_stripe_reserve(unsigned s,
+                        struct hash_chain_entry ***table,
+                        unsigned *log_size_ptr, const word *entries_ptr,
+                        struct hash_chain_entry **free_list_ptr,
+                        unsigned *free_count_ptr, size_t entry_sz,
+                        const char *tbl_log_name)
 {
-    word i;
-    struct hash_chain_entry *p;
     unsigned log_old_size = *log_size_ptr;
-    unsigned log_new_size = log_old_size + 1;
-    word old_size = *table == NULL ? 0 : (word)1 << log_old_size;
-    word new_size = (word)1 << log_new_size;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool need_grow = NULL == *table
+                        || *entries_ptr > ((word)1 << log_old_size);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool need_entries = NULL == *free_list_ptr;
     /* FIXME: Power of 2 size often gets rounded up to one more page. */
-    struct hash_chain_entry **new_table;
+    struct hash_chain_entry **new_table = NULL;
+    struct hash_chain_entry *new_entries = NULL;
+    struct hash_chain_entry *last_entry = NULL;
+    unsigned n = 0;
 
+#   ifdef STRIPED_FNLZ_TABLES
+      UNLOCK_FNLZ_STRIPE(s);
+      LOCK();
+#   else
+      UNUSED_ARG(s);
+#   endif
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
     /* Avoid growing the table in case of at least 25% of entries can   */
     /* be deleted by enforcing a collection.  Ignored for small tables. */
     /* In incremental mode we skip this optimization, as we want to     */
-    /* avoid triggering a full GC whenever possible.                    */
-    if (log_old_size >= MANAGED_STACK_ADDRESS_BOEHM_GC_ON_GROW_LOG_SIZE_MIN && !MANAGED_STACK_ADDRESS_BOEHM_GC_incremental) {
+    /* avoid triggering a full GC whenever possible.  The stripes are   */
+    /* filled evenly, thus they tend to grow one after another; so the  */
+    /* collection is not repeated for each of them.                     */
+    if (need_grow && log_old_size + LOG_FNLZ_STRIPES >= MANAGED_STACK_ADDRESS_BOEHM_GC_ON_GROW_LOG_SIZE_MIN
+        && !MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_grow_gc_no != MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no) {
       IF_CANCEL(int cancel_state;)
 
       DISABLE_CANCEL(cancel_state);
       MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect_inner();
       RESTORE_CANCEL(cancel_state);
-      /* MANAGED_STACK_ADDRESS_BOEHM_GC_finalize might decrease entries value.  */
-      if (*entries_ptr < ((word)1 << log_old_size) - (*entries_ptr >> 2))
-        return;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_grow_gc_no = MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+#     ifdef STRIPED_FNLZ_TABLES
+        LOCK_FNLZ_STRIPE(s);
+#     endif
+      /* MANAGED_STACK_ADDRESS_BOEHM_GC_finalize might decrease entries value.      */
+      if (*log_size_ptr != log_old_size
+          || *entries_ptr < ((word)1 << log_old_size) - (*entries_ptr >> 2))
+        need_grow = FALSE;
+#     ifdef STRIPED_FNLZ_TABLES
+        UNLOCK_FNLZ_STRIPE(s);
+#     endif
     }
+    for (;;) {
+      if (need_grow) {
+        new_table = (struct hash_chain_entry **)
+                      MANAGED_STACK_ADDRESS_BOEHM_GC_INTERNAL_MALLOC_IGNORE_OFF_PAGE(
+                          ((size_t)1 << (log_old_size + 1))
+                          * sizeof(struct hash_chain_entry *), NORMAL);
+      }
+      if (need_entries) {
+        for (; n < FNLZ_REFILL_ENTRIES; n++) {
+          struct hash_chain_entry *p = (struct hash_chain_entry *)
+                                          MANAGED_STACK_ADDRESS_BOEHM_GC_INTERNAL_MALLOC(entry_sz, NORMAL);
+
+          if (EXPECT(NULL == p, FALSE)) break;
+          if (NULL == last_entry) last_entry = p;
+          p -> next = new_entries;
+          MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(p);
+          new_entries = p;
+        }
+      }
 
-    new_table = (struct hash_chain_entry **)
-                    MANAGED_STACK_ADDRESS_BOEHM_GC_INTERNAL_MALLOC_IGNORE_OFF_PAGE(
-                        (size_t)new_size * sizeof(struct hash_chain_entry *),
-                        NORMAL);
-    if (new_table == 0) {
-        if (*table == 0) {
-            ABORT("Insufficient space for initial table allocation");
+#     ifdef STRIPED_FNLZ_TABLES
+        LOCK_FNLZ_STRIPE(s);
+#     endif
+      if (new_table != NULL) {
+        if (*log_size_ptr == log_old_size) {
+          /* Not grown by another client meanwhile.     */
+          unsigned log_new_size = log_old_size + 1;
+          word new_size = (word)1 << log_new_size;
+          word old_size = *table == NULL ? 0 : (word)1 << log_old_size;
+          word i;
+
+          for (i = 0; i < old_size; i++) {
+            struct hash_chain_entry *p = (*table)[i];
+
+            while (p != 0) {
+              ptr_t real_key = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(p -> hidden_key);
+              struct hash_chain_entry *next = p -> next;
+              size_t new_hash = HASH3(real_key, new_size, log_new_size);
+
+              p -> next = new_table[new_hash];
+              MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(p);
+              new_table[new_hash] = p;
+              p = next;
+            }
+          }
+          *log_size_ptr = log_new_size;
+          *table = new_table;
+          MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(new_table); /* entire object */
+          MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Grew %s table stripe to %u entries\n",
+                             tbl_log_name, 1U << log_new_size);
         } else {
-            return;
+          MANAGED_STACK_ADDRESS_BOEHM_GC_INTERNAL_FREE(new_table);
         }
-    }
-    for (i = 0; i < old_size; i++) {
-      p = (*table)[i];
-      while (p != 0) {
-        ptr_t real_key = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(p -> hidden_key);
-        struct hash_chain_entry *next = p -> next;
-        size_t new_hash = HASH3(real_key, new_size, log_new_size);
-
-        p -> next = new_table[new_hash];
-        MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(p);
-        new_table[new_hash] = p;
-        p = next;
+      } else if (NULL == *table) {
+        ABORT("Insufficient space for initial table allocation");
+      }
+      if (new_entries != NULL) {
+        last_entry -> next = *free_list_ptr;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(last_entry);
+        *free_list_ptr = new_entries;
+        *free_count_ptr += n;
       }
+      if (need_entries || *free_list_ptr != NULL) break;
+
+      /* The free entries have been taken by the other clients while    */
+      /* the stripe lock was released (to grow the table), so refill    */
+      /* the free list once more.                                       */
+#     ifdef STRIPED_FNLZ_TABLES
+        UNLOCK_FNLZ_STRIPE(s);
+#     endif
+      need_grow = FALSE;
+      need_entries = TRUE;
+      new_table = NULL;
     }
-    *log_size_ptr = log_new_size;
-    *table = new_table;
-    MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(new_table); /* entire object */
+#   ifdef STRIPED_FNLZ_TABLES
+      UNLOCK();
+#   endif
+    return *free_list_ptr != NULL;
 }
 
+/* Same as MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_stripe_reserve but for a stripe t (of any table)     */
+/* containing entries of the given type.                                */
+#define FNLZ_STRIPE_RESERVE(s, t, entry_type, tbl_log_name) \
+        MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_stripe_reserve(s, (struct hash_chain_entry ***)&(t) -> head, \
+                        &(t) -> log_size, &(t) -> entries, \
+                        (struct hash_chain_entry **)&(t) -> free_list, \
+                        &(t) -> free_count, sizeof(entry_type), \
+                        tbl_log_name)
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_register_disappearing_link(void * * link)
 {
     ptr_t base;
@@ -164,60 +341,53 @@ STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_register_disappearing_link_inner(
     struct disappearing_link *curr_dl;
     size_t index;
     struct disappearing_link * new_dl;
+    unsigned s = FNLZ_STRIPE_INDEX(link);
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized);
     if (EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_find_leak, FALSE)) return MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED;
 #   ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERTIONS
       MANAGED_STACK_ADDRESS_BOEHM_GC_noop1((word)(*link)); /* check accessibility */
 #   endif
-    LOCK();
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(obj != NULL && MANAGED_STACK_ADDRESS_BOEHM_GC_base_C(obj) == obj);
-    if (EXPECT(NULL == dl_hashtbl -> head, FALSE)
+    dl_hashtbl += s;
+    LOCK_FNLZ_STRIPE(s);
+    if (EXPECT(NULL == dl_hashtbl -> free_list, FALSE)
         || EXPECT(dl_hashtbl -> entries
-                  > ((word)1 << dl_hashtbl -> log_size), FALSE)) {
-        MANAGED_STACK_ADDRESS_BOEHM_GC_grow_table((struct hash_chain_entry ***)&dl_hashtbl -> head,
-                      &dl_hashtbl -> log_size, &dl_hashtbl -> entries);
-        MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Grew %s table to %u entries\n", tbl_log_name,
-                           1U << dl_hashtbl -> log_size);
+                  > ((word)1 << dl_hashtbl -> log_size), FALSE)
+        || EXPECT(NULL == dl_hashtbl -> head, FALSE)) {
+      if (!FNLZ_STRIPE_RESERVE(s, dl_hashtbl, struct disappearing_link,
+                               tbl_log_name)) {
+        UNLOCK_FNLZ_STRIPE(s);
+        new_dl = (struct disappearing_link *)
+                (*MANAGED_STACK_ADDRESS_BOEHM_GC_get_oom_fn())(sizeof(struct disappearing_link));
+        if (0 == new_dl) {
+          return MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY;
+        }
+        /* It's not likely we'll make it here, but ... */
+        LOCK_FNLZ_STRIPE(s);
+        dl_set_next(new_dl, dl_hashtbl -> free_list);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(new_dl);
+        dl_hashtbl -> free_list = new_dl;
+        dl_hashtbl -> free_count++;
+      }
     }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(dl_hashtbl -> head != NULL);
+    /* Calculate index after the stripe lock is (re)acquired since the  */
+    /* stripe may grow meanwhile.                                       */
     index = HASH2(link, dl_hashtbl -> log_size);
     for (curr_dl = dl_hashtbl -> head[index]; curr_dl != 0;
          curr_dl = dl_next(curr_dl)) {
         if (curr_dl -> dl_hidden_link == MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(link)) {
             /* Alternatively, MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_NZ_POINTER() could be used instead. */
             curr_dl -> dl_hidden_obj = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj);
-            UNLOCK();
+            UNLOCK_FNLZ_STRIPE(s);
             return MANAGED_STACK_ADDRESS_BOEHM_GC_DUPLICATE;
         }
     }
-    new_dl = (struct disappearing_link *)
-        MANAGED_STACK_ADDRESS_BOEHM_GC_INTERNAL_MALLOC(sizeof(struct disappearing_link), NORMAL);
-    if (EXPECT(NULL == new_dl, FALSE)) {
-      MANAGED_STACK_ADDRESS_BOEHM_GC_oom_func oom_fn = MANAGED_STACK_ADDRESS_BOEHM_GC_oom_fn;
-      UNLOCK();
-      new_dl = (struct disappearing_link *)
-                (*oom_fn)(sizeof(struct disappearing_link));
-      if (0 == new_dl) {
-        return MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY;
-      }
-      /* It's not likely we'll make it here, but ... */
-      LOCK();
-      /* Recalculate index since the table may grow.    */
-      index = HASH2(link, dl_hashtbl -> log_size);
-      /* Check again that our disappearing link not in the table. */
-      for (curr_dl = dl_hashtbl -> head[index]; curr_dl != 0;
-           curr_dl = dl_next(curr_dl)) {
-        if (curr_dl -> dl_hidden_link == MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(link)) {
-          curr_dl -> dl_hidden_obj = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj);
-          UNLOCK();
-#         ifndef DBG_HDRS_ALL
-            /* Free unused new_dl returned by MANAGED_STACK_ADDRESS_BOEHM_GC_oom_fn() */
-            MANAGED_STACK_ADDRESS_BOEHM_GC_free((void *)new_dl);
-#         endif
-          return MANAGED_STACK_ADDRESS_BOEHM_GC_DUPLICATE;
-        }
-      }
-    }
+    new_dl = dl_hashtbl -> free_list;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(new_dl != NULL && dl_hashtbl -> free_count > 0);
+    dl_hashtbl -> free_list = dl_next(new_dl);
+    dl_hashtbl -> free_count--;
     new_dl -> dl_hidden_obj = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj);
     new_dl -> dl_hidden_link = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(link);
     dl_set_next(new_dl, dl_hashtbl -> head[index]);
@@ -225,7 +395,7 @@ STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_register_disappearing_link_inner(
     dl_hashtbl -> head[index] = new_dl;
     dl_hashtbl -> entries++;
     MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(dl_hashtbl->head + index);
-    UNLOCK();
+    UNLOCK_FNLZ_STRIPE(s);
     return MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
 }
 
@@ -234,7 +404,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
 {
     if (((word)link & (ALIGNMENT-1)) != 0 || !NONNULL_ARG_NOT_NULL(link))
         ABORT("Bad arg to MANAGED_STACK_ADDRESS_BOEHM_GC_general_register_disappearing_link");
-    return MANAGED_STACK_ADDRESS_BOEHM_GC_register_disappearing_link_inner(&MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, link, obj,
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_register_disappearing_link_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, link, obj,
                                                "dl");
 }
 
@@ -244,16 +414,26 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
 # define FREE_DL_ENTRY(curr_dl) MANAGED_STACK_ADDRESS_BOEHM_GC_free(curr_dl)
 #endif
 
-/* Unregisters given link and returns the link entry to free.   */
-MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE struct disappearing_link *MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link_inner(
+/* Unregisters given link of the given table.  The entry is kept in     */
+/* the free list of the stripe (for reuse by a subsequent registration) */
+/* unless the list is long enough.  Returns 1 if the link was found.    */
+MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE int MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link_inner(
                                 struct dl_hashtbl_s *dl_hashtbl, void **link)
 {
     struct disappearing_link *curr_dl;
     struct disappearing_link *prev_dl = NULL;
     size_t index;
+    unsigned s;
 
-    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
-    if (EXPECT(NULL == dl_hashtbl -> head, FALSE)) return NULL;
+    if (((word)link & (ALIGNMENT-1)) != 0) return 0; /* Nothing to do. */
+
+    s = FNLZ_STRIPE_INDEX(link);
+    dl_hashtbl += s;
+    LOCK_FNLZ_STRIPE(s);
+    if (EXPECT(NULL == dl_hashtbl -> head, FALSE)) {
+      UNLOCK_FNLZ_STRIPE(s);
+      return 0;
+    }
 
     index = HASH2(link, dl_hashtbl -> log_size);
     for (curr_dl = dl_hashtbl -> head[index]; curr_dl;
@@ -272,21 +452,23 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE struct disappearing_link *MANAGED_STACK_AD
         }
         prev_dl = curr_dl;
     }
-    return curr_dl;
+    if (curr_dl != NULL && dl_hashtbl -> free_count < FNLZ_FREE_ENTRIES_MAX) {
+      dl_set_next(curr_dl, dl_hashtbl -> free_list);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_dl);
+      dl_hashtbl -> free_list = curr_dl;
+      dl_hashtbl -> free_count++;
+      UNLOCK_FNLZ_STRIPE(s);
+      return 1;
+    }
+    UNLOCK_FNLZ_STRIPE(s);
+    if (NULL == curr_dl) return 0;
+    FREE_DL_ENTRY(curr_dl);
+    return 1;
 }
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link(void * * link)
 {
-    struct disappearing_link *curr_dl;
-
-    if (((word)link & (ALIGNMENT-1)) != 0) return 0; /* Nothing to do. */
-
-    LOCK();
-    curr_dl = MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link_inner(&MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, link);
-    UNLOCK();
-    if (NULL == curr_dl) return 0;
-    FREE_DL_ENTRY(curr_dl);
-    return 1;
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, link);
 }
 
 /* Mark from one finalizable object using the specified mark proc.      */
@@ -310,43 +492,96 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_comple
   }
 }
 
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_normal_finalize_mark_proc(ptr_t);
+
+/* Mark a given unmarked object and push its contents.  With the        */
+/* parallel marker, the objects reachable from it are marked only once  */
+/* the mark stack is filled up enough or the caller invokes             */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_from_mark_stack, otherwise they are marked before   */
+/* return.  In any case, the caller should complete the ongoing         */
+/* collection (if any) finally.                                         */
+MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_strong_ref(ptr_t obj)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_normal_finalize_mark_proc(obj);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_set_mark_bit(obj);
+# ifdef PARALLEL_MARK
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel) {
+      if ((word)MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_top
+            >= (word)(MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack + MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_size/4))
+        MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_from_mark_stack();
+      return;
+    }
+# endif
+  while (!MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_empty())
+    MARK_FROM_MARK_STACK();
+}
+
 /* Toggle-ref support.  */
 #ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
   typedef union toggle_ref_u GCToggleRef;
 
   STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_func MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_callback = 0;
 
+# ifndef TOGGLEREF_BATCH_SIZE
+    /* The maximum number of objects passed to the toggle-ref callback  */
+    /* at once.                                                         */
+#   define TOGGLEREF_BATCH_SIZE 256
+# endif
+
+  STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_func MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_callback = 0;
+
   MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_process_togglerefs(void)
   {
-    size_t i;
+    void *objs[TOGGLEREF_BATCH_SIZE];
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ToggleRefStatus statuses[TOGGLEREF_BATCH_SIZE];
+    size_t i = 0;
     size_t new_size = 0;
     MANAGED_STACK_ADDRESS_BOEHM_GC_bool needs_barrier = FALSE;
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
-    for (i = 0; i < MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_array_size; ++i) {
-      GCToggleRef *r = &MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr[i];
-      void *obj = r -> strong_ref;
+    while (i < MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_array_size) {
+      size_t j, n = 0;
+
+      /* Collect the next batch.  The array is compacted in place, as   */
+      /* the entries are stored (below) only up to the index of the     */
+      /* last collected one.                                            */
+      for (; i < MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_array_size && n < TOGGLEREF_BATCH_SIZE; ++i) {
+        GCToggleRef *r = &MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr[i];
+        void *obj = r -> strong_ref;
+
+        if (((word)obj & 1) != 0) {
+          obj = MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(r -> weak_ref);
+          MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(((word)obj & 1) == 0);
+        }
+        if (obj != NULL) objs[n++] = obj;
+      }
+      if (0 == n) break;
 
-      if (((word)obj & 1) != 0) {
-        obj = MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(r -> weak_ref);
-        MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(((word)obj & 1) == 0);
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_callback != 0) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_callback(objs, statuses, n);
+      } else {
+        for (j = 0; j < n; ++j)
+          statuses[j] = MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_callback(objs[j]);
       }
-      if (NULL == obj) continue;
 
-      switch (MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_callback(obj)) {
-      case MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_DROP:
-        break;
-      case MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_STRONG:
-        MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr[new_size++].strong_ref = obj;
-        needs_barrier = TRUE;
-        break;
-      case MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_WEAK:
-        MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr[new_size++].weak_ref = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj);
-        break;
-      default:
-        ABORT("Bad toggle-ref status returned by callback");
+      for (j = 0; j < n; ++j) {
+        switch (statuses[j]) {
+        case MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_DROP:
+          break;
+        case MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_STRONG:
+          MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr[new_size++].strong_ref = objs[j];
+          needs_barrier = TRUE;
+          break;
+        case MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_WEAK:
+          MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr[new_size++].weak_ref = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(objs[j]);
+          break;
+        default:
+          ABORT("Bad toggle-ref status returned by callback");
+        }
       }
     }
+    /* Do not leave the weakly referenced objects on the stack.         */
+    BZERO(objs, sizeof(objs));
 
     if (new_size < MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_array_size) {
       BZERO(&MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr[new_size],
@@ -357,8 +592,9 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_comple
       MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr); /* entire object */
   }
 
-  STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_normal_finalize_mark_proc(ptr_t);
-
+  /* Mark the objects referenced strongly by the toggle-refs (and all   */
+  /* the objects reachable from them).  The marking is done by the      */
+  /* parallel marker if available.                                      */
   STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_togglerefs(void)
   {
     size_t i;
@@ -370,13 +606,17 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_comple
     MANAGED_STACK_ADDRESS_BOEHM_GC_set_mark_bit(MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr);
     for (i = 0; i < MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_array_size; ++i) {
       void *obj = MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr[i].strong_ref;
-      if (obj != NULL && ((word)obj & 1) == 0) {
-        /* Push and mark the object.    */
-        MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fo((ptr_t)obj, MANAGED_STACK_ADDRESS_BOEHM_GC_normal_finalize_mark_proc);
-        MANAGED_STACK_ADDRESS_BOEHM_GC_set_mark_bit(obj);
-        MANAGED_STACK_ADDRESS_BOEHM_GC_complete_ongoing_collection();
-      }
+
+      if (obj != NULL && ((word)obj & 1) == 0 && !MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(obj))
+        MANAGED_STACK_ADDRESS_BOEHM_GC_mark_strong_ref((ptr_t)obj);
     }
+#   ifdef PARALLEL_MARK
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_from_mark_stack();
+#   endif
+    /* The mark stack might have overflowed.  All the pushed objects    */
+    /* are marked, thus their contents are traced by the recovery.      */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_complete_ongoing_collection();
   }
 
   STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_clear_togglerefs(void)
@@ -414,6 +654,23 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_comple
     return fn;
   }
 
+  MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_toggleref_batch_func(MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_func fn)
+  {
+    LOCK();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_callback = fn;
+    UNLOCK();
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_func MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_toggleref_batch_func(void)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_func fn;
+
+    LOCK();
+    fn = MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_callback;
+    UNLOCK();
+    return fn;
+  }
+
   static MANAGED_STACK_ADDRESS_BOEHM_GC_bool ensure_toggleref_capacity(size_t capacity_inc)
   {
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
@@ -457,7 +714,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_comple
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(NONNULL_ARG_NOT_NULL(obj));
     LOCK();
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(((word)obj & 1) == 0 && obj == MANAGED_STACK_ADDRESS_BOEHM_GC_base(obj));
-    if (MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_callback != 0) {
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_callback != 0 || MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_callback != 0) {
       if (!ensure_toggleref_capacity(1)) {
         res = MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY;
       } else {
@@ -503,113 +760,158 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_await_finalize
   {
     if (((word)link & (ALIGNMENT-1)) != 0 || !NONNULL_ARG_NOT_NULL(link))
         ABORT("Bad arg to MANAGED_STACK_ADDRESS_BOEHM_GC_register_long_link");
-    return MANAGED_STACK_ADDRESS_BOEHM_GC_register_disappearing_link_inner(&MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, link, obj,
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_register_disappearing_link_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, link, obj,
                                                "long dl");
   }
 
   MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_long_link(void * * link)
   {
-    struct disappearing_link *curr_dl;
-
-    if (((word)link & (ALIGNMENT-1)) != 0) return 0; /* Nothing to do. */
-
-    LOCK();
-    curr_dl = MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link_inner(&MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, link);
-    UNLOCK();
-    if (NULL == curr_dl) return 0;
-    FREE_DL_ENTRY(curr_dl);
-    return 1;
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, link);
   }
 #endif /* !MANAGED_STACK_ADDRESS_BOEHM_GC_LONG_REFS_NOT_NEEDED */
 
+#ifdef LOCK_FREE_WEAK_DEREF
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER volatile AO_t MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq = 0;
+#endif
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link(void **link)
+{
+  word hidden;
+  void *volatile result;
+
+  /* The pointer is revealed (thus becomes visible to the collector)    */
+  /* before the lock is released or the sequence is rechecked.          */
+# ifdef LOCK_FREE_WEAK_DEREF
+    for (;;) {
+      AO_t seq = AO_load_acquire(&MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq);
+
+      if (EXPECT((seq & 1) != 0, FALSE)) break; /* in clearing phase */
+      hidden = (word)AO_load_acquire((volatile AO_t *)link);
+      result = hidden != 0 ? MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(hidden) : NULL;
+      if (EXPECT(AO_load(&MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq) == seq, TRUE))
+        return result;
+    }
+# endif
+  LOCK();
+  hidden = *(word *)link;
+  result = hidden != 0 ? MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(hidden) : NULL;
+  UNLOCK();
+  return result;
+}
+
 #ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_MOVE_DISAPPEARING_LINK_NOT_NEEDED
   STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link_inner(
                                 struct dl_hashtbl_s *dl_hashtbl,
                                 void **link, void **new_link)
   {
     struct disappearing_link *curr_dl, *new_dl;
-    struct disappearing_link *prev_dl = NULL;
+    struct disappearing_link *prev_dl;
     size_t curr_index, new_index;
     word curr_hidden_link, new_hidden_link;
+    unsigned s = FNLZ_STRIPE_INDEX(link);
+    unsigned new_s = FNLZ_STRIPE_INDEX(new_link);
+    struct dl_hashtbl_s *new_dl_hashtbl = dl_hashtbl + new_s;
+    int result;
 
 #   ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERTIONS
       MANAGED_STACK_ADDRESS_BOEHM_GC_noop1((word)(*new_link));
 #   endif
-    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
-    if (EXPECT(NULL == dl_hashtbl -> head, FALSE)) return MANAGED_STACK_ADDRESS_BOEHM_GC_NOT_FOUND;
-
-    /* Find current link.       */
-    curr_index = HASH2(link, dl_hashtbl -> log_size);
-    curr_hidden_link = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(link);
-    for (curr_dl = dl_hashtbl -> head[curr_index]; curr_dl;
-         curr_dl = dl_next(curr_dl)) {
-      if (curr_dl -> dl_hidden_link == curr_hidden_link)
+    dl_hashtbl += s;
+    for (;;) {
+      /* Acquire the locks of both stripes in the order of indices.     */
+      LOCK_FNLZ_STRIPE(s < new_s ? s : new_s);
+      if (s != new_s)
+        LOCK_FNLZ_STRIPE(s < new_s ? new_s : s);
+
+      /* Find current link.     */
+      curr_dl = NULL;
+      prev_dl = NULL;
+      curr_index = 0;
+      if (EXPECT(dl_hashtbl -> head != NULL, TRUE)) {
+        curr_index = HASH2(link, dl_hashtbl -> log_size);
+        curr_hidden_link = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(link);
+        for (curr_dl = dl_hashtbl -> head[curr_index]; curr_dl;
+             curr_dl = dl_next(curr_dl)) {
+          if (curr_dl -> dl_hidden_link == curr_hidden_link)
+            break;
+          prev_dl = curr_dl;
+        }
+      }
+      if (EXPECT(NULL == curr_dl || link == new_link, FALSE)
+          || EXPECT(new_dl_hashtbl -> head != NULL, TRUE))
         break;
-      prev_dl = curr_dl;
-    }
-    if (EXPECT(NULL == curr_dl, FALSE)) {
-      return MANAGED_STACK_ADDRESS_BOEHM_GC_NOT_FOUND;
-    } else if (link == new_link) {
-      return MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS; /* Nothing to do.      */
-    }
 
-    /* link found; now check new_link not present.      */
-    new_index = HASH2(new_link, dl_hashtbl -> log_size);
-    new_hidden_link = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(new_link);
-    for (new_dl = dl_hashtbl -> head[new_index]; new_dl;
-         new_dl = dl_next(new_dl)) {
-      if (new_dl -> dl_hidden_link == new_hidden_link) {
-        /* Target already registered; bail.     */
-        return MANAGED_STACK_ADDRESS_BOEHM_GC_DUPLICATE;
-      }
+      /* The target stripe has no table yet (thus s != new_s).  */
+      UNLOCK_FNLZ_STRIPE(s);
+      (void)FNLZ_STRIPE_RESERVE(new_s, new_dl_hashtbl,
+                                struct disappearing_link, "dl");
+      UNLOCK_FNLZ_STRIPE(new_s);
     }
 
-    /* Remove from old, add to new, update link.        */
-    if (NULL == prev_dl) {
-      dl_hashtbl -> head[curr_index] = dl_next(curr_dl);
+    if (EXPECT(NULL == curr_dl, FALSE)) {
+      result = MANAGED_STACK_ADDRESS_BOEHM_GC_NOT_FOUND;
+    } else if (link == new_link) {
+      result = MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS; /* Nothing to do.    */
     } else {
-      dl_set_next(prev_dl, dl_next(curr_dl));
-      MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(prev_dl);
+      /* link found; now check new_link not present.    */
+      new_index = HASH2(new_link, new_dl_hashtbl -> log_size);
+      new_hidden_link = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(new_link);
+      for (new_dl = new_dl_hashtbl -> head[new_index]; new_dl;
+           new_dl = dl_next(new_dl)) {
+        if (new_dl -> dl_hidden_link == new_hidden_link) {
+          /* Target already registered; bail.   */
+          break;
+        }
+      }
+      if (new_dl != NULL) {
+        result = MANAGED_STACK_ADDRESS_BOEHM_GC_DUPLICATE;
+      } else {
+        /* Remove from old, add to new, update link.    */
+        if (NULL == prev_dl) {
+          dl_hashtbl -> head[curr_index] = dl_next(curr_dl);
+          MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(dl_hashtbl -> head + curr_index);
+        } else {
+          dl_set_next(prev_dl, dl_next(curr_dl));
+          MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(prev_dl);
+        }
+        curr_dl -> dl_hidden_link = new_hidden_link;
+        dl_set_next(curr_dl, new_dl_hashtbl -> head[new_index]);
+        new_dl_hashtbl -> head[new_index] = curr_dl;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_dl);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(new_dl_hashtbl -> head + new_index);
+        dl_hashtbl -> entries--;
+        new_dl_hashtbl -> entries++;
+        result = MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+      }
     }
-    curr_dl -> dl_hidden_link = new_hidden_link;
-    dl_set_next(curr_dl, dl_hashtbl -> head[new_index]);
-    dl_hashtbl -> head[new_index] = curr_dl;
-    MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_dl);
-    MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(dl_hashtbl->head); /* entire object */
-    return MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+    UNLOCK_FNLZ_STRIPE(s);
+    if (s != new_s)
+      UNLOCK_FNLZ_STRIPE(new_s);
+    return result;
   }
 
   MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link(void **link, void **new_link)
   {
-    int result;
-
     if (((word)new_link & (ALIGNMENT-1)) != 0
         || !NONNULL_ARG_NOT_NULL(new_link))
       ABORT("Bad new_link arg to MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link");
     if (((word)link & (ALIGNMENT-1)) != 0)
       return MANAGED_STACK_ADDRESS_BOEHM_GC_NOT_FOUND; /* Nothing to do. */
 
-    LOCK();
-    result = MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link_inner(&MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, link, new_link);
-    UNLOCK();
-    return result;
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, link, new_link);
   }
 
 # ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_LONG_REFS_NOT_NEEDED
     MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_move_long_link(void **link, void **new_link)
     {
-      int result;
-
       if (((word)new_link & (ALIGNMENT-1)) != 0
           || !NONNULL_ARG_NOT_NULL(new_link))
         ABORT("Bad new_link arg to MANAGED_STACK_ADDRESS_BOEHM_GC_move_long_link");
       if (((word)link & (ALIGNMENT-1)) != 0)
         return MANAGED_STACK_ADDRESS_BOEHM_GC_NOT_FOUND; /* Nothing to do. */
 
-      LOCK();
-      result = MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link_inner(&MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, link, new_link);
-      UNLOCK();
-      return result;
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, link,
+                                             new_link);
     }
 # endif /* !MANAGED_STACK_ADDRESS_BOEHM_GC_LONG_REFS_NOT_NEEDED */
 #endif /* !MANAGED_STACK_ADDRESS_BOEHM_GC_MOVE_DISAPPEARING_LINK_NOT_NEEDED */
@@ -691,33 +993,54 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_register_finalizer_inner(void * obj,
                                         finalization_mark_proc mp)
 {
     struct finalizable_object * curr_fo;
+    struct finalizable_object *prev_fo = NULL;
     size_t index;
-    struct finalizable_object *new_fo = 0;
-    hdr *hhdr = NULL; /* initialized to prevent warning. */
+    struct finalizable_object *new_fo;
+    hdr *hhdr;
+    unsigned s = FNLZ_STRIPE_INDEX(obj);
+    struct fo_hashtbl_s *fo_hashtbl = MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl + s;
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized);
     if (EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_find_leak, FALSE)) {
       /* No-op.  *ocd and *ofn remain unchanged.    */
       return;
     }
-    LOCK();
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(obj != NULL && MANAGED_STACK_ADDRESS_BOEHM_GC_base_C(obj) == obj);
+    LOCK_FNLZ_STRIPE(s);
     if (mp == MANAGED_STACK_ADDRESS_BOEHM_GC_unreachable_finalize_mark_proc)
         need_unreachable_finalization = TRUE;
-    if (EXPECT(NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head, FALSE)
-        || EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries > ((word)1 << MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size), FALSE)) {
-        MANAGED_STACK_ADDRESS_BOEHM_GC_grow_table((struct hash_chain_entry ***)&MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head,
-                      &MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size, &MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries);
-        MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Grew fo table to %u entries\n",
-                           1U << MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size);
+    if (fn != 0
+        && (EXPECT(NULL == fo_hashtbl -> free_list, FALSE)
+            || EXPECT(fo_hashtbl -> entries
+                        > ((word)1 << fo_hashtbl -> log_size), FALSE)
+            || EXPECT(NULL == fo_hashtbl -> head, FALSE))) {
+      if (!FNLZ_STRIPE_RESERVE(s, fo_hashtbl, struct finalizable_object,
+                               "fo")) {
+        UNLOCK_FNLZ_STRIPE(s);
+        new_fo = (struct finalizable_object *)
+                (*MANAGED_STACK_ADDRESS_BOEHM_GC_get_oom_fn())(sizeof(struct finalizable_object));
+        if (0 == new_fo) {
+          /* No enough memory.  *ocd and *ofn remain unchanged.   */
+          return;
+        }
+        /* It's not likely we'll make it here, but ... */
+        LOCK_FNLZ_STRIPE(s);
+        fo_set_next(new_fo, fo_hashtbl -> free_list);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(new_fo);
+        fo_hashtbl -> free_list = new_fo;
+        fo_hashtbl -> free_count++;
+      }
     }
-    for (;;) {
-      struct finalizable_object *prev_fo = NULL;
-      MANAGED_STACK_ADDRESS_BOEHM_GC_oom_func oom_fn;
 
-      index = HASH2(obj, MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size);
-      curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[index];
-      while (curr_fo != 0) {
+    /* Calculate index after the stripe lock is (re)acquired since the  */
+    /* stripe may grow meanwhile.                                       */
+    curr_fo = NULL;
+    index = 0;
+    if (EXPECT(fo_hashtbl -> head != NULL, TRUE)) {
+      index = HASH2(obj, fo_hashtbl -> log_size);
+      curr_fo = fo_hashtbl -> head[index];
+    }
+    while (curr_fo != 0) {
         MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_size(curr_fo) >= sizeof(struct finalizable_object));
         if (curr_fo -> fo_hidden_base == MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj)) {
           /* Interruption by a signal in the middle of this     */
@@ -727,19 +1050,26 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_register_finalizer_inner(void * obj,
           if (ofn) *ofn = curr_fo -> fo_fn;
           /* Delete the structure for obj.      */
           if (prev_fo == 0) {
-            MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[index] = fo_next(curr_fo);
+            fo_hashtbl -> head[index] = fo_next(curr_fo);
           } else {
             fo_set_next(prev_fo, fo_next(curr_fo));
             MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(prev_fo);
           }
           if (fn == 0) {
-            MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries--;
+            fo_hashtbl -> entries--;
+            FO_ENTRIES_DEC();
             /* May not happen if we get a signal.  But a high   */
             /* estimate will only make the table larger than    */
             /* necessary.                                       */
-#           if !defined(THREADS) && !defined(DBG_HDRS_ALL)
-              MANAGED_STACK_ADDRESS_BOEHM_GC_free((void *)curr_fo);
-#           endif
+            if (fo_hashtbl -> free_count < FNLZ_FREE_ENTRIES_MAX) {
+              /* Keep the entry for reuse.      */
+              curr_fo -> fo_client_data = NULL;
+              fo_set_next(curr_fo, fo_hashtbl -> free_list);
+              MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_fo);
+              fo_hashtbl -> free_list = curr_fo;
+              fo_hashtbl -> free_count++;
+              curr_fo = NULL;
+            }
           } else {
             curr_fo -> fo_fn = fn;
             curr_fo -> fo_client_data = (ptr_t)cd;
@@ -748,64 +1078,44 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_register_finalizer_inner(void * obj,
             /* Reinsert it.  We deleted it first to maintain    */
             /* consistency in the event of a signal.            */
             if (prev_fo == 0) {
-              MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[index] = curr_fo;
+              fo_hashtbl -> head[index] = curr_fo;
             } else {
               fo_set_next(prev_fo, curr_fo);
               MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(prev_fo);
             }
+            curr_fo = NULL;
           }
           if (NULL == prev_fo)
-            MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head + index);
-          UNLOCK();
+            MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(fo_hashtbl -> head + index);
+          UNLOCK_FNLZ_STRIPE(s);
 #         ifndef DBG_HDRS_ALL
-              /* Free unused new_fo returned by MANAGED_STACK_ADDRESS_BOEHM_GC_oom_fn() */
-              MANAGED_STACK_ADDRESS_BOEHM_GC_free((void *)new_fo);
+            /* Free the deleted entry if not kept in the free list.     */
+            if (curr_fo != NULL) MANAGED_STACK_ADDRESS_BOEHM_GC_free((void *)curr_fo);
 #         endif
           return;
         }
         prev_fo = curr_fo;
         curr_fo = fo_next(curr_fo);
-      }
-      if (EXPECT(new_fo != 0, FALSE)) {
-        /* new_fo is returned by MANAGED_STACK_ADDRESS_BOEHM_GC_oom_fn().   */
-        MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(fn != 0);
-#       ifdef LINT2
-          if (NULL == hhdr) ABORT("Bad hhdr in MANAGED_STACK_ADDRESS_BOEHM_GC_register_finalizer_inner");
-#       endif
-        break;
-      }
-      if (fn == 0) {
+    }
+    if (fn == 0) {
         if (ocd) *ocd = 0;
         if (ofn) *ofn = 0;
-        UNLOCK();
+        UNLOCK_FNLZ_STRIPE(s);
         return;
-      }
-      GET_HDR(obj, hhdr);
-      if (EXPECT(0 == hhdr, FALSE)) {
+    }
+    GET_HDR(obj, hhdr);
+    if (EXPECT(0 == hhdr, FALSE)) {
         /* We won't collect it, hence finalizer wouldn't be run. */
         if (ocd) *ocd = 0;
         if (ofn) *ofn = 0;
-        UNLOCK();
+        UNLOCK_FNLZ_STRIPE(s);
         return;
-      }
-      new_fo = (struct finalizable_object *)
-        MANAGED_STACK_ADDRESS_BOEHM_GC_INTERNAL_MALLOC(sizeof(struct finalizable_object), NORMAL);
-      if (EXPECT(new_fo != 0, TRUE))
-        break;
-      oom_fn = MANAGED_STACK_ADDRESS_BOEHM_GC_oom_fn;
-      UNLOCK();
-      new_fo = (struct finalizable_object *)
-                (*oom_fn)(sizeof(struct finalizable_object));
-      if (0 == new_fo) {
-        /* No enough memory.  *ocd and *ofn remain unchanged.   */
-        return;
-      }
-      /* It's not likely we'll make it here, but ... */
-      LOCK();
-      /* Recalculate index since the table may grow and         */
-      /* check again that our finalizer is not in the table.    */
     }
+    new_fo = fo_hashtbl -> free_list;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(new_fo != NULL && fo_hashtbl -> free_count > 0);
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_size(new_fo) >= sizeof(struct finalizable_object));
+    fo_hashtbl -> free_list = fo_next(new_fo);
+    fo_hashtbl -> free_count--;
     if (ocd) *ocd = 0;
     if (ofn) *ofn = 0;
     new_fo -> fo_hidden_base = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj);
@@ -813,12 +1123,13 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_register_finalizer_inner(void * obj,
     new_fo -> fo_client_data = (ptr_t)cd;
     new_fo -> fo_object_size = hhdr -> hb_sz;
     new_fo -> fo_mark_proc = mp;
-    fo_set_next(new_fo, MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[index]);
+    fo_set_next(new_fo, fo_hashtbl -> head[index]);
     MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(new_fo);
-    MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries++;
-    MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[index] = new_fo;
-    MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head + index);
-    UNLOCK();
+    fo_hashtbl -> entries++;
+    FO_ENTRIES_INC();
+    fo_hashtbl -> head[index] = new_fo;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(fo_hashtbl -> head + index);
+    UNLOCK_FNLZ_STRIPE(s);
 }
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_register_finalizer(void * obj,
@@ -858,45 +1169,53 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
   STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_dump_finalization_links(
                                 const struct dl_hashtbl_s *dl_hashtbl)
   {
-    size_t dl_size = (size_t)1 << dl_hashtbl -> log_size;
-    size_t i;
+    unsigned s;
 
-    if (NULL == dl_hashtbl -> head) return; /* empty table  */
+    for (s = 0; s < FNLZ_STRIPES; s++) {
+      const struct dl_hashtbl_s *stripe = dl_hashtbl + s;
+      size_t dl_size = FNLZ_STRIPE_SIZE(stripe);
+      size_t i;
 
-    for (i = 0; i < dl_size; i++) {
-      struct disappearing_link *curr_dl;
+      for (i = 0; i < dl_size; i++) {
+        struct disappearing_link *curr_dl;
 
-      for (curr_dl = dl_hashtbl -> head[i]; curr_dl != 0;
-           curr_dl = dl_next(curr_dl)) {
-        ptr_t real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_dl -> dl_hidden_obj);
-        ptr_t real_link = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_dl -> dl_hidden_link);
+        for (curr_dl = stripe -> head[i]; curr_dl != 0;
+             curr_dl = dl_next(curr_dl)) {
+          ptr_t real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_dl -> dl_hidden_obj);
+          ptr_t real_link = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(
+                                                curr_dl -> dl_hidden_link);
 
-        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Object: %p, link value: %p, link addr: %p\n",
-                  (void *)real_ptr, *(void **)real_link, (void *)real_link);
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Object: %p, link value: %p, link addr: %p\n",
+                    (void *)real_ptr, *(void **)real_link, (void *)real_link);
+        }
       }
     }
   }
 
   MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_dump_finalization(void)
   {
-    struct finalizable_object * curr_fo;
-    size_t i;
-    size_t fo_size = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head == NULL ? 0 :
-                                (size_t)1 << MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size;
+    unsigned s;
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_printf("\n***Disappearing (short) links:\n");
-    MANAGED_STACK_ADDRESS_BOEHM_GC_dump_finalization_links(&MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_dump_finalization_links(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl);
 #   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_LONG_REFS_NOT_NEEDED
       MANAGED_STACK_ADDRESS_BOEHM_GC_printf("\n***Disappearing long links:\n");
-      MANAGED_STACK_ADDRESS_BOEHM_GC_dump_finalization_links(&MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_dump_finalization_links(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl);
 #   endif
     MANAGED_STACK_ADDRESS_BOEHM_GC_printf("\n***Finalizers:\n");
-    for (i = 0; i < fo_size; i++) {
-      for (curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[i];
-           curr_fo != NULL; curr_fo = fo_next(curr_fo)) {
-        ptr_t real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
+    for (s = 0; s < FNLZ_STRIPES; s++) {
+      size_t fo_size = FNLZ_STRIPE_SIZE(&MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl[s]);
+      size_t i;
+
+      for (i = 0; i < fo_size; i++) {
+        struct finalizable_object * curr_fo;
+
+        for (curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl[s].head[i];
+             curr_fo != NULL; curr_fo = fo_next(curr_fo)) {
+          ptr_t real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
 
-        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Finalizable object: %p\n", (void *)real_ptr);
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Finalizable object: %p\n", (void *)real_ptr);
+        }
       }
     }
   }
@@ -937,20 +1256,21 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
   }
 #endif /* !THREADS */
 
-MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(
-                                        struct dl_hashtbl_s* dl_hashtbl,
-                                        MANAGED_STACK_ADDRESS_BOEHM_GC_bool is_remove_dangling)
+/* Clear the links of one bucket of a stripe (dl_hashtbl) whose objects */
+/* unreachable (or remove the dangling links) and unlink their entries. */
+/* If deleted_dl is NULL, then the mark bits of the unlinked entries    */
+/* are cleared here (and the entries count is updated), otherwise the   */
+/* entries are prepended to *deleted_dl (chained via dl_next) to be     */
+/* processed by the caller.  Returns whether the head was updated.      */
+/* Could be called for distinct buckets concurrently (the world might   */
+/* be running but the allocation lock is held by the initiator).        */
+STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_clear_dl_bucket(struct dl_hashtbl_s *dl_hashtbl,
+                                  size_t i, MANAGED_STACK_ADDRESS_BOEHM_GC_bool is_remove_dangling,
+                                  struct disappearing_link **deleted_dl)
 {
-  size_t i;
-  size_t dl_size = (size_t)1 << dl_hashtbl -> log_size;
-  MANAGED_STACK_ADDRESS_BOEHM_GC_bool needs_barrier = FALSE;
-
-  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
-  if (NULL == dl_hashtbl -> head) return; /* empty table  */
-
-  for (i = 0; i < dl_size; i++) {
     struct disappearing_link *curr_dl, *next_dl;
     struct disappearing_link *prev_dl = NULL;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool needs_barrier = FALSE;
 
     for (curr_dl = dl_hashtbl->head[i]; curr_dl != NULL; curr_dl = next_dl) {
       next_dl = dl_next(curr_dl);
@@ -983,12 +1303,419 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_make_d
         dl_set_next(prev_dl, next_dl);
         MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(prev_dl);
       }
-      MANAGED_STACK_ADDRESS_BOEHM_GC_clear_mark_bit(curr_dl);
-      dl_hashtbl -> entries--;
+      if (deleted_dl != NULL) {
+        dl_set_next(curr_dl, *deleted_dl);
+        *deleted_dl = curr_dl;
+      } else {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_clear_mark_bit(curr_dl);
+        dl_hashtbl -> entries--;
+      }
+    }
+    return needs_barrier;
+}
+
+#ifdef PARALLEL_MARK
+# ifndef PARALLEL_FINALIZE_THRESHOLD
+    /* The minimal number of entries in a finalization or disappearing  */
+    /* link table to process it with the help of the marker threads.    */
+#   define PARALLEL_FINALIZE_THRESHOLD 1024
+# endif
+
+# define DL_BUCKETS_PER_CLAIM 256
+
+  struct clear_dl_task_s {
+    struct dl_hashtbl_s *dl_hashtbl; /* the stripes */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool is_remove_dangling;
+    volatile AO_t next_bucket[FNLZ_STRIPES];
+                        /* the first unclaimed bucket of each stripe */
+    volatile AO_t deleted; /* the list of the unlinked entries */
+    volatile AO_t needs_barrier;
+  };
+
+  STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_clear_dl_task(void *client_data)
+  {
+    struct clear_dl_task_s *t = (struct clear_dl_task_s *)client_data;
+    struct disappearing_link *deleted_dl = NULL;
+    struct disappearing_link *last_dl;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool needs_barrier = FALSE;
+    unsigned s;
+
+    for (s = 0; s < FNLZ_STRIPES; s++) {
+      struct dl_hashtbl_s *stripe = t -> dl_hashtbl + s;
+      size_t dl_size = FNLZ_STRIPE_SIZE(stripe);
+
+      for (;;) {
+        size_t i = (size_t)AO_fetch_and_add(&t -> next_bucket[s],
+                                            DL_BUCKETS_PER_CLAIM);
+        size_t lim;
+
+        if (i >= dl_size) break;
+        lim = i + DL_BUCKETS_PER_CLAIM < dl_size ? i + DL_BUCKETS_PER_CLAIM
+                                                 : dl_size;
+        for (; i < lim; i++) {
+          if (MANAGED_STACK_ADDRESS_BOEHM_GC_clear_dl_bucket(stripe, i, t -> is_remove_dangling,
+                                 &deleted_dl))
+            needs_barrier = TRUE;
+        }
+      }
+    }
+    if (needs_barrier)
+      AO_store(&t -> needs_barrier, TRUE);
+    if (NULL == deleted_dl) return;
+
+    /* Prepend the entries unlinked by this thread to the shared list.  */
+    for (last_dl = deleted_dl; dl_next(last_dl) != NULL;
+         last_dl = dl_next(last_dl)) {
+      /* empty */
+    }
+    for (;;) {
+      AO_t head = AO_load(&t -> deleted);
+
+      dl_set_next(last_dl, (struct disappearing_link *)head);
+      if (AO_compare_and_swap(&t -> deleted, head, (AO_t)deleted_dl))
+        break;
     }
   }
-  if (needs_barrier)
-    MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(dl_hashtbl -> head); /* entire object */
+#endif /* PARALLEL_MARK */
+
+/* Process all the stripes of the given disappearing links table.       */
+/* The locks of all the stripes should be held.                         */
+MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(
+                                        struct dl_hashtbl_s* dl_hashtbl,
+                                        MANAGED_STACK_ADDRESS_BOEHM_GC_bool is_remove_dangling)
+{
+  unsigned s;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+# ifdef PARALLEL_MARK
+    /* The marker threads have all signals blocked, thus they cannot    */
+    /* write to the heap pages protected by the dirty bits              */
+    /* implementation (the links and the table entries may reside in    */
+    /* such pages).                                                     */
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel
+        && MANAGED_STACK_ADDRESS_BOEHM_GC_dl_table_entries(dl_hashtbl) >= PARALLEL_FINALIZE_THRESHOLD
+        && (!MANAGED_STACK_ADDRESS_BOEHM_GC_auto_incremental
+            || MANAGED_STACK_ADDRESS_BOEHM_GC_incremental_protection_needs() == MANAGED_STACK_ADDRESS_BOEHM_GC_PROTECTS_NONE)) {
+      struct clear_dl_task_s t;
+      struct disappearing_link *curr_dl, *next_dl;
+
+      t.dl_hashtbl = dl_hashtbl;
+      t.is_remove_dangling = is_remove_dangling;
+      for (s = 0; s < FNLZ_STRIPES; s++)
+        t.next_bucket[s] = 0;
+      t.deleted = 0;
+      t.needs_barrier = FALSE;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_do_parallel_task(MANAGED_STACK_ADDRESS_BOEHM_GC_clear_dl_task, &t);
+
+      /* The mark bits are not updated atomically, thus the unlinked    */
+      /* entries are released by this thread only.                      */
+      for (curr_dl = (struct disappearing_link *)AO_load_acquire(&t.deleted);
+           curr_dl != NULL; curr_dl = next_dl) {
+        next_dl = dl_next(curr_dl);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_clear_mark_bit(curr_dl);
+        dl_hashtbl[FNLZ_STRIPE_INDEX(MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(
+                                curr_dl -> dl_hidden_link))].entries--;
+      }
+      if (AO_load(&t.needs_barrier)) {
+        for (s = 0; s < FNLZ_STRIPES; s++) {
+          if (dl_hashtbl[s].head != NULL)
+            MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(dl_hashtbl[s].head); /* entire object */
+        }
+      }
+      return;
+    }
+# endif
+  for (s = 0; s < FNLZ_STRIPES; s++) {
+    struct dl_hashtbl_s *stripe = dl_hashtbl + s;
+    size_t dl_size = FNLZ_STRIPE_SIZE(stripe);
+    size_t i;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool needs_barrier = FALSE;
+
+    for (i = 0; i < dl_size; i++) {
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_clear_dl_bucket(stripe, i, is_remove_dangling, NULL))
+        needs_barrier = TRUE;
+    }
+    if (needs_barrier)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(stripe -> head); /* entire object */
+  }
+}
+
+#ifdef PARALLEL_MARK
+  /* Same as the first pass of MANAGED_STACK_ADDRESS_BOEHM_GC_finalize but the marking from all     */
+  /* the unmarked finalizable objects is done by the parallel marker    */
+  /* (the resulting set of marked objects does not depend on the order  */
+  /* in which the objects are processed).  The finalizable objects      */
+  /* themselves remain unmarked unless reachable from other ones, thus  */
+  /* the ordering of finalizers is preserved.  The finalization cycles  */
+  /* are not reported, though.                                          */
+  STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fo_parallel(void)
+  {
+    for (;;) {
+      unsigned s;
+
+      for (s = 0; s < FNLZ_STRIPES; s++) {
+        size_t fo_size = FNLZ_STRIPE_SIZE(&MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl[s]);
+        size_t i;
+
+        for (i = 0; i < fo_size; i++) {
+          struct finalizable_object *curr_fo;
+
+          for (curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl[s].head[i];
+               curr_fo != NULL; curr_fo = fo_next(curr_fo)) {
+            ptr_t real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(
+                                                curr_fo -> fo_hidden_base);
+
+            if (MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(real_ptr)) continue;
+            MANAGED_STACK_ADDRESS_BOEHM_GC_MARKED_FOR_FINALIZATION(real_ptr);
+            curr_fo -> fo_mark_proc(real_ptr);
+            if ((word)MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_top
+                  >= (word)(MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack + MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_size/4))
+              MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_from_mark_stack();
+          }
+        }
+      }
+      MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_from_mark_stack();
+      if (EXPECT(!MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress(), TRUE)) break;
+
+      /* The mark stack has overflowed, so the contents of some         */
+      /* finalizable objects might remain unmarked.  Mark from all the  */
+      /* marked objects (thus the mark state becomes valid) and retry.  */
+      MANAGED_STACK_ADDRESS_BOEHM_GC_complete_ongoing_collection();
+    }
+  }
+#endif /* PARALLEL_MARK */
+
+/* Ephemeron tables.  A table is an object of a dedicated kind which    */
+/* is not traced by the marker: a header (the number of the pairs, the  */
+/* number of the pairs cleared so far and the hidden link to the next   */
+/* table) is followed by the pairs of a key and a value.  Once the      */
+/* marking is otherwise complete, the values of the pairs with marked   */
+/* keys of the marked tables are marked (repeatedly, since the marked   */
+/* values may reach more keys and tables), and then the pairs whose     */
+/* keys remain unmarked are cleared.                                    */
+#define EPHEMERON_HDR_WORDS 3
+#define EPHEMERON_CLEARED(tbl) ((tbl)[1])
+#define EPHEMERON_NEXT(tbl) ((tbl)[2])
+
+STATIC unsigned MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_kind = 0;
+                        /* Zero until the first table is allocated.     */
+
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_tables = 0;
+                        /* The hidden pointer to the most recently      */
+                        /* allocated table, the tables are linked by    */
+                        /* EPHEMERON_NEXT.  The unreachable ones are    */
+                        /* unlinked when their pairs would be cleared,  */
+                        /* thus only the live tables are walked.        */
+
+#ifndef SMALL_CONFIG
+  STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_ephemerons_cleared = 0; /* for stats printing */
+#endif
+
+/* The base of the object referenced by a key or value of a pair, or    */
+/* NULL if it is not a heap object (such a key is never cleared).       */
+#define EPHEMERON_BASE(w) ((w) != 0 ? (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_base((void *)(w)) : NULL)
+
+/* Mark the values of the live pairs of a given (marked) table, or      */
+/* clear the dead pairs if requested.  Returns the number of the values */
+/* marked or the pairs cleared, respectively.                           */
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_walk(word *tbl, MANAGED_STACK_ADDRESS_BOEHM_GC_bool clear)
+{
+  word *pair;
+  word *lim = tbl + EPHEMERON_HDR_WORDS + 2 * tbl[0];
+  word count = 0;
+
+  for (pair = tbl + EPHEMERON_HDR_WORDS; pair != lim; pair += 2) {
+    ptr_t key_base;
+
+    if (0 == pair[0]) continue;
+    key_base = EPHEMERON_BASE(pair[0]);
+    if (NULL == key_base || MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(key_base)) {
+      ptr_t value_base;
+
+      if (clear) continue;
+      value_base = EPHEMERON_BASE(pair[1]);
+      if (value_base != NULL && !MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(value_base)) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_mark_strong_ref(value_base);
+        count++;
+      }
+    } else if (clear) {
+      pair[0] = 0;
+      pair[1] = 0;
+      count++;
+    }
+  }
+  if (clear && count > 0) {
+#   ifdef LOCK_FREE_WEAK_DEREF
+      AO_store((volatile AO_t *)&EPHEMERON_CLEARED(tbl),
+               (AO_t)(EPHEMERON_CLEARED(tbl) + count));
+#   else
+      EPHEMERON_CLEARED(tbl) += count;
+#   endif
+  }
+  return count;
+}
+
+/* Mark the values of the ephemerons with marked keys until no more     */
+/* values get marked, then clear the pairs with unmarked keys (and      */
+/* unlink the unmarked tables) if requested.  The value marking is done */
+/* by the parallel marker if available.  Called with the world running. */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_process_ephemerons(MANAGED_STACK_ADDRESS_BOEHM_GC_bool clear)
+{
+  word *tbl;
+  word count;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  if (0 == MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_tables) return;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_complete_ongoing_collection();
+  do {
+    count = 0;
+    for (tbl = (word *)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_tables); tbl != NULL;
+         tbl = EPHEMERON_NEXT(tbl) != 0
+                ? (word *)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(EPHEMERON_NEXT(tbl)) : NULL) {
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(tbl))
+        count += MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_walk(tbl, FALSE);
+    }
+#   ifdef PARALLEL_MARK
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_from_mark_stack();
+#   endif
+    /* The mark stack might have overflowed.    */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_complete_ongoing_collection();
+  } while (count > 0);
+
+  if (clear) {
+    word *prev = NULL;
+    word next;
+
+    count = 0;
+    for (tbl = (word *)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_tables); tbl != NULL;
+         tbl = next != 0 ? (word *)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(next) : NULL) {
+      next = EPHEMERON_NEXT(tbl);
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(tbl)) {
+        count += MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_walk(tbl, TRUE);
+        prev = tbl;
+      } else if (NULL == prev) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_tables = next;
+      } else {
+        EPHEMERON_NEXT(prev) = next;
+      }
+    }
+#   ifndef SMALL_CONFIG
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ephemerons_cleared = count;
+#   endif
+  }
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_ephemeron_table(size_t n)
+{
+  word *tbl;
+  unsigned kind;
+
+  if (EXPECT(n > (MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_MAX / sizeof(word) - EPHEMERON_HDR_WORDS) / 2,
+             FALSE))
+    return (*MANAGED_STACK_ADDRESS_BOEHM_GC_get_oom_fn())(MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_MAX); /* overflow */
+  if (!EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized, TRUE)) MANAGED_STACK_ADDRESS_BOEHM_GC_init();
+  LOCK();
+  if (EXPECT(0 == MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_kind, FALSE)) {
+    /* The tables have no pointers for the marker, but they are         */
+    /* cleared on allocation (the empty pairs are zeroed).              */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_kind = MANAGED_STACK_ADDRESS_BOEHM_GC_new_kind_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_new_free_list_inner(),
+                                          0 | MANAGED_STACK_ADDRESS_BOEHM_GC_DS_LENGTH, FALSE, TRUE);
+  }
+  kind = MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_kind;
+  UNLOCK();
+
+  tbl = (word *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind((EPHEMERON_HDR_WORDS + 2 * n) * sizeof(word),
+                               (int)kind);
+  if (EXPECT(NULL == tbl, FALSE)) return NULL;
+  tbl[0] = (word)n;
+  LOCK();
+  EPHEMERON_NEXT(tbl) = MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_tables;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_tables = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(tbl);
+  UNLOCK();
+  return tbl;
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API size_t MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_size(const void *tbl)
+{
+  return (size_t)((const word *)tbl)[0];
+}
+
+/* Unlike the getter, the setter acquires the lock: the pairs are       */
+/* cleared (with the world running) holding the lock only, so a pair    */
+/* stored without it might be cleared partly, or a new key might be     */
+/* cleared as unmarked.                                                 */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_set(void *tbl, size_t i,
+                                           const void *key, const void *value)
+{
+  word *pair = (word *)tbl + EPHEMERON_HDR_WORDS + 2 * i;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(i < MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_size(tbl));
+  LOCK();
+# ifdef LOCK_FREE_WEAK_DEREF
+    /* The value is stored before the key (and cleared after it) for    */
+    /* the lock-free getter.                                            */
+    if (NULL == key) {
+      AO_store((volatile AO_t *)pair, 0);
+      AO_store_release((volatile AO_t *)&pair[1], 0);
+    } else {
+      AO_store((volatile AO_t *)&pair[1], (AO_t)value);
+      AO_store_release((volatile AO_t *)pair, (AO_t)key);
+    }
+# else
+    pair[0] = (word)key;
+    pair[1] = NULL == key ? 0 : (word)value;
+# endif
+  UNLOCK();
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_get(const void *tbl, size_t i,
+                                             void **pvalue)
+{
+  const word *pair = (const word *)tbl + EPHEMERON_HDR_WORDS + 2 * i;
+  void *key;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(i < MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_size(tbl));
+# ifdef LOCK_FREE_WEAK_DEREF
+    /* Same as in MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link: the pairs are read        */
+    /* lock-free unless the collector is clearing them.                 */
+    for (;;) {
+      AO_t seq = AO_load_acquire(&MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq);
+      void *volatile k;
+      void *volatile v;
+
+      if (EXPECT((seq & 1) != 0, FALSE)) break; /* in clearing phase */
+      k = (void *)AO_load_acquire((volatile AO_t *)pair);
+      v = (void *)AO_load((volatile AO_t *)&pair[1]);
+      if (EXPECT(AO_load(&MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq) == seq, TRUE)) {
+        if (pvalue != NULL)
+          *pvalue = k != NULL ? v : NULL;
+        return k;
+      }
+    }
+# endif
+  /* The lock prevents from getting a key being cleared.        */
+  LOCK();
+  key = (void *)pair[0];
+  if (pvalue != NULL)
+    *pvalue = (void *)pair[1];
+  UNLOCK();
+  return key;
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_word MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_cleared(const void *tbl)
+{
+  word count;
+
+# ifdef LOCK_FREE_WEAK_DEREF
+    count = (word)AO_load((volatile AO_t *)&EPHEMERON_CLEARED(
+                                                (const word *)tbl));
+# else
+    LOCK();
+    count = EPHEMERON_CLEARED((const word *)tbl);
+    UNLOCK();
+# endif
+  return count;
 }
 
 /* Cause disappearing links to disappear and unreachable objects to be  */
@@ -998,88 +1725,116 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_finaliz
     struct finalizable_object * curr_fo, * prev_fo, * next_fo;
     ptr_t real_ptr;
     size_t i;
-    size_t fo_size = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head == NULL ? 0 :
-                                (size_t)1 << MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size;
-    MANAGED_STACK_ADDRESS_BOEHM_GC_bool needs_barrier = FALSE;
+    unsigned s;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool needs_barrier;
+    word ready_before = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count;
+    EVTRACE_SPAN(sp)
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    EVTRACE_BEGIN(sp);
+    LOCK_ALL_FNLZ_STRIPES();
 #   ifndef SMALL_CONFIG
       /* Save current MANAGED_STACK_ADDRESS_BOEHM_GC_[dl/ll]_entries value for stats printing */
-      MANAGED_STACK_ADDRESS_BOEHM_GC_old_dl_entries = MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl.entries;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_old_dl_entries = MANAGED_STACK_ADDRESS_BOEHM_GC_dl_table_entries(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl);
 #     ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_LONG_REFS_NOT_NEEDED
-        MANAGED_STACK_ADDRESS_BOEHM_GC_old_ll_entries = MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl.entries;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_old_ll_entries = MANAGED_STACK_ADDRESS_BOEHM_GC_dl_table_entries(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl);
 #     endif
 #   endif
 
 #   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
       MANAGED_STACK_ADDRESS_BOEHM_GC_mark_togglerefs();
 #   endif
-    MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(&MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, FALSE);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_process_ephemerons(FALSE);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, FALSE);
 
   /* Mark all objects reachable via chains of 1 or more pointers        */
   /* from finalizable objects.                                          */
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(!MANAGED_STACK_ADDRESS_BOEHM_GC_collection_in_progress());
-    for (i = 0; i < fo_size; i++) {
-      for (curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[i];
-           curr_fo != NULL; curr_fo = fo_next(curr_fo)) {
-        MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_size(curr_fo) >= sizeof(struct finalizable_object));
-        real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
-        if (!MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(real_ptr)) {
+#   ifdef PARALLEL_MARK
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel && MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries >= PARALLEL_FINALIZE_THRESHOLD) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fo_parallel();
+      } else
+#   endif
+    /* else */ for (s = 0; s < FNLZ_STRIPES; s++) {
+      size_t fo_size = FNLZ_STRIPE_SIZE(&MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl[s]);
+
+      for (i = 0; i < fo_size; i++) {
+        for (curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl[s].head[i];
+             curr_fo != NULL; curr_fo = fo_next(curr_fo)) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_size(curr_fo) >= sizeof(struct finalizable_object));
+          real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
+          if (!MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(real_ptr)) {
             MANAGED_STACK_ADDRESS_BOEHM_GC_MARKED_FOR_FINALIZATION(real_ptr);
             MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fo(real_ptr, curr_fo -> fo_mark_proc);
             if (MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(real_ptr)) {
                 WARN("Finalization cycle involving %p\n", real_ptr);
             }
+          }
         }
       }
     }
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries > 0) {
+      /* The values of the keys reachable from finalizable objects are  */
+      /* reachable from them too (thus not finalized in this cycle).    */
+      MANAGED_STACK_ADDRESS_BOEHM_GC_process_ephemerons(FALSE);
+    }
   /* Enqueue for finalization all objects that are still                */
   /* unreachable.                                                       */
     MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_finalized = 0;
-    for (i = 0; i < fo_size; i++) {
-      curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[i];
-      prev_fo = NULL;
-      while (curr_fo != NULL) {
-        real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
-        if (!MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(real_ptr)) {
-            if (!MANAGED_STACK_ADDRESS_BOEHM_GC_java_finalization) {
-              MANAGED_STACK_ADDRESS_BOEHM_GC_set_mark_bit(real_ptr);
-            }
-            /* Delete from hash table.  */
-              next_fo = fo_next(curr_fo);
-              if (NULL == prev_fo) {
-                MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[i] = next_fo;
-                if (MANAGED_STACK_ADDRESS_BOEHM_GC_object_finalized_proc) {
-                  MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head + i);
+    for (s = 0; s < FNLZ_STRIPES; s++) {
+      struct fo_hashtbl_s *fo_hashtbl = MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl + s;
+      size_t fo_size = FNLZ_STRIPE_SIZE(fo_hashtbl);
+
+      needs_barrier = FALSE;
+      for (i = 0; i < fo_size; i++) {
+        curr_fo = fo_hashtbl -> head[i];
+        prev_fo = NULL;
+        while (curr_fo != NULL) {
+          real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
+          if (!MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(real_ptr)) {
+              if (!MANAGED_STACK_ADDRESS_BOEHM_GC_java_finalization) {
+                MANAGED_STACK_ADDRESS_BOEHM_GC_set_mark_bit(real_ptr);
+              }
+              /* Delete from hash table.  */
+                next_fo = fo_next(curr_fo);
+                if (NULL == prev_fo) {
+                  fo_hashtbl -> head[i] = next_fo;
+                  if (MANAGED_STACK_ADDRESS_BOEHM_GC_object_finalized_proc) {
+                    MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(fo_hashtbl -> head + i);
+                  } else {
+                    needs_barrier = TRUE;
+                  }
                 } else {
-                  needs_barrier = TRUE;
+                  fo_set_next(prev_fo, next_fo);
+                  MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(prev_fo);
                 }
-              } else {
-                fo_set_next(prev_fo, next_fo);
-                MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(prev_fo);
-              }
-              MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries--;
-              if (MANAGED_STACK_ADDRESS_BOEHM_GC_object_finalized_proc)
-                MANAGED_STACK_ADDRESS_BOEHM_GC_object_finalized_proc(real_ptr);
-
-            /* Add to list of objects awaiting finalization.    */
-              fo_set_next(curr_fo, MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now);
-              MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_fo);
-              SET_FINALIZE_NOW(curr_fo);
-            /* Unhide object pointer so any future collections will   */
-            /* see it.                                                */
-              curr_fo -> fo_hidden_base =
-                        (word)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
-              MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_finalized +=
-                        curr_fo -> fo_object_size
-                        + sizeof(struct finalizable_object);
-            MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(MANAGED_STACK_ADDRESS_BOEHM_GC_base(curr_fo)));
-            curr_fo = next_fo;
-        } else {
-            prev_fo = curr_fo;
-            curr_fo = fo_next(curr_fo);
+                fo_hashtbl -> entries--;
+                MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries--;
+                if (MANAGED_STACK_ADDRESS_BOEHM_GC_object_finalized_proc)
+                  MANAGED_STACK_ADDRESS_BOEHM_GC_object_finalized_proc(real_ptr);
+
+              /* Add to list of objects awaiting finalization.    */
+                fo_set_next(curr_fo, MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now);
+                MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_fo);
+                SET_FINALIZE_NOW(curr_fo);
+                MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count++;
+              /* Unhide object pointer so any future collections will   */
+              /* see it.                                                */
+                curr_fo -> fo_hidden_base =
+                          (word)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
+                MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_finalized +=
+                          curr_fo -> fo_object_size
+                          + sizeof(struct finalizable_object);
+              MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(MANAGED_STACK_ADDRESS_BOEHM_GC_base(curr_fo)));
+              curr_fo = next_fo;
+          } else {
+              prev_fo = curr_fo;
+              curr_fo = fo_next(curr_fo);
+          }
         }
       }
+      if (needs_barrier)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(fo_hashtbl -> head); /* entire object */
     }
 
   if (MANAGED_STACK_ADDRESS_BOEHM_GC_java_finalization) {
@@ -1102,9 +1857,10 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_finaliz
     /* other finalizable objects.                                       */
       if (need_unreachable_finalization) {
         curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now;
-        MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(NULL == curr_fo || MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head != NULL);
         for (prev_fo = NULL; curr_fo != NULL;
              prev_fo = curr_fo, curr_fo = next_fo) {
+          struct fo_hashtbl_s *fo_hashtbl;
+
           next_fo = fo_next(curr_fo);
           if (curr_fo -> fo_mark_proc != MANAGED_STACK_ADDRESS_BOEHM_GC_unreachable_finalize_mark_proc)
             continue;
@@ -1120,33 +1876,48 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_finaliz
             fo_set_next(prev_fo, next_fo);
             MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(prev_fo);
           }
+          MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count--;
           curr_fo -> fo_hidden_base = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(real_ptr);
           MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_finalized -=
               (curr_fo -> fo_object_size) + sizeof(struct finalizable_object);
 
-          i = HASH2(real_ptr, MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size);
-          fo_set_next(curr_fo, MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[i]);
+          fo_hashtbl = MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl + FNLZ_STRIPE_INDEX(real_ptr);
+          MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(fo_hashtbl -> head != NULL);
+          i = HASH2(real_ptr, fo_hashtbl -> log_size);
+          fo_set_next(curr_fo, fo_hashtbl -> head[i]);
           MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_fo);
+          fo_hashtbl -> entries++;
           MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries++;
-          MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[i] = curr_fo;
+          fo_hashtbl -> head[i] = curr_fo;
+          MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(fo_hashtbl -> head + i);
           curr_fo = prev_fo;
-          needs_barrier = TRUE;
         }
       }
   }
-  if (needs_barrier)
-    MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head); /* entire object */
+  /* The objects marked since the previous pass (including the ones     */
+  /* enqueued for finalization) may be keys, so process the ephemerons  */
+  /* again before clearing the dead pairs.                              */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_process_ephemerons(TRUE);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_note_enqueued(ready_before);
 
   /* Remove dangling disappearing links. */
-  MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(&MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, TRUE);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl, TRUE);
 
 # ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
     MANAGED_STACK_ADDRESS_BOEHM_GC_clear_togglerefs();
 # endif
 # ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_LONG_REFS_NOT_NEEDED
-    MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(&MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, FALSE);
-    MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(&MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, TRUE);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, FALSE);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_make_disappearing_links_disappear(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl, TRUE);
 # endif
+  UNLOCK_ALL_FNLZ_STRIPES();
+# ifdef LOCK_FREE_WEAK_DEREF
+    /* The links (and ephemerons) are cleared, let the readers go.      */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq & 1) != 0);
+    AO_store_release(&MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq, MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq + 1);
+# endif
+  EVTRACE_END(sp, 0, EVTRACE_FINALIZE, MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count - ready_before,
+              0);
 
   if (MANAGED_STACK_ADDRESS_BOEHM_GC_fail_count) {
     /* Don't prevent running finalizers if there has been an allocation */
@@ -1171,40 +1942,50 @@ STATIC unsigned MANAGED_STACK_ADDRESS_BOEHM_GC_interrupt_finalizers = 0;
   /* when the first finalizer is enqueued.              */
   STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_enqueue_all_finalizers(void)
   {
-    size_t i;
-    size_t fo_size = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head == NULL ? 0 :
-                                (size_t)1 << MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size;
+    unsigned s;
+    word ready_before = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count;
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    LOCK_ALL_FNLZ_STRIPES();
     MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_finalized = 0;
-    for (i = 0; i < fo_size; i++) {
-      struct finalizable_object * curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[i];
+    for (s = 0; s < FNLZ_STRIPES; s++) {
+      struct fo_hashtbl_s *fo_hashtbl = MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl + s;
+      size_t fo_size = FNLZ_STRIPE_SIZE(fo_hashtbl);
+      size_t i;
 
-      MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.fo_head[i] = NULL;
-      while (curr_fo != NULL) {
-          struct finalizable_object * next_fo;
-          ptr_t real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
+      fo_hashtbl -> entries = 0;
+      for (i = 0; i < fo_size; i++) {
+        struct finalizable_object * curr_fo = fo_hashtbl -> head[i];
 
-          MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fo(real_ptr, MANAGED_STACK_ADDRESS_BOEHM_GC_normal_finalize_mark_proc);
-          MANAGED_STACK_ADDRESS_BOEHM_GC_set_mark_bit(real_ptr);
-          MANAGED_STACK_ADDRESS_BOEHM_GC_complete_ongoing_collection();
-          next_fo = fo_next(curr_fo);
+        fo_hashtbl -> head[i] = NULL;
+        while (curr_fo != NULL) {
+            struct finalizable_object * next_fo;
+            ptr_t real_ptr = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
 
-          /* Add to list of objects awaiting finalization.      */
-          fo_set_next(curr_fo, MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now);
-          MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_fo);
-          SET_FINALIZE_NOW(curr_fo);
-
-          /* Unhide object pointer so any future collections will       */
-          /* see it.                                                    */
-          curr_fo -> fo_hidden_base =
-                        (word)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
-          MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_finalized +=
-                curr_fo -> fo_object_size + sizeof(struct finalizable_object);
-          curr_fo = next_fo;
+            MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fo(real_ptr, MANAGED_STACK_ADDRESS_BOEHM_GC_normal_finalize_mark_proc);
+            MANAGED_STACK_ADDRESS_BOEHM_GC_set_mark_bit(real_ptr);
+            MANAGED_STACK_ADDRESS_BOEHM_GC_complete_ongoing_collection();
+            next_fo = fo_next(curr_fo);
+
+            /* Add to list of objects awaiting finalization.      */
+            fo_set_next(curr_fo, MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now);
+            MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(curr_fo);
+            SET_FINALIZE_NOW(curr_fo);
+            MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count++;
+
+            /* Unhide object pointer so any future collections will     */
+            /* see it.                                                  */
+            curr_fo -> fo_hidden_base =
+                          (word)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(curr_fo -> fo_hidden_base);
+            MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_finalized +=
+                  curr_fo -> fo_object_size + sizeof(struct finalizable_object);
+            curr_fo = next_fo;
+        }
       }
     }
     MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries = 0;  /* all entries deleted from the hash table */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_note_enqueued(ready_before);
+    UNLOCK_ALL_FNLZ_STRIPES();
   }
 
   /* Invoke all remaining finalizers that haven't yet been run.
@@ -1269,6 +2050,11 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
 
 /* Invoke finalizers for all objects that are ready to be finalized.    */
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_finalizers(void)
+{
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_some_finalizers(0);
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_some_finalizers(MANAGED_STACK_ADDRESS_BOEHM_GC_stop_func stop_func)
 {
     int count = 0;
     word bytes_freed_before = 0; /* initialized to prevent warning. */
@@ -1287,6 +2073,10 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
             UNLOCK();
             break;
         }
+        if (stop_func != 0 && (*stop_func)()) {
+            UNLOCK();
+            break;
+        }
         curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now;
 #       ifdef THREADS
             if (EXPECT(NULL == curr_fo, FALSE)) {
@@ -1295,6 +2085,8 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
             }
 #       endif
         SET_FINALIZE_NOW(fo_next(curr_fo));
+        MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count--;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_finalizers_run++;
         UNLOCK();
         fo_set_next(curr_fo, 0);
         real_ptr = (ptr_t)(curr_fo -> fo_hidden_base); /* revealed */
@@ -1322,6 +2114,389 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
     return count;
 }
 
+#ifdef FINALIZER_THREADS
+# ifndef MAX_FINALIZER_THREADS
+#   define MAX_FINALIZER_THREADS 16
+# endif
+
+  /* The maximum number of finalizers run by a pool thread at once.     */
+# ifndef FINALIZER_BATCH_SIZE
+#   define FINALIZER_BATCH_SIZE 64
+# endif
+
+  /* The pool parameters; protected by the allocation lock.             */
+  static unsigned fnlz_threads_wanted = 0; /* zero means no pool */
+  static unsigned fnlz_threads_started = 0;
+  static word fnlz_backlog_limit = 0; /* zero means no limit */
+
+  /* The pool state and statistics; protected by the finalizer lock.    */
+  static word fnlz_pool_len = 0; /* the length of pool_queue */
+  static struct finalizable_object *fnlz_pool_tail = NULL;
+                        /* The last object of pool_queue (meaningful    */
+                        /* only if the queue is non-empty); the taken   */
+                        /* objects are appended, so the pool runs the   */
+                        /* finalizers in the FIFO order.                */
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool fnlz_taking = FALSE;
+                        /* Whether a pool thread is moving finalize_now */
+                        /* to pool_queue.                               */
+  static unsigned fnlz_pause_count = 0;
+                        /* No new batches are started while non-zero.   */
+  static word fnlz_pool_run = 0;
+  static word fnlz_batches_run = 0;
+  static word fnlz_total_latency_ns = 0;
+  static word fnlz_max_latency_ns = 0;
+# ifndef NO_CLOCK
+#   ifndef MAX_FNLZ_POOL_CHAINS
+#     define MAX_FNLZ_POOL_CHAINS 32
+#   endif
+    static struct {
+      word len; /* the number of the chain objects left in pool_queue */
+      CLOCK_TYPE enqueue_time;
+    } fnlz_pool_chains[MAX_FNLZ_POOL_CHAINS];
+                        /* The chains (each taken from finalize_now at  */
+                        /* once) of pool_queue in the same order, with  */
+                        /* their enqueue time; a circular buffer.  If   */
+                        /* it is full, a new chain is merged into the   */
+                        /* last one (thus the latency of its objects is */
+                        /* overestimated).                              */
+    static unsigned fnlz_pool_chains_first = 0;
+    static unsigned fnlz_pool_chains_cnt = 0;
+
+    /* Record the chain of n objects appended to pool_queue.    */
+    static void fnlz_pool_chains_add(word n, CLOCK_TYPE enqueue_time)
+    {
+      unsigned i;
+
+      if (fnlz_pool_chains_cnt == MAX_FNLZ_POOL_CHAINS) {
+        i = (fnlz_pool_chains_first + fnlz_pool_chains_cnt - 1)
+            % MAX_FNLZ_POOL_CHAINS;
+        fnlz_pool_chains[i].len += n;
+        return;
+      }
+      i = (fnlz_pool_chains_first + fnlz_pool_chains_cnt)
+          % MAX_FNLZ_POOL_CHAINS;
+      fnlz_pool_chains[i].len = n;
+      fnlz_pool_chains[i].enqueue_time = enqueue_time;
+      fnlz_pool_chains_cnt++;
+    }
+
+    /* Account n objects removed from the head of pool_queue.  Return  */
+    /* the enqueue time of the first (i.e. the oldest) of them.        */
+    static CLOCK_TYPE fnlz_pool_chains_remove(word n)
+    {
+      CLOCK_TYPE enqueue_time;
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(fnlz_pool_chains_cnt > 0);
+      enqueue_time = fnlz_pool_chains[fnlz_pool_chains_first].enqueue_time;
+      while (n > 0) {
+        unsigned i = fnlz_pool_chains_first;
+
+        MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(fnlz_pool_chains_cnt > 0);
+        if (fnlz_pool_chains[i].len > n) {
+          fnlz_pool_chains[i].len -= n;
+          break;
+        }
+        n -= fnlz_pool_chains[i].len;
+        fnlz_pool_chains_first = (i + 1) % MAX_FNLZ_POOL_CHAINS;
+        fnlz_pool_chains_cnt--;
+      }
+      return enqueue_time;
+    }
+# endif
+
+  /* Move all the ready finalizers to the tail of the pool queue.       */
+  STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_take_ready(void)
+  {
+    struct finalizable_object *head_fo, *last_fo;
+    word n = 0;
+#   ifndef NO_CLOCK
+      CLOCK_TYPE enqueue_time;
+#   endif
+
+    LOCK();
+    head_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now;
+    SET_FINALIZE_NOW(NULL);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count = 0;
+#   ifndef NO_CLOCK
+      enqueue_time = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_enqueue_time;
+#   endif
+    UNLOCK();
+
+    /* The taken objects are referenced only from the stack of this     */
+    /* (registered) thread now.                                         */
+    last_fo = head_fo;
+    if (head_fo != NULL) {
+      for (n = 1; fo_next(last_fo) != NULL; n++)
+        last_fo = fo_next(last_fo);
+    }
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+    fnlz_taking = FALSE;
+    if (head_fo != NULL) {
+      if (NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.pool_queue) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.pool_queue = head_fo;
+      } else {
+        fo_set_next(fnlz_pool_tail, head_fo);
+      }
+      fnlz_pool_tail = last_fo;
+      fnlz_pool_len += n;
+#     ifndef NO_CLOCK
+        fnlz_pool_chains_add(n, enqueue_time);
+#     endif
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_finalizer();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_run_finalizer_pool(void)
+  {
+    for (;;) {
+      struct finalizable_object *curr_fo, *next_fo;
+      word n;
+      word bytes_freed_before;
+#     ifndef NO_CLOCK
+        CLOCK_TYPE enqueue_time, done_time;
+#     endif
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+      while (fnlz_pause_count > 0
+             || (NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.pool_queue
+                 && (fnlz_taking || !MANAGED_STACK_ADDRESS_BOEHM_GC_should_invoke_finalizers()))) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_wait_finalizer();
+      }
+      curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.pool_queue;
+      if (NULL == curr_fo) {
+        /* Take the whole collector queue with a single acquisition of  */
+        /* the allocation lock.                                         */
+        fnlz_taking = TRUE;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+        MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_take_ready();
+        continue;
+      }
+
+      /* Cut a batch off the pool queue.        */
+      for (n = 1, next_fo = curr_fo; n < FINALIZER_BATCH_SIZE
+                                     && fo_next(next_fo) != NULL; n++) {
+        next_fo = fo_next(next_fo);
+      }
+      MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.pool_queue = fo_next(next_fo);
+      fo_set_next(next_fo, NULL);
+      fnlz_pool_len -= n;
+#     ifndef NO_CLOCK
+        enqueue_time = fnlz_pool_chains_remove(n);
+#     endif
+      MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+
+      bytes_freed_before = MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_freed;
+      for (; curr_fo != NULL; curr_fo = next_fo) {
+        ptr_t real_ptr = (ptr_t)(curr_fo -> fo_hidden_base); /* revealed */
+
+        next_fo = fo_next(curr_fo);
+        fo_set_next(curr_fo, NULL);
+        (*(curr_fo -> fo_fn))(real_ptr, curr_fo -> fo_client_data);
+        curr_fo -> fo_client_data = 0;
+      }
+
+#     ifndef NO_CLOCK
+        GET_TIME(done_time);
+#     endif
+      MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+      fnlz_pool_run += n;
+      fnlz_batches_run++;
+#     ifndef NO_CLOCK
+        {
+          word latency_ns = (word)MS_TIME_DIFF(done_time, enqueue_time)
+                                * 1000000UL
+                            + NS_FRAC_TIME_DIFF(done_time, enqueue_time);
+
+          fnlz_total_latency_ns += latency_ns * n;
+          if (latency_ns > fnlz_max_latency_ns)
+            fnlz_max_latency_ns = latency_ns;
+        }
+#     endif
+      MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+
+#     ifndef THREAD_SANITIZER
+        /* A quick check whether some memory was freed (same as in      */
+        /* MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_some_finalizers).                                  */
+        if (bytes_freed_before != MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_freed)
+#     endif
+      {
+        LOCK();
+        MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_bytes_freed += MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_freed - bytes_freed_before;
+        UNLOCK();
+      }
+    }
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_threads_reset_child(void)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    fnlz_threads_started = 0;
+    fnlz_taking = FALSE;
+    fnlz_pause_count = 0;
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_pause_finalizer_threads(void)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_DONT_HOLD_LOCK());
+    MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+    fnlz_pause_count++;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_resume_finalizer_threads(void)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(fnlz_pause_count > 0);
+    if (0 == --fnlz_pause_count)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_finalizer();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+  }
+
+  /* Create the missing finalizer threads (if any).  */
+  STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_create_threads(unsigned n)
+  {
+    unsigned created = 0;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_DONT_HOLD_LOCK());
+    while (created < n && MANAGED_STACK_ADDRESS_BOEHM_GC_create_finalizer_thread())
+      created++;
+    if (EXPECT(created < n, FALSE)) {
+      LOCK();
+      /* Do not retry on the next notification.   */
+      fnlz_threads_started -= n - created;
+      fnlz_threads_wanted = fnlz_threads_started;
+      UNLOCK();
+    } else {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Started %u finalizer threads\n", n);
+    }
+  }
+
+  /* The number of the ready finalizers not started yet, including      */
+  /* those taken by the pool.                                           */
+  static word fnlz_backlog_len(void)
+  {
+    word n;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+    n = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count + fnlz_pool_len;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+    return n;
+  }
+
+  STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_backlog_drained(void)
+  {
+    return fnlz_backlog_len() <= fnlz_backlog_limit;
+  }
+
+  /* Run the excess (over the backlog limit) of the finalizers taken by */
+  /* the pool threads but not started yet.  Called by an allocating     */
+  /* thread once the collector queue is drained.  Returns the number of */
+  /* the invoked finalizers.                                            */
+  STATIC int MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_run_pool_backlog(void)
+  {
+    struct finalizable_object *curr_fo, *next_fo;
+    word n = 0;
+
+    LOCK();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+    curr_fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.pool_queue;
+    if (curr_fo != NULL
+        && MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count + fnlz_pool_len > fnlz_backlog_limit) {
+      word excess = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count + fnlz_pool_len
+                    - fnlz_backlog_limit;
+
+      for (n = 1, next_fo = curr_fo; n < excess && fo_next(next_fo) != NULL;
+           n++) {
+        next_fo = fo_next(next_fo);
+      }
+      MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.pool_queue = fo_next(next_fo);
+      fo_set_next(next_fo, NULL);
+      fnlz_pool_len -= n;
+#     ifndef NO_CLOCK
+        (void)fnlz_pool_chains_remove(n);
+#     endif
+    } else {
+      curr_fo = NULL;
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_finalizers_run += n;
+    UNLOCK();
+
+    for (; curr_fo != NULL; curr_fo = next_fo) {
+      ptr_t real_ptr = (ptr_t)(curr_fo -> fo_hidden_base); /* revealed */
+
+      next_fo = fo_next(curr_fo);
+      fo_set_next(curr_fo, NULL);
+      (*(curr_fo -> fo_fn))(real_ptr, curr_fo -> fo_client_data);
+      curr_fo -> fo_client_data = 0;
+    }
+    return (int)n;
+  }
+#endif /* FINALIZER_THREADS */
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_start_finalizer_threads(unsigned n_threads,
+                                              MANAGED_STACK_ADDRESS_BOEHM_GC_word backlog_limit)
+{
+# ifdef FINALIZER_THREADS
+    if (n_threads > MAX_FINALIZER_THREADS)
+      n_threads = MAX_FINALIZER_THREADS;
+    LOCK();
+    if (n_threads > fnlz_threads_wanted)
+      fnlz_threads_wanted = n_threads;
+    fnlz_backlog_limit = (word)backlog_limit;
+    UNLOCK();
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+# else
+    UNUSED_ARG(n_threads);
+    UNUSED_ARG(backlog_limit);
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED;
+# endif
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API size_t MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalizer_stats(
+                                struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_stats_s *pstats,
+                                size_t stats_sz)
+{
+  struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_stats_s stats;
+
+  LOCK();
+  stats.queue_depth = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_ready_count;
+  stats.max_queue_depth = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_max_ready_count;
+  stats.finalizers_run = MANAGED_STACK_ADDRESS_BOEHM_GC_finalizers_run;
+  stats.backlog_finalizers_run = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_backlog_run;
+# ifdef FINALIZER_THREADS
+    stats.finalizer_threads = fnlz_threads_started;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+    stats.queue_depth += fnlz_pool_len;
+    stats.finalizers_run += fnlz_pool_run;
+    stats.batches_run = fnlz_batches_run;
+    stats.total_latency_ns = fnlz_total_latency_ns;
+    stats.max_latency_ns = fnlz_max_latency_ns;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+# else
+    stats.finalizer_threads = 0;
+    stats.batches_run = 0;
+    stats.total_latency_ns = 0;
+    stats.max_latency_ns = 0;
+# endif
+  UNLOCK();
+
+  if (stats_sz >= sizeof(stats)) {
+    BCOPY(&stats, pstats, sizeof(stats));
+    if (stats_sz > sizeof(stats)) {
+      /* Fill in the remaining part with -1.    */
+      memset((char *)pstats + sizeof(stats), 0xff, stats_sz - sizeof(stats));
+    }
+    return sizeof(stats);
+  }
+  if (EXPECT(stats_sz > 0, TRUE))
+    BCOPY(&stats, pstats, stats_sz);
+  return stats_sz;
+}
+
 static word last_finalizer_notification = 0;
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_notify_or_invoke_finalizers(void)
@@ -1373,6 +2548,43 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_notify_
       return;
     }
 
+#   ifdef FINALIZER_THREADS
+      if (fnlz_threads_wanted > 0) {
+        unsigned n_create = 0;
+        unsigned char *pnested = NULL;
+
+        if (fnlz_threads_started < fnlz_threads_wanted
+            && !MANAGED_STACK_ADDRESS_BOEHM_GC_in_thread_creation) {
+          n_create = fnlz_threads_wanted - fnlz_threads_started;
+          fnlz_threads_started = fnlz_threads_wanted;
+        }
+        if (fnlz_backlog_limit != 0
+            && fnlz_backlog_len() > fnlz_backlog_limit)
+          pnested = MANAGED_STACK_ADDRESS_BOEHM_GC_check_finalizer_nested();
+        UNLOCK();
+        if (n_create > 0)
+          MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_create_threads(n_create);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock();
+        MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_finalizer();
+        MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock();
+
+        if (pnested != NULL) {
+          /* The finalization falls behind, so slow down the allocating */
+          /* thread by making it run the excess of finalizers.          */
+          int count = MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_some_finalizers(MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_backlog_drained);
+
+          count += MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_run_pool_backlog();
+          *pnested = 0;
+          if (count > 0) {
+            LOCK();
+            MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_backlog_run += (word)count;
+            UNLOCK();
+          }
+        }
+        return;
+      }
+#   endif
+
     if (!MANAGED_STACK_ADDRESS_BOEHM_GC_finalize_on_demand) {
       unsigned char *pnested;
 
@@ -1417,22 +2629,30 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_notify_
   {
     struct finalizable_object *fo;
     unsigned long ready = 0;
+    word dl_entries, ll_entries;
 
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    LOCK_ALL_FNLZ_STRIPES();
+    dl_entries = MANAGED_STACK_ADDRESS_BOEHM_GC_dl_table_entries(MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl);
+    ll_entries = IF_LONG_REFS_PRESENT_ELSE(
+                                MANAGED_STACK_ADDRESS_BOEHM_GC_dl_table_entries(MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl), 0);
+    UNLOCK_ALL_FNLZ_STRIPES();
     MANAGED_STACK_ADDRESS_BOEHM_GC_log_printf("%lu finalization entries;"
                   " %lu/%lu short/long disappearing links alive\n",
                   (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries,
-                  (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl.entries,
-                  (unsigned long)IF_LONG_REFS_PRESENT_ELSE(
-                                                MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl.entries, 0));
+                  (unsigned long)dl_entries, (unsigned long)ll_entries);
 
     for (fo = MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots.finalize_now; fo != NULL; fo = fo_next(fo))
       ++ready;
     MANAGED_STACK_ADDRESS_BOEHM_GC_log_printf("%lu finalization-ready objects;"
                   " %ld/%ld short/long links cleared\n",
                   ready,
-                  (long)MANAGED_STACK_ADDRESS_BOEHM_GC_old_dl_entries - (long)MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl.entries,
+                  (long)MANAGED_STACK_ADDRESS_BOEHM_GC_old_dl_entries - (long)dl_entries,
                   (long)IF_LONG_REFS_PRESENT_ELSE(
-                              MANAGED_STACK_ADDRESS_BOEHM_GC_old_ll_entries - MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl.entries, 0));
+                                MANAGED_STACK_ADDRESS_BOEHM_GC_old_ll_entries - ll_entries, 0));
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_kind != 0)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_log_printf("%lu ephemeron pairs cleared\n",
+                    (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_ephemerons_cleared);
   }
 #endif /* !SMALL_CONFIG */
 
@@ -84,6 +84,10 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
     MANAGED_STACK_ADDRESS_BOEHM_GC_register_displacement_inner(FINALIZER_CLOSURE_FLAG);
     MANAGED_STACK_ADDRESS_BOEHM_GC_register_displacement_inner(sizeof(oh) + FINALIZER_CLOSURE_FLAG);
 
+    /* The objects of gc_finalized_cleanup class (see                   */
+    /* gc_finalized_cleanup.h) are preceded by one more word.           */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_register_displacement_inner(2 * sizeof(word));
+
     MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_kind = MANAGED_STACK_ADDRESS_BOEHM_GC_new_kind_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_new_free_list_inner(),
                                           MANAGED_STACK_ADDRESS_BOEHM_GC_DS_LENGTH, TRUE, TRUE);
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_kind != 0);
@@ -101,6 +105,20 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
     UNLOCK();
 }
 
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_register_disclaim_block_proc(int kind,
+                                        MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_block_proc proc,
+                                        int mark_unconditionally)
+{
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((unsigned)kind < MAXOBJKINDS);
+    LOCK();
+    if (EXPECT(!MANAGED_STACK_ADDRESS_BOEHM_GC_find_leak, TRUE)) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[kind].ok_disclaim_block_proc = proc;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[kind].ok_mark_unconditionally =
+                                        (MANAGED_STACK_ADDRESS_BOEHM_GC_bool)mark_unconditionally;
+    }
+    UNLOCK();
+}
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_malloc(size_t lb,
                                 const struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_closure *fclos)
 {
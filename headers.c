@@ -278,6 +278,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER struct hblkhdr * MANAGED_STACK_ADDRESS_BOEH
       SET_HDR(h, result);
 #     ifdef USE_MUNMAP
         result -> hb_last_reclaimed = (unsigned short)MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+        SET_FREE_BLK_TIME(result);
 #     endif
     }
     return result;
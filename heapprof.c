@@ -0,0 +1,806 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+#include "private/gc_priv.h"
+
+#ifdef ENABLE_HEAP_PROFILE
+
+/*
+ * The sampling heap profiler.  Each allocating thread (or the process,
+ * if there are no thread-local free lists) has a counter of the bytes
+ * left till the next sample; it is decremented on the allocation fast
+ * path, and, once it goes negative, the call stack of the allocation is
+ * captured and the counter is rearmed with an exponentially distributed
+ * random period.  A sample accounts for all the bytes allocated since
+ * the previous one (i.e. the estimations are unbiased regardless of the
+ * object sizes).  The distinct call stacks are kept in a hash table
+ * (never freed), the sampled objects are kept in another one, which is
+ * swept (of the unmarked objects) by the collector right before the
+ * reclaim phase.  All the tables are allocated by MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc and
+ * protected by the allocation lock.
+ */
+
+#include "gc/gc_heap_profile.h"
+
+#if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_HAVE_BUILTIN_BACKTRACE)
+# ifdef _MSC_VER
+    EXTERN_C_BEGIN
+    int backtrace(void* addresses[], int count);
+    EXTERN_C_END
+# else
+#   include <execinfo.h>
+# endif
+#endif
+
+#ifndef HEAP_PROFILE_MAX_FRAMES
+# define HEAP_PROFILE_MAX_FRAMES 64
+#endif
+
+#define HPROF_SKIP_FRAMES 1 /* the frame of MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_record itself */
+
+#define HPROF_RECHECK_BYTES ((word)1 << 20)
+                /* The amount of allocation after which a thread checks */
+                /* again whether the sampling has been turned on.       */
+
+#ifndef LOG_HPROF_STACK_TABLE_SZ
+# define LOG_HPROF_STACK_TABLE_SZ 10
+#endif
+
+#define LOG_HPROF_LIVE_TABLE_MIN_SZ 10
+
+#define HPROF_HASH(v, log_size) \
+        ((((word)(v) >> 3) ^ ((word)(v) >> (3 + (log_size)))) \
+         & (((word)1 << (log_size)) - 1))
+
+/* A distinct call stack of the sampled allocations.    */
+struct hprof_stack_s {
+  struct hprof_stack_s *hs_next;        /* the hash chain link  */
+  word hs_hash;
+  word hs_alloc_objs;   /* the estimated number of objects allocated    */
+  word hs_alloc_bytes;  /* and of bytes; the same for the live objects  */
+  word hs_inuse_objs;   /* (as of the last collection).                 */
+  word hs_inuse_bytes;
+  word hs_depth;
+  word hs_pcs[1];       /* the return addresses, hs_depth of them       */
+};
+
+/* A sampled object which is not known to be reclaimed yet.     */
+struct hprof_live_s {
+  struct hprof_live_s *hl_next;
+  word hl_hidden_obj;
+  struct hprof_stack_s *hl_stack;
+  word hl_objs;         /* the weights of the sample, to subtract from  */
+  word hl_bytes;        /* the in-use values of the stack when the      */
+                        /* object is reclaimed.                         */
+};
+
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_interval = 0;
+                /* The mean sampling interval; zero means no sampling.  */
+
+STATIC struct hprof_stack_s *
+                MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_stacks[(word)1 << LOG_HPROF_STACK_TABLE_SZ];
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_stacks = 0;
+
+STATIC struct hprof_live_s **MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live = NULL;
+STATIC unsigned MANAGED_STACK_ADDRESS_BOEHM_GC_log_hprof_live_sz = 0;
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER word MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_live = 0;
+STATIC struct hprof_live_s *MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_free_live = NULL;
+                /* The recycled entries of the above table.     */
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER struct hprof_counter_s MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_counter = { 0, 0, 0 };
+
+/* A xorshift generator; the state is seeded by the counter address.    */
+STATIC unsigned32 MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_random(struct hprof_counter_s *pc)
+{
+  unsigned32 x = pc -> hc_rng;
+
+  if (EXPECT(0 == x, FALSE))
+    x = (unsigned32)((word)pc >> 3) ^ (unsigned32)0x9e3779b9UL;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  pc -> hc_rng = x;
+  return x;
+}
+
+/* Draw the next sampling period from the exponential distribution with */
+/* the given mean, i.e. -ln(u)*mean where u is uniform in (0, 1].  The  */
+/* fractional part of the base-2 logarithm is approximated by a         */
+/* quadratic polynomial (the error is below 0.01), not to depend on     */
+/* libm.                                                                */
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_next_period(struct hprof_counter_s *pc, word mean)
+{
+  word q = (word)(MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_random(pc) >> 6) + 1; /* 1 .. 2**26 */
+  unsigned k = 0;
+  double f, period;
+
+  while ((q >> (k + 1)) != 0) k++;
+  f = (double)(q - ((word)1 << k)) / (double)((word)1 << k);
+  period = (26 - (k + f + 0.346607 * f * (1 - f)))
+           * 0.6931471805599453 * (double)mean;
+  if (period < 1.0) return 1;
+  if (period >= (double)(MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX >> 2)) return MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX >> 2;
+  return (word)period;
+}
+
+/* Find or add the entry for the given call stack.  Returns NULL if     */
+/* out of memory.                                                       */
+STATIC struct hprof_stack_s *MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_find_stack(const word *pcs,
+                                                 word depth)
+{
+  word hash = 0;
+  word i;
+  struct hprof_stack_s *hs;
+  struct hprof_stack_s **bucket;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  for (i = 0; i < depth; i++) {
+    hash = (hash << 5) + hash + (pcs[i] >> 2);
+  }
+  bucket = &MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_stacks[HPROF_HASH(hash, LOG_HPROF_STACK_TABLE_SZ)];
+  for (hs = *bucket; hs != NULL; hs = hs -> hs_next) {
+    if (hs -> hs_hash == hash && hs -> hs_depth == depth
+        && (0 == depth || memcmp(hs -> hs_pcs, pcs,
+                                 depth * sizeof(word)) == 0))
+      return hs;
+  }
+  hs = (struct hprof_stack_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc(
+                        sizeof(struct hprof_stack_s)
+                        + (depth > 0 ? depth - 1 : 0) * sizeof(word));
+  if (EXPECT(NULL == hs, FALSE)) return NULL;
+  BZERO(hs, sizeof(struct hprof_stack_s));
+  hs -> hs_hash = hash;
+  hs -> hs_depth = depth;
+  if (depth > 0) BCOPY(pcs, hs -> hs_pcs, depth * sizeof(word));
+  hs -> hs_next = *bucket;
+  *bucket = hs;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_stacks++;
+  return hs;
+}
+
+/* Double the size of the table of the sampled objects (or allocate the */
+/* initial one).  Returns FALSE if out of memory.                       */
+STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_grow_live_table(void)
+{
+  unsigned old_log_sz = MANAGED_STACK_ADDRESS_BOEHM_GC_log_hprof_live_sz;
+  unsigned log_sz = old_log_sz > 0 ? old_log_sz + 1
+                                   : LOG_HPROF_LIVE_TABLE_MIN_SZ;
+  struct hprof_live_s **new_table;
+  word i;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  new_table = (struct hprof_live_s **)MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc(
+                        ((word)1 << log_sz) * sizeof(struct hprof_live_s *));
+  if (EXPECT(NULL == new_table, FALSE)) return FALSE;
+  BZERO(new_table, ((word)1 << log_sz) * sizeof(struct hprof_live_s *));
+  if (old_log_sz > 0) {
+    for (i = 0; i < ((word)1 << old_log_sz); i++) {
+      struct hprof_live_s *hl = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live[i];
+
+      while (hl != NULL) {
+        struct hprof_live_s *next = hl -> hl_next;
+        struct hprof_live_s **bucket = &new_table[HPROF_HASH(
+                        MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(hl -> hl_hidden_obj), log_sz)];
+
+        hl -> hl_next = *bucket;
+        *bucket = hl;
+        hl = next;
+      }
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_recycle_inner(MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live,
+                        ((word)1 << old_log_sz) * sizeof(struct hprof_live_s *));
+  }
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live = new_table;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_log_hprof_live_sz = log_sz;
+  return TRUE;
+}
+
+/* Capture the call stack and account a sample of the given weight.     */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_record(void *op, size_t lb, word weight, word ra)
+{
+  word pcs[HEAP_PROFILE_MAX_FRAMES + HPROF_SKIP_FRAMES];
+  word depth = 0;
+  word objs = weight / (lb > 0 ? (word)lb : 1);
+  struct hprof_stack_s *hs;
+  struct hprof_live_s *hl;
+  struct hprof_live_s **bucket;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+# if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_HAVE_BUILTIN_BACKTRACE)
+    {
+      /* The lock is held here as backtrace might call dl_iterate_phdr  */
+      /* which is also used by MANAGED_STACK_ADDRESS_BOEHM_GC_register_dynamic_libraries.           */
+      int npcs = backtrace((void **)pcs,
+                           HEAP_PROFILE_MAX_FRAMES + HPROF_SKIP_FRAMES);
+
+      (void)ra;
+      if (npcs > HPROF_SKIP_FRAMES) {
+        depth = (word)npcs - HPROF_SKIP_FRAMES;
+        BCOPY(&pcs[HPROF_SKIP_FRAMES], pcs, depth * sizeof(word));
+      }
+    }
+# else
+    if (ra != 0) {
+      pcs[0] = ra;
+      depth = 1;
+    }
+# endif
+  if (0 == objs) objs = 1;
+  hs = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_find_stack(pcs, depth);
+  if (EXPECT(NULL == hs, FALSE)) return;
+  hs -> hs_alloc_objs += objs;
+  hs -> hs_alloc_bytes += weight;
+
+  if ((NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live
+       || MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_live >= ((word)1 << MANAGED_STACK_ADDRESS_BOEHM_GC_log_hprof_live_sz))
+      && !MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_grow_live_table() && NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live)
+    return;
+  hl = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_free_live;
+  if (hl != NULL) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_free_live = hl -> hl_next;
+  } else {
+    hl = (struct hprof_live_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc(sizeof(struct hprof_live_s));
+    if (EXPECT(NULL == hl, FALSE)) return;
+  }
+  hl -> hl_hidden_obj = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(op);
+  hl -> hl_stack = hs;
+  hl -> hl_objs = objs;
+  hl -> hl_bytes = weight;
+  bucket = &MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live[HPROF_HASH(op, MANAGED_STACK_ADDRESS_BOEHM_GC_log_hprof_live_sz)];
+  hl -> hl_next = *bucket;
+  *bucket = hl;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_live++;
+  hs -> hs_inuse_objs += objs;
+  hs -> hs_inuse_bytes += weight;
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sample_inner(struct hprof_counter_s *pc, void *op,
+                                    size_t lb, word ra)
+{
+  word interval = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_interval;
+  word weight = 0;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  if (EXPECT(0 == interval, FALSE)) {
+    /* The sampling is off.     */
+    pc -> hc_period = 0;
+    pc -> hc_bytes_left = (signed_word)HPROF_RECHECK_BYTES;
+    return;
+  }
+  if (pc -> hc_period != 0) {
+    /* The bytes allocated since the previous sample (including lb).    */
+    /* Otherwise the sampling has just been turned on, the counter is   */
+    /* only armed.                                                      */
+    weight = pc -> hc_period - (word)(pc -> hc_bytes_left);
+  }
+  pc -> hc_period = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_next_period(pc, interval);
+  pc -> hc_bytes_left = (signed_word)(pc -> hc_period);
+  if (op != NULL && weight > 0) MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_record(op, lb, weight, ra);
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sample(struct hprof_counter_s *pc, void *op,
+                              size_t lb, word ra)
+{
+  LOCK();
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sample_inner(pc, op, lb, ra);
+  UNLOCK();
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_count_global(void *op, size_t lb, word ra)
+{
+  LOCK();
+  if ((MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_counter.hc_bytes_left -= (signed_word)lb) < 0)
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sample_inner(&MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_counter, op, lb, ra);
+  UNLOCK();
+}
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_drop_live(struct hprof_live_s *hl)
+{
+  struct hprof_stack_s *hs = hl -> hl_stack;
+
+  hs -> hs_inuse_objs -= hl -> hl_objs;
+  hs -> hs_inuse_bytes -= hl -> hl_bytes;
+  hl -> hl_hidden_obj = 0;
+  hl -> hl_next = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_free_live;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_free_live = hl;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_live--;
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_forget(ptr_t p)
+{
+  struct hprof_live_s **link;
+  struct hprof_live_s *hl;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  link = &MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live[HPROF_HASH(p, MANAGED_STACK_ADDRESS_BOEHM_GC_log_hprof_live_sz)];
+  for (hl = *link; hl != NULL; link = &hl -> hl_next, hl = *link) {
+    if (hl -> hl_hidden_obj == MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(p)) {
+      *link = hl -> hl_next;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_drop_live(hl);
+      break;
+    }
+  }
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sweep(void)
+{
+  word i;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  if (NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live) return;
+  for (i = 0; i < ((word)1 << MANAGED_STACK_ADDRESS_BOEHM_GC_log_hprof_live_sz); i++) {
+    struct hprof_live_s **link = &MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_live[i];
+    struct hprof_live_s *hl;
+
+    while ((hl = *link) != NULL) {
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_is_marked(MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(hl -> hl_hidden_obj))) {
+        link = &hl -> hl_next;
+      } else {
+        *link = hl -> hl_next;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_drop_live(hl);
+      }
+    }
+  }
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_heap_profile_interval(MANAGED_STACK_ADDRESS_BOEHM_GC_word bytes)
+{
+# if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_HAVE_BUILTIN_BACKTRACE)
+    if (bytes != 0) {
+      void *pc;
+
+      /* The first call of backtrace might allocate memory (to load the */
+      /* unwinder), thus it should not be done with the lock held.      */
+      (void)backtrace(&pc, 1);
+    }
+# endif
+  LOCK();
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_interval = bytes;
+  UNLOCK();
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_word MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_heap_profile_interval(void)
+{
+  return MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_interval;
+}
+
+/* The profile output.  The message lengths are computed in advance,    */
+/* so the profile is written in one pass through a small buffer.        */
+
+#define PB_VARINT 0     /* the protocol buffer wire types       */
+#define PB_LEN 2
+
+#define HPROF_OUT_BUF_SZ 1024
+
+struct hprof_out_s {
+  MANAGED_STACK_ADDRESS_BOEHM_GC_heap_profile_write_proc proc;
+  void *client_data;
+  int status;
+  size_t pos;
+  unsigned char buf[HPROF_OUT_BUF_SZ];
+};
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_flush(struct hprof_out_s *out)
+{
+  if (out -> pos > 0 && MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS == out -> status)
+    out -> status = out -> proc(out -> client_data, out -> buf, out -> pos);
+  out -> pos = 0;
+}
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_bytes(struct hprof_out_s *out, const void *p,
+                               size_t len)
+{
+  while (len > 0) {
+    size_t n = HPROF_OUT_BUF_SZ - out -> pos;
+
+    if (n > len) n = len;
+    BCOPY(p, out -> buf + out -> pos, n);
+    out -> pos += n;
+    p = (const char *)p + n;
+    len -= n;
+    if (HPROF_OUT_BUF_SZ == out -> pos) MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_flush(out);
+  }
+}
+
+STATIC size_t MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_varint_len(word v)
+{
+  size_t n = 1;
+
+  for (; v >= 0x80; v >>= 7) n++;
+  return n;
+}
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_varint(struct hprof_out_s *out, word v)
+{
+  unsigned char b[(sizeof(word) * 8 + 6) / 7];
+  size_t n = 0;
+
+  for (; v >= 0x80; v >>= 7) b[n++] = (unsigned char)(v | 0x80);
+  b[n++] = (unsigned char)v;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_bytes(out, b, n);
+}
+
+/* The size of a varint field (the field number is less than 16).       */
+#define PB_UINT_SZ(v) (1 + MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_varint_len(v))
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(struct hprof_out_s *out, unsigned field,
+                              word v)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_varint(out, ((word)field << 3) | PB_VARINT);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_varint(out, v);
+}
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(struct hprof_out_s *out, unsigned field,
+                             size_t len)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_varint(out, ((word)field << 3) | PB_LEN);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_varint(out, (word)len);
+}
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_value_type(struct hprof_out_s *out,
+                                    unsigned field, word type, word unit)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(out, field, PB_UINT_SZ(type) + PB_UINT_SZ(unit));
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 1, type);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 2, unit);
+}
+
+/* The fields of the Profile message (of profile.proto of pprof).       */
+#define PROFILE_SAMPLE_TYPE 1
+#define PROFILE_SAMPLE 2
+#define PROFILE_MAPPING 3
+#define PROFILE_LOCATION 4
+#define PROFILE_STRING_TABLE 6
+#define PROFILE_DROP_FRAMES 7
+#define PROFILE_PERIOD_TYPE 11
+#define PROFILE_PERIOD 12
+#define PROFILE_DEFAULT_SAMPLE_TYPE 14
+
+/* The fixed part of the string table.  The allocator frames are        */
+/* dropped by pprof (the rest of the sample stack is kept).             */
+static const char * const hprof_strings[] = {
+  "", "alloc_objects", "count", "alloc_space", "bytes", "inuse_objects",
+  "inuse_space", "space",
+  ".*MANAGED_STACK_ADDRESS_BOEHM_GC_(hprof_.*|malloc.*|generic_malloc.*|debug_malloc.*|gcj_malloc.*)"
+};
+#define HPROF_STR_ALLOC_OBJECTS 1
+#define HPROF_STR_COUNT 2
+#define HPROF_STR_ALLOC_SPACE 3
+#define HPROF_STR_BYTES 4
+#define HPROF_STR_INUSE_OBJECTS 5
+#define HPROF_STR_INUSE_SPACE 6
+#define HPROF_STR_SPACE 7
+#define HPROF_STR_DROP_FRAMES 8
+#define HPROF_N_STRINGS (sizeof(hprof_strings) / sizeof(hprof_strings[0]))
+
+#define HPROF_SNAP_WORDS 5      /* stack, and the 4 values      */
+#define HPROF_MAPPING_WORDS 5 /* start, limit, offset, name and length */
+
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sift_down(word *a, size_t root, size_t n)
+{
+  word v = a[root];
+
+  for (;;) {
+    size_t child = 2 * root + 1;
+
+    if (child >= n) break;
+    if (child + 1 < n && a[child + 1] > a[child]) child++;
+    if (a[child] <= v) break;
+    a[root] = a[child];
+    root = child;
+  }
+  a[root] = v;
+}
+
+/* Sort the addresses.  The libc qsort is not used for the reason given */
+/* in dyn_load.c (it might call malloc).                                */
+STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sort(word *a, size_t n)
+{
+  size_t i;
+
+  if (n < 2) return;
+  for (i = n / 2; i > 0; ) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sift_down(a, --i, n);
+  }
+  for (i = n - 1; i > 0; i--) {
+    word v = a[0];
+
+    a[0] = a[i];
+    a[i] = v;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sift_down(a, 0, i);
+  }
+}
+
+/* Return the index of v in the sorted array a (v should be present).   */
+STATIC size_t MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_search(const word *a, size_t n, word v)
+{
+  size_t lo = 0;
+
+  while (n > 1) {
+    size_t half = n / 2;
+
+    if (a[lo + half] <= v) lo += half;
+    n -= half;
+  }
+  return lo;
+}
+
+#ifdef NEED_PROC_MAPS
+  /* Parse the executable mappings from a copy of /proc/self/maps into  */
+  /* the array (if not NULL).  Returns the number of the mappings.      */
+  STATIC size_t MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_parse_maps(const char *maps, word *mappings)
+  {
+    size_t n = 0;
+    const char *p = maps;
+
+    while (*p != '\0') {
+      const char *eol = strchr(p, '\n');
+      char *q;
+      word start, limit, offset;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_bool exec;
+
+      if (NULL == eol) eol = p + strlen(p);
+      start = (word)strtoul(p, &q, 16);
+      if ('-' == *q) {
+        limit = (word)strtoul(q + 1, &q, 16);
+        while (' ' == *q) q++;
+        exec = q + 2 < eol && 'x' == q[2];
+        while (*q != ' ' && q < eol) q++; /* prot */
+        offset = (word)strtoul(q, &q, 16);
+        while (' ' == *q) q++;
+        while (*q != ' ' && q < eol) q++; /* dev */
+        while (' ' == *q) q++;
+        while (*q != ' ' && q < eol) q++; /* inode */
+        while (' ' == *q) q++;
+        if (exec && start < limit) {
+          if (mappings != NULL) {
+            word *m = &mappings[n * HPROF_MAPPING_WORDS];
+
+            m[0] = start;
+            m[1] = limit;
+            m[2] = offset;
+            m[3] = (word)q;
+            m[4] = q < eol ? (word)(eol - q) : 0;
+          }
+          n++;
+        }
+      }
+      p = '\0' == *eol ? eol : eol + 1;
+    }
+    return n;
+  }
+#endif /* NEED_PROC_MAPS */
+
+/* Return the id (the index plus one) of the mapping containing the     */
+/* given address, zero if none.                                         */
+STATIC word MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_mapping_id(const word *mappings, size_t n_mappings,
+                                word addr)
+{
+  size_t i;
+
+  for (i = 0; i < n_mappings; i++) {
+    const word *m = &mappings[i * HPROF_MAPPING_WORDS];
+
+    if (addr >= m[0] && addr < m[1]) return (word)i + 1;
+  }
+  return 0;
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_write_heap_profile(MANAGED_STACK_ADDRESS_BOEHM_GC_heap_profile_write_proc proc,
+                                         void *client_data)
+{
+  word *snap = NULL;
+  size_t snap_cap = 0, n_stacks;
+  char *maps = NULL;
+  size_t maps_cap = 0;
+  word *locs = NULL;
+  size_t n_locs, n_frames, i, j;
+  word *mappings = NULL;
+  size_t n_mappings = 0;
+  word period = 0;
+  struct hprof_out_s *out;
+
+  /* Take a snapshot of the stack table (and of the process mappings).  */
+  /* The stack entries themselves are never freed or changed (except    */
+  /* for the values), thus the pointers to them remain valid.           */
+  for (;;) {
+    size_t maps_len = 0;
+    struct hprof_stack_s *hs;
+
+    LOCK();
+    n_stacks = (size_t)MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_stacks;
+#   ifdef NEED_PROC_MAPS
+      {
+        const char *s;
+        IF_CANCEL(int cancel_state;)
+
+        DISABLE_CANCEL(cancel_state);
+        s = MANAGED_STACK_ADDRESS_BOEHM_GC_get_maps();
+        RESTORE_CANCEL(cancel_state);
+        maps_len = strlen(s) + 1;
+        if (maps_len <= maps_cap) BCOPY(s, maps, maps_len);
+      }
+#   endif
+    if (snap != NULL && n_stacks <= snap_cap && maps_len <= maps_cap) {
+      j = 0;
+      for (i = 0; i < ((word)1 << LOG_HPROF_STACK_TABLE_SZ); i++) {
+        for (hs = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_stacks[i]; hs != NULL; hs = hs -> hs_next) {
+          snap[j++] = (word)hs;
+          snap[j++] = hs -> hs_alloc_objs;
+          snap[j++] = hs -> hs_alloc_bytes;
+          snap[j++] = hs -> hs_inuse_objs;
+          snap[j++] = hs -> hs_inuse_bytes;
+        }
+      }
+      period = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_interval;
+      UNLOCK();
+      break;
+    }
+    UNLOCK();
+    if (NULL == snap || n_stacks > snap_cap) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_free(snap);
+      snap_cap = n_stacks + n_stacks / 4 + 16;
+      snap = (word *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic(snap_cap * HPROF_SNAP_WORDS
+                                      * sizeof(word));
+      if (NULL == snap) break;
+    }
+    if (maps_len > maps_cap) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_free(maps);
+      maps_cap = maps_len + maps_len / 4;
+      maps = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic(maps_cap);
+      if (NULL == maps) break;
+    }
+  }
+  if (NULL == snap || (maps_cap > 0 && NULL == maps)) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(snap);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(maps);
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY;
+  }
+
+  /* Collect the distinct addresses, they become the locations.  */
+  n_frames = 0;
+  for (i = 0; i < n_stacks; i++) {
+    n_frames += (size_t)((struct hprof_stack_s *)
+                         snap[i * HPROF_SNAP_WORDS]) -> hs_depth;
+  }
+# ifdef NEED_PROC_MAPS
+    if (maps != NULL) n_mappings = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_parse_maps(maps, NULL);
+# endif
+  locs = (word *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic((n_frames + 1) * sizeof(word));
+  mappings = (word *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic((n_mappings + 1)
+                                      * HPROF_MAPPING_WORDS * sizeof(word));
+  out = (struct hprof_out_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic(sizeof(struct hprof_out_s));
+  if (NULL == locs || NULL == mappings || NULL == out) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(snap);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(maps);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(locs);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(mappings);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(out);
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY;
+  }
+# ifdef NEED_PROC_MAPS
+    if (maps != NULL) (void)MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_parse_maps(maps, mappings);
+# endif
+  n_frames = 0;
+  for (i = 0; i < n_stacks; i++) {
+    struct hprof_stack_s *hs = (struct hprof_stack_s *)
+                                        snap[i * HPROF_SNAP_WORDS];
+
+    for (j = 0; j < (size_t)(hs -> hs_depth); j++)
+      locs[n_frames++] = hs -> hs_pcs[j];
+  }
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sort(locs, n_frames);
+  n_locs = 0;
+  for (i = 0; i < n_frames; i++) {
+    if (0 == n_locs || locs[i] != locs[n_locs - 1])
+      locs[n_locs++] = locs[i];
+  }
+
+  out -> proc = proc;
+  out -> client_data = client_data;
+  out -> status = MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+  out -> pos = 0;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_value_type(out, PROFILE_SAMPLE_TYPE,
+                          HPROF_STR_ALLOC_OBJECTS, HPROF_STR_COUNT);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_value_type(out, PROFILE_SAMPLE_TYPE,
+                          HPROF_STR_ALLOC_SPACE, HPROF_STR_BYTES);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_value_type(out, PROFILE_SAMPLE_TYPE,
+                          HPROF_STR_INUSE_OBJECTS, HPROF_STR_COUNT);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_value_type(out, PROFILE_SAMPLE_TYPE,
+                          HPROF_STR_INUSE_SPACE, HPROF_STR_BYTES);
+
+  for (i = 0; i < n_stacks && MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS == out -> status; i++) {
+    const word *s = &snap[i * HPROF_SNAP_WORDS];
+    const struct hprof_stack_s *hs = (const struct hprof_stack_s *)s[0];
+    size_t loc_sz = 0, val_sz = 0;
+
+    for (j = 0; j < (size_t)(hs -> hs_depth); j++) {
+      loc_sz += MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_varint_len(
+                (word)MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_search(locs, n_locs, hs -> hs_pcs[j]) + 1);
+    }
+    for (j = 1; j < HPROF_SNAP_WORDS; j++)
+      val_sz += MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_varint_len(s[j]);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(out, PROFILE_SAMPLE,
+                     (loc_sz > 0 ? 1 + MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_varint_len(loc_sz) + loc_sz
+                                 : 0)
+                     + 1 + MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_varint_len(val_sz) + val_sz);
+    if (loc_sz > 0) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(out, 1 /* location_id */, loc_sz);
+      for (j = 0; j < (size_t)(hs -> hs_depth); j++) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_varint(out,
+                (word)MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_search(locs, n_locs, hs -> hs_pcs[j]) + 1);
+      }
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(out, 2 /* value */, val_sz);
+    for (j = 1; j < HPROF_SNAP_WORDS; j++)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_varint(out, s[j]);
+  }
+
+  for (i = 0; i < n_mappings; i++) {
+    const word *m = &mappings[i * HPROF_MAPPING_WORDS];
+    word name = (word)(HPROF_N_STRINGS + i);
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(out, PROFILE_MAPPING,
+                     PB_UINT_SZ((word)i + 1) + PB_UINT_SZ(m[0])
+                     + PB_UINT_SZ(m[1]) + PB_UINT_SZ(m[2])
+                     + PB_UINT_SZ(name));
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 1 /* id */, (word)i + 1);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 2 /* memory_start */, m[0]);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 3 /* memory_limit */, m[1]);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 4 /* file_offset */, m[2]);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 5 /* filename */, name);
+  }
+
+  for (i = 0; i < n_locs && MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS == out -> status; i++) {
+    /* The return addresses point past the call instructions, thus the  */
+    /* addresses are decremented to symbolize the calls themselves.     */
+    word addr = locs[i] - 1;
+    word mapping_id = MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_mapping_id(mappings, n_mappings, addr);
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(out, PROFILE_LOCATION,
+                     PB_UINT_SZ((word)i + 1)
+                     + (mapping_id != 0 ? PB_UINT_SZ(mapping_id) : 0)
+                     + PB_UINT_SZ(addr));
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 1 /* id */, (word)i + 1);
+    if (mapping_id != 0)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 2 /* mapping_id */, mapping_id);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, 3 /* address */, addr);
+  }
+
+  for (i = 0; i < HPROF_N_STRINGS; i++) {
+    size_t len = strlen(hprof_strings[i]);
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(out, PROFILE_STRING_TABLE, len);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_bytes(out, hprof_strings[i], len);
+  }
+  for (i = 0; i < n_mappings; i++) {
+    const word *m = &mappings[i * HPROF_MAPPING_WORDS];
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_len(out, PROFILE_STRING_TABLE, (size_t)m[4]);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_bytes(out, (const char *)m[3], (size_t)m[4]);
+  }
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, PROFILE_DROP_FRAMES, HPROF_STR_DROP_FRAMES);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_value_type(out, PROFILE_PERIOD_TYPE,
+                          HPROF_STR_SPACE, HPROF_STR_BYTES);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, PROFILE_PERIOD, period);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_put_uint(out, PROFILE_DEFAULT_SAMPLE_TYPE, HPROF_STR_INUSE_SPACE);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_flush(out);
+
+  i = (size_t)(out -> status);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_free(snap);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_free(maps);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_free(locs);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_free(mappings);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_free(out);
+  return (int)i;
+}
+
+#endif /* ENABLE_HEAP_PROFILE */
@@ -137,7 +137,8 @@ typedef enum {
     MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_PRE_START_WORLD /* STARTWORLD_BEGIN */,
     MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_POST_START_WORLD /* STARTWORLD_END */,
     MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_THREAD_SUSPENDED,
-    MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_THREAD_UNSUSPENDED
+    MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_THREAD_UNSUSPENDED,
+    MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_PACER_UPDATE /* see MANAGED_STACK_ADDRESS_BOEHM_GC_get_pacer_stats */
 } MANAGED_STACK_ADDRESS_BOEHM_GC_EventType;
 
 typedef void (MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK * MANAGED_STACK_ADDRESS_BOEHM_GC_on_collection_event_proc)(MANAGED_STACK_ADDRESS_BOEHM_GC_EventType);
@@ -231,6 +232,63 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_DEPRECATE
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_finalizer_notifier(MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_notifier_proc);
 MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_notifier_proc MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalizer_notifier(void);
 
+/* Run the finalizers in a pool of n_threads collector-created threads  */
+/* (which are registered ones) instead of the client threads.  A        */
+/* finalizer thread takes the whole queue of the ready finalizers at    */
+/* once and splits it into batches run by all the pool threads          */
+/* concurrently, thus the finalizers should not depend on the order of  */
+/* their invocation (except for that imposed by the ordered             */
+/* finalization).  When the pool is running, the finalizers are not     */
+/* invoked implicitly by the allocating threads (regardless of          */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_finalize_on_demand and MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_notifier) unless more than    */
+/* backlog_limit ready finalizers (zero means no limit) are queued;     */
+/* then an allocating thread runs the excess ones itself, thus slowing  */
+/* down the allocation until the finalization catches up.  The threads  */
+/* are created on demand, i.e. once there are finalizers to run (also   */
+/* in a forked child).  fork() does not wait for the finalizers being   */
+/* run by the pool threads (these are never invoked in the child), so   */
+/* such a finalizer is like any other client thread which might hold a  */
+/* lock at fork().  The number of the threads could be increased by a   */
+/* subsequent call but not decreased; backlog_limit is updated.         */
+/* Returns MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS, or MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED if the pool is not supported */
+/* by the collector.  Could be also requested by setting                */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_FINALIZER_THREADS (and, optionally, MANAGED_STACK_ADDRESS_BOEHM_GC_FINALIZER_BACKLOG)         */
+/* environment variable.                                                */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_start_finalizer_threads(unsigned /* n_threads */,
+                                        MANAGED_STACK_ADDRESS_BOEHM_GC_word /* backlog_limit */);
+
+/* Structure used to query the finalization statistics.  Same           */
+/* compatibility rules as for MANAGED_STACK_ADDRESS_BOEHM_GC_prof_stats_s are applied.              */
+struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_stats_s {
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word queue_depth;
+            /* Number of the ready finalizers not started yet.          */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word max_queue_depth;
+            /* The maximum number of the ready finalizers left in the   */
+            /* collector queue by a collection.                         */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word finalizers_run;
+            /* Total number of the invoked finalizers (by any thread).  */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word backlog_finalizers_run;
+            /* Number of the finalizers invoked by the allocating       */
+            /* threads because of the backlog limit.                    */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word batches_run;
+            /* Number of batches of finalizers run by the pool threads. */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word total_latency_ns;
+            /* Sum (over the finalizers run by the pool) of the time    */
+            /* from the collection which has enqueued the finalizer     */
+            /* till its batch completion; an upper bound (as measured   */
+            /* from the oldest enqueued one).  Zero if no clock.        */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word max_latency_ns;
+            /* The maximum of the above per-finalizer latency.          */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word finalizer_threads;
+            /* Number of the running finalizer threads.                 */
+};
+
+/* Get the finalization statistics.  Same as MANAGED_STACK_ADDRESS_BOEHM_GC_get_prof_stats (i.e.,   */
+/* the fields not known to the library are filled with -1) but for      */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_stats_s.  Acquires the GC lock.                         */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API size_t MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalizer_stats(struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_stats_s *,
+                                             size_t /* stats_sz */);
+
 /* The functions called to report pointer checking errors.  Called      */
 /* without the GC lock held.  The default behavior is to fail with      */
 /* the appropriate message which includes the pointers.  The functions  */
@@ -510,6 +568,62 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_max_prior_attempts(int);
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_max_prior_attempts(void);
 
+/* Turn on the pacer which replaces the MANAGED_STACK_ADDRESS_BOEHM_GC_free_space_divisor based     */
+/* heuristic: at the end of every collection the marking rate and the   */
+/* allocation rate are measured, and the amount of allocation between   */
+/* collections (thus the heap growth) is chosen so that the collector   */
+/* takes about gc_percent of the process time, while the incremental    */
+/* work size (MANAGED_STACK_ADDRESS_BOEHM_GC_rate) and the time limit are chosen so that a single   */
+/* pause does not exceed max_pause_us microseconds (the latter has      */
+/* effect only in the incremental mode).  Zero gc_percent means the     */
+/* default (25); the values above 99 are replaced with 99 (and a        */
+/* warning is printed).  Zero max_pause_us turns the pacer off          */
+/* restoring the time limit and the rate (MANAGED_STACK_ADDRESS_BOEHM_GC_set_rate) values which     */
+/* were in effect when it was turned on.  Every decision is reported    */
+/* by MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_PACER_UPDATE to the collection event notifier.           */
+/* The function does not use any synchronization.  Defined only if the  */
+/* library has been compiled without NO_CLOCK.                          */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target(unsigned long /* max_pause_us */,
+                                        unsigned /* gc_percent */);
+
+/* The latest decision of the pacer, and the measurements it is based   */
+/* on.  All the rates are exponentially smoothed over the collections.  */
+struct MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats_s {
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word gc_no;
+            /* Garbage collection cycle number the decision is made at. */
+  unsigned long max_pause_us;
+  unsigned gc_percent;
+            /* The targets as passed to MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target (with the   */
+            /* default applied), zero if the pacer is off.              */
+  unsigned long pause_ns;
+            /* The longest marking pause of the cycle, in nanoseconds.  */
+  unsigned long gc_ns;
+            /* Total time of marking, finalization and sweep start      */
+            /* of the cycle, in nanoseconds (saturated on overflow).    */
+  unsigned measured_percent;
+            /* Share of the collector in the time elapsed since the     */
+            /* previous collection, in percent.                         */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word mark_rate;
+            /* Number of marked bytes per millisecond of marking.       */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word alloc_rate;
+            /* Number of allocated bytes per millisecond of mutator.    */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word trigger_bytes;
+            /* Number of bytes to allocate before the next collection.  */
+            /* Zero while the rates are unknown.                        */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word heap_goal;
+            /* Heap size the collector grows toward (zero if unknown).  */
+  int rate;
+            /* The chosen MANAGED_STACK_ADDRESS_BOEHM_GC_rate value (unchanged in non-incremental   */
+            /* mode).                                                   */
+};
+
+/* Copy the latest pacer statistics to the given structure.  Does not   */
+/* use any synchronization, so it could be called from the collection   */
+/* event notifier (on MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_PACER_UPDATE).  Defined only if the      */
+/* library has been compiled without NO_CLOCK.                          */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_pacer_stats(struct MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats_s *)
+                                                        MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
+
 /* Control whether to disable algorithm deciding if a collection should */
 /* be started when we allocated enough to amortize GC.  Both the setter */
 /* and the getter acquire the GC lock (to avoid data races).            */
@@ -901,9 +1015,11 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
 /* compiled with MANUAL_VDB defined.  The manual VDB mode should be     */
 /* used only if the client has the appropriate MANAGED_STACK_ADDRESS_BOEHM_GC_END_STUBBORN_CHANGE   */
 /* and MANAGED_STACK_ADDRESS_BOEHM_GC_reachable_here (or, alternatively, MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_DIRTY)    */
-/* calls (to ensure proper write barriers).  Both the setter and getter */
-/* are not synchronized, and are defined only if the library has been   */
-/* compiled without SMALL_CONFIG.                                       */
+/* calls (to ensure proper write barriers).  The dirty state is kept in */
+/* a card table, which could be updated inline (by                      */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_MARK_CARD).  Both the setter and getter are not     */
+/* synchronized, and are defined only if the library has been compiled  */
+/* without SMALL_CONFIG.                                                */
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_manual_vdb_allowed(int);
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_manual_vdb_allowed(void);
 
@@ -955,6 +1071,33 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
 /* but not stopping the world (and without the reclaim phase).  */
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little(void);
 
+/* The kinds of collector work reported by MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle as left.     */
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_MARK       1 /* a collection is in progress or due */
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_SWEEP      2 /* some blocks are not swept yet      */
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_UNMAP      4 /* free blocks are not unmapped yet   */
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_FINALIZE   8 /* some finalizers are ready to run   */
+
+/* Perform the collector work (in this order: incremental marking,      */
+/* sweeping, unmapping of the free blocks, starting the next collection */
+/* ahead of time and marking for it, running the ready finalizers)      */
+/* until none is left or budget_ns nanoseconds pass (measured by a      */
+/* monotonic clock, where available).  Intended to be called by an      */
+/* event loop when it knows how long it is going to be idle, so that    */
+/* the work is moved out of the allocation calls.  The budget is not    */
+/* exceeded by much except for the final world-stopped marking (after   */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_get_max_prior_attempts abandoned attempts) and the finishing of a */
+/* collection.  In the incremental mode, the next collection is started */
+/* once half of the usual amount is allocated since the previous one.   */
+/* Otherwise, a full collection is started only once it is due, and is  */
+/* abandoned (as by MANAGED_STACK_ADDRESS_BOEHM_GC_try_to_collect) if not completed in time.  Once  */
+/* called, the unmapping of the free blocks is deferred (from the end   */
+/* of each collection) to the next call (or the next collection).  The  */
+/* finalizers are run only if MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalize_on_demand() returns 0,    */
+/* otherwise they are just reported.  Returns a mask of MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_   */
+/* values indicating the kinds of work left (0 if none).  Should not be */
+/* called from a finalizer.  Acquires the GC lock.                      */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API unsigned MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle(unsigned long /* budget_ns */);
+
 /* Allocate an object of size lb bytes.  The client guarantees that as  */
 /* long as the object is live, it will be referenced by a pointer that  */
 /* points to somewhere within the first GC heap block (hblk) of the     */
@@ -1314,7 +1457,8 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
         /* of weak pointers.  Note, however, this generally     */
         /* requires that the allocation lock is held (see       */
         /* MANAGED_STACK_ADDRESS_BOEHM_GC_call_with_alloc_lock() below) when the disguised  */
-        /* pointer is accessed.  Otherwise a strong pointer     */
+        /* pointer is accessed (or MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link   */
+        /* is used instead).  Otherwise a strong pointer        */
         /* could be recreated between the time the collector    */
         /* decides to reclaim the object and the link is        */
         /* cleared.  Returns MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS if registration         */
@@ -1365,6 +1509,19 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
         /* Similar to MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link but for a */
         /* registration by either of the above two routines.    */
 
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link(void ** /* link */)
+                                                MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
+        /* Return the object referenced by a disappearing link  */
+        /* (short or long) holding a disguised pointer (i.e.    */
+        /* MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj)), or NULL if the link has been  */
+        /* cleared.  Unlike the reading of the link with the    */
+        /* allocation lock held, this does not acquire the lock */
+        /* normally: the result is checked to be read outside   */
+        /* of the collection phase in which the links to the    */
+        /* unreachable objects are cleared, the lock is taken   */
+        /* only if the read overlaps such a phase.  Thus the    */
+        /* returned pointer is always safe to use.              */
+
 /* Support of toggle-ref style of external memory management    */
 /* without hooking up to the host retain/release machinery.     */
 /* The idea of toggle-ref is that an external reference to      */
@@ -1391,6 +1548,25 @@ typedef MANAGED_STACK_ADDRESS_BOEHM_GC_ToggleRefStatus (MANAGED_STACK_ADDRESS_BO
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_toggleref_func(MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_func);
 MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_func MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_toggleref_func(void);
 
+/* The batched variant of the toggle-ref callback.  Invoked (in the     */
+/* same context as MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_func) with an array of n objects which  */
+/* are registered for toggle-ref processing, it should store the new    */
+/* state of objs[i] to statuses[i] for every i less than n.  The arrays */
+/* are valid only during the call.  The objects are passed in the order */
+/* of their registration, a collection might involve several calls.     */
+typedef void (MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK * MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_func)(void ** /* objs */,
+                                MANAGED_STACK_ADDRESS_BOEHM_GC_ToggleRefStatus * /* statuses */,
+                                size_t /* n */);
+
+/* Set (register) a batched toggle-ref callback.  If it is non-zero,    */
+/* then it is used instead of the one set by MANAGED_STACK_ADDRESS_BOEHM_GC_set_toggleref_func.     */
+/* This is preferred when there are many objects registered for         */
+/* toggle-ref processing as the cost of a call (e.g. to enter a script  */
+/* runtime) is paid once per batch.  Both the setter and the getter     */
+/* acquire the allocation lock.                                         */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_toggleref_batch_func(MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_func);
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_batch_func MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_toggleref_batch_func(void);
+
 /* Register a given object for toggle-ref processing.  It will  */
 /* be stored internally and the toggle-ref callback will be     */
 /* invoked on the object until the callback returns             */
@@ -1399,13 +1575,64 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_func
 /* a weak one otherwise.  Obj should be the starting address    */
 /* of an object allocated by MANAGED_STACK_ADDRESS_BOEHM_GC_malloc (MANAGED_STACK_ADDRESS_BOEHM_GC_debug_malloc) or     */
 /* friends.  Returns MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS if registration succeeded (or   */
-/* no callback is registered yet), MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY if it failed    */
-/* for a lack of memory reason.                                 */
+/* no callback, neither batched nor plain one, is registered    */
+/* yet), MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY if it failed for a lack of memory reason. */
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_add(void * /* obj */, int /* is_strong */)
                                                 MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_debug_toggleref_add(void * /* obj */,
                                 int /* is_strong */) MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
 
+/* Ephemeron tables support.  An ephemeron table is a collectible       */
+/* object holding a fixed number of (key, value) pairs.  The value of   */
+/* a pair is kept alive only as long as its key is reachable by other   */
+/* means than through the values of ephemerons, thus a value may refer  */
+/* to its key (or to keys of other pairs) without preventing the        */
+/* collection of the key.  Once a key becomes unreachable, the pair is  */
+/* cleared (both the key and the value are set to NULL) by the          */
+/* collector.  Keys and values should be NULL or pointers to objects    */
+/* allocated by MANAGED_STACK_ADDRESS_BOEHM_GC_malloc (MANAGED_STACK_ADDRESS_BOEHM_GC_debug_malloc) or friends; a non-heap key  */
+/* is considered always reachable.  Unlike disappearing links, a table  */
+/* is processed in bulk, and no registration is needed.  The collector  */
+/* walks the live tables only; a table should not be deallocated        */
+/* explicitly (by MANAGED_STACK_ADDRESS_BOEHM_GC_free).                                             */
+
+/* Allocate an ephemeron table of n empty pairs.  Returns NULL (or the  */
+/* result of the out-of-memory handler) on failure.                     */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL
+        MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_ephemeron_table(size_t /* n */);
+
+/* Return the number of pairs of a given ephemeron table.  Does not     */
+/* acquire the allocation lock.                                         */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API size_t MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_size(const void * /* tbl */)
+                                                MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
+
+/* Store a given pair at index i (less than the table size) of          */
+/* an ephemeron table.  A NULL key empties the pair.  Acquires the      */
+/* allocation lock (since the collector clears the pairs with the world */
+/* running).                                                            */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_set(void * /* tbl */, size_t /* i */,
+                                const void * /* key */,
+                                const void * /* value */) MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
+
+/* Return the key of the pair at index i of an ephemeron table, NULL    */
+/* if the pair is empty (or cleared by the collector).  The value is    */
+/* stored to *pvalue unless pvalue is NULL.  The result is never        */
+/* a pointer to an object being reclaimed.  Does not acquire the        */
+/* allocation lock (unless the collector is clearing the pairs, or      */
+/* the atomic operations are unavailable), like                         */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link; thus, the key and value might be         */
+/* inconsistent if the pair is being stored concurrently.               */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_get(const void * /* tbl */,
+                                size_t /* i */,
+                                void ** /* pvalue */) MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
+
+/* Return the number of pairs cleared by the collector in a given       */
+/* ephemeron table since its allocation.  A client could use it to      */
+/* decide when to compact the table.  Does not acquire the allocation   */
+/* lock if the atomic operations are available.                         */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_word MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_cleared(const void * /* tbl */)
+                                                MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
+
 /* Finalizer callback support.  Invoked by the collector (with  */
 /* the allocation lock held) for each unreachable object        */
 /* enqueued for finalization.                                   */
@@ -1873,6 +2100,48 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_debug_ptr_store_and_dirty(void * /* p */,
                                                  const void * /* q */);
 
+/* The card table used by the manual VDB mode.  It is allocated when    */
+/* the incremental mode is turned on in the manual VDB mode, cards is   */
+/* null till then (and always if the collector does not support the     */
+/* incremental mode).  There is one byte per card, a card is an         */
+/* HBLKSIZE-sized heap block; the cards are hashed by address (thus a   */
+/* card might correspond to several heap blocks).  A non-zero card      */
+/* means some object of the block is modified since the previous        */
+/* retrieval of the dirty bits.  Exposed only for the inline write      */
+/* barrier below; the client should not modify it in other ways.        */
+struct MANAGED_STACK_ADDRESS_BOEHM_GC_card_table_s {
+  volatile unsigned char *cards;
+  unsigned log_card_size;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word card_mask;
+};
+MANAGED_STACK_ADDRESS_BOEHM_GC_API struct MANAGED_STACK_ADDRESS_BOEHM_GC_card_table_s MANAGED_STACK_ADDRESS_BOEHM_GC_card_table;
+
+/* Mark the card containing p as dirty.  The inline equivalent of       */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_end_stubborn_change(p), it should be followed by                  */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_reachable_here calls in the same way.  No-op unless the card      */
+/* table is allocated.                                                  */
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_CARD_MARK(p) \
+        (void)(MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.cards != 0 \
+               ? (MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.cards[((MANAGED_STACK_ADDRESS_BOEHM_GC_word)(p) \
+                                >> MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.log_card_size) \
+                               & MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.card_mask] = 1) : 0)
+
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_MARK_CARD(p,q) is the inline equivalent of          */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_DIRTY(p,q), for the clients controlling all their   */
+/* pointer stores (e.g. language runtimes), no function is called       */
+/* unless MANAGED_STACK_ADDRESS_BOEHM_GC_DEBUG is defined.  Same assumptions apply.                 */
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_DEBUG
+# define MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_MARK_CARD(p, q) \
+        MANAGED_STACK_ADDRESS_BOEHM_GC_debug_ptr_store_and_dirty(p, q)
+#else
+# define MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_MARK_CARD(p, q) \
+        do { \
+          MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE(p, q); \
+          MANAGED_STACK_ADDRESS_BOEHM_GC_CARD_MARK(p); \
+          MANAGED_STACK_ADDRESS_BOEHM_GC_reachable_here(q); \
+        } while (0)
+#endif
+
 #ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS
   /* For pthread support, we generally need to intercept a number of    */
   /* thread library calls.  We do that here by macro defining them.     */
@@ -2060,6 +2329,50 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_force_unmap_on_gcollect(int);
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_force_unmap_on_gcollect(void);
 
+/* Start (or reconfigure) a background thread returning to the OS the   */
+/* heap blocks which have been free for at least age_ms milliseconds    */
+/* (of wall-clock time), even if no collection happens.  At most        */
+/* max_bytes_per_sec are returned per second (0 means no limit).  Zero  */
+/* age_ms pauses the thread.  Where supported (Linux 4.5+), the pages   */
+/* are returned with madvise(MADV_FREE), i.e. the kernel takes them     */
+/* only under memory pressure and a reuse of the pages still present    */
+/* costs no page fault (unless MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MADV_FREE environment variable     */
+/* is set).  The thread is not inherited by a forked child (call again  */
+/* to restart it).  MANAGED_STACK_ADDRESS_BOEHM_GC_init starts the thread if                        */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_SCAVENGE_AGE_MS (and, optionally, MANAGED_STACK_ADDRESS_BOEHM_GC_SCAVENGE_RATE) environment   */
+/* variable is set.  Returns MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS, or MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED if         */
+/* unmapping or threads are not supported (or the thread cannot be      */
+/* created).  Acquires the GC lock.                                     */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger(unsigned long /* age_ms */,
+                                        size_t /* max_bytes_per_sec */);
+
+/* Start (or reconfigure) a background thread adapting the heap growth  */
+/* to the memory limit of the enclosing cgroup (v2 memory.max and       */
+/* memory.high) and to the memory pressure reported by the kernel       */
+/* (PSI).  The heap is not expanded beyond the limit less               */
+/* headroom_percent of it (less the memory used by the process besides  */
+/* the collector heap) without collecting first.  Under pressure (the   */
+/* limit is reached, or the tasks are stalled on memory for at least    */
+/* psi_stall_us microseconds per 2-second window), the collections are  */
+/* triggered earlier, the heap is not expanded unless needed, and the   */
+/* free blocks are unmapped immediately (if unmapping is enabled).      */
+/* Zero psi_stall_us disables the pressure monitoring; headroom_percent */
+/* is capped at 90.  The cgroup directory could be given by             */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_CGROUP_DIR environment variable.  The thread is not inherited by  */
+/* a forked child (call again to restart it).  MANAGED_STACK_ADDRESS_BOEHM_GC_init starts the       */
+/* thread if MANAGED_STACK_ADDRESS_BOEHM_GC_MEMORY_CONTROLLER environment variable is set (see      */
+/* README.environment).  Returns MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS, MANAGED_STACK_ADDRESS_BOEHM_GC_NOT_FOUND if neither    */
+/* the cgroup memory controller nor PSI is available, or                */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED if not supported on the target (or the thread       */
+/* cannot be created).  Acquires the GC lock.                           */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_start_memory_controller(
+                                unsigned /* headroom_percent */,
+                                unsigned long /* psi_stall_us */);
+
+/* Return 1 if the memory controller considers the process to be under  */
+/* memory pressure (see above), 0 otherwise.  Unsynchronized.           */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_memory_pressure(void);
+
 /* Fully portable code should call MANAGED_STACK_ADDRESS_BOEHM_GC_INIT() from the main program      */
 /* before making any other MANAGED_STACK_ADDRESS_BOEHM_GC_ calls.  On most platforms this is a      */
 /* no-op and the collector self-initializes.  But a number of           */
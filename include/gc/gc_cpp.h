@@ -69,6 +69,13 @@ an additional placement argument:
 
     A* a = ::new (GC, MyCleanup) A;
 
+An object derived from "gc_finalized_cleanup" has its destructors
+invoked too, but its clean-up is bound to the object at allocation
+rather than registered by the constructor, thus the construction costs
+roughly the same as that of an object derived from "gc".  This requires
+the collector built with the disclaim support; the class is declared in
+gc_finalized_cleanup.h.
+
 An object is considered "accessible" by the collector if it can be
 reached by a path of pointers from static variables, automatic
 variables of active functions, or from some object with clean-up
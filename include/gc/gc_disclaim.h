@@ -45,6 +45,32 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
                                               MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_proc /* proc */,
                                               int /* mark_from_all */);
 
+/* Type of a per-block disclaim call-back.  Called for a heap block     */
+/* holding n_objs objects of obj_sz bytes each, the first one starting  */
+/* at the block address (n_objs is 1 for a large object).  The bit i    */
+/* of bitmap (i.e. bit i % w of bitmap[i / w], where w is the number of */
+/* bits in MANAGED_STACK_ADDRESS_BOEHM_GC_word) is set if the object i is ready to be reclaimed;    */
+/* the call-back should clear the bits of the objects which are not to  */
+/* be reclaimed on this GC cycle.  As with MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_proc, the        */
+/* objects from the free list might be passed too.  The call-back might */
+/* be invoked concurrently (for different blocks) by the marker threads */
+/* while the allocation lock is held by the collecting thread, thus it  */
+/* should not call any collector function.                              */
+typedef void (MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK * MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_block_proc)(void * /* hblk */,
+                                        size_t /* obj_sz */,
+                                        size_t /* n_objs */,
+                                        MANAGED_STACK_ADDRESS_BOEHM_GC_word * /* bitmap */);
+
+/* Same as MANAGED_STACK_ADDRESS_BOEHM_GC_register_disclaim_proc but registers a per-block          */
+/* call-back which is used instead of the per-object one (if any).      */
+/* The blocks of a kind with mark_from_all set are swept as soon as the */
+/* marking is complete; this is done in parallel by the marker threads  */
+/* (if any).  Acquires the allocation lock.  No-op in the leak-finding  */
+/* mode.                                                                */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_register_disclaim_block_proc(int /* kind */,
+                                        MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_block_proc /* proc */,
+                                        int /* mark_from_all */);
+
 /* The finalizer closure used by MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_malloc.                   */
 struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_closure {
     MANAGED_STACK_ADDRESS_BOEHM_GC_finalization_proc proc;
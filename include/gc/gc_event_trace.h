@@ -0,0 +1,72 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/*
+ * This is the interface of the collector event tracing.  If turned on,
+ * the collector records the timestamped spans of its phases: the whole
+ * collection, the world-stopped pause (and the stopping and restarting
+ * of the world in it), the marking, the root pushing, the work of every
+ * parallel mark helper (with the number of the mark stack steals), the
+ * finalization, the sweeping (including the lazy sweeping of a single
+ * size class on allocation), the unmapping and the heap growth.  The
+ * spans are kept in fixed-size ring buffers (thus only the most recent
+ * ones are kept), one per the collector thread (the thread holding the
+ * allocation lock, and every parallel mark helper).  On request, the
+ * trace is written in the Chrome trace event JSON format, which could be
+ * loaded by chrome://tracing or by the Perfetto UI.
+ */
+
+#ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_TRACE_H
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_TRACE_H
+
+#include "gc.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* This API is defined only if the library has been suitably compiled   */
+/* (i.e. with ENABLE_EVENT_TRACE defined).                              */
+
+/* Turn the event tracing on (if the argument is non-zero) or off.  It  */
+/* is off by default unless MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_TRACE or MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_TRACE_FILE       */
+/* environment variable is set.  The ring buffers are allocated when    */
+/* the tracing is turned on the first time; the spans recorded so far   */
+/* are kept if it is turned off.  Acquires the allocation lock.         */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_event_tracing(int);
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_event_tracing(void);
+
+/* Discard the spans recorded so far.  Acquires the allocation lock.    */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_clear_event_trace(void);
+
+/* Type of a trace output call-back.  Writes len bytes of buf and       */
+/* returns zero on success.  Called without the allocation lock held.   */
+typedef int (MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK * MANAGED_STACK_ADDRESS_BOEHM_GC_event_trace_write_proc)(
+                                        void * /* client_data */,
+                                        const void * /* buf */,
+                                        size_t /* len */);
+
+/* Write the recorded spans (as the complete events in the Chrome trace */
+/* event format) by the given call-back.  The timestamps are relative   */
+/* to the moment the tracing was turned on the first time.  Returns     */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS, MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY if fails to allocate a temporary buffer, or */
+/* the non-zero value returned by proc (the output stops at the first   */
+/* failure).  Acquires the allocation lock (but does not hold it while  */
+/* calling proc).                                                       */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_write_event_trace(MANAGED_STACK_ADDRESS_BOEHM_GC_event_trace_write_proc /* proc */,
+                                        void * /* client_data */)
+                                                        MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
+
+#ifdef __cplusplus
+  } /* extern "C" */
+#endif
+
+#endif /* MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_TRACE_H */
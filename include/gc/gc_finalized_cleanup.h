@@ -0,0 +1,187 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/*
+ * This is an addition to the C++ interface of gc_cpp.h providing the
+ * gc_finalized_cleanup class.  An object derived from it has its
+ * destructors invoked when the collector discovers the object to be
+ * inaccessible (as for gc_cleanup), but the clean-up is bound to the
+ * object at allocation rather than registered by the constructor, thus
+ * the construction costs roughly the same as that of an object derived
+ * from "gc".  This requires the collector built with the disclaim
+ * support (see gc_disclaim.h).
+ */
+
+#ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_FINALIZED_CLEANUP_H
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_FINALIZED_CLEANUP_H
+
+#include "gc_cpp.h"
+#include "gc_disclaim.h"
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_NAMESPACE
+namespace boehmgc
+{
+#endif
+
+/**
+ * Same as gc_cleanup but the objects are allocated (unless a placement
+ * other than UseGC is specified) by MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_malloc with a closure
+ * invoking the destructors, thus no finalizer is registered per object.
+ * One extra word preceding the object holds the hidden address of the
+ * first constructed gc_finalized_cleanup subobject; it is cleared when
+ * the object is deleted explicitly.  MANAGED_STACK_ADDRESS_BOEHM_GC_init_finalized_malloc is called
+ * on the first allocation.  Arrays are not cleaned up.
+ *
+ * The destructors are invoked while the collector sweeps the heap, with
+ * the allocation lock held.  Thus they must not call back into the
+ * collector: no allocation, no explicit deletion of another collectible
+ * object, no finalizer registration, etc.  The objects referenced by an
+ * object being destructed are not reclaimed before its destructors run.
+ */
+class gc_finalized_cleanup: virtual public gc
+{
+public:
+  inline gc_finalized_cleanup();
+  inline virtual ~gc_finalized_cleanup();
+
+  inline void* operator new(MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_T);
+  inline void* operator new(MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_T, GCPlacement);
+  inline void* operator new(MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_T, void*) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT;
+  inline void operator delete(void*) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT;
+# ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_OPERATOR_SIZED_DELETE
+    inline void operator delete(void*, MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_T) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT;
+# endif
+
+# ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PLACEMENT_DELETE
+    inline void operator delete(void*, GCPlacement) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT;
+    inline void operator delete(void*, void*) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT;
+# endif
+
+private:
+  inline static void MANAGED_STACK_ADDRESS_BOEHM_GC_cdecl cleanup(void* obj, void* clientData);
+  inline static const MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_closure* closure();
+  inline static MANAGED_STACK_ADDRESS_BOEHM_GC_word* slot_of(void* obj);
+};
+
+// Inline implementation.
+
+inline const MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_closure* gc_finalized_cleanup::closure()
+{
+  static const MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_closure fclos = { cleanup, 0 };
+  return &fclos;
+}
+
+inline MANAGED_STACK_ADDRESS_BOEHM_GC_word* gc_finalized_cleanup::slot_of(void* obj)
+{
+  // Returns the address of the word holding the hidden pointer to the
+  // object to be destructed, or null if obj has not been allocated by
+  // the operator new of this class.
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word* base = reinterpret_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_word*>(MANAGED_STACK_ADDRESS_BOEHM_GC_base(obj));
+
+  if (0 == base || (base[0] & ~static_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_word>(3))
+                    != reinterpret_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_word>(closure()))
+    return 0;
+  return base + 1;
+}
+
+inline void* gc_finalized_cleanup::operator new(MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_T size)
+{
+  // MANAGED_STACK_ADDRESS_BOEHM_GC_init_finalized_malloc does nothing if called once more, so it is
+  // fine even if the static is initialized concurrently (before C++11).
+  static const bool initialized = (MANAGED_STACK_ADDRESS_BOEHM_GC_init_finalized_malloc(), true);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word* slot;
+
+  (void)initialized;
+  // The closure is stored by MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_malloc, the slot is cleared.
+  slot = static_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_word*>(MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_malloc(size + sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word),
+                                                   closure()));
+  MANAGED_STACK_ADDRESS_BOEHM_GC_OP_NEW_OOM_CHECK(slot);
+  return slot + 1;
+}
+
+inline void* gc_finalized_cleanup::operator new(MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_T size,
+                                                GCPlacement gcp)
+{
+  if (gcp != UseGC)
+    return gc::operator new(size, gcp);
+  return gc_finalized_cleanup::operator new(size);
+}
+
+inline void* gc_finalized_cleanup::operator new(MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_T, void* p)
+                                                                MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+{
+  return p;
+}
+
+inline void gc_finalized_cleanup::operator delete(void* obj) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word* slot = slot_of(obj);
+
+  if (slot != 0 && reinterpret_cast<void*>(slot + 1) == obj) {
+    // Not the debug version, as allocated by MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_malloc.
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(slot - 1);
+  } else {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(obj);
+  }
+}
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_OPERATOR_SIZED_DELETE
+  inline void gc_finalized_cleanup::operator delete(void* obj, MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_T)
+                                                                MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+  {
+    gc_finalized_cleanup::operator delete(obj);
+  }
+#endif
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PLACEMENT_DELETE
+  inline void gc_finalized_cleanup::operator delete(void*, void*)
+                                                        MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT {}
+
+  inline void gc_finalized_cleanup::operator delete(void* obj, GCPlacement)
+                                                                MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+  {
+    gc_finalized_cleanup::operator delete(obj);
+  }
+#endif // MANAGED_STACK_ADDRESS_BOEHM_GC_PLACEMENT_DELETE
+
+inline gc_finalized_cleanup::~gc_finalized_cleanup()
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word* slot = slot_of(this);
+
+  if (slot != 0 && *slot == MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(this))
+    *slot = 0; // Prevent the destructors from being called once more.
+}
+
+inline void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK gc_finalized_cleanup::cleanup(void* obj, void*)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word hidden = *reinterpret_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_word*>(obj);
+
+  if (hidden != 0)
+    reinterpret_cast<gc_finalized_cleanup*>(MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(hidden))
+                                                ->~gc_finalized_cleanup();
+}
+
+inline gc_finalized_cleanup::gc_finalized_cleanup()
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word* slot = slot_of(this);
+
+  // The pointer is hidden not to keep the object alive.  If there are
+  // several such subobjects, then a base one is constructed before any
+  // member one, so the virtual destructor of the whole object is called.
+  if (slot != 0 && 0 == *slot)
+    *slot = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(this);
+}
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_NAMESPACE
+}
+#endif
+
+#endif /* MANAGED_STACK_ADDRESS_BOEHM_GC_FINALIZED_CLEANUP_H */
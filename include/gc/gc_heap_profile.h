@@ -0,0 +1,75 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/*
+ * This is the interface of the sampling heap profiler.  The collector
+ * takes a sample (the call stack of the allocating thread) on average
+ * once per the given number of allocated bytes (the distance between
+ * the samples is exponentially distributed, thus every allocated byte
+ * has the same chance to be sampled), and keeps the sampled objects
+ * until they are reclaimed or explicitly deallocated.  On request, the
+ * profile of the allocated (since the profiling start) and of the
+ * in-use (i.e. the live as of the last collection) memory is written in
+ * the pprof format (an uncompressed protocol buffer, which could be
+ * read by pprof directly or after gzip), the values are scaled
+ * estimations.  The addresses are not symbolized, the pprof tool does
+ * it using the mappings of the process (written on Linux only).
+ * The samples are taken by MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind (thus by MANAGED_STACK_ADDRESS_BOEHM_GC_malloc,
+ * MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic and the allocation functions based on them) only,
+ * from the thread-local free lists if available.
+ */
+
+#ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_HEAP_PROFILE_H
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_HEAP_PROFILE_H
+
+#include "gc.h"
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+/* This API is defined only if the library has been suitably compiled   */
+/* (i.e. with ENABLE_HEAP_PROFILE defined).                             */
+
+/* Set the mean sampling interval (in bytes) of the heap profiler.      */
+/* Zero (the default unless MANAGED_STACK_ADDRESS_BOEHM_GC_HEAP_PROFILE_INTERVAL environment        */
+/* variable is set) turns the sampling off; the samples taken so far    */
+/* are kept.  The threads pick up the new value after allocating up to  */
+/* the previous interval (or 1 MB if the sampling was off).  Acquires   */
+/* the allocation lock.                                                 */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_set_heap_profile_interval(MANAGED_STACK_ADDRESS_BOEHM_GC_word /* bytes */);
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_word MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_heap_profile_interval(void);
+
+/* Type of a profile output call-back.  Writes len bytes of buf and     */
+/* returns zero on success.  Called without the allocation lock held.   */
+typedef int (MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK * MANAGED_STACK_ADDRESS_BOEHM_GC_heap_profile_write_proc)(
+                                        void * /* client_data */,
+                                        const void * /* buf */,
+                                        size_t /* len */);
+
+/* Write the heap profile (in the pprof format) by the given call-back. */
+/* Contains 4 sample types: alloc_objects, alloc_space, inuse_objects   */
+/* and inuse_space (the default one).  The in-use values reflect the    */
+/* state as of the last garbage collection (and the explicit            */
+/* deallocations since it), thus the client might want to call          */
+/* MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect() before.  Returns MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS, MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY if fails     */
+/* to allocate a temporary buffer, or the non-zero value returned by    */
+/* proc (the output stops at the first failure).  Acquires the          */
+/* allocation lock (but does not hold it while calling proc).           */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_write_heap_profile(MANAGED_STACK_ADDRESS_BOEHM_GC_heap_profile_write_proc /* proc */,
+                                         void * /* client_data */)
+                                                        MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_NONNULL(1);
+
+#ifdef __cplusplus
+  } /* extern "C" */
+#endif
+
+#endif /* MANAGED_STACK_ADDRESS_BOEHM_GC_HEAP_PROFILE_H */
@@ -92,6 +92,11 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC MA
 # define MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind_global MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind
 #endif
 
+/* Same as MANAGED_STACK_ADDRESS_BOEHM_GC_memalign but allocates an object of the specified kind    */
+/* (e.g. MANAGED_STACK_ADDRESS_BOEHM_GC_I_PTRFREE).                                                 */
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_ALLOC_SIZE(2) void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL
+        MANAGED_STACK_ADDRESS_BOEHM_GC_memalign_kind(size_t /* align */, size_t /* lb */, int /* k */);
+
 /* An internal macro to update the free list pointer atomically (if     */
 /* the AO primitives are available) to avoid race with the marker.      */
 #if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_THREADS) && defined(AO_HAVE_store)
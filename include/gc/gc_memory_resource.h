@@ -0,0 +1,265 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/*
+ * This implements std::pmr::memory_resource (C++17) classes which
+ * allocate memory by the collector, thus the polymorphic-allocator-aware
+ * containers could be moved to the garbage-collected heap by passing
+ * a pointer to such a resource (e.g. gc_resource()) to them, or by
+ * calling std::pmr::set_default_resource().
+ *
+ * gc_memory_resource allocates collectible objects by MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC;
+ * gc_atomic_memory_resource is the same but uses MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC (i.e.
+ * the allocated memory is not scanned by the collector, thus it is only
+ * appropriate for containers of elements having no pointers);
+ * gc_uncollectable_memory_resource allocates objects which are scanned
+ * by the collector but are not collected (MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_UNCOLLECTABLE).  The
+ * memory is explicitly deallocated by MANAGED_STACK_ADDRESS_BOEHM_GC_FREE when the container returns
+ * it to the resource.  These resources have no state, any instances of
+ * the same class compare equal.
+ *
+ * Note that the collector should be able to find the pointers to the
+ * memory allocated by a collectible resource, i.e. the container
+ * objects themselves should be placed in the stack, the static data
+ * or in the memory allocated by the collector (including the memory
+ * allocated by gc_uncollectable_memory_resource).
+ *
+ * gc_arena_memory_resource is a monotonic resource (deallocation is
+ * a no-op) which allocates small collectible objects (of MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC kind)
+ * from its own free lists with no locking (see MANAGED_STACK_ADDRESS_BOEHM_GC_FAST_MALLOC_GRANS in
+ * gc_inline.h), the free lists are refilled by MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc_many.
+ * Like std::pmr::monotonic_buffer_resource, it is not thread-safe, thus
+ * each thread should have its own instance (e.g. a thread_local one).
+ * Unlike the former, the objects allocated from the arena are reclaimed
+ * by the collector individually once they are unreachable, regardless
+ * of the arena lifetime.
+ */
+
+#ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_MEMORY_RESOURCE_H
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_MEMORY_RESOURCE_H
+
+#if __cplusplus < 201703L && _MSVC_LANG < 201703L
+# error gc_memory_resource.h requires C++17
+#endif
+
+#include <cstddef> // for size_t
+#include <memory_resource>
+
+#include "gc_allocator.h"
+#include "gc_inline.h"
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_NAMESPACE_ALLOCATOR
+namespace boehmgc
+{
+#endif
+
+// Allocate an object of the given alignment (which exceeds the one
+// guaranteed by the collector).  The result might be not the beginning
+// of an object (as returned by MANAGED_STACK_ADDRESS_BOEHM_GC_base).
+inline void* MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_alloc(std::size_t bytes, std::size_t alignment,
+                                  bool uncollectable)
+{
+  char* obj;
+
+  if (!uncollectable)
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_memalign(alignment, bytes);
+  if (bytes > static_cast<std::size_t>(-1) - alignment)
+    return 0;
+  obj = static_cast<char*>(MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_uncollectable(bytes + alignment - 1));
+  if (0 == obj)
+    return 0;
+  return obj + ((alignment - reinterpret_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_word>(obj) % alignment)
+                % alignment);
+}
+
+// The memory allocated by MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_alloc (not the debug version).
+inline void MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_free(void* p) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_free(MANAGED_STACK_ADDRESS_BOEHM_GC_base(p));
+}
+
+class gc_memory_resource : public std::pmr::memory_resource {
+protected:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    void* obj = alignment > MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES
+                ? MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_alloc(bytes, alignment, false)
+                : MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(bytes);
+
+    if (0 == obj)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ALLOCATOR_THROW_OR_ABORT();
+    return obj;
+  }
+
+  void do_deallocate(void* p, std::size_t, std::size_t alignment) override
+  {
+    if (alignment > MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_free(p);
+    } else {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(p);
+    }
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+                                                        MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT override
+  {
+    return dynamic_cast<const gc_memory_resource*>(&other) != 0;
+  }
+};
+
+class gc_atomic_memory_resource : public std::pmr::memory_resource {
+protected:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    void* obj = alignment > MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES
+                ? MANAGED_STACK_ADDRESS_BOEHM_GC_memalign_kind(alignment, bytes, MANAGED_STACK_ADDRESS_BOEHM_GC_I_PTRFREE)
+                : MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(bytes);
+
+    if (0 == obj)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ALLOCATOR_THROW_OR_ABORT();
+    return obj;
+  }
+
+  void do_deallocate(void* p, std::size_t, std::size_t alignment) override
+  {
+    if (alignment > MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_free(p);
+    } else {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(p);
+    }
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+                                                        MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT override
+  {
+    return dynamic_cast<const gc_atomic_memory_resource*>(&other) != 0;
+  }
+};
+
+class gc_uncollectable_memory_resource : public std::pmr::memory_resource {
+protected:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    void* obj = alignment > MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES
+                ? MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_alloc(bytes, alignment, true)
+                : MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_UNCOLLECTABLE(bytes);
+
+    if (0 == obj)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ALLOCATOR_THROW_OR_ABORT();
+    return obj;
+  }
+
+  void do_deallocate(void* p, std::size_t, std::size_t alignment) override
+  {
+    if (alignment > MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_free(p);
+    } else {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(p);
+    }
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+                                                        MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT override
+  {
+    return dynamic_cast<const gc_uncollectable_memory_resource*>(&other)
+            != 0;
+  }
+};
+
+class gc_arena_memory_resource : public std::pmr::memory_resource {
+public:
+  gc_arena_memory_resource()
+    : MANAGED_STACK_ADDRESS_BOEHM_GC_extra_bytes(MANAGED_STACK_ADDRESS_BOEHM_GC_get_all_interior_pointers() ? 1 : 0)
+  {
+    // The free lists are placed to an uncollectible object (which is
+    // cleared), so that the objects on them are not reclaimed.
+    MANAGED_STACK_ADDRESS_BOEHM_GC_tiny_fl = static_cast<void**>(MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_uncollectable(
+                                MANAGED_STACK_ADDRESS_BOEHM_GC_TINY_FREELISTS * sizeof(void*)));
+    if (0 == MANAGED_STACK_ADDRESS_BOEHM_GC_tiny_fl)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ALLOCATOR_THROW_OR_ABORT();
+  }
+
+  gc_arena_memory_resource(const gc_arena_memory_resource&) = delete;
+  gc_arena_memory_resource& operator=(const gc_arena_memory_resource&)
+                                                                = delete;
+
+  ~gc_arena_memory_resource() override
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_free(MANAGED_STACK_ADDRESS_BOEHM_GC_tiny_fl);
+  }
+
+  // Drop the objects remaining on the free lists.
+  void release() MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+  {
+    for (int i = 0; i < MANAGED_STACK_ADDRESS_BOEHM_GC_TINY_FREELISTS; i++)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_tiny_fl[i] = 0;
+  }
+
+protected:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    void* obj;
+
+    if (alignment > MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES) {
+      obj = MANAGED_STACK_ADDRESS_BOEHM_GC_overaligned_alloc(bytes, alignment, false);
+    } else if (bytes >= MANAGED_STACK_ADDRESS_BOEHM_GC_TINY_FREELISTS * MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES) {
+      obj = MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind(bytes, MANAGED_STACK_ADDRESS_BOEHM_GC_I_NORMAL);
+    } else {
+      std::size_t granules = (bytes + MANAGED_STACK_ADDRESS_BOEHM_GC_extra_bytes + MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES - 1)
+                                / MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES;
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FAST_MALLOC_GRANS(obj, granules, MANAGED_STACK_ADDRESS_BOEHM_GC_tiny_fl, 0, MANAGED_STACK_ADDRESS_BOEHM_GC_I_NORMAL,
+                           MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind(bytes, MANAGED_STACK_ADDRESS_BOEHM_GC_I_NORMAL),
+                           *(void**)obj = 0);
+    }
+    if (0 == obj)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ALLOCATOR_THROW_OR_ABORT();
+    return obj;
+  }
+
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+                                                        MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT override
+  {
+    return this == &other;
+  }
+
+private:
+  void** MANAGED_STACK_ADDRESS_BOEHM_GC_tiny_fl;
+  std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_extra_bytes;
+};
+
+// The pointers to the global instances of the stateless resources.
+inline gc_memory_resource* gc_resource() MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+{
+  static gc_memory_resource r;
+  return &r;
+}
+
+inline gc_atomic_memory_resource* gc_atomic_resource() MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+{
+  static gc_atomic_memory_resource r;
+  return &r;
+}
+
+inline gc_uncollectable_memory_resource* gc_uncollectable_resource()
+                                                                MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+{
+  static gc_uncollectable_memory_resource r;
+  return &r;
+}
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_NAMESPACE_ALLOCATOR
+}
+#endif
+
+#endif /* MANAGED_STACK_ADDRESS_BOEHM_GC_MEMORY_RESOURCE_H */
@@ -0,0 +1,286 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/*
+ * This is a C++17 interface to the explicitly typed allocation primitives
+ * of gc_typed.h.  Instead of filling a bitmap by hand and calling
+ * MANAGED_STACK_ADDRESS_BOEHM_GC_make_descriptor, the client declares which fields of a type may
+ * hold pointers (at the global namespace scope):
+ *
+ *   struct Node { long key; Node* next; void* value; };
+ *   MANAGED_STACK_ADDRESS_BOEHM_GC_BEGIN_PTR_FIELDS(Node)
+ *     MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_FIELD(next)
+ *     MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_FIELD(value)
+ *   MANAGED_STACK_ADDRESS_BOEHM_GC_END_PTR_FIELDS;
+ *
+ * The layout bitmap is then computed at compile time and the descriptor
+ * is created once per type, on the first allocation.  Only the listed
+ * fields are scanned by the collector.  A listed field may be a pointer,
+ * an array, or a type which has its fields declared too; any other field
+ * type (except for the arithmetic and enumeration ones) is considered to
+ * hold pointers in every word.  The objects of a type which has no fields
+ * declared are scanned conservatively (unless the type is arithmetic or
+ * enumeration, or is declared by MANAGED_STACK_ADDRESS_BOEHM_GC_DECLARE_PTRFREE).  The type should
+ * be a standard-layout one (as offsetof is applied to it).
+ *
+ * gc_typed_new<T>(args) allocates a collectible object of type T
+ * and constructs it with the given arguments; gc_typed_new_array<T>(n)
+ * allocates and value-initializes an array of n such objects.  As for
+ * the other collectible objects, the destructors are not invoked.
+ *
+ * gc_typed_allocator<T> is same as gc_allocator<T> but allocates arrays
+ * of T scanned according to the layout of T (std::pair has its layout
+ * declared here).  Thus, e.g., the elements of std::vector of pairs of
+ * an integer and a pointer have only their second words traced.  Note
+ * that node-based containers rebind the allocator to their internal
+ * node types which are, typically, scanned conservatively.
+ */
+
+#ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TYPED_CPP_H
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_TYPED_CPP_H
+
+#if __cplusplus < 201703L && _MSVC_LANG < 201703L
+# error gc_typed_cpp.h requires C++17
+#endif
+
+#include <cstddef> // for offsetof, size_t
+#include <type_traits>
+#include <utility> // for forward
+
+#include "gc_allocator.h"
+#include "gc_typed.h"
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_NAMESPACE_ALLOCATOR
+# define MANAGED_STACK_ADDRESS_BOEHM_GC_TYPED_NS_QUALIFY(T) boehmgc::T
+namespace boehmgc
+{
+#else
+# define MANAGED_STACK_ADDRESS_BOEHM_GC_TYPED_NS_QUALIFY(T) T
+#endif
+
+// The layout of a type with the pointer fields not declared.
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+struct MANAGED_STACK_ADDRESS_BOEHM_GC_type_layout {
+  static constexpr bool MANAGED_STACK_ADDRESS_BOEHM_GC_declared = false;
+};
+
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_BEGIN_PTR_FIELDS(T) \
+    template<> struct MANAGED_STACK_ADDRESS_BOEHM_GC_TYPED_NS_QUALIFY(MANAGED_STACK_ADDRESS_BOEHM_GC_type_layout)<T> { \
+      typedef T MANAGED_STACK_ADDRESS_BOEHM_GC_layout_tp; \
+      static constexpr bool MANAGED_STACK_ADDRESS_BOEHM_GC_declared = true; \
+      static constexpr void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fields(MANAGED_STACK_ADDRESS_BOEHM_GC_word* MANAGED_STACK_ADDRESS_BOEHM_GC_bm, \
+                                           std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_ofs) { \
+        (void)MANAGED_STACK_ADDRESS_BOEHM_GC_bm; (void)MANAGED_STACK_ADDRESS_BOEHM_GC_ofs;
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_FIELD(f) \
+        MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark<decltype(MANAGED_STACK_ADDRESS_BOEHM_GC_layout_tp::f)>(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, \
+                                MANAGED_STACK_ADDRESS_BOEHM_GC_ofs + offsetof(MANAGED_STACK_ADDRESS_BOEHM_GC_layout_tp, f));
+#define MANAGED_STACK_ADDRESS_BOEHM_GC_END_PTR_FIELDS }}
+
+// Set the bits of bitmap corresponding to the words overlapping
+// the given range of bytes.
+constexpr void MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark_range(MANAGED_STACK_ADDRESS_BOEHM_GC_word* MANAGED_STACK_ADDRESS_BOEHM_GC_bm, std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_ofs,
+                                    std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_sz)
+{
+  for (std::size_t i = MANAGED_STACK_ADDRESS_BOEHM_GC_ofs / sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word);
+       i * sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word) < MANAGED_STACK_ADDRESS_BOEHM_GC_ofs + MANAGED_STACK_ADDRESS_BOEHM_GC_sz; i++)
+    MANAGED_STACK_ADDRESS_BOEHM_GC_set_bit(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, i);
+}
+
+// Set the bits of bitmap corresponding to the words of an object of
+// type MANAGED_STACK_ADDRESS_BOEHM_GC_Tp placed at the given offset which might hold pointers.
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+constexpr void MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark(MANAGED_STACK_ADDRESS_BOEHM_GC_word* MANAGED_STACK_ADDRESS_BOEHM_GC_bm, std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_ofs)
+{
+  if constexpr ((std::is_pointer<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value
+                 && !std::is_function<
+                        typename std::remove_pointer<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::type>::value)
+                || std::is_reference<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark_range(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, MANAGED_STACK_ADDRESS_BOEHM_GC_ofs, sizeof(void*));
+  } else if constexpr (std::is_array<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value) {
+    typedef typename std::remove_extent<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::type MANAGED_STACK_ADDRESS_BOEHM_GC_elem_tp;
+
+    for (std::size_t i = 0; i < std::extent<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value; i++)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark<MANAGED_STACK_ADDRESS_BOEHM_GC_elem_tp>(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, MANAGED_STACK_ADDRESS_BOEHM_GC_ofs + i * sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_elem_tp));
+  } else if constexpr (MANAGED_STACK_ADDRESS_BOEHM_GC_type_layout<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::MANAGED_STACK_ADDRESS_BOEHM_GC_declared) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_type_layout<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fields(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, MANAGED_STACK_ADDRESS_BOEHM_GC_ofs);
+  } else if constexpr (!std::is_arithmetic<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value
+                       && !std::is_enum<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value
+                       && !std::is_function<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value
+                       && !std::is_member_pointer<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value
+                       && !std::is_null_pointer<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>::value
+                       && !std::is_same<
+                            decltype(MANAGED_STACK_ADDRESS_BOEHM_GC_type_traits<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>().MANAGED_STACK_ADDRESS_BOEHM_GC_is_ptr_free),
+                            MANAGED_STACK_ADDRESS_BOEHM_GC_true_type>::value) {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark_range(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, MANAGED_STACK_ADDRESS_BOEHM_GC_ofs, sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_Tp));
+  }
+}
+
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_T1, class MANAGED_STACK_ADDRESS_BOEHM_GC_T2>
+struct MANAGED_STACK_ADDRESS_BOEHM_GC_type_layout<std::pair<MANAGED_STACK_ADDRESS_BOEHM_GC_T1, MANAGED_STACK_ADDRESS_BOEHM_GC_T2> > {
+  static constexpr bool MANAGED_STACK_ADDRESS_BOEHM_GC_declared = true;
+
+  static constexpr void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_fields(MANAGED_STACK_ADDRESS_BOEHM_GC_word* MANAGED_STACK_ADDRESS_BOEHM_GC_bm, std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_ofs)
+  {
+    typedef std::pair<MANAGED_STACK_ADDRESS_BOEHM_GC_T1, MANAGED_STACK_ADDRESS_BOEHM_GC_T2> MANAGED_STACK_ADDRESS_BOEHM_GC_pair_tp;
+
+    if constexpr (std::is_standard_layout<MANAGED_STACK_ADDRESS_BOEHM_GC_pair_tp>::value) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark<MANAGED_STACK_ADDRESS_BOEHM_GC_T1>(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, MANAGED_STACK_ADDRESS_BOEHM_GC_ofs + offsetof(MANAGED_STACK_ADDRESS_BOEHM_GC_pair_tp, first));
+      MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark<MANAGED_STACK_ADDRESS_BOEHM_GC_T2>(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, MANAGED_STACK_ADDRESS_BOEHM_GC_ofs + offsetof(MANAGED_STACK_ADDRESS_BOEHM_GC_pair_tp, second));
+    } else {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark_range(MANAGED_STACK_ADDRESS_BOEHM_GC_bm, MANAGED_STACK_ADDRESS_BOEHM_GC_ofs, sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_pair_tp));
+    }
+  }
+};
+
+// The bitmap of the words (of an object of type MANAGED_STACK_ADDRESS_BOEHM_GC_Tp) which might
+// hold pointers.
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+struct MANAGED_STACK_ADDRESS_BOEHM_GC_type_bitmap {
+  static constexpr std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_nwords =
+                        (sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_Tp) + sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word) - 1) / sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word);
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_word MANAGED_STACK_ADDRESS_BOEHM_GC_bm[(MANAGED_STACK_ADDRESS_BOEHM_GC_nwords + MANAGED_STACK_ADDRESS_BOEHM_GC_WORDSZ - 1) / MANAGED_STACK_ADDRESS_BOEHM_GC_WORDSZ];
+};
+
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+constexpr MANAGED_STACK_ADDRESS_BOEHM_GC_type_bitmap<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp> MANAGED_STACK_ADDRESS_BOEHM_GC_make_type_bitmap()
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_type_bitmap<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp> r{};
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_layout_mark<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>(r.MANAGED_STACK_ADDRESS_BOEHM_GC_bm, 0);
+  return r;
+}
+
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+constexpr std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_count_type_bitmap(const MANAGED_STACK_ADDRESS_BOEHM_GC_type_bitmap<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>& b)
+{
+  std::size_t cnt = 0;
+
+  for (std::size_t i = 0; i < b.MANAGED_STACK_ADDRESS_BOEHM_GC_nwords; i++)
+    cnt += static_cast<std::size_t>(MANAGED_STACK_ADDRESS_BOEHM_GC_get_bit(b.MANAGED_STACK_ADDRESS_BOEHM_GC_bm, i));
+  return cnt;
+}
+
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+struct MANAGED_STACK_ADDRESS_BOEHM_GC_type_descr {
+  static constexpr MANAGED_STACK_ADDRESS_BOEHM_GC_type_bitmap<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp> MANAGED_STACK_ADDRESS_BOEHM_GC_bitmap =
+                                        MANAGED_STACK_ADDRESS_BOEHM_GC_make_type_bitmap<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>();
+  static constexpr std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_nptrs = MANAGED_STACK_ADDRESS_BOEHM_GC_count_type_bitmap(MANAGED_STACK_ADDRESS_BOEHM_GC_bitmap);
+
+  // Whether the objects should be allocated by MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC
+  // or MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC, respectively, without a descriptor.
+  static constexpr bool MANAGED_STACK_ADDRESS_BOEHM_GC_ptr_free = 0 == MANAGED_STACK_ADDRESS_BOEHM_GC_nptrs;
+  static constexpr bool MANAGED_STACK_ADDRESS_BOEHM_GC_all_ptrs = MANAGED_STACK_ADDRESS_BOEHM_GC_bitmap.MANAGED_STACK_ADDRESS_BOEHM_GC_nwords == MANAGED_STACK_ADDRESS_BOEHM_GC_nptrs;
+
+  // The descriptor is built on the first call (as MANAGED_STACK_ADDRESS_BOEHM_GC_make_descriptor
+  // might consume some finite resource) and cached.
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_descr MANAGED_STACK_ADDRESS_BOEHM_GC_get()
+  {
+    static const MANAGED_STACK_ADDRESS_BOEHM_GC_descr d = MANAGED_STACK_ADDRESS_BOEHM_GC_make_descriptor(MANAGED_STACK_ADDRESS_BOEHM_GC_bitmap.MANAGED_STACK_ADDRESS_BOEHM_GC_bm,
+                                                 MANAGED_STACK_ADDRESS_BOEHM_GC_bitmap.MANAGED_STACK_ADDRESS_BOEHM_GC_nwords);
+    return d;
+  }
+};
+
+// Allocate memory for n objects of type MANAGED_STACK_ADDRESS_BOEHM_GC_Tp (not constructed).
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+inline void* MANAGED_STACK_ADDRESS_BOEHM_GC_typed_alloc(std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_n)
+{
+  typedef MANAGED_STACK_ADDRESS_BOEHM_GC_type_descr<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp> MANAGED_STACK_ADDRESS_BOEHM_GC_descr_tp;
+  void* obj;
+
+  if (MANAGED_STACK_ADDRESS_BOEHM_GC_n > static_cast<std::size_t>(-1) / sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_Tp))
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ALLOCATOR_THROW_OR_ABORT();
+  if constexpr (MANAGED_STACK_ADDRESS_BOEHM_GC_descr_tp::MANAGED_STACK_ADDRESS_BOEHM_GC_ptr_free) {
+    obj = MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(MANAGED_STACK_ADDRESS_BOEHM_GC_n * sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_Tp));
+  } else if constexpr (MANAGED_STACK_ADDRESS_BOEHM_GC_descr_tp::MANAGED_STACK_ADDRESS_BOEHM_GC_all_ptrs) {
+    obj = MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(MANAGED_STACK_ADDRESS_BOEHM_GC_n * sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_Tp));
+  } else if (1 == MANAGED_STACK_ADDRESS_BOEHM_GC_n) {
+    obj = MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_EXPLICITLY_TYPED(sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_Tp), MANAGED_STACK_ADDRESS_BOEHM_GC_descr_tp::MANAGED_STACK_ADDRESS_BOEHM_GC_get());
+  } else {
+    obj = MANAGED_STACK_ADDRESS_BOEHM_GC_CALLOC_EXPLICITLY_TYPED(MANAGED_STACK_ADDRESS_BOEHM_GC_n, sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_Tp),
+                                     MANAGED_STACK_ADDRESS_BOEHM_GC_descr_tp::MANAGED_STACK_ADDRESS_BOEHM_GC_get());
+  }
+  if (0 == obj)
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ALLOCATOR_THROW_OR_ABORT();
+  return obj;
+}
+
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp, class... MANAGED_STACK_ADDRESS_BOEHM_GC_Args>
+inline MANAGED_STACK_ADDRESS_BOEHM_GC_Tp* gc_typed_new(MANAGED_STACK_ADDRESS_BOEHM_GC_Args&&... args)
+{
+  return ::new (MANAGED_STACK_ADDRESS_BOEHM_GC_typed_alloc<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>(1))
+                MANAGED_STACK_ADDRESS_BOEHM_GC_Tp(std::forward<MANAGED_STACK_ADDRESS_BOEHM_GC_Args>(args)...);
+}
+
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+inline MANAGED_STACK_ADDRESS_BOEHM_GC_Tp* gc_typed_new_array(std::size_t MANAGED_STACK_ADDRESS_BOEHM_GC_n)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_Tp* p = static_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp*>(MANAGED_STACK_ADDRESS_BOEHM_GC_typed_alloc<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>(MANAGED_STACK_ADDRESS_BOEHM_GC_n));
+
+  for (std::size_t i = 0; i < MANAGED_STACK_ADDRESS_BOEHM_GC_n; i++)
+    ::new (p + i) MANAGED_STACK_ADDRESS_BOEHM_GC_Tp();
+  return p;
+}
+
+// The public gc_typed_allocator<T> class.
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>
+class gc_typed_allocator {
+public:
+  typedef std::size_t    size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef MANAGED_STACK_ADDRESS_BOEHM_GC_Tp*       pointer;
+  typedef const MANAGED_STACK_ADDRESS_BOEHM_GC_Tp* const_pointer;
+  typedef MANAGED_STACK_ADDRESS_BOEHM_GC_Tp&       reference;
+  typedef const MANAGED_STACK_ADDRESS_BOEHM_GC_Tp& const_reference;
+  typedef MANAGED_STACK_ADDRESS_BOEHM_GC_Tp        value_type;
+
+  template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp1> struct rebind {
+    typedef gc_typed_allocator<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp1> other;
+  };
+
+  gc_typed_allocator() MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT {}
+  gc_typed_allocator(const gc_typed_allocator&) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT {}
+  template <class MANAGED_STACK_ADDRESS_BOEHM_GC_Tp1> MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_EXPLICIT
+  gc_typed_allocator(const gc_typed_allocator<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp1>&) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT {}
+  ~gc_typed_allocator() MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT {}
+
+  // MANAGED_STACK_ADDRESS_BOEHM_GC_n is permitted to be 0.
+  MANAGED_STACK_ADDRESS_BOEHM_GC_Tp* allocate(size_type MANAGED_STACK_ADDRESS_BOEHM_GC_n, const void* = 0) {
+    return static_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp*>(MANAGED_STACK_ADDRESS_BOEHM_GC_typed_alloc<MANAGED_STACK_ADDRESS_BOEHM_GC_Tp>(MANAGED_STACK_ADDRESS_BOEHM_GC_n));
+  }
+
+  void deallocate(pointer __p, size_type /* MANAGED_STACK_ADDRESS_BOEHM_GC_n */) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+    { MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(__p); }
+
+  size_type max_size() const MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+    { return static_cast<std::size_t>(-1) / sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_Tp); }
+};
+
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_T1, class MANAGED_STACK_ADDRESS_BOEHM_GC_T2>
+inline bool operator==(const gc_typed_allocator<MANAGED_STACK_ADDRESS_BOEHM_GC_T1>&,
+                       const gc_typed_allocator<MANAGED_STACK_ADDRESS_BOEHM_GC_T2>&) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+{
+  return true;
+}
+
+template <class MANAGED_STACK_ADDRESS_BOEHM_GC_T1, class MANAGED_STACK_ADDRESS_BOEHM_GC_T2>
+inline bool operator!=(const gc_typed_allocator<MANAGED_STACK_ADDRESS_BOEHM_GC_T1>&,
+                       const gc_typed_allocator<MANAGED_STACK_ADDRESS_BOEHM_GC_T2>&) MANAGED_STACK_ADDRESS_BOEHM_GC_NOEXCEPT
+{
+  return false;
+}
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_NAMESPACE_ALLOCATOR
+}
+#endif
+
+#endif /* MANAGED_STACK_ADDRESS_BOEHM_GC_TYPED_CPP_H */
@@ -106,6 +106,24 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN unsigned MANAGED_STACK_ADDRESS_BOEHM_GC_n_
      * This could be split into multiple CVs (and probably should be to
      * scale to really large numbers of processors.)
      */
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_from_mark_stack(void);
+                /* Mark from the entries on the mark stack (until it is */
+                /* empty) using the parallel marker.  Unlike            */
+                /* MANAGED_STACK_ADDRESS_BOEHM_GC_mark_some, the mark state is not changed unless   */
+                /* the mark stack overflows (it becomes MS_INVALID).    */
+                /* The world may be running.                            */
+
+  typedef void (*MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_proc)(void * /* client_data */);
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_do_parallel_task(MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_proc fn,
+                                    void *client_data);
+                /* Run fn(client_data) in the calling thread and in all */
+                /* the marker threads which are ready to help; return   */
+                /* once all of them are done.  Not all the helpers      */
+                /* might join, thus fn should claim the pieces of work  */
+                /* atomically (e.g. with AO_fetch_and_add1) until none  */
+                /* is left.  Called with the allocation lock held.      */
 #endif /* PARALLEL_MARK */
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER mse * MANAGED_STACK_ADDRESS_BOEHM_GC_signal_mark_stack_overflow(mse *msp);
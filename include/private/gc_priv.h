@@ -383,6 +383,79 @@ EXTERN_C_BEGIN
                         /* for processing by MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_finalizers.      */
                         /* Invoked with lock.                           */
 
+# if defined(THREADS) && defined(AO_HAVE_load_acquire) \
+     && defined(AO_HAVE_store_release) && !defined(NO_LOCK_FREE_WEAK_DEREF)
+#   define LOCK_FREE_WEAK_DEREF
+    MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN volatile AO_t MANAGED_STACK_ADDRESS_BOEHM_GC_weak_refs_seq;
+                        /* A sequence counter which is odd since the    */
+                        /* world is restarted after a complete mark     */
+                        /* until MANAGED_STACK_ADDRESS_BOEHM_GC_finalize clears the weak references */
+                        /* to the unmarked objects.  A weak reference   */
+                        /* read while the counter is even (and          */
+                        /* unchanged) refers to a live object since the */
+                        /* stacks of all threads are scanned in the     */
+                        /* world-stopped mark phase.  Updated with the  */
+                        /* lock held.                                   */
+# endif
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_some_finalizers(MANAGED_STACK_ADDRESS_BOEHM_GC_stop_func stop_func);
+                        /* Same as MANAGED_STACK_ADDRESS_BOEHM_GC_invoke_finalizers but also stops  */
+                        /* once stop_func (if non-zero) returns TRUE.   */
+                        /* The latter is called holding the lock before */
+                        /* each finalizer.  Invoked without the lock.   */
+
+# ifdef FINALIZER_THREADS
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock(void);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock(void);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_wait_finalizer(void);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_finalizer(void);
+                        /* The lock and condition variable of the pool  */
+                        /* of finalizer threads (defined in             */
+                        /* pthread_support.c).  If the allocation lock  */
+                        /* is needed too, then it is acquired first.    */
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_create_finalizer_thread(void);
+                        /* Create a detached registered thread running  */
+                        /* MANAGED_STACK_ADDRESS_BOEHM_GC_run_finalizer_pool.  Returns FALSE (after */
+                        /* a warning) on failure.  Invoked without the  */
+                        /* lock.                                        */
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_run_finalizer_pool(void);
+                        /* The body of a finalizer thread, never        */
+                        /* returns.                                     */
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_threads_reset_child(void);
+                        /* Forget the finalizer threads (not inherited) */
+                        /* in a forked child; they are created again on */
+                        /* demand.  Invoked with lock.                  */
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_pause_finalizer_threads(void);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_resume_finalizer_threads(void);
+                        /* Prevent the idle pool threads from starting  */
+                        /* new batches of finalizers until the matching */
+                        /* resume call.  Used around fork().  The       */
+                        /* batches being run are not waited for (the    */
+                        /* finalizers are client code which might even  */
+                        /* call fork() itself), so a finalizer running  */
+                        /* at fork() is like any other client thread    */
+                        /* holding a client lock then.  Invoked without */
+                        /* the lock.                                    */
+# endif
+
+# ifdef STRIPED_FNLZ_TABLES
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_fnlz_stripe_lock(unsigned s);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_release_fnlz_stripe_lock(unsigned s);
+                        /* The lock of the given stripe of the          */
+                        /* finalization tables (defined in              */
+                        /* pthread_support.c).  The allocation lock is  */
+                        /* never acquired while holding it.             */
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_all_fnlz_stripe_locks(void);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_release_all_fnlz_stripe_locks(void);
+                        /* Same but for all the stripes (in the order   */
+                        /* of their indices).  Invoked with lock.       */
+# endif
+
 # ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
     MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_process_togglerefs(void);
                         /* Process the toggle-refs before GC starts.    */
@@ -417,6 +490,15 @@ EXTERN_C_BEGIN
 #   define MAXHINCR 2048 /* Maximum heap increment, in blocks.  */
 # endif /* !LARGE_CONFIG */
 
+#ifndef HUGE_OBJ_BYTES
+# define HUGE_OBJ_BYTES ((word)MAXHINCR * HBLKSIZE)
+                        /* Objects not smaller than this usually get    */
+                        /* a heap section of their own.  Such objects   */
+                        /* are grown in place by MANAGED_STACK_ADDRESS_BOEHM_GC_realloc (if     */
+                        /* GROW_HEAP_IN_PLACE) and unmapped as soon as  */
+                        /* explicitly deallocated (if USE_MUNMAP).      */
+#endif
+
 # define BL_LIMIT MANAGED_STACK_ADDRESS_BOEHM_GC_black_list_spacing
                            /* If we need a block of N bytes, and we have */
                            /* a block of N + BL_LIMIT bytes available,   */
@@ -1134,6 +1216,15 @@ struct hblkhdr {
 #       ifndef MARK_BIT_PER_OBJ
 #         define LARGE_BLOCK 0x20
 #       endif
+#       define ZERO_BLK 0x40    /* The content of the block is known to */
+                                /* be all zeros, e.g. the memory is     */
+                                /* fresh from the OS or it has been     */
+                                /* remapped after unmapping.  Kept for  */
+                                /* free blocks; for an in-use one, the  */
+                                /* flag may be set only on return from  */
+                                /* MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk, and the caller should  */
+                                /* test and clear it (on first use) by  */
+                                /* MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_take_zeroed.                 */
     unsigned short hb_last_reclaimed;
                                 /* Value of MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no when block was     */
                                 /* last allocated or swept. May wrap.   */
@@ -1142,6 +1233,12 @@ struct hblkhdr {
                                 /* when the header was allocated, or    */
                                 /* when the size of the block last      */
                                 /* changed.                             */
+#   ifdef SCAVENGER_THREAD
+      unsigned32 hb_free_ms;    /* For a free block, the value of       */
+                                /* MANAGED_STACK_ADDRESS_BOEHM_GC_scavenge_ms when the age above    */
+                                /* was last updated, i.e. the same age  */
+                                /* but in (coarse) milliseconds.        */
+#   endif
 #   ifdef MARK_BIT_PER_OBJ
       unsigned32 hb_inv_sz;     /* A good upper bound for 2**32/hb_sz.  */
                                 /* For large objects, we use            */
@@ -1224,6 +1321,28 @@ struct hblk {
 
 # define HBLK_IS_FREE(hdr) (((hdr) -> hb_flags & FREE_BLK) != 0)
 
+/* Test whether the block just returned by MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk is known to    */
+/* be zero-filled; clear the flag as the block is about to be used.     */
+MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_take_zeroed(hdr *hhdr)
+{
+  if ((hhdr -> hb_flags & ZERO_BLK) == 0) return FALSE;
+  hhdr -> hb_flags &= (unsigned char)~ZERO_BLK;
+  return TRUE;
+}
+
+#ifdef SCAVENGER_THREAD
+  MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN unsigned32 MANAGED_STACK_ADDRESS_BOEHM_GC_scavenge_ms;
+                        /* The time (in milliseconds, wrapping) sampled */
+                        /* by the scavenger thread on each wake-up; it  */
+                        /* is the clock of the free block ages.  Set to */
+                        /* zero till the scavenger is started.  Defined */
+                        /* in pthread_support.c.                        */
+# define SET_FREE_BLK_TIME(hhdr) \
+                (void)((hhdr) -> hb_free_ms = MANAGED_STACK_ADDRESS_BOEHM_GC_scavenge_ms)
+#else
+# define SET_FREE_BLK_TIME(hhdr) (void)0
+#endif
+
 # define OBJ_SZ_TO_BLOCKS(lb) divHBLKSZ((lb) + HBLKSIZE-1)
 # define OBJ_SZ_TO_BLOCKS_CHECKED(lb) /* lb should have no side-effect */ \
                                 divHBLKSZ(SIZET_SAT_ADD(lb, HBLKSIZE-1))
@@ -1314,16 +1433,46 @@ typedef int mark_state_t;   /* Current state of marking.                */
 struct disappearing_link;
 struct finalizable_object;
 
+/* Each of the finalization hash tables is split into FNLZ_STRIPES      */
+/* independent sub-tables (stripes); an entry goes to the stripe        */
+/* selected by the high bits of a multiplicative hash of its key.       */
+#ifdef STRIPED_FNLZ_TABLES
+# ifndef LOG_FNLZ_STRIPES
+#   define LOG_FNLZ_STRIPES 6
+# endif
+#else
+# undef LOG_FNLZ_STRIPES
+# define LOG_FNLZ_STRIPES 0
+#endif
+#define FNLZ_STRIPES (1 << LOG_FNLZ_STRIPES)
+
+/* A stripe of a disappearing links table.      */
 struct dl_hashtbl_s {
     struct disappearing_link **head;
     word entries;
     unsigned log_size;
+    unsigned free_count;        /* the length of free_list */
+    struct disappearing_link *free_list;
+                        /* Unused entries (chained via dl_next).        */
+};
+
+/* A stripe of the finalization table.  */
+struct fo_hashtbl_s {
+    struct finalizable_object **head;
+    word entries;
+    unsigned log_size;
+    unsigned free_count;
+    struct finalizable_object *free_list;
 };
 
 struct fnlz_roots_s {
-  struct finalizable_object **fo_head;
   /* List of objects that should be finalized now: */
   struct finalizable_object *finalize_now;
+# ifdef FINALIZER_THREADS
+    /* Ready objects taken by the finalizer threads but not started     */
+    /* yet; protected by the finalizer lock.                            */
+    struct finalizable_object *pool_queue;
+# endif
 };
 
 union toggle_ref_u {
@@ -1510,18 +1659,18 @@ struct _MANAGED_STACK_ADDRESS_BOEHM_GC_arrays {
     ptr_t *_gcjobjfreelist;
 # endif
 # define MANAGED_STACK_ADDRESS_BOEHM_GC_fo_entries MANAGED_STACK_ADDRESS_BOEHM_GC_arrays._fo_entries
-  word _fo_entries;
+  word _fo_entries;     /* The sum of the entries of MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl.     */
 # ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
 #   define MANAGED_STACK_ADDRESS_BOEHM_GC_dl_hashtbl MANAGED_STACK_ADDRESS_BOEHM_GC_arrays._dl_hashtbl
+#   define MANAGED_STACK_ADDRESS_BOEHM_GC_fo_hashtbl MANAGED_STACK_ADDRESS_BOEHM_GC_arrays._fo_hashtbl
 #   define MANAGED_STACK_ADDRESS_BOEHM_GC_fnlz_roots MANAGED_STACK_ADDRESS_BOEHM_GC_arrays._fnlz_roots
-#   define MANAGED_STACK_ADDRESS_BOEHM_GC_log_fo_table_size MANAGED_STACK_ADDRESS_BOEHM_GC_arrays._log_fo_table_size
 #   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_LONG_REFS_NOT_NEEDED
 #     define MANAGED_STACK_ADDRESS_BOEHM_GC_ll_hashtbl MANAGED_STACK_ADDRESS_BOEHM_GC_arrays._ll_hashtbl
-      struct dl_hashtbl_s _ll_hashtbl;
+      struct dl_hashtbl_s _ll_hashtbl[FNLZ_STRIPES];
 #   endif
-    struct dl_hashtbl_s _dl_hashtbl;
+    struct dl_hashtbl_s _dl_hashtbl[FNLZ_STRIPES];
+    struct fo_hashtbl_s _fo_hashtbl[FNLZ_STRIPES];
     struct fnlz_roots_s _fnlz_roots;
-    unsigned _log_fo_table_size;
 #   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
 #     define MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_arr MANAGED_STACK_ADDRESS_BOEHM_GC_arrays._toggleref_arr
 #     define MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_array_size MANAGED_STACK_ADDRESS_BOEHM_GC_arrays._toggleref_array_size
@@ -1726,7 +1875,13 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN struct obj_kind {
                         /* is reclaimed, but must also tolerate being   */
                         /* called with object from freelist.  Non-zero  */
                         /* exit prevents object from being reclaimed.   */
-#   define OK_DISCLAIM_INITZ /* comma */, FALSE, 0
+    void (MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK *ok_disclaim_block_proc)(void * /*hblk*/,
+                                size_t /*obj_sz*/, size_t /*n_objs*/,
+                                word * /*bitmap*/);
+                        /* The per-block variant of the above; used     */
+                        /* instead of it if non-zero.  Might be called  */
+                        /* concurrently for different blocks.           */
+#   define OK_DISCLAIM_INITZ /* comma */, FALSE, 0, 0
 # else
 #   define OK_DISCLAIM_INITZ /* empty */
 # endif /* !ENABLE_DISCLAIM */
@@ -2212,6 +2367,29 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_build_
                                 /* called by MANAGED_STACK_ADDRESS_BOEHM_GC_new_hblk, but also      */
                                 /* called explicitly without GC lock.   */
 
+#ifdef USE_NT_CLEAR
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_init_clear_kernels(void);
+                                /* Select the clearing kernels based on */
+                                /* the CPU features.  Called once by    */
+                                /* MANAGED_STACK_ADDRESS_BOEHM_GC_init.                             */
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_clear_nt(ptr_t p, size_t bytes);
+                                /* Clear the given memory.  Chunks of   */
+                                /* NT_CLEAR_MIN_BYTES or larger ones    */
+                                /* are cleared bypassing the caches     */
+                                /* (unless disabled at MANAGED_STACK_ADDRESS_BOEHM_GC_init).        */
+# define BZERO_LARGE(x, n) MANAGED_STACK_ADDRESS_BOEHM_GC_clear_nt((ptr_t)(x), (size_t)(n))
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_avx_clear;
+                                /* Use AVX stores to clear reclaimed    */
+                                /* objects (set by MANAGED_STACK_ADDRESS_BOEHM_GC_init).            */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_clear_words_avx(word *p, word *lim);
+                                /* Clear words in [p, lim) using AVX    */
+                                /* stores.  The CPU should support AVX. */
+#else
+# define BZERO_LARGE(x, n) BZERO(x, n)
+#endif
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER struct hblk * MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk(size_t size_in_bytes, int kind,
                                     unsigned flags, size_t align_m1);
                                 /* Allocate (and return pointer to)     */
@@ -2243,10 +2421,37 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk(struct hblk * p);
                                 /* Deallocate a heap block and mark it  */
                                 /* as invalid.                          */
+#ifdef USE_MUNMAP
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk_and_unmap(struct hblk * p);
+                                /* Same as MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk but also return  */
+                                /* the resulting free block to the OS   */
+                                /* immediately (unless the unmapping is */
+                                /* disabled by MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_threshold).     */
+#endif
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_extend_hblk(struct hblk *h, size_t new_bytes,
+                                   MANAGED_STACK_ADDRESS_BOEHM_GC_bool *pzeroed);
+                                /* Grow the in-use large block h (not   */
+                                /* moving it) to new_bytes (a multiple  */
+                                /* of HBLKSIZE) by taking over the free */
+                                /* block following it.  The size and    */
+                                /* descriptor in the header of h are    */
+                                /* not updated.  Returns FALSE if that  */
+                                /* block is not free or too small.      */
+                                /* On success, *pzeroed tells whether   */
+                                /* the added memory is known to be      */
+                                /* zero-filled.                         */
 
 /*  Miscellaneous GC routines.  */
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_expand_hp_inner(word n);
+#ifdef GROW_HEAP_IN_PLACE
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_expand_hp_at(struct hblk *h, word n);
+                                /* Similar to MANAGED_STACK_ADDRESS_BOEHM_GC_expand_hp_inner but    */
+                                /* the new heap section should start    */
+                                /* exactly at h.  Fails if the address  */
+                                /* range is already occupied.           */
+#endif
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_start_reclaim(MANAGED_STACK_ADDRESS_BOEHM_GC_bool abort_if_found);
                                 /* Restore unmarked objects to free     */
                                 /* lists, or (if abort_if_found is      */
@@ -2297,6 +2502,26 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_collect
                                 /* A unit is an amount appropriate for  */
                                 /* HBLKSIZE bytes of allocation.        */
 
+struct mark_assist_s {
+  signed_word balance;  /* the marking debt (in bytes of allocation)    */
+                        /* of a thread if positive, credit if negative  */
+  word gc_no;           /* the value of MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no the balance is for     */
+};
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_assist(word bytes);
+                                /* Charge the current thread with bytes */
+                                /* of allocation, and let it pay its    */
+                                /* marking debt (if a collection is in  */
+                                /* progress) in a bounded step of       */
+                                /* MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner.           */
+
+#ifdef THREADS
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER struct mark_assist_s *MANAGED_STACK_ADDRESS_BOEHM_GC_self_mark_assist(void);
+                                /* The mark assist state of the current */
+                                /* thread, or NULL if the thread is not */
+                                /* registered.  Called holding the lock.*/
+#endif
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void * MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc_aligned(size_t lb, int k, unsigned flags,
                                           size_t align_m1);
 
@@ -2365,6 +2590,11 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_remove_
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER hdr * MANAGED_STACK_ADDRESS_BOEHM_GC_find_header(ptr_t h);
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_os_get_mem(size_t bytes);
+#ifdef GROW_HEAP_IN_PLACE
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_unix_get_mem_at(ptr_t addr, size_t bytes);
+                        /* Map bytes of fresh memory exactly at addr.   */
+                        /* Returns FALSE if the range is not available. */
+#endif
                         /* Get HBLKSIZE-aligned heap memory chunk from  */
                         /* the OS and add the chunk to MANAGED_STACK_ADDRESS_BOEHM_GC_our_memory.   */
                         /* Return NULL if out of memory.                */
@@ -2493,6 +2723,21 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGE
   MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_remap(ptr_t start, size_t bytes);
   MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_gap(ptr_t start1, size_t bytes1, ptr_t start2,
                              size_t bytes2);
+# ifdef SCAVENGER_THREAD
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER word MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_aged(unsigned32 age_ms, word max_bytes);
+                /* Unmap the free blocks not touched for at least       */
+                /* age_ms (by MANAGED_STACK_ADDRESS_BOEHM_GC_scavenge_ms clock) till max_bytes      */
+                /* (if non-zero) are unmapped.  Returns the amount of   */
+                /* the unmapped bytes.                                  */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger_inner(unsigned long age_ms,
+                                        size_t max_bytes_per_sec);
+# endif
+# ifdef USE_MADV_FREE
+    MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_lazy_unmap; /* defined in os_dep.c */
+                /* Use madvise(MADV_FREE) to unmap blocks (thus the     */
+                /* remapped ones are not known to be zero-filled).      */
+                /* Never reset once set.                                */
+# endif
 
 # ifndef NOT_GCBUILD
     /* Compute end address for an unmap operation on the indicated block. */
@@ -2503,6 +2748,144 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGE
 # endif
 #endif /* USE_MUNMAP */
 
+#ifdef MEMORY_CONTROLLER
+  MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN word MANAGED_STACK_ADDRESS_BOEHM_GC_soft_max_heapsize;
+                /* The amount of the mapped heap the expansion should   */
+                /* not exceed (unless a collection does not help), as   */
+                /* set by the memory controller; zero means no limit.   */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_memory_pressure;
+                /* Collect earlier (set by the memory controller).      */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_to_memory_limit(word limit, word current,
+                                          unsigned headroom_percent,
+                                          MANAGED_STACK_ADDRESS_BOEHM_GC_bool psi_pressure);
+                /* Set the above variables (and unmap the free blocks   */
+                /* under pressure) according to the cgroup memory limit */
+                /* and the current usage (limit is zero if unknown).    */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_cgroup_init(void);
+                /* Find the cgroup (v2) directory of the process.       */
+                /* Returns FALSE if not found.                          */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_cgroup_memory(word *plimit, word *pcurrent);
+                /* Read the lower of memory.max and memory.high, and    */
+                /* memory.current of the cgroup.  Returns FALSE unless  */
+                /* the cgroup has a memory limit.                       */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_psi_open(unsigned long stall_us);
+                /* Open the memory pressure (PSI) file of the cgroup    */
+                /* (or of the system) and set a trigger on stall_us of  */
+                /* some stall per the tracking window.  Returns the     */
+                /* file descriptor or -1.                               */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_psi_wait(int fd, unsigned long timeout_ms);
+                /* Wait for a pressure event on the given descriptor    */
+                /* (or just sleep if it is -1).  Returns 1 on the       */
+                /* event, 0 on timeout, -1 if fd is no longer usable.   */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_start_memory_controller_inner(unsigned headroom_percent,
+                                                unsigned long psi_stall_us);
+#endif
+
+#ifdef ENABLE_HEAP_PROFILE
+  /* The sampling counter of the heap profiler (per thread if the       */
+  /* thread-local allocation is on).                                    */
+  struct hprof_counter_s {
+    signed_word hc_bytes_left;  /* The amount of allocation till the    */
+                                /* next sample.                         */
+    word hc_period;             /* The value hc_bytes_left was last set */
+                                /* to; zero if the sampling was off.    */
+    unsigned32 hc_rng;          /* The random generator state.          */
+  };
+# ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_RETURN_ADDR
+#   define MANAGED_STACK_ADDRESS_BOEHM_GC_HPROF_RA MANAGED_STACK_ADDRESS_BOEHM_GC_RETURN_ADDR
+# else
+#   define MANAGED_STACK_ADDRESS_BOEHM_GC_HPROF_RA 0
+# endif
+                /* The caller address, used as the sample stack if the  */
+                /* call stacks could not be saved.                      */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN word MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_live; /* defined in heapprof.c */
+                /* The number of the tracked sampled objects.           */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sample(struct hprof_counter_s *pc, void *op,
+                                size_t lb, word ra);
+                /* Called once the counter goes negative after the      */
+                /* allocation of op (of lb bytes, might be NULL): takes */
+                /* a sample (unless the sampling is off) and rearms the */
+                /* counter.  Acquires the allocation lock.              */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sample_inner(struct hprof_counter_s *pc,
+                                      void *op, size_t lb, word ra);
+                /* Same as above but called with the lock held.         */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN struct hprof_counter_s MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_counter;
+                /* The counter shared by all threads (only for the      */
+                /* allocations not served by the thread-local free      */
+                /* lists if the latter are on), protected by the        */
+                /* allocation lock.                                     */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_count_global(void *op, size_t lb, word ra);
+                /* Count the allocation of op by the above counter.     */
+                /* Acquires the allocation lock.                        */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_forget(ptr_t p);
+                /* Stop tracking the explicitly deallocated p (if it is */
+                /* sampled).  Called with the lock held, only if        */
+                /* MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_live is non-zero.                         */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sweep(void);
+                /* Stop tracking the sampled objects which are not      */
+                /* marked.  Called before the reclaim phase.            */
+#endif
+
+#if defined(ENABLE_EVENT_TRACE) && defined(NO_CLOCK)
+# undef ENABLE_EVENT_TRACE /* no timestamps */
+#endif
+
+#ifdef ENABLE_EVENT_TRACE
+  /* The kinds of the traced spans (the names are given in evtrace.c).  */
+# define EVTRACE_COLLECTION 0
+# define EVTRACE_PAUSE 1
+# define EVTRACE_STOP_WORLD 2
+# define EVTRACE_MARK 3
+# define EVTRACE_START_WORLD 4
+# define EVTRACE_PUSH_ROOTS 5
+# define EVTRACE_MARK_HELPER 6
+# define EVTRACE_PARALLEL_TASK 7
+# define EVTRACE_FINISH_COLLECTION 8
+# define EVTRACE_FINALIZE 9
+# define EVTRACE_START_RECLAIM 10
+# define EVTRACE_RECLAIM_ALL 11
+# define EVTRACE_SWEEP 12
+# define EVTRACE_UNMAP 13
+# define EVTRACE_EXPAND_HEAP 14
+# define EVTRACE_N_KINDS 15
+
+  struct evtrace_span_s {
+    CLOCK_TYPE es_start;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool es_on;
+  };
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_on; /* defined in evtrace.c */
+                /* Whether new spans are recorded.  Changed only with   */
+                /* the allocation lock held.                            */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_start(CLOCK_TYPE *pstart);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_record(unsigned slot, unsigned kind,
+                                  const CLOCK_TYPE *pstart,
+                                  word arg1, word arg2);
+                /* Record a span started at *pstart and ending now to   */
+                /* the ring buffer of the given slot: zero is for the   */
+                /* allocation lock holder, the others are for the       */
+                /* parallel mark helpers (by their id).  A ring is      */
+                /* written by one thread at a time (the helper slots    */
+                /* are written with the mark lock held), thus no lock   */
+                /* or atomic update is needed.                          */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_write_at_exit(const char *path);
+                /* Turn the tracing on, and write the trace to the      */
+                /* given file at the process exit.                      */
+
+# define EVTRACE_SPAN(sp) struct evtrace_span_s sp;
+# define EVTRACE_BEGIN(sp) \
+        (void)((sp).es_on = EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_on, FALSE) \
+                            && (MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_start(&(sp).es_start), TRUE))
+# define EVTRACE_END(sp, slot, kind, arg1, arg2) \
+        (void)(!(sp).es_on \
+               || (MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_record(slot, kind, &(sp).es_start, \
+                                     (word)(arg1), (word)(arg2)), TRUE))
+#else
+# define EVTRACE_SPAN(sp) /* empty */
+# define EVTRACE_BEGIN(sp) (void)0
+# define EVTRACE_END(sp, slot, kind, arg1, arg2) (void)0
+#endif
+
 #ifdef CAN_HANDLE_FORK
   MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN int MANAGED_STACK_ADDRESS_BOEHM_GC_handle_fork;
                 /* Fork-handling mode:                                  */
@@ -2581,6 +2964,10 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_EXTERN MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGE
 
 # define MANAGED_STACK_ADDRESS_BOEHM_GC_auto_incremental (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && !MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb)
 
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_card_table_init(void);
+                /* Allocate MANAGED_STACK_ADDRESS_BOEHM_GC_card_table (if not yet) for the manual   */
+                /* VDB mode.  Returns false on failure.                 */
+
   MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_inner(const void *p); /* does not require locking */
 # define MANAGED_STACK_ADDRESS_BOEHM_GC_dirty(p) (MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb ? MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_inner(p) : (void)0)
 # define REACHABLE_AFTER_DIRTY(p) MANAGED_STACK_ADDRESS_BOEHM_GC_reachable_here(p)
@@ -2735,6 +2735,52 @@ EXTERN_C_BEGIN
 # define MMAP_SUPPORTED
 #endif
 
+#if defined(LINUX) && defined(USE_MMAP) && !defined(USE_MMAP_FIXED) \
+    && !defined(NO_UNIX_GET_MEM) && !defined(PLATFORM_GETMEM) \
+    && !defined(EMSCRIPTEN) && !defined(NO_GROW_HEAP_IN_PLACE) \
+    && !defined(GROW_HEAP_IN_PLACE)
+  /* Allow mapping fresh memory right after the end of a heap section,  */
+  /* so that huge objects could be grown by MANAGED_STACK_ADDRESS_BOEHM_GC_realloc in place.    */
+# define GROW_HEAP_IN_PLACE
+#endif
+
+#if (defined(LINUX) || defined(ANY_BSD) || defined(DARWIN) \
+     || defined(SOLARIS)) && defined(USE_MMAP) \
+    && !defined(NO_UNIX_GET_MEM) && !defined(PLATFORM_GETMEM) \
+    && !defined(EMSCRIPTEN) && !defined(NO_GET_MEM_ZEROED) \
+    && !defined(GET_MEM_ZEROED)
+  /* Memory returned by GET_MEM (an anonymous mapping) is zero-filled.  */
+# define GET_MEM_ZEROED
+#endif
+
+#if defined(X86_64) && !defined(USE_NT_CLEAR) && !defined(NO_NT_CLEAR) \
+    && (MANAGED_STACK_ADDRESS_BOEHM_GC_GNUC_PREREQ(5, 0) || MANAGED_STACK_ADDRESS_BOEHM_GC_CLANG_PREREQ(3, 8)) \
+    && !defined(CPPCHECK) && !defined(SMALL_CONFIG)
+  /* Clear large chunks with non-temporal (streaming) SSE2 stores, and  */
+  /* small objects being reclaimed with AVX stores (if the CPU supports */
+  /* them, as detected at MANAGED_STACK_ADDRESS_BOEHM_GC_init).                                 */
+# define USE_NT_CLEAR
+#endif
+
+#if defined(USE_MUNMAP) && !defined(UNMAP_DISCARDS_CONTENT) \
+    && !defined(NO_UNMAP_DISCARDS_CONTENT) \
+    && (defined(USE_WINALLOC) \
+        || (!defined(AIX) && !defined(CYGWIN32) && !defined(HAIKU) \
+            && !defined(HPUX) && !defined(SN_TARGET_PS3)))
+  /* MANAGED_STACK_ADDRESS_BOEHM_GC_unmap drops the content of the pages (the ones remapped     */
+  /* later read as zero); i.e. it uses mmap(MAP_FIXED) or, on Linux,    */
+  /* madvise(MADV_DONTNEED), or decommits the pages on Win32.           */
+# define UNMAP_DISCARDS_CONTENT
+#endif
+
+#if defined(LINUX) && defined(USE_MUNMAP) && !defined(PREFER_MMAP_PROT_NONE) \
+    && !defined(NO_MADV_FREE) && !defined(USE_MADV_FREE)
+  /* MANAGED_STACK_ADDRESS_BOEHM_GC_unmap may be switched (at runtime) to madvise(MADV_FREE),       */
+  /* so that the kernel reclaims the pages only under memory pressure   */
+  /* and a reuse of the ones not reclaimed yet costs no page fault.     */
+# define USE_MADV_FREE
+#endif
+
 /* Xbox One (DURANGO) may not need to be this aggressive, but the       */
 /* default is likely too lax under heavy allocation pressure.           */
 /* The platform does not have a virtual paging system, so it does not   */
@@ -2789,6 +2835,14 @@ EXTERN_C_BEGIN
 # endif
 #endif /* SOFT_VDB */
 
+#if defined(SOFT_VDB) && !defined(CHECK_SOFT_VDB) && !defined(NO_UFFD_VDB) \
+    && !defined(UFFD_VDB)
+  /* Prefer the userfaultfd write-protection (in the asynchronous mode) */
+  /* combined with PAGEMAP_SCAN ioctl to the soft-dirty bits, if both   */
+  /* are supported by the kernel at runtime.                            */
+# define UFFD_VDB
+#endif
+
 #ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_DISABLE_INCREMENTAL
 # undef CHECKSUMS
 #endif
@@ -3168,6 +3222,43 @@ EXTERN_C_BEGIN
 # define HAVE_CLOCK_GETTIME 1
 #endif
 
+#if defined(USE_MUNMAP) && defined(MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS) \
+    && !defined(MANAGED_STACK_ADDRESS_BOEHM_GC_WIN32_THREADS) && !defined(NO_CLOCK) \
+    && (defined(HAVE_CLOCK_GETTIME) || defined(BSD_TIME)) \
+    && !defined(SMALL_CONFIG) && !defined(NO_SCAVENGER_THREAD) \
+    && !defined(SCAVENGER_THREAD)
+  /* Support a background thread returning the free blocks to the OS    */
+  /* once they stay unused for a given wall-clock time.                 */
+# define SCAVENGER_THREAD
+#endif
+
+#if defined(LINUX) && defined(MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS) && !defined(SMALL_CONFIG) \
+    && !defined(NO_MEMORY_CONTROLLER) && !defined(MEMORY_CONTROLLER)
+  /* Support a background thread limiting the heap growth by the cgroup */
+  /* (v2) memory limits and reacting to the PSI memory pressure events. */
+# define MEMORY_CONTROLLER
+#endif
+
+#if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS) && !defined(MANAGED_STACK_ADDRESS_BOEHM_GC_WIN32_THREADS) \
+    && !defined(SN_TARGET_ORBIS) && !defined(SN_TARGET_PSP2) \
+    && !defined(MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION) && !defined(SMALL_CONFIG) \
+    && !defined(NO_FINALIZER_THREADS) && !defined(FINALIZER_THREADS)
+  /* Support a pool of the collector-created threads running the ready  */
+  /* finalizers.                                                        */
+# define FINALIZER_THREADS
+#endif
+
+#if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS) && !defined(MANAGED_STACK_ADDRESS_BOEHM_GC_WIN32_THREADS) \
+    && !defined(SN_TARGET_ORBIS) && !defined(SN_TARGET_PSP2) \
+    && !defined(MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION) && !defined(SMALL_CONFIG) \
+    && !defined(NO_STRIPED_FNLZ_TABLES) && !defined(STRIPED_FNLZ_TABLES)
+  /* Split the finalization and disappearing link hash tables into      */
+  /* independently locked and resized stripes, so that the clients      */
+  /* could register and unregister the entries concurrently (without    */
+  /* acquiring the allocation lock in most cases).                      */
+# define STRIPED_FNLZ_TABLES
+#endif
+
 #if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS) && !defined(E2K) && !defined(IA64) \
     && (!defined(DARWIN) || defined(DARWIN_DONT_PARSE_STACK)) \
     && !defined(SN_TARGET_PSP2) && !defined(REDIRECT_MALLOC)
@@ -3397,9 +3488,8 @@ EXTERN_C_BEGIN
         /* 0 is taken to mean failure.                                  */
         /* In case of MMAP_SUPPORTED, the argument must also be         */
         /* a multiple of a physical page size.                          */
-        /* GET_MEM is currently not assumed to retrieve 0 filled space, */
-        /* though we should perhaps take advantage of the case in which */
-        /* does.                                                        */
+        /* GET_MEM is not assumed to retrieve 0 filled space unless     */
+        /* GET_MEM_ZEROED is defined.                                   */
 # define hblk MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_s
   struct hblk;  /* See gc_priv.h. */
 # if defined(PCR)
@@ -196,6 +196,9 @@ typedef struct MANAGED_STACK_ADDRESS_BOEHM_GC_Thread_Rep {
                                 /* not need a signal sent to stop it.   */
 # ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_WIN32_THREADS
 #   define IS_SUSPENDED 0x40    /* Thread is suspended by SuspendThread. */
+# endif
+# ifdef FINALIZER_THREADS
+#   define FINALIZER_THREAD 0x80 /* Thread is a finalizer pool thread.  */
 # endif
 
   char flags_pad[sizeof(word) - 1 /* sizeof(flags) */];
@@ -228,6 +231,11 @@ typedef struct MANAGED_STACK_ADDRESS_BOEHM_GC_Thread_Rep {
                                 /* and detach.                          */
 # endif
 
+  struct mark_assist_s mark_assist;
+                                /* The marking debt of the thread in    */
+                                /* the incremental mode.  Protected by  */
+                                /* GC lock.                             */
+
 # ifdef THREAD_LOCAL_ALLOC
     struct thread_local_freelists tlfs MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_WORD_ALIGNED;
 # endif
@@ -137,6 +137,10 @@ typedef struct thread_local_freelists {
 # define DIRECT_GRANULES (HBLKSIZE/MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES)
         /* Don't use local free lists for up to this much       */
         /* allocation.                                          */
+# ifdef ENABLE_HEAP_PROFILE
+    struct hprof_counter_s hprof_counter;
+        /* The sampling counter of the heap profiler.           */
+# endif
 } *MANAGED_STACK_ADDRESS_BOEHM_GC_tlfs;
 
 #if defined(USE_PTHREAD_SPECIFIC)
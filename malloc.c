@@ -52,7 +52,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_
     /* Do our share of marking work.    */
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && !MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc) {
             ENTER_GC();
-            MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner((int)n_blocks);
+            MANAGED_STACK_ADDRESS_BOEHM_GC_mark_assist(n_blocks * HBLKSIZE);
             EXIT_GC();
     }
 
@@ -90,9 +90,10 @@ STATIC ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_large_and_clear(size_t lb, int
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
     result = MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_large(lb, k, flags, 0 /* align_m1 */);
     if (EXPECT(result != NULL, TRUE)
+          && !MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_take_zeroed(HDR(result))
           && (MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started || MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[k].ok_init)) {
         /* Clear the whole block, in case of MANAGED_STACK_ADDRESS_BOEHM_GC_realloc call. */
-        BZERO(result, HBLKSIZE * OBJ_SZ_TO_BLOCKS(lb));
+        BZERO_LARGE(result, HBLKSIZE * OBJ_SZ_TO_BLOCKS(lb));
     }
     return result;
 }
@@ -270,12 +271,15 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void * MANAGED_STACK_ADDRESS_BOEHM_GC_gener
         LOCK();
         result = MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_large(lb_rounded, k, flags, align_m1);
         if (EXPECT(result != NULL, TRUE)) {
-          if (MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started
+          if (MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_take_zeroed(HDR(result))) {
+            /* The block is fresh, nothing to clear.    */
+            init = FALSE;
+          } else if (MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started
 #             ifndef THREADS
                 || init
 #             endif
              ) {
-            BZERO(result, HBLKSIZE * OBJ_SZ_TO_BLOCKS(lb_rounded));
+            BZERO_LARGE(result, HBLKSIZE * OBJ_SZ_TO_BLOCKS(lb_rounded));
           } else {
 #           ifdef THREADS
               MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(GRANULES_TO_WORDS(lg) >= 2);
@@ -292,8 +296,9 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void * MANAGED_STACK_ADDRESS_BOEHM_GC_gener
 #       ifdef THREADS
           if (init && !MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started && result != NULL) {
             /* Clear the rest (i.e. excluding the initial 2 words). */
-            BZERO((word *)result + 2,
-                  HBLKSIZE * OBJ_SZ_TO_BLOCKS(lb_rounded) - 2 * sizeof(word));
+            BZERO_LARGE((word *)result + 2,
+                        HBLKSIZE * OBJ_SZ_TO_BLOCKS(lb_rounded)
+                        - 2 * sizeof(word));
           }
 #       endif
     }
@@ -331,15 +336,31 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC vo
                 obj_link(op) = 0;
             }
             MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_allocd += GRANULES_TO_BYTES((word)lg);
+#           if defined(ENABLE_HEAP_PROFILE) && !defined(THREAD_LOCAL_ALLOC)
+              if (EXPECT((MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_counter.hc_bytes_left
+                          -= (signed_word)lb) < 0, FALSE))
+                MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sample_inner(&MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_counter, op, lb,
+                                      MANAGED_STACK_ADDRESS_BOEHM_GC_HPROF_RA);
+#           endif
             UNLOCK();
             return op;
         }
         UNLOCK();
     }
 
-    /* We make the MANAGED_STACK_ADDRESS_BOEHM_GC_clear_stack() call a tail one, hoping to get more */
-    /* of the stack.                                                    */
-    return MANAGED_STACK_ADDRESS_BOEHM_GC_clear_stack(MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc_aligned(lb, k, 0 /* flags */, 0));
+#   if defined(ENABLE_HEAP_PROFILE) && !defined(THREAD_LOCAL_ALLOC)
+      {
+        void *op = MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc_aligned(lb, k, 0 /* flags */, 0);
+
+        if (op != NULL) MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_count_global(op, lb, MANAGED_STACK_ADDRESS_BOEHM_GC_HPROF_RA);
+        return MANAGED_STACK_ADDRESS_BOEHM_GC_clear_stack(op);
+      }
+#   else
+      /* We make the MANAGED_STACK_ADDRESS_BOEHM_GC_clear_stack() call a tail one, hoping to get    */
+      /* more of the stack.                                             */
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_clear_stack(MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc_aligned(lb, k, 0 /* flags */,
+                                                      0));
+#   endif
 }
 
 #if defined(THREADS) && !defined(THREAD_LOCAL_ALLOC)
@@ -590,6 +611,10 @@ static void free_internal(void *p, hdr *hhdr)
 
   MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_freed += sz;
   if (IS_UNCOLLECTABLE(k)) MANAGED_STACK_ADDRESS_BOEHM_GC_non_gc_bytes -= sz;
+# ifdef ENABLE_HEAP_PROFILE
+    if (EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_n_live != 0, FALSE))
+      MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_forget((ptr_t)p);
+# endif
   if (EXPECT(ngranules <= MAXOBJGRANULES, TRUE)) {
     struct obj_kind *ok = &MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[k];
     void **flh;
@@ -608,6 +633,13 @@ static void free_internal(void *p, hdr *hhdr)
     if (sz > HBLKSIZE) {
       MANAGED_STACK_ADDRESS_BOEHM_GC_large_allocd_bytes -= HBLKSIZE * OBJ_SZ_TO_BLOCKS(sz);
     }
+#   ifdef USE_MUNMAP
+      if (sz >= HUGE_OBJ_BYTES) {
+        /* Do not wait for MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_old to return it to the OS.   */
+        MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk_and_unmap(HBLKPTR(p));
+        return;
+      }
+#   endif
     MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk(HBLKPTR(p));
   }
 }
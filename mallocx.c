@@ -68,8 +68,55 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC vo
     }
 }
 
+/* Try to grow the large object (starting at h) to hold lb bytes      */
+/* without moving it.  The heap blocks immediately following the      */
+/* object are taken if they are free; otherwise, for a huge object,   */
+/* fresh memory is mapped right after its end, if possible.  The      */
+/* taken memory is cleared unless known to be zero-filled.  Returns   */
+/* the new size (a multiple of HBLKSIZE), or 0 on failure.            */
+static size_t grow_large_in_place(struct hblk *h, size_t lb)
+{
+    hdr *hhdr;
+    size_t old_bytes, new_bytes;
+    int obj_kind;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool zeroed;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    hhdr = HDR(h);
+    obj_kind = hhdr -> hb_obj_kind;
+    old_bytes = HBLKSIZE * OBJ_SZ_TO_BLOCKS(hhdr -> hb_sz);
+    new_bytes = HBLKSIZE * OBJ_SZ_TO_BLOCKS_CHECKED(lb);
+    if (new_bytes >= (MANAGED_STACK_ADDRESS_BOEHM_GC_SIZE_MAX >> 1)) return 0;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(new_bytes > old_bytes);
+    if (!MANAGED_STACK_ADDRESS_BOEHM_GC_extend_hblk(h, new_bytes, &zeroed)) {
+#     ifdef GROW_HEAP_IN_PLACE
+        if (old_bytes < HUGE_OBJ_BYTES
+            || !MANAGED_STACK_ADDRESS_BOEHM_GC_expand_hp_at(h + divHBLKSZ(old_bytes),
+                                divHBLKSZ(new_bytes - old_bytes))
+            || !MANAGED_STACK_ADDRESS_BOEHM_GC_extend_hblk(h, new_bytes, &zeroed))
+#     endif
+      {
+        return 0;
+      }
+    }
+    if (!zeroed
+        && (MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started || MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[obj_kind].ok_init))
+      BZERO_LARGE((ptr_t)h + old_bytes, new_bytes - old_bytes);
+
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[obj_kind].ok_relocate_descr)
+      hhdr -> hb_descr += new_bytes - hhdr -> hb_sz;
+    hhdr -> hb_sz = new_bytes;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_allocd += new_bytes - old_bytes;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_large_allocd_bytes += new_bytes - old_bytes;
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_large_allocd_bytes > MANAGED_STACK_ADDRESS_BOEHM_GC_max_large_allocd_bytes)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_max_large_allocd_bytes = MANAGED_STACK_ADDRESS_BOEHM_GC_large_allocd_bytes;
+    if (IS_UNCOLLECTABLE(obj_kind)) MANAGED_STACK_ADDRESS_BOEHM_GC_non_gc_bytes += new_bytes - old_bytes;
+    return new_bytes;
+}
+
 /* Change the size of the block pointed to by p to contain at least   */
-/* lb bytes.  The object may be (and quite likely will be) moved.     */
+/* lb bytes.  The object may be (and quite likely will be) moved,    */
+/* unless it is a large one followed by enough free heap blocks.      */
 /* The kind (e.g. atomic) is the same as that of the old.             */
 /* Shrinking of large blocks is not implemented well.                 */
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_realloc(void * p, size_t lb)
@@ -150,6 +197,18 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MA
 #         endif
           if (IS_UNCOLLECTABLE(obj_kind)) MANAGED_STACK_ADDRESS_BOEHM_GC_non_gc_bytes += (sz - orig_sz);
           /* Extra area is already cleared by MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_large_and_clear. */
+
+          if (ADD_EXTRA_BYTES(lb) > sz) {
+            size_t new_sz;
+
+            LOCK();
+            new_sz = grow_large_in_place(h, ADD_EXTRA_BYTES(lb));
+            UNLOCK();
+            if (new_sz != 0) {
+              MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(ADD_EXTRA_BYTES(lb) <= new_sz);
+              return p;
+            }
+          }
     }
     if (ADD_EXTRA_BYTES(lb) <= sz) {
         if (lb >= (sz >> 1)) {
@@ -297,10 +356,11 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
     MANAGED_STACK_ADDRESS_BOEHM_GC_DBG_COLLECT_AT_MALLOC(lb);
     if (!EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized, TRUE)) MANAGED_STACK_ADDRESS_BOEHM_GC_init();
     LOCK();
-    /* Do our share of marking work */
+    /* Do our share of marking work (about a block of objects is        */
+    /* returned).                                                       */
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_incremental && !MANAGED_STACK_ADDRESS_BOEHM_GC_dont_gc) {
         ENTER_GC();
-        MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little_inner(1);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_mark_assist(HBLKSIZE);
         EXIT_GC();
       }
     /* First see if we can reclaim a page of objects waiting to be */
@@ -407,6 +467,9 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
         struct hblk *h = MANAGED_STACK_ADDRESS_BOEHM_GC_allochblk(lb, k, 0 /* flags */, 0 /* align_m1 */);
 
         if (h /* != NULL */) { /* CPPCHECK */
+          MANAGED_STACK_ADDRESS_BOEHM_GC_bool clear = !MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_take_zeroed(HDR(h))
+                        && (ok -> ok_init || MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started);
+
           if (IS_UNCOLLECTABLE(k)) MANAGED_STACK_ADDRESS_BOEHM_GC_set_hdr_marks(HDR(h));
           MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_allocd += HBLKSIZE - HBLKSIZE % lb;
 #         ifdef PARALLEL_MARK
@@ -416,8 +479,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
               UNLOCK();
               MANAGED_STACK_ADDRESS_BOEHM_GC_release_mark_lock();
 
-              op = MANAGED_STACK_ADDRESS_BOEHM_GC_build_fl(h, lw,
-                        (ok -> ok_init || MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started), 0);
+              op = MANAGED_STACK_ADDRESS_BOEHM_GC_build_fl(h, lw, clear, 0);
 
               *result = op;
               MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_mark_lock();
@@ -428,7 +490,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
               return;
             }
 #         endif
-          op = MANAGED_STACK_ADDRESS_BOEHM_GC_build_fl(h, lw, (ok -> ok_init || MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started), 0);
+          op = MANAGED_STACK_ADDRESS_BOEHM_GC_build_fl(h, lw, clear, 0);
           goto out;
         }
     }
@@ -464,7 +526,8 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC vo
 /* - store_debug_info() should return the pointer of the object with    */
 /* the requested alignment (unlike the object header).                  */
 
-MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_memalign(size_t align, size_t lb)
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_memalign_kind(size_t align,
+                                                      size_t lb, int k)
 {
     size_t offset;
     ptr_t result;
@@ -472,17 +535,17 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC vo
 
     /* Check the alignment argument.    */
     if (EXPECT(0 == align || (align & align_m1) != 0, FALSE)) return NULL;
-    if (align <= MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES) return MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(lb);
+    if (align <= MANAGED_STACK_ADDRESS_BOEHM_GC_GRANULE_BYTES) return MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind(lb, k);
 
     if (align >= HBLKSIZE/2 || lb >= HBLKSIZE/2) {
-      return MANAGED_STACK_ADDRESS_BOEHM_GC_clear_stack(MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc_aligned(lb, NORMAL,
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_clear_stack(MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc_aligned(lb, k,
                                         0 /* flags */, align_m1));
     }
 
     /* We could also try to make sure that the real rounded-up object size */
     /* is a multiple of align.  That would be correct up to HBLKSIZE.      */
     /* TODO: Not space efficient for big align values. */
-    result = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(SIZET_SAT_ADD(lb, align_m1));
+    result = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind(SIZET_SAT_ADD(lb, align_m1), k);
             /* It is OK not to check result for NULL as in that case    */
             /* MANAGED_STACK_ADDRESS_BOEHM_GC_memalign returns NULL too since (0 + 0 % align) is 0. */
     offset = (size_t)(word)result & align_m1;
@@ -499,6 +562,11 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC vo
     return result;
 }
 
+MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC void * MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_memalign(size_t align, size_t lb)
+{
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_memalign_kind(align, lb, NORMAL);
+}
+
 /* This one exists largely to redirect posix_memalign for leaks finding. */
 MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_posix_memalign(void **memptr, size_t align, size_t lb)
 {
@@ -270,9 +270,13 @@ static void alloc_mark_stack(size_t);
 
 static void push_roots_and_advance(MANAGED_STACK_ADDRESS_BOEHM_GC_bool push_all, ptr_t cold_gc_frame)
 {
+  EVTRACE_SPAN(sp)
+
   if (MANAGED_STACK_ADDRESS_BOEHM_GC_scan_ptr != NULL) return; /* not ready to push */
 
+  EVTRACE_BEGIN(sp);
   MANAGED_STACK_ADDRESS_BOEHM_GC_push_roots(push_all, cold_gc_frame);
+  EVTRACE_END(sp, 0, EVTRACE_PUSH_ROOTS, push_all, 0);
   MANAGED_STACK_ADDRESS_BOEHM_GC_objects_are_marked = TRUE;
   if (MANAGED_STACK_ADDRESS_BOEHM_GC_mark_state != MS_INVALID)
     MANAGED_STACK_ADDRESS_BOEHM_GC_mark_state = MS_ROOTS_PUSHED;
@@ -1042,7 +1046,13 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_do_local_mark(mse *local_mark_stack,
 STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_local(mse *local_mark_stack, int id)
 {
     mse * my_first_nonempty;
+#   ifdef ENABLE_EVENT_TRACE
+      word n_steals = 0;
+      word n_stolen = 0;
+#   endif
+    EVTRACE_SPAN(sp)
 
+    EVTRACE_BEGIN(sp);
     MANAGED_STACK_ADDRESS_BOEHM_GC_active_count++;
     my_first_nonempty = (mse *)AO_load(&MANAGED_STACK_ADDRESS_BOEHM_GC_first_nonempty);
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack <= (word)my_first_nonempty);
@@ -1107,6 +1117,10 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_local(mse *local_mark_stack, int
                     MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count--;
                     if (0 == MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count) need_to_notify = TRUE;
                     MANAGED_STACK_ADDRESS_BOEHM_GC_VERBOSE_LOG_PRINTF("Finished mark helper %d\n", id);
+                    /* The slot of the helper might be reused once we   */
+                    /* release the mark lock.                           */
+                    EVTRACE_END(sp, (unsigned)id, EVTRACE_MARK_HELPER,
+                                n_steals, n_stolen);
                     if (need_to_notify) MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_marker();
                     return;
                 }
@@ -1127,6 +1141,12 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_mark_local(mse *local_mark_stack, int
         local_top = MANAGED_STACK_ADDRESS_BOEHM_GC_steal_mark_stack(my_first_nonempty, my_top,
                                         local_mark_stack, n_to_get,
                                         &my_first_nonempty);
+#       ifdef ENABLE_EVENT_TRACE
+          if ((word)local_top >= (word)local_mark_stack) {
+            n_steals++;
+            n_stolen += (word)(local_top - local_mark_stack) + 1;
+          }
+#       endif
         MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)my_first_nonempty >= (word)MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack &&
                   (word)my_first_nonempty <=
                         (word)AO_load((volatile AO_t *)&MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_top)
@@ -1168,6 +1188,58 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_do_parallel_mark(void)
     MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_marker();
 }
 
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_mark_from_mark_stack(void)
+{
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_parallel);
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_empty()) return;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_do_parallel_mark();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((word)MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_top < (word)MANAGED_STACK_ADDRESS_BOEHM_GC_first_nonempty);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_top = MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack - 1;
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_too_small) {
+      alloc_mark_stack(2*MANAGED_STACK_ADDRESS_BOEHM_GC_mark_stack_size);
+    }
+}
+
+/* The task run by the helpers instead of marking, if any.  Both are    */
+/* protected by the mark lock.                                          */
+STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_proc MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task = 0;
+STATIC void *MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_data = NULL;
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_do_parallel_task(MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_proc fn,
+                                  void *client_data)
+{
+    EVTRACE_SPAN(sp)
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_parallel);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_mark_lock();
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_help_wanted || MANAGED_STACK_ADDRESS_BOEHM_GC_active_count != 0 || MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count != 0)
+        ABORT("Tried to start parallel task in bad state");
+    MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task = fn;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_data = client_data;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count = 1;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_help_wanted = TRUE;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_release_mark_lock();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_marker();
+        /* Wake up potential helpers.   */
+    EVTRACE_BEGIN(sp);
+    fn(client_data);
+    EVTRACE_END(sp, 0, EVTRACE_PARALLEL_TASK, 0, 0);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_mark_lock();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_help_wanted = FALSE;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count--;
+    while (MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count > 0) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_wait_marker();
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task = 0;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_data = NULL;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_mark_no++;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_release_mark_lock();
+    MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_marker();
+}
+
 /* Try to help out the marker, if it's running.  We hold the mark lock  */
 /* only, the initiating thread holds the allocation lock.               */
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_help_marker(word my_mark_no)
@@ -1190,6 +1262,19 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_help_ma
       return;
     }
     MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count = (unsigned)my_id + 1;
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task != 0) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_proc fn = MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task;
+      void *client_data = MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_task_data;
+      EVTRACE_SPAN(sp)
+
+      EVTRACE_BEGIN(sp);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_release_mark_lock();
+      fn(client_data);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_mark_lock();
+      EVTRACE_END(sp, (unsigned)my_id, EVTRACE_PARALLEL_TASK, 0, 0);
+      if (0 == --MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count) MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_marker();
+      return;
+    }
     MANAGED_STACK_ADDRESS_BOEHM_GC_mark_local(local_mark_stack, (int)my_id);
     /* MANAGED_STACK_ADDRESS_BOEHM_GC_mark_local decrements MANAGED_STACK_ADDRESS_BOEHM_GC_helper_count. */
 #   undef my_id
@@ -41,6 +41,13 @@
 # include <floss.h>
 #endif
 
+#ifdef ENABLE_HEAP_PROFILE
+# include "gc/gc_heap_profile.h"
+#endif
+#ifdef ENABLE_EVENT_TRACE
+# include "gc/gc_event_trace.h"
+#endif
+
 #ifdef THREADS
 # ifdef PCR
 #   include "il/PCR_IL.h"
@@ -1145,6 +1152,25 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
         }
       }
 #   endif
+#   ifndef NO_CLOCK
+      {
+        char * pause_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_PACER_PAUSE_US");
+        if (pause_string != NULL) {
+          long max_pause_us = atol(pause_string);
+          char * percent_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_PACER_PERCENT");
+          int gc_percent = percent_string != NULL ? atoi(percent_string)
+                                                  : 0;
+
+          if (max_pause_us > 0 && gc_percent >= 0 && gc_percent < 100) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target((unsigned long)max_pause_us,
+                                (unsigned)gc_percent);
+          } else {
+            WARN("MANAGED_STACK_ADDRESS_BOEHM_GC_PACER_PAUSE_US or MANAGED_STACK_ADDRESS_BOEHM_GC_PACER_PERCENT environment"
+                 " variable has bad value - ignoring\n", 0);
+          }
+        }
+      }
+#   endif
 #   ifndef SMALL_CONFIG
       {
         char * full_freq_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_FULL_FREQUENCY");
@@ -1275,6 +1301,9 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
       MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(!((word)MANAGED_STACK_ADDRESS_BOEHM_GC_stackbottom HOTTER_THAN (word)MANAGED_STACK_ADDRESS_BOEHM_GC_approx_sp()));
 #   endif
     MANAGED_STACK_ADDRESS_BOEHM_GC_init_headers();
+#   ifdef USE_NT_CLEAR
+      MANAGED_STACK_ADDRESS_BOEHM_GC_init_clear_kernels();
+#   endif
 #   ifdef SEARCH_FOR_DATA_START
       /* For MPROTECT_VDB, the temporary fault handler should be        */
       /* installed first, before the write fault one in MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_init.  */
@@ -1287,7 +1316,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
            || defined(SMALL_CONFIG)
           /* TODO: Implement CHECKSUMS for manual VDB. */
 #       else
-          if (manual_vdb_allowed) {
+          if (manual_vdb_allowed && MANAGED_STACK_ADDRESS_BOEHM_GC_card_table_init()) {
               MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb = TRUE;
               MANAGED_STACK_ADDRESS_BOEHM_GC_incremental = TRUE;
           } else
@@ -1400,6 +1429,77 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
       /* Initialize thread-local allocation.    */
       MANAGED_STACK_ADDRESS_BOEHM_GC_init_parallel();
 #   endif
+#   ifdef SCAVENGER_THREAD
+      {
+        char * age_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_SCAVENGE_AGE_MS");
+
+        if (age_string != NULL) {
+          char * rate_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_SCAVENGE_RATE");
+          long age_ms = atol(age_string);
+          long rate = rate_string != NULL ? atol(rate_string) : 0;
+
+          if (age_ms > 0)
+            (void)MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger((unsigned long)age_ms,
+                                     rate > 0 ? (size_t)rate : 0);
+        }
+      }
+#   endif
+#   ifdef MEMORY_CONTROLLER
+      {
+        char * mc_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_MEMORY_CONTROLLER");
+
+        if (mc_string != NULL) {
+          char * headroom_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_MEMORY_HEADROOM_PERCENT");
+          char * stall_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_PSI_STALL_US");
+          long headroom = headroom_string != NULL ? atol(headroom_string)
+                                                  : 10;
+          long stall_us = stall_string != NULL ? atol(stall_string)
+                                               : 100000L;
+
+          (void)MANAGED_STACK_ADDRESS_BOEHM_GC_start_memory_controller(
+                                headroom > 0 ? (unsigned)headroom : 0,
+                                stall_us > 0 ? (unsigned long)stall_us : 0);
+        }
+      }
+#   endif
+#   ifdef FINALIZER_THREADS
+      {
+        char * threads_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_FINALIZER_THREADS");
+
+        if (threads_string != NULL) {
+          char * backlog_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_FINALIZER_BACKLOG");
+          int n = atoi(threads_string);
+          long backlog = backlog_string != NULL ? atol(backlog_string) : 0;
+
+          if (n > 0)
+            (void)MANAGED_STACK_ADDRESS_BOEHM_GC_start_finalizer_threads((unsigned)n,
+                                backlog > 0 ? (MANAGED_STACK_ADDRESS_BOEHM_GC_word)backlog : 0);
+        }
+      }
+#   endif
+#   ifdef ENABLE_HEAP_PROFILE
+      {
+        char * interval_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_HEAP_PROFILE_INTERVAL");
+
+        if (interval_string != NULL) {
+          long interval = atol(interval_string);
+
+          if (interval > 0)
+            MANAGED_STACK_ADDRESS_BOEHM_GC_set_heap_profile_interval((MANAGED_STACK_ADDRESS_BOEHM_GC_word)interval);
+        }
+      }
+#   endif
+#   ifdef ENABLE_EVENT_TRACE
+      {
+        char * file_string = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_TRACE_FILE");
+
+        if (file_string != NULL) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_evtrace_write_at_exit(file_string);
+        } else if (GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_EVENT_TRACE") != NULL) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_set_event_tracing(1);
+        }
+      }
+#   endif
 
 #   if defined(DYNAMIC_LOADING) && defined(DARWIN)
         /* This must be called WITHOUT the allocation lock held */
@@ -1436,7 +1536,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANA
 #         if !defined(BASE_ATOMIC_OPS_EMULATED) && !defined(CHECKSUMS) \
              && !defined(REDIRECT_MALLOC) \
              && !defined(REDIRECT_MALLOC_IN_HEADER) && !defined(SMALL_CONFIG)
-            if (manual_vdb_allowed) {
+            if (manual_vdb_allowed && MANAGED_STACK_ADDRESS_BOEHM_GC_card_table_init()) {
               MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb = TRUE;
               MANAGED_STACK_ADDRESS_BOEHM_GC_incremental = TRUE;
             } else
@@ -2122,6 +2222,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API unsigned MANAGED_STACK_ADDRESS_BOEHM_GC_CALL
 #     ifdef ENABLE_DISCLAIM
         MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[result].ok_mark_unconditionally = FALSE;
         MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[result].ok_disclaim_proc = 0;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[result].ok_disclaim_block_proc = 0;
 #     endif
     } else {
       ABORT("Too many kinds");
@@ -2641,6 +2742,61 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
     return (int)MANAGED_STACK_ADDRESS_BOEHM_GC_force_unmap_on_gcollect;
 }
 
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger(unsigned long age_ms,
+                                        size_t max_bytes_per_sec)
+{
+#   ifdef SCAVENGER_THREAD
+      int result;
+      IF_CANCEL(int cancel_state;)
+
+      if (!EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized, TRUE)) MANAGED_STACK_ADDRESS_BOEHM_GC_init();
+      set_need_to_lock(); /* the scavenger acquires the lock */
+      DISABLE_CANCEL(cancel_state);
+      LOCK();
+      result = MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger_inner(age_ms, max_bytes_per_sec);
+      UNLOCK();
+      RESTORE_CANCEL(cancel_state);
+      return result;
+#   else
+      UNUSED_ARG(age_ms);
+      UNUSED_ARG(max_bytes_per_sec);
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED;
+#   endif
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_start_memory_controller(unsigned headroom_percent,
+                                              unsigned long psi_stall_us)
+{
+#   ifdef MEMORY_CONTROLLER
+      int result;
+      IF_CANCEL(int cancel_state;)
+
+      if (!EXPECT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized, TRUE)) MANAGED_STACK_ADDRESS_BOEHM_GC_init();
+      if (headroom_percent > 90) headroom_percent = 90;
+      set_need_to_lock(); /* the controller acquires the lock */
+      DISABLE_CANCEL(cancel_state);
+      LOCK();
+      result = MANAGED_STACK_ADDRESS_BOEHM_GC_start_memory_controller_inner(headroom_percent,
+                                                psi_stall_us);
+      UNLOCK();
+      RESTORE_CANCEL(cancel_state);
+      return result;
+#   else
+      UNUSED_ARG(headroom_percent);
+      UNUSED_ARG(psi_stall_us);
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED;
+#   endif
+}
+
+MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_get_memory_pressure(void)
+{
+#   ifdef MEMORY_CONTROLLER
+      return (int)MANAGED_STACK_ADDRESS_BOEHM_GC_memory_pressure;
+#   else
+      return 0;
+#   endif
+}
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_API void MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAGED_STACK_ADDRESS_BOEHM_GC_abort_on_oom(void)
 {
     MANAGED_STACK_ADDRESS_BOEHM_GC_err_printf("Insufficient memory for the allocation\n");
@@ -98,6 +98,69 @@
   }
 #endif /* !SMALL_CONFIG */
 
+#ifdef USE_NT_CLEAR
+# include <immintrin.h>
+
+# ifndef NT_CLEAR_MIN_BYTES
+    /* Smaller chunks are cleared with the regular stores, as they are  */
+    /* likely to be touched by the client soon, e.g. the free lists     */
+    /* built by MANAGED_STACK_ADDRESS_BOEHM_GC_build_fl.  The default is an L1 cache size.      */
+#   define NT_CLEAR_MIN_BYTES (8 * HBLKSIZE)
+# endif
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_avx_clear = FALSE;
+
+  STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_nt_clear = FALSE;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_init_clear_kernels(void)
+  {
+    __builtin_cpu_init();
+    /* SSE2 (needed by the streaming stores) is always there on x64.    */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_nt_clear = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_DISABLE_NT_CLEAR") == NULL;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_avx_clear = MANAGED_STACK_ADDRESS_BOEHM_GC_nt_clear && __builtin_cpu_supports("avx");
+    MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Clearing kernels: streaming: %s, AVX: %s\n",
+                       MANAGED_STACK_ADDRESS_BOEHM_GC_nt_clear ? "yes" : "no", MANAGED_STACK_ADDRESS_BOEHM_GC_avx_clear ? "yes" : "no");
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_clear_nt(ptr_t p, size_t bytes)
+  {
+    ptr_t lim = p + bytes;
+    ptr_t q;
+
+    if (bytes < NT_CLEAR_MIN_BYTES || !MANAGED_STACK_ADDRESS_BOEHM_GC_nt_clear) {
+      BZERO(p, bytes);
+      return;
+    }
+    /* Clear the head up to a cache line boundary, then stream whole  */
+    /* cache lines, then clear the tail.                              */
+    q = PTRT_ROUNDUP_BY_MASK(p, 63);
+    BZERO(p, q - p);
+    for (; (word)q + 64 <= (word)lim; q += 64) {
+      __m128i zero = _mm_setzero_si128();
+
+      _mm_stream_si128((__m128i *)q, zero);
+      _mm_stream_si128((__m128i *)q + 1, zero);
+      _mm_stream_si128((__m128i *)q + 2, zero);
+      _mm_stream_si128((__m128i *)q + 3, zero);
+    }
+    /* Make the streaming stores globally visible (in order w.r.t.    */
+    /* the subsequent regular stores) before the memory is published. */
+    _mm_sfence();
+    BZERO(q, lim - q);
+  }
+
+  __attribute__((__target__("avx")))
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_clear_words_avx(word *p, word *lim)
+  {
+    __m256i zero = _mm256_setzero_si256();
+
+    for (; (word)(p + 4) <= (word)lim; p += 4)
+      _mm256_storeu_si256((__m256i *)p, zero);
+    while ((word)p < (word)lim)
+      *p++ = 0;
+  }
+#endif /* USE_NT_CLEAR */
+
 /* Build a free list for objects of size sz inside heap block h.        */
 /* Clear objects inside h if clear is set.  Add list to the end of      */
 /* the free list we build.  Return the new free list.                   */
@@ -170,6 +233,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_build_
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_new_hblk(size_t gran, int k)
 {
   struct hblk *h;       /* the new heap block */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_bool clear;
 
   MANAGED_STACK_ADDRESS_BOEHM_GC_STATIC_ASSERT(sizeof(struct hblk) == HBLKSIZE);
   MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
@@ -180,9 +244,10 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_new_hbl
   /* Mark all objects if appropriate. */
   if (IS_UNCOLLECTABLE(k)) MANAGED_STACK_ADDRESS_BOEHM_GC_set_hdr_marks(HDR(h));
 
-  /* Build the free list */
+  /* Build the free list; a block fresh from the OS need not be cleared. */
+  clear = !MANAGED_STACK_ADDRESS_BOEHM_GC_hblk_take_zeroed(HDR(h))
+          && (MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started || MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[k].ok_init);
   MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[k].ok_freelist[gran] =
-        MANAGED_STACK_ADDRESS_BOEHM_GC_build_fl(h, GRANULES_TO_WORDS(gran),
-                    MANAGED_STACK_ADDRESS_BOEHM_GC_debugging_started || MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[k].ok_init,
+        MANAGED_STACK_ADDRESS_BOEHM_GC_build_fl(h, GRANULES_TO_WORDS(gran), clear,
                     (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[k].ok_freelist[gran]);
 }
@@ -2165,6 +2165,11 @@ void MANAGED_STACK_ADDRESS_BOEHM_GC_register_data_segments(void)
 # define OPT_MAP_ANON 0
 #endif
 
+#if defined(GROW_HEAP_IN_PLACE) && !defined(MAP_FIXED_NOREPLACE)
+  /* Old kernel headers: the address is just a hint then.       */
+# define MAP_FIXED_NOREPLACE 0
+#endif
+
 # ifndef MSWIN_XBOX1
 #   if defined(SYMBIAN) && !defined(USE_MMAP_ANON)
       EXTERN_C_BEGIN
@@ -2240,6 +2245,33 @@ void MANAGED_STACK_ADDRESS_BOEHM_GC_register_data_segments(void)
   {
     return MANAGED_STACK_ADDRESS_BOEHM_GC_unix_mmap_get_mem(bytes);
   }
+
+# ifdef GROW_HEAP_IN_PLACE
+    /* Note: mremap() without MREMAP_MAYMOVE could be used instead but  */
+    /* it requires the old range to match exactly one existing mapping, */
+    /* while adjacent heap sections are usually merged by the kernel.   */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_unix_get_mem_at(ptr_t addr, size_t bytes)
+    {
+      void *result;
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_page_size != 0);
+      if (((word)addr | bytes) & (MANAGED_STACK_ADDRESS_BOEHM_GC_page_size - 1))
+        return FALSE;
+      result = mmap(addr, bytes, (PROT_READ | PROT_WRITE)
+                                 | (MANAGED_STACK_ADDRESS_BOEHM_GC_pages_executable ? PROT_EXEC : 0),
+                    MAP_PRIVATE | MAP_FIXED_NOREPLACE | OPT_MAP_ANON,
+                    zero_fd, 0 /* offset */);
+      if (EXPECT(MAP_FAILED == result, FALSE)) return FALSE;
+      if (result != (void *)addr) {
+        /* The kernel has placed it elsewhere (the hint was ignored).   */
+        MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Cannot map %lu bytes at %p (got %p)\n",
+                           (unsigned long)bytes, (void *)addr, result);
+        (void)munmap(result, bytes);
+        return FALSE;
+      }
+      return TRUE;
+    }
+# endif /* GROW_HEAP_IN_PLACE */
 #else /* !USE_MMAP */
 
 STATIC ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_unix_sbrk_get_mem(size_t bytes)
@@ -2570,6 +2602,32 @@ STATIC ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_start(ptr_t start, size_t byte
     return result;
 }
 
+#ifdef USE_MADV_FREE
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_lazy_unmap = FALSE;
+
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool madv_free_unsupported = FALSE;
+
+# ifndef MADV_FREE
+    /* Missing in old system headers; the value is the same on  */
+    /* all Linux targets.                                       */
+#   define MADV_FREE 8
+# endif
+
+  /* Mark the pages as lazily freeable, if requested.  Return FALSE     */
+  /* if not done, e.g. the kernel does not support MADV_FREE (it is     */
+  /* available since Linux 4.5).                                        */
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool madvise_free(ptr_t start_addr, size_t len)
+  {
+    if (!MANAGED_STACK_ADDRESS_BOEHM_GC_lazy_unmap || madv_free_unsupported) return FALSE;
+    if (madvise(start_addr, len, MADV_FREE) == 0) return TRUE;
+    if (errno != EINVAL)
+      ABORT_ON_REMAP_FAIL("unmap: madvise(MADV_FREE)", start_addr, len);
+    madv_free_unsupported = TRUE;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("MADV_FREE is not supported, using MADV_DONTNEED\n");
+    return FALSE;
+  }
+#endif /* USE_MADV_FREE */
+
 /* We assume that MANAGED_STACK_ADDRESS_BOEHM_GC_remap is called on exactly the same range  */
 /* as a previous call to MANAGED_STACK_ADDRESS_BOEHM_GC_unmap.  It is safe to consistently  */
 /* round the endpoints in both places.                          */
@@ -2625,7 +2683,12 @@ static void block_unmap_inner(ptr_t start_addr, size_t len)
             /* On Linux (and some other platforms probably),    */
             /* mprotect(PROT_NONE) is just disabling access to  */
             /* the pages but not returning them to OS.          */
-            if (madvise(start_addr, len, MADV_DONTNEED) == -1)
+#           ifdef USE_MADV_FREE
+              if (madvise_free(start_addr, len)) {
+                /* The pages are returned to OS lazily. */
+              } else
+#           endif
+            /* else */ if (madvise(start_addr, len, MADV_DONTNEED) == -1)
               ABORT_ON_REMAP_FAIL("unmap: madvise", start_addr, len);
 #         endif
 #       else
@@ -2752,6 +2815,198 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_g
 
 #endif /* USE_MUNMAP */
 
+#ifdef MEMORY_CONTROLLER
+# include <poll.h>
+
+# ifndef CGROUP_PATH_MAX
+#   define CGROUP_PATH_MAX 512
+# endif
+
+  /* The PSI tracking window; a multiple of 2 s is required for the     */
+  /* unprivileged users.                                                */
+# ifndef PSI_WINDOW_US
+#   define PSI_WINDOW_US 2000000UL
+# endif
+
+  /* The directory of the cgroup of the process (empty if unknown).     */
+  static char cgroup_dir[CGROUP_PATH_MAX];
+
+  /* Read a small file to buf (zero-terminated), return FALSE if the    */
+  /* file cannot be read.                                               */
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool read_small_file(const char *path, char *buf, size_t buf_sz)
+  {
+    int f = open(path, O_RDONLY);
+    ssize_t len;
+
+    if (-1 == f) return FALSE;
+    len = read(f, buf, buf_sz - 1);
+    close(f);
+    if (len < 0) return FALSE;
+    buf[len] = '\0';
+    return TRUE;
+  }
+
+  /* Store the path of the given file of the cgroup directory to path   */
+  /* (of CGROUP_PATH_MAX size).                                         */
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool cgroup_file_path(char *path, const char *name)
+  {
+    size_t dir_len = strlen(cgroup_dir);
+    size_t name_len = strlen(name);
+
+    if (0 == dir_len || dir_len + name_len + 2 > CGROUP_PATH_MAX)
+      return FALSE;
+    BCOPY(cgroup_dir, path, dir_len);
+    path[dir_len] = '/';
+    BCOPY(name, path + dir_len + 1, name_len + 1);
+    return TRUE;
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_cgroup_init(void)
+  {
+    /* The mount points of the cgroup2 file system: the unified and     */
+    /* the hybrid hierarchy ones.                                       */
+    static const char *const mounts[] = {
+      "/sys/fs/cgroup", "/sys/fs/cgroup/unified"
+    };
+    char buf[CGROUP_PATH_MAX];
+    char path[CGROUP_PATH_MAX];
+    const char *dir = GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_CGROUP_DIR");
+    char *p;
+    size_t i, len;
+
+    if (dir != NULL) {
+      len = strlen(dir);
+      if (0 == len || len >= CGROUP_PATH_MAX) return FALSE;
+      BCOPY(dir, cgroup_dir, len + 1);
+      return TRUE;
+    }
+
+    /* The cgroup v2 entry looks like "0::/path".       */
+    if (!read_small_file("/proc/self/cgroup", buf, sizeof(buf)))
+      return FALSE;
+    if (strncmp(buf, "0::", 3) == 0) {
+      p = buf + 3;
+    } else {
+      p = strstr(buf, "\n0::");
+      if (NULL == p) return FALSE;
+      p += 4;
+    }
+    len = strcspn(p, "\n");
+    p[len] = '\0';
+    if (1 == len) len = 0; /* the root cgroup */
+
+    for (i = 0; i < sizeof(mounts) / sizeof(mounts[0]); i++) {
+      size_t mount_len = strlen(mounts[i]);
+      int f;
+
+      if (mount_len + len >= CGROUP_PATH_MAX) continue;
+      BCOPY(mounts[i], cgroup_dir, mount_len);
+      BCOPY(p, cgroup_dir + mount_len, len);
+      cgroup_dir[mount_len + len] = '\0';
+      if (!cgroup_file_path(path, "cgroup.controllers")) break;
+      f = open(path, O_RDONLY);
+      if (f != -1) {
+        close(f);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Using cgroup at %s\n", cgroup_dir);
+        return TRUE;
+      }
+    }
+    cgroup_dir[0] = '\0';
+    return FALSE;
+  }
+
+  /* Read the value of a cgroup memory interface file ("max" is         */
+  /* returned as MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX).                                          */
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool read_cgroup_value(const char *name, word *pvalue)
+  {
+    char path[CGROUP_PATH_MAX];
+    char buf[32];
+
+    if (!cgroup_file_path(path, name)
+        || !read_small_file(path, buf, sizeof(buf)))
+      return FALSE;
+    if (strncmp(buf, "max", 3) == 0) {
+      *pvalue = MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX;
+    } else if (isdigit((unsigned char)buf[0])) {
+      *pvalue = (word)STRTOULL(buf, NULL, 10);
+    } else {
+      return FALSE;
+    }
+    return TRUE;
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_cgroup_memory(word *plimit, word *pcurrent)
+  {
+    word value;
+
+    *plimit = MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX;
+    if (read_cgroup_value("memory.max", &value))
+      *plimit = value;
+    if (read_cgroup_value("memory.high", &value) && value < *plimit)
+      *plimit = value;
+    return *plimit != MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX
+           && read_cgroup_value("memory.current", pcurrent);
+  }
+
+  /* Open the given PSI file and write the trigger to it.       */
+  static int psi_open_file(const char *path, const char *trigger)
+  {
+    size_t len = strlen(trigger) + 1; /* including the terminating zero */
+    int fd = open(path, O_RDWR | O_NONBLOCK);
+
+    if (-1 == fd) return -1;
+    if (write(fd, trigger, len) != (ssize_t)len) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_psi_open(unsigned long stall_us)
+  {
+    char path[CGROUP_PATH_MAX];
+    char trigger[64];
+    int fd = -1;
+
+    if (stall_us >= PSI_WINDOW_US) stall_us = PSI_WINDOW_US - 1;
+    (void)snprintf(trigger, sizeof(trigger), "some %lu %lu",
+                   stall_us, PSI_WINDOW_US);
+    if (cgroup_file_path(path, "memory.pressure"))
+      fd = psi_open_file(path, trigger);
+    if (-1 == fd)
+      fd = psi_open_file("/proc/pressure/memory", trigger);
+    if (-1 == fd) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Memory pressure (PSI) triggers not supported\n");
+    } else {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Using PSI memory pressure trigger: %s\n",
+                         trigger);
+    }
+    return fd;
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_psi_wait(int fd, unsigned long timeout_ms)
+  {
+    struct pollfd pfd;
+    int res;
+
+    if (-1 == fd) {
+      struct timespec ts;
+
+      ts.tv_sec = (time_t)(timeout_ms / 1000);
+      ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+      (void)nanosleep(&ts, NULL);
+      return 0;
+    }
+    pfd.fd = fd;
+    pfd.events = POLLPRI;
+    pfd.revents = 0;
+    res = poll(&pfd, 1, (int)timeout_ms);
+    if (res < 0) return errno == EINTR ? 0 : -1;
+    if ((pfd.revents & (POLLERR | POLLNVAL)) != 0) return -1;
+    return (pfd.revents & POLLPRI) != 0 ? 1 : 0;
+  }
+#endif /* MEMORY_CONTROLLER */
+
 /* Routine for pushing any additional roots.  In THREADS        */
 /* environment, this is also responsible for marking from       */
 /* thread stacks.                                               */
@@ -2910,7 +3165,14 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_push_other_roo
  *              cleared (by writing some special value to
  *              /proc/self/clear_refs file).  In case the soft-dirty bit is
  *              not supported by the kernel, MPROTECT_VDB may be defined as
- *              a fallback strategy.
+ *              a fallback strategy.  If UFFD_VDB is defined too, and the
+ *              kernel supports it (Linux 6.7+), the heap sections are
+ *              registered for userfaultfd write-protection in the async
+ *              mode instead, and the written pages of each section are
+ *              retrieved and write-protected again by a single
+ *              PAGEMAP_SCAN ioctl call, thus neither the static roots
+ *              nor the rest of the process pages are touched (the static
+ *              roots are considered always dirty in this case).
  * MPROTECT_VDB:Protect pages and then catch the faults to keep track of
  *              dirtied pages.  The implementation (and implementability)
  *              is highly system dependent.  This usually fails when system
@@ -3031,6 +3293,9 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_push_other_roo
 
 #elif defined(SOFT_VDB)
   static int clear_refs_fd = -1;
+# ifdef UFFD_VDB
+    static int uffd_fd = -1; /* -1 unless PAGEMAP_SCAN is used */
+# endif
 # define MANAGED_STACK_ADDRESS_BOEHM_GC_GWW_AVAILABLE() (clear_refs_fd != -1)
 #else
 # define MANAGED_STACK_ADDRESS_BOEHM_GC_GWW_AVAILABLE() FALSE
@@ -3402,6 +3667,13 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_push_other_roo
           ABORT("Soft-dirty bit support is missing");
 #     else
         if (soft_dirty_init()) {
+#         ifdef UFFD_VDB
+            if (uffd_fd != -1) {
+              MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF(
+                        "Using userfaultfd write-protect and PAGEMAP_SCAN\n");
+              return TRUE;
+            }
+#         endif
           MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Using soft-dirty bit feature\n");
           return TRUE;
         }
@@ -3802,6 +4074,206 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_proc_r
   static pagemap_elem_t *soft_vdb_buf;
   static int pagemap_fd;
 
+# ifdef UFFD_VDB
+#   include <linux/userfaultfd.h>
+#   include <sys/ioctl.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+
+    /* Some of the definitions are missing in old system headers.       */
+#   ifndef UFFD_USER_MODE_ONLY
+#     define UFFD_USER_MODE_ONLY 1
+#   endif
+#   ifndef UFFD_FEATURE_WP_UNPOPULATED
+#     define UFFD_FEATURE_WP_UNPOPULATED (1 << 13)
+#   endif
+#   ifndef UFFD_FEATURE_WP_ASYNC
+#     define UFFD_FEATURE_WP_ASYNC (1 << 15)
+#   endif
+#   ifndef UFFDIO_REGISTER_MODE_WP
+#     define UFFDIO_REGISTER_MODE_WP ((__u64)1 << 1)
+#   endif
+#   ifndef PAGEMAP_SCAN
+      struct page_region {
+        __u64 start;
+        __u64 end;
+        __u64 categories;
+      };
+
+      struct pm_scan_arg {
+        __u64 size;
+        __u64 flags;
+        __u64 start;
+        __u64 end;
+        __u64 walk_end;
+        __u64 vec;
+        __u64 vec_len;
+        __u64 max_pages;
+        __u64 category_inverted;
+        __u64 category_mask;
+        __u64 category_anyof_mask;
+        __u64 return_mask;
+      };
+
+#     define PAGE_IS_WRITTEN (1 << 1)
+#     define PM_SCAN_WP_MATCHING (1 << 0)
+#     define PM_SCAN_CHECK_WPASYNC (1 << 1)
+#     define PAGEMAP_SCAN _IOWR('f', 16, struct pm_scan_arg)
+#   endif
+
+    /* Create a userfaultfd object supporting the asynchronous          */
+    /* write-protection (available since Linux 6.7).  Return -1 on      */
+    /* failure.                                                         */
+    static int uffd_open(void)
+    {
+#     ifdef __NR_userfaultfd
+        struct uffdio_api api;
+        int fd = (int)syscall(__NR_userfaultfd,
+                              O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+
+        if (-1 == fd) {
+          /* UFFD_USER_MODE_ONLY is not supported prior to Linux 5.11.  */
+          fd = (int)syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK);
+          if (-1 == fd) return -1;
+        }
+        BZERO(&api, sizeof(api));
+        api.api = UFFD_API;
+        api.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED;
+        if (ioctl(fd, UFFDIO_API, &api) == -1
+            || (api.features & UFFD_FEATURE_WP_ASYNC) == 0) {
+          close(fd);
+          return -1;
+        }
+        return fd;
+#     else
+        return -1;
+#     endif
+    }
+
+    /* Register the pages of the given range for the write-protection.  */
+    static MANAGED_STACK_ADDRESS_BOEHM_GC_bool uffd_register(ptr_t start, ptr_t limit)
+    {
+      struct uffdio_register reg;
+
+      BZERO(&reg, sizeof(reg));
+      reg.range.start = (__u64)(word)start;
+      reg.range.len = (__u64)((word)limit - (word)start);
+      reg.mode = UFFDIO_REGISTER_MODE_WP;
+      return ioctl(uffd_fd, UFFDIO_REGISTER, &reg) == 0;
+    }
+
+    /* Find the pages of the given (page-aligned) range which are       */
+    /* written since the previous call, mark them in MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages    */
+    /* (unless output_unneeded), and write-protect them again           */
+    /* (atomically).  Return the number of the found page runs, or -1   */
+    /* if the range is not registered (or its registration has been     */
+    /* lost).                                                           */
+    static long uffd_scan_range(ptr_t start, ptr_t limit,
+                                MANAGED_STACK_ADDRESS_BOEHM_GC_bool output_unneeded)
+    {
+      struct pm_scan_arg arg;
+      struct page_region *vec = (struct page_region *)soft_vdb_buf;
+      long total = 0;
+
+      BZERO(&arg, sizeof(arg));
+      arg.size = sizeof(arg);
+      arg.flags = PM_SCAN_WP_MATCHING | PM_SCAN_CHECK_WPASYNC;
+      arg.start = (__u64)(word)start;
+      arg.end = (__u64)(word)limit;
+      arg.vec = (__u64)(word)vec;
+      arg.vec_len = VDB_BUF_SZ / sizeof(struct page_region);
+      arg.category_mask = PAGE_IS_WRITTEN;
+      arg.return_mask = PAGE_IS_WRITTEN;
+      for (;;) {
+        int i;
+        int n = ioctl(pagemap_fd, PAGEMAP_SCAN, &arg);
+
+        if (n < 0) return -1;
+        for (i = 0; i < n && !output_unneeded; i++) {
+          struct hblk *h;
+
+          for (h = (struct hblk *)(word)vec[i].start;
+               (word)h < (word)vec[i].end; h++) {
+            set_pht_entry_from_index(MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages, PHT_HASH(h));
+          }
+        }
+        total += n;
+        if (arg.walk_end >= arg.end) break;
+        /* The vector is full, continue from where the walk stopped.    */
+        arg.start = arg.walk_end;
+      }
+      return total;
+    }
+
+    static MANAGED_STACK_ADDRESS_BOEHM_GC_bool uffd_vdb_init(void)
+    {
+      ptr_t p;
+      MANAGED_STACK_ADDRESS_BOEHM_GC_bool ok;
+
+      uffd_fd = uffd_open();
+      if (-1 == uffd_fd) return FALSE;
+
+      /* Check on a temporary page that PAGEMAP_SCAN (not supported     */
+      /* prior to Linux 6.7) reports the writes to it exactly.  Note:   */
+      /* the heap sections are registered lazily, in uffd_read_dirty.   */
+      p = (ptr_t)mmap(NULL, MANAGED_STACK_ADDRESS_BOEHM_GC_page_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 /* offset */);
+      if (MAP_FAILED == (void *)p) {
+        ok = FALSE;
+      } else {
+        *p = 1; /* make it dirty */
+        ok = uffd_register(p, p + MANAGED_STACK_ADDRESS_BOEHM_GC_page_size)
+             && uffd_scan_range(p, p + MANAGED_STACK_ADDRESS_BOEHM_GC_page_size, TRUE) == 1
+             && uffd_scan_range(p, p + MANAGED_STACK_ADDRESS_BOEHM_GC_page_size, TRUE) == 0;
+        if (ok) {
+          *p = 2;
+          ok = uffd_scan_range(p, p + MANAGED_STACK_ADDRESS_BOEHM_GC_page_size, TRUE) == 1;
+        }
+        (void)munmap(p, MANAGED_STACK_ADDRESS_BOEHM_GC_page_size);
+      }
+      if (!ok) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF(
+                "PAGEMAP_SCAN with userfaultfd is not supported by kernel\n");
+        close(uffd_fd);
+        uffd_fd = -1;
+      }
+      return ok;
+    }
+
+    /* The pages are write-protected again even if output_unneeded.     */
+    static void uffd_read_dirty(MANAGED_STACK_ADDRESS_BOEHM_GC_bool output_unneeded)
+    {
+      word i;
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_page_size != 0);
+      for (i = 0; i != MANAGED_STACK_ADDRESS_BOEHM_GC_n_heap_sects; ++i) {
+        ptr_t start = (ptr_t)((word)MANAGED_STACK_ADDRESS_BOEHM_GC_heap_sects[i].hs_start
+                              & ~(word)(MANAGED_STACK_ADDRESS_BOEHM_GC_page_size-1));
+        ptr_t limit = PTRT_ROUNDUP_BY_MASK(MANAGED_STACK_ADDRESS_BOEHM_GC_heap_sects[i].hs_start
+                                           + MANAGED_STACK_ADDRESS_BOEHM_GC_heap_sects[i].hs_bytes,
+                                           MANAGED_STACK_ADDRESS_BOEHM_GC_page_size-1);
+        struct hblk *h;
+
+        if (uffd_scan_range(start, limit, output_unneeded) >= 0) continue;
+
+        /* The section is new (or its registration is lost, e.g. in the */
+        /* child process after fork).  Register and write-protect it;   */
+        /* all its pages are considered dirty this time as some of them */
+        /* might be already write-protected by the failed call.         */
+        if (!uffd_register(start, limit)
+            || uffd_scan_range(start, limit, TRUE) < 0) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_VERBOSE_LOG_PRINTF("Cannot write-protect heap section at %p"
+                                " by userfaultfd, errno= %d\n",
+                                (void *)start, errno);
+        }
+        if (output_unneeded) continue;
+        for (h = (struct hblk *)start; (word)h < (word)limit; h++) {
+          set_pht_entry_from_index(MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages, PHT_HASH(h));
+        }
+      }
+    }
+# endif /* UFFD_VDB */
+
   static MANAGED_STACK_ADDRESS_BOEHM_GC_bool soft_dirty_open_files(void)
   {
     pid_t pid = getpid();
@@ -3815,6 +4287,22 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_proc_r
       clear_refs_fd = -1;
       return FALSE;
     }
+#   ifdef UFFD_VDB
+      if (uffd_fd != -1) {
+        /* The registrations are not inherited by the child process,    */
+        /* thus start from scratch (the sections are registered again   */
+        /* lazily).  The soft-dirty bits might be unsupported, so no    */
+        /* fallback to them is possible here.                           */
+        close(uffd_fd);
+        uffd_fd = uffd_open();
+        if (-1 == uffd_fd) {
+          close(clear_refs_fd);
+          clear_refs_fd = -1;
+          close(pagemap_fd);
+          return FALSE;
+        }
+      }
+#   endif
 #   ifndef THREADS
       saved_proc_pid = pid; /* updated on success only */
 #   endif
@@ -3930,6 +4418,10 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_proc_r
     soft_vdb_buf = (pagemap_elem_t *)MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc(VDB_BUF_SZ);
     if (NULL == soft_vdb_buf)
       ABORT("Insufficient space for /proc pagemap buffer");
+#   ifdef UFFD_VDB
+      if (uffd_vdb_init())
+        return TRUE;
+#   endif
     if (!detect_soft_dirty_supported((ptr_t)soft_vdb_buf)) {
       MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Soft-dirty bit is not supported by kernel\n");
       /* Release the resources. */
@@ -4085,6 +4577,23 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_proc_r
       }
 #   endif
 
+#   ifdef UFFD_VDB
+      if (uffd_fd != -1) {
+        /* The pages should be write-protected again even if the        */
+        /* output is unneeded, so the scan is done anyway.              */
+        if (output_unneeded) {
+          uffd_read_dirty(TRUE);
+          return;
+        }
+        BZERO(MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages, sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages));
+        uffd_read_dirty(FALSE);
+#       ifdef CHECKSUMS
+          MANAGED_STACK_ADDRESS_BOEHM_GC_or_pages(MANAGED_STACK_ADDRESS_BOEHM_GC_written_pages, MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages);
+#       endif
+        return;
+      }
+#   endif
+
     if (!output_unneeded) {
       word i;
 
@@ -4143,21 +4652,78 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
 }
 #endif /* PCR_VDB */
 
+/* The card index is the same as PHT_HASH() of the address.             */
+struct MANAGED_STACK_ADDRESS_BOEHM_GC_card_table_s MANAGED_STACK_ADDRESS_BOEHM_GC_card_table = {
+  NULL, LOG_HBLKSIZE, PHT_ENTRIES - 1
+};
+
 #ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_DISABLE_INCREMENTAL
   MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb = FALSE;
 
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_card_table_init(void)
+  {
+    ptr_t cards;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.cards != NULL) return TRUE;
+    cards = MANAGED_STACK_ADDRESS_BOEHM_GC_scratch_alloc(PHT_ENTRIES);
+    if (NULL == cards) return FALSE;
+    BZERO(cards, PHT_ENTRIES);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.cards = (volatile unsigned char *)cards;
+    return TRUE;
+  }
+
   /* Manually mark the page containing p as dirty.  Logically, this     */
   /* dirties the entire object.                                         */
   MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_inner(const void *p)
   {
-    word index = PHT_HASH(p);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb && MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.cards != NULL);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.cards[PHT_HASH(p)] = 1;
+  }
 
-#   if defined(MPROTECT_VDB)
-      /* Do not update MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages if it should be followed by the   */
-      /* page unprotection.                                             */
-      MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb);
-#   endif
-    async_set_pht_entry_from_index(MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages, index);
+# if defined(__SSE2__) && !defined(CPPCHECK)
+#   include <emmintrin.h>
+# endif
+
+  /* Convert the card table to MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages (unless output_unneeded) */
+  /* and reset it.  The cards are checked by 16 (with SSE2) or a word   */
+  /* at a time, only the chunks having dirty cards are cleared.         */
+  STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_read_cards(MANAGED_STACK_ADDRESS_BOEHM_GC_bool output_unneeded)
+  {
+    volatile unsigned char *cards = MANAGED_STACK_ADDRESS_BOEHM_GC_card_table.cards;
+    size_t i;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_STATIC_ASSERT(PHT_ENTRIES % CPP_WORDSZ == 0);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(cards != NULL);
+    for (i = 0; i < PHT_ENTRIES / CPP_WORDSZ; i++) {
+      volatile unsigned char *c = cards + i * CPP_WORDSZ;
+      word bits = 0;
+      unsigned j;
+
+#     if defined(__SSE2__) && !defined(CPPCHECK)
+        for (j = 0; j < CPP_WORDSZ; j += 16) {
+          __m128i v = _mm_loadu_si128((const __m128i *)(word)(c + j));
+          unsigned m = (unsigned)_mm_movemask_epi8(
+                                _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+
+          bits |= (word)(m ^ 0xffff) << j;
+        }
+#     else
+        for (j = 0; j < CPP_WORDSZ; j += sizeof(word)) {
+          if (*(volatile word *)(c + j) != 0) {
+            unsigned k;
+
+            for (k = 0; k < sizeof(word); k++) {
+              if (c[j + k] != 0) bits |= (word)1 << (j + k);
+            }
+          }
+        }
+#     endif
+      if (bits != 0)
+        BZERO((/* no volatile */ void *)(word)c, CPP_WORDSZ);
+      if (!output_unneeded)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages[i] = bits;
+    }
   }
 
   /* Retrieve system dirty bits for the heap to a local buffer (unless  */
@@ -4172,22 +4738,21 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
 #   ifdef DEBUG_DIRTY_BITS
       MANAGED_STACK_ADDRESS_BOEHM_GC_log_printf("read dirty begin\n");
 #   endif
-    if (MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb
-#       if defined(MPROTECT_VDB)
-          || !MANAGED_STACK_ADDRESS_BOEHM_GC_GWW_AVAILABLE()
-#       endif
-        ) {
-      if (!output_unneeded)
-        BCOPY((/* no volatile */ void *)(word)MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages,
-              MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages, sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages));
-      BZERO((/* no volatile */ void *)(word)MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages,
-            sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages));
-#     ifdef MPROTECT_VDB
-        if (!MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb)
-          MANAGED_STACK_ADDRESS_BOEHM_GC_protect_heap();
-#     endif
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_read_cards(output_unneeded);
       return;
     }
+#   if defined(MPROTECT_VDB)
+      if (!MANAGED_STACK_ADDRESS_BOEHM_GC_GWW_AVAILABLE()) {
+        if (!output_unneeded)
+          BCOPY((/* no volatile */ void *)(word)MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages,
+                MANAGED_STACK_ADDRESS_BOEHM_GC_grungy_pages, sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages));
+        BZERO((/* no volatile */ void *)(word)MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages,
+              sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_dirty_pages));
+        MANAGED_STACK_ADDRESS_BOEHM_GC_protect_heap();
+        return;
+      }
+#   endif
 
 #   ifdef GWW_VDB
       MANAGED_STACK_ADDRESS_BOEHM_GC_gww_read_dirty(output_unneeded);
@@ -4222,6 +4787,9 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
     MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_is_vdb_for_static_roots(void)
     {
       if (MANAGED_STACK_ADDRESS_BOEHM_GC_manual_vdb) return FALSE;
+#     ifdef UFFD_VDB
+        if (uffd_fd != -1) return FALSE; /* only the heap is tracked */
+#     endif
 #     if defined(MPROTECT_VDB)
         /* Currently used only in conjunction with SOFT_VDB.    */
         return MANAGED_STACK_ADDRESS_BOEHM_GC_GWW_AVAILABLE();
@@ -609,6 +609,293 @@
 
 #endif /* MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS_PARAMARK */
 
+#ifdef FINALIZER_THREADS
+  static pthread_mutex_t fnlz_mutex = PTHREAD_MUTEX_INITIALIZER;
+  static pthread_cond_t fnlz_cv = PTHREAD_COND_INITIALIZER;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_finalizer_lock(void)
+  {
+    if (pthread_mutex_lock(&fnlz_mutex) != 0) {
+        ABORT("pthread_mutex_lock failed");
+    }
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_release_finalizer_lock(void)
+  {
+    if (pthread_mutex_unlock(&fnlz_mutex) != 0) {
+        ABORT("pthread_mutex_unlock failed");
+    }
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_wait_finalizer(void)
+  {
+    if (pthread_cond_wait(&fnlz_cv, &fnlz_mutex) != 0) {
+        ABORT("pthread_cond_wait failed");
+    }
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_notify_all_finalizer(void)
+  {
+    if (pthread_cond_broadcast(&fnlz_cv) != 0) {
+        ABORT("pthread_cond_broadcast failed");
+    }
+  }
+#endif /* FINALIZER_THREADS */
+
+#ifdef STRIPED_FNLZ_TABLES
+  static pthread_mutex_t fnlz_stripe_ml[FNLZ_STRIPES];
+                        /* Initialized by MANAGED_STACK_ADDRESS_BOEHM_GC_thr_init.  */
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_fnlz_stripe_lock(unsigned s)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(s < FNLZ_STRIPES);
+    if (pthread_mutex_lock(&fnlz_stripe_ml[s]) != 0) {
+        ABORT("pthread_mutex_lock failed");
+    }
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_release_fnlz_stripe_lock(unsigned s)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(s < FNLZ_STRIPES);
+    if (pthread_mutex_unlock(&fnlz_stripe_ml[s]) != 0) {
+        ABORT("pthread_mutex_unlock failed");
+    }
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_all_fnlz_stripe_locks(void)
+  {
+    unsigned s;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    for (s = 0; s < FNLZ_STRIPES; s++)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_fnlz_stripe_lock(s);
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_release_all_fnlz_stripe_locks(void)
+  {
+    unsigned s;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    for (s = 0; s < FNLZ_STRIPES; s++)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_release_fnlz_stripe_lock(s);
+  }
+#endif /* STRIPED_FNLZ_TABLES */
+
+#if defined(SCAVENGER_THREAD) || defined(MEMORY_CONTROLLER)
+  /* Create a detached helper thread not registered in the collector.   */
+  /* Returns FALSE (after a warning) on failure.                        */
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool start_helper_thread(void *(*fn)(void *), const char *name)
+  {
+    pthread_attr_t attr;
+    pthread_t new_thread;
+    int res;
+#   ifndef NO_MARKER_SPECIAL_SIGMASK
+      sigset_t set, oldset;
+#   endif
+
+    INIT_REAL_SYMS(); /* for pthread_create */
+    if (0 != pthread_attr_init(&attr)) ABORT("pthread_attr_init failed");
+    if (0 != pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED))
+      ABORT("pthread_attr_setdetachstate failed");
+#   ifndef NO_MARKER_SPECIAL_SIGMASK
+      /* The thread is not registered, thus it neither needs to be      */
+      /* stopped by the collector nor should steal the user signals.    */
+      if (sigfillset(&set) != 0)
+        ABORT("sigfillset failed");
+      if (EXPECT(REAL_FUNC(pthread_sigmask)(SIG_BLOCK,
+                                            &set, &oldset) < 0, FALSE)) {
+        WARN("pthread_sigmask set failed, no %s thread started\n", name);
+        (void)pthread_attr_destroy(&attr);
+        return FALSE;
+      }
+#   endif
+    res = REAL_FUNC(pthread_create)(&new_thread, &attr, fn, NULL);
+#   ifndef NO_MARKER_SPECIAL_SIGMASK
+      if (EXPECT(REAL_FUNC(pthread_sigmask)(SIG_SETMASK,
+                                            &oldset, NULL) < 0, FALSE)) {
+        WARN("pthread_sigmask restore failed\n", 0);
+      }
+#   endif
+    (void)pthread_attr_destroy(&attr);
+    if (EXPECT(res != 0, FALSE)) {
+      WARN("Creation of %s thread failed\n", name);
+      return FALSE;
+    }
+    return TRUE;
+  }
+#endif /* SCAVENGER_THREAD || MEMORY_CONTROLLER */
+
+#ifdef SCAVENGER_THREAD
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER unsigned32 MANAGED_STACK_ADDRESS_BOEHM_GC_scavenge_ms = 0;
+
+  /* The scavenger parameters; protected by the allocation lock.        */
+  static unsigned long scavenge_age_ms = 0; /* zero means paused */
+  static size_t scavenge_bytes_per_sec = 0; /* zero means no limit */
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool scavenger_started = FALSE;
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool scavenge_clock_set = FALSE;
+  static CLOCK_TYPE scavenger_start_time; /* the origin of the clock */
+
+# ifndef SCAVENGER_MIN_PERIOD_MS
+#   define SCAVENGER_MIN_PERIOD_MS 10
+# endif
+# ifndef SCAVENGER_MAX_PERIOD_MS
+#   define SCAVENGER_MAX_PERIOD_MS 1000
+# endif
+
+  STATIC void *MANAGED_STACK_ADDRESS_BOEHM_GC_scavenger_thread(void *arg)
+  {
+    UNUSED_ARG(arg);
+    for (;;) {
+      unsigned long period_ms;
+      word max_bytes = 0;
+      struct timespec ts;
+      CLOCK_TYPE now;
+
+      LOCK();
+      /* Wake up several times per the age, so that a block is          */
+      /* returned not much later than it becomes old enough.            */
+      period_ms = scavenge_age_ms / 4;
+      if (period_ms < SCAVENGER_MIN_PERIOD_MS)
+        period_ms = SCAVENGER_MIN_PERIOD_MS;
+      if (0 == scavenge_age_ms || period_ms > SCAVENGER_MAX_PERIOD_MS)
+        period_ms = SCAVENGER_MAX_PERIOD_MS;
+      UNLOCK();
+
+      ts.tv_sec = (time_t)(period_ms / 1000);
+      ts.tv_nsec = (long)(period_ms % 1000) * 1000000L;
+      (void)nanosleep(&ts, NULL);
+
+      LOCK();
+      GET_TIME(now);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_scavenge_ms = (unsigned32)MS_TIME_DIFF(now, scavenger_start_time);
+      if (scavenge_age_ms != 0) {
+        word unmapped;
+
+        if (scavenge_bytes_per_sec != 0) {
+          max_bytes = (word)scavenge_bytes_per_sec / 1000 * period_ms;
+          if (0 == max_bytes) max_bytes = 1; /* at least one block */
+        }
+        unmapped = MANAGED_STACK_ADDRESS_BOEHM_GC_unmap_aged((unsigned32)scavenge_age_ms, max_bytes);
+        if (unmapped != 0) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Scavenger unmapped %lu bytes\n",
+                             (unsigned long)unmapped);
+        }
+      }
+      UNLOCK();
+    }
+    return NULL; /* unreachable */
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger_inner(unsigned long age_ms,
+                                        size_t max_bytes_per_sec)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    scavenge_age_ms = age_ms;
+    scavenge_bytes_per_sec = max_bytes_per_sec;
+    if (scavenger_started) return MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+
+    if (!scavenge_clock_set) {
+      /* The clock is not reset on a restart (in a forked child), as    */
+      /* the free blocks are already stamped by it.                     */
+      GET_TIME(scavenger_start_time);
+      scavenge_clock_set = TRUE;
+    }
+    if (!start_helper_thread(MANAGED_STACK_ADDRESS_BOEHM_GC_scavenger_thread, "scavenger"))
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED;
+    scavenger_started = TRUE;
+#   ifdef USE_MADV_FREE
+      if (NULL == GETENV("MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MADV_FREE"))
+        MANAGED_STACK_ADDRESS_BOEHM_GC_lazy_unmap = TRUE;
+#   endif
+    MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Started scavenger thread (age: %lu ms)\n", age_ms);
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+  }
+#endif /* SCAVENGER_THREAD */
+
+#ifdef MEMORY_CONTROLLER
+  /* The memory controller parameters; protected by the allocation      */
+  /* lock.                                                              */
+  static unsigned mc_headroom_percent = 0;
+  static unsigned long mc_psi_stall_us = 0; /* zero means no PSI */
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool mc_started = FALSE;
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_bool mc_have_cgroup = FALSE;
+
+  static int mc_psi_fd = -1;
+                /* The PSI trigger; used by the controller thread only. */
+
+# ifndef MEMORY_CONTROLLER_PERIOD_MS
+#   define MEMORY_CONTROLLER_PERIOD_MS 500
+# endif
+
+  /* The number of the controller periods the pressure is assumed to    */
+  /* last after a PSI event (i.e. the PSI window).                      */
+# ifndef MEMORY_PRESSURE_PERIODS
+#   define MEMORY_PRESSURE_PERIODS 4
+# endif
+
+  STATIC void *MANAGED_STACK_ADDRESS_BOEHM_GC_memory_controller_thread(void *arg)
+  {
+    unsigned long psi_stall_us = 0; /* that of mc_psi_fd */
+    unsigned pressure_periods = 0;
+
+    UNUSED_ARG(arg);
+    for (;;) {
+      word limit = 0, current = 0;
+      int res;
+
+      LOCK();
+      if (psi_stall_us != mc_psi_stall_us) {
+        /* Reconfigured (or just started).      */
+        if (mc_psi_fd != -1) close(mc_psi_fd);
+        psi_stall_us = mc_psi_stall_us;
+        mc_psi_fd = psi_stall_us != 0 ? MANAGED_STACK_ADDRESS_BOEHM_GC_psi_open(psi_stall_us) : -1;
+      }
+      UNLOCK();
+
+      res = MANAGED_STACK_ADDRESS_BOEHM_GC_psi_wait(mc_psi_fd, MEMORY_CONTROLLER_PERIOD_MS);
+      if (res > 0) {
+        pressure_periods = MEMORY_PRESSURE_PERIODS;
+      } else {
+        if (res < 0) {
+          /* The trigger is destroyed (e.g. the cgroup is removed). */
+          close(mc_psi_fd);
+          mc_psi_fd = -1;
+        }
+        if (pressure_periods > 0) pressure_periods--;
+      }
+      if (!mc_have_cgroup || !MANAGED_STACK_ADDRESS_BOEHM_GC_cgroup_memory(&limit, &current))
+        limit = 0;
+
+      LOCK();
+      MANAGED_STACK_ADDRESS_BOEHM_GC_adjust_to_memory_limit(limit, current, mc_headroom_percent,
+                                pressure_periods > 0);
+      UNLOCK();
+    }
+    return NULL; /* unreachable */
+  }
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INNER int MANAGED_STACK_ADDRESS_BOEHM_GC_start_memory_controller_inner(unsigned headroom_percent,
+                                                unsigned long psi_stall_us)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    mc_headroom_percent = headroom_percent;
+    mc_psi_stall_us = psi_stall_us;
+    if (mc_started) return MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+
+    mc_have_cgroup = MANAGED_STACK_ADDRESS_BOEHM_GC_cgroup_init();
+    if (!mc_have_cgroup && 0 == psi_stall_us)
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_NOT_FOUND;
+    if (!start_helper_thread(MANAGED_STACK_ADDRESS_BOEHM_GC_memory_controller_thread,
+                             "memory controller"))
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_UNIMPLEMENTED;
+    mc_started = TRUE;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_COND_LOG_PRINTF("Started memory controller thread (headroom: %u%%,"
+                       " PSI stall: %lu us)\n",
+                       headroom_percent, psi_stall_us);
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS;
+  }
+#endif /* MEMORY_CONTROLLER */
+
 /* A hash table to keep information about the registered threads.       */
 /* Not used if MANAGED_STACK_ADDRESS_BOEHM_GC_win32_dll_threads is set.                             */
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_thread MANAGED_STACK_ADDRESS_BOEHM_GC_threads[THREAD_TABLE_SZ] = {0};
@@ -853,6 +1140,15 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_thread MANAGED_STACK_ADDRESS_BOEHM_GC_self
   return p;
 }
 
+MANAGED_STACK_ADDRESS_BOEHM_GC_INNER struct mark_assist_s *MANAGED_STACK_ADDRESS_BOEHM_GC_self_mark_assist(void)
+{
+  MANAGED_STACK_ADDRESS_BOEHM_GC_thread me;
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+  me = MANAGED_STACK_ADDRESS_BOEHM_GC_self_thread_inner();
+  return EXPECT(me != NULL, TRUE) ? &(me -> mark_assist) : NULL;
+}
+
 #ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
   /* Called by MANAGED_STACK_ADDRESS_BOEHM_GC_finalize() (in case of an allocation failure observed). */
   MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_reset_finalizer_nested(void)
@@ -1353,6 +1649,12 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_wait_fo
     /* Wait for an ongoing GC to finish, since we can't finish it in    */
     /* the (one remaining thread in) the child.                         */
 
+#     ifdef FINALIZER_THREADS
+        /* Do not let the idle finalizer threads start client code      */
+        /* which might acquire some client locks never released in the  */
+        /* child.  The finalizers already running are not waited for.   */
+        MANAGED_STACK_ADDRESS_BOEHM_GC_pause_finalizer_threads();
+#     endif
       LOCK();
       DISABLE_CANCEL(fork_cancel_state);
                 /* Following waits may include cancellation points. */
@@ -1361,6 +1663,9 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_wait_fo
           wait_for_reclaim_atfork();
 #     endif
       MANAGED_STACK_ADDRESS_BOEHM_GC_wait_for_gc_completion(TRUE);
+#     ifdef STRIPED_FNLZ_TABLES
+        MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_all_fnlz_stripe_locks();
+#     endif
 #     ifdef PARALLEL_MARK
         if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel) {
 #         if defined(THREAD_SANITIZER) && defined(MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERTIONS) \
@@ -1393,9 +1698,15 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_wait_fo
           MANAGED_STACK_ADDRESS_BOEHM_GC_release_mark_lock();
 #       endif
       }
+#   endif
+#   ifdef STRIPED_FNLZ_TABLES
+      MANAGED_STACK_ADDRESS_BOEHM_GC_release_all_fnlz_stripe_locks();
 #   endif
     RESTORE_CANCEL(fork_cancel_state);
     UNLOCK();
+#   ifdef FINALIZER_THREADS
+      MANAGED_STACK_ADDRESS_BOEHM_GC_resume_finalizer_threads();
+#   endif
   }
 
   /* Called in child after a fork().    */
@@ -1421,6 +1732,37 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_wait_fo
         /* TSan does not support threads creation in the child process. */
         MANAGED_STACK_ADDRESS_BOEHM_GC_available_markers_m1 = 0;
 #     endif
+#   endif
+#   ifdef STRIPED_FNLZ_TABLES
+      /* The locks are held by this thread (acquired in                 */
+      /* fork_prepare_proc).                                            */
+      MANAGED_STACK_ADDRESS_BOEHM_GC_release_all_fnlz_stripe_locks();
+#   endif
+#   ifdef SCAVENGER_THREAD
+      /* The scavenger thread is not inherited; it is started again by  */
+      /* the next MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger call (if any) in the child.        */
+      scavenger_started = FALSE;
+#   endif
+#   ifdef MEMORY_CONTROLLER
+      /* Same for the memory controller thread; the PSI trigger is      */
+      /* shared with the parent, so it is not used by the child.        */
+      mc_started = FALSE;
+      if (mc_psi_fd != -1) {
+        close(mc_psi_fd);
+        mc_psi_fd = -1;
+      }
+#   endif
+#   ifdef FINALIZER_THREADS
+      /* Same for the finalizer threads.  Their lock might be held by   */
+      /* a thread of the parent, thus it is reinitialized.  The         */
+      /* condition variable is not destroyed since this would wait for  */
+      /* the (not inherited) waiters.                                   */
+      (void)pthread_mutex_destroy(&fnlz_mutex);
+      if (0 != pthread_mutex_init(&fnlz_mutex, NULL))
+        ABORT("pthread_mutex_init failed (in child)");
+      if (0 != pthread_cond_init(&fnlz_cv, NULL))
+        ABORT("pthread_cond_init failed (in child)");
+      MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_threads_reset_child();
 #   endif
     /* Clean up the thread table, so that just our thread is left.      */
     MANAGED_STACK_ADDRESS_BOEHM_GC_remove_all_threads_but_me();
@@ -1579,6 +1921,16 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_thr_ini
 # ifdef CAN_HANDLE_FORK
     MANAGED_STACK_ADDRESS_BOEHM_GC_setup_atfork();
 # endif
+# ifdef STRIPED_FNLZ_TABLES
+    {
+      unsigned s;
+
+      for (s = 0; s < FNLZ_STRIPES; s++) {
+        if (pthread_mutex_init(&fnlz_stripe_ml[s], NULL) != 0)
+          ABORT("pthread_mutex_init failed");
+      }
+    }
+# endif
 
 # ifdef INCLUDE_LINUX_THREAD_DESCR
     /* Explicitly register the region including the address     */
@@ -2539,6 +2891,39 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API int MANAGED_STACK_ADDRESS_BOEHM_GC_CALL MANAG
     return result;
   }
 
+# ifdef FINALIZER_THREADS
+    static void *MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_thread(void *arg)
+    {
+      LOCK();
+      MANAGED_STACK_ADDRESS_BOEHM_GC_self_thread_inner() -> flags |= FINALIZER_THREAD;
+      UNLOCK();
+      MANAGED_STACK_ADDRESS_BOEHM_GC_run_finalizer_pool();
+      return arg;
+    }
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_create_finalizer_thread(void)
+    {
+      pthread_attr_t attr;
+      pthread_t new_thread;
+      int res;
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_DONT_HOLD_LOCK());
+      if (0 != pthread_attr_init(&attr)) ABORT("pthread_attr_init failed");
+      if (0 != pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED))
+        ABORT("pthread_attr_setdetachstate failed");
+      /* The thread is registered, since the finalizers may allocate    */
+      /* and the taken objects are referenced from its stack only.      */
+      res = WRAP_FUNC(pthread_create)(&new_thread, &attr,
+                                      MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_thread, NULL);
+      (void)pthread_attr_destroy(&attr);
+      if (EXPECT(res != 0, FALSE)) {
+        WARN("Creation of finalizer thread failed\n", 0);
+        return FALSE;
+      }
+      return TRUE;
+    }
+# endif /* FINALIZER_THREADS */
+
 #endif /* MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS && !SN_TARGET_ORBIS && !SN_TARGET_PSP2 */
 
 #if ((defined(MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS_PARAMARK) || defined(USE_PTHREAD_LOCKS)) \
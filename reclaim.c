@@ -20,6 +20,9 @@
 #ifdef ENABLE_DISCLAIM
 # include "gc/gc_disclaim.h"
 #endif
+#ifdef PARALLEL_MARK
+# include "private/gc_pmark.h" /* for MANAGED_STACK_ADDRESS_BOEHM_GC_do_parallel_task */
+#endif
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER signed_word MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_found = 0;
                         /* Number of bytes of memory reclaimed     */
@@ -51,6 +54,9 @@ STATIC unsigned MANAGED_STACK_ADDRESS_BOEHM_GC_n_leaked = 0;
 
 #if !defined(EAGER_SWEEP) && defined(ENABLE_DISCLAIM)
   STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_unconditionally_marked(void);
+# ifdef PARALLEL_MARK
+#   define PARALLEL_DISCLAIM
+# endif
 #endif
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE void MANAGED_STACK_ADDRESS_BOEHM_GC_add_leaked(ptr_t leaked)
@@ -146,10 +152,22 @@ STATIC MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_block_
 /* TODO: This should perhaps again be specialized for USE_MARK_BYTES    */
 /* and USE_MARK_BITS cases.                                             */
 
+#ifndef AVX_CLEAR_MIN_BYTES
+  /* Smaller objects are cleared by the plain loop below.       */
+# define AVX_CLEAR_MIN_BYTES 64
+#endif
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE word *MANAGED_STACK_ADDRESS_BOEHM_GC_clear_block(word *p, word sz, word *pcount)
 {
   word *q = (word *)((ptr_t)p + sz);
 
+# ifdef USE_NT_CLEAR
+    if (sz >= AVX_CLEAR_MIN_BYTES && MANAGED_STACK_ADDRESS_BOEHM_GC_avx_clear) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_clear_words_avx(p + 1 /* skip link field */, q);
+      *pcount += sz;
+      return q;
+    }
+# endif
   /* Clear object, advance p to next object in the process.     */
 # ifdef USE_MARK_BYTES
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT((sz & 1) == 0);
@@ -237,6 +255,51 @@ STATIC ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_uninit(struct hblk *hbp, hdr
 }
 
 #ifdef ENABLE_DISCLAIM
+  /* The number of words of the bitmap passed to the per-block disclaim */
+  /* procedure.                                                         */
+# define DISCLAIM_BITMAP_WORDS divWORDSZ(HBLK_GRANULES + CPP_WORDSZ - 1)
+
+  /* Same as MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_and_reclaim but the per-block reclaim notifier */
+  /* is called once for all the unmarked objects in block.              */
+  STATIC ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_block_and_reclaim(struct hblk *hbp, hdr *hhdr,
+                                             word sz, ptr_t list,
+                                             word *pcount)
+  {
+    word bitmap[DISCLAIM_BITMAP_WORDS];
+    word bit_no, i;
+    word n_objs = HBLK_OBJS(sz);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_bool found = FALSE;
+    ptr_t p;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(n_objs <= HBLK_GRANULES);
+    BZERO(bitmap, sizeof(bitmap));
+    for (i = 0, bit_no = 0; i < n_objs; i++, bit_no += MARK_BIT_OFFSET(sz)) {
+      if (!mark_bit_from_hdr(hhdr, bit_no)) {
+        bitmap[divWORDSZ(i)] |= (word)1 << modWORDSZ(i);
+        found = TRUE;
+      }
+    }
+    if (found)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[hhdr -> hb_obj_kind].ok_disclaim_block_proc(
+                        hbp -> hb_body, (size_t)sz, (size_t)n_objs, bitmap);
+
+    p = hbp -> hb_body;
+    for (i = 0, bit_no = 0; i < n_objs; i++, bit_no += MARK_BIT_OFFSET(sz)) {
+        if (mark_bit_from_hdr(hhdr, bit_no)) {
+            p += sz;
+        } else if (((bitmap[divWORDSZ(i)] >> modWORDSZ(i)) & 1) == 0) {
+            set_mark_bit_from_hdr(hhdr, bit_no);
+            hhdr -> hb_n_marks++;
+            p += sz;
+        } else {
+            obj_link(p) = list;
+            list = p;
+            p = (ptr_t)MANAGED_STACK_ADDRESS_BOEHM_GC_clear_block((word *)p, sz, pcount);
+        }
+    }
+    return list;
+  }
+
   /* Call reclaim notifier for block's kind on each unmarked object in  */
   /* block, all within a pair of corresponding enter/leave callbacks.   */
   STATIC ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_and_reclaim(struct hblk *hbp, hdr *hhdr, word sz,
@@ -247,6 +310,8 @@ STATIC ptr_t MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_uninit(struct hblk *hbp, hdr
     int (MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK *disclaim)(void *) =
                 MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[hhdr -> hb_obj_kind].ok_disclaim_proc;
 
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[hhdr -> hb_obj_kind].ok_disclaim_block_proc != 0)
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_block_and_reclaim(hbp, hhdr, sz, list, pcount);
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(disclaim != 0);
 #   ifndef THREADS
       MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(sz == hhdr -> hb_sz);
@@ -371,6 +436,23 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_small_nonempty_block(struct h
   }
 #endif /* ENABLE_DISCLAIM */
 
+#ifdef PARALLEL_DISCLAIM
+  /* Whether a given block is to be swept by the marker threads in      */
+  /* MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_unconditionally_marked.  The marker threads have all    */
+  /* signals blocked, thus they cannot write to the heap pages          */
+  /* protected by the dirty bits implementation (the disclaim procedure */
+  /* may write to any object).                                          */
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INLINE MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_disclaim_block(hdr *hhdr,
+                                               struct obj_kind *ok)
+  {
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_parallel && (hhdr -> hb_flags & HAS_DISCLAIM) != 0
+           && ok -> ok_disclaim_block_proc != 0
+           && ok -> ok_mark_unconditionally
+           && (!MANAGED_STACK_ADDRESS_BOEHM_GC_auto_incremental
+               || MANAGED_STACK_ADDRESS_BOEHM_GC_incremental_protection_needs() == MANAGED_STACK_ADDRESS_BOEHM_GC_PROTECTS_NONE);
+  }
+#endif /* PARALLEL_DISCLAIM */
+
 /*
  * Restore an unmarked large object or an entirely empty blocks of small objects
  * to the heap block free list.
@@ -400,7 +482,16 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK MANAGED_STACK_ADDRESS_BOEHM_
             } else {
 #             ifdef ENABLE_DISCLAIM
                 if (EXPECT(hhdr -> hb_flags & HAS_DISCLAIM, 0)) {
-                  if (ok -> ok_disclaim_proc(hbp)) {
+                  if (ok -> ok_disclaim_block_proc != 0) {
+                    word bitmap = 1;
+
+                    ok -> ok_disclaim_block_proc(hbp, (size_t)sz, 1,
+                                                 &bitmap);
+                    if (0 == bitmap) {
+                      set_mark_bit_from_hdr(hhdr, 0);
+                      goto in_use;
+                    }
+                  } else if (ok -> ok_disclaim_proc(hbp)) {
                     /* Not disclaimed => resurrect the object. */
                     set_mark_bit_from_hdr(hhdr, 0);
                     goto in_use;
@@ -440,7 +531,12 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK MANAGED_STACK_ADDRESS_BOEHM_
         if (report_if_found) {
           MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_small_nonempty_block(hbp, sz,
                                           TRUE /* report_if_found */);
-        } else if (empty) {
+        } else if (empty
+#                  ifdef PARALLEL_DISCLAIM
+                     /* Such a block is freed once swept.       */
+                     && !MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_disclaim_block(hhdr, ok)
+#                  endif
+                   ) {
 #       ifdef ENABLE_DISCLAIM
           if ((hhdr -> hb_flags & HAS_DISCLAIM) != 0) {
             MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_and_reclaim_or_free_small_block(hbp);
@@ -637,8 +733,10 @@ STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_clear_fl_links(void **flp)
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_start_reclaim(MANAGED_STACK_ADDRESS_BOEHM_GC_bool report_if_found)
 {
     unsigned kind;
+    EVTRACE_SPAN(sp)
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    EVTRACE_BEGIN(sp);
 #   if defined(PARALLEL_MARK)
       MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(0 == MANAGED_STACK_ADDRESS_BOEHM_GC_fl_builder_count);
 #   endif
@@ -688,6 +786,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_start_r
 # if defined(PARALLEL_MARK)
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(0 == MANAGED_STACK_ADDRESS_BOEHM_GC_fl_builder_count);
 # endif
+    EVTRACE_END(sp, 0, EVTRACE_START_RECLAIM, report_if_found, 0);
 }
 
 /* Sweep blocks of the indicated object size and kind until either  */
@@ -699,11 +798,13 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_continu
     struct obj_kind * ok = &MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[kind];
     struct hblk ** rlh = ok -> ok_reclaim_list;
     void **flh = &(ok -> ok_freelist[sz]);
+    EVTRACE_SPAN(sp)
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
-    if (NULL == rlh)
-        return; /* No blocks of this kind.      */
+    if (NULL == rlh || NULL == rlh[sz])
+        return; /* No blocks of this kind and size.     */
 
+    EVTRACE_BEGIN(sp);
     for (rlh += sz; (hbp = *rlh) != NULL; ) {
         hdr *hhdr = HDR(hbp);
 
@@ -712,6 +813,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_continu
         if (*flh != NULL)
             break; /* the appropriate free list is nonempty */
     }
+    EVTRACE_END(sp, 0, EVTRACE_SWEEP, sz, kind);
 }
 
 /*
@@ -731,6 +833,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
     struct hblk * hbp;
     struct hblk ** rlp;
     struct hblk ** rlh;
+    EVTRACE_SPAN(sp)
 #   ifndef NO_CLOCK
       CLOCK_TYPE start_time = CLOCK_TYPE_INITIALIZER;
 
@@ -738,6 +841,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
         GET_TIME(start_time);
 #   endif
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(I_HOLD_LOCK());
+    EVTRACE_BEGIN(sp);
 
     for (kind = 0; kind < MANAGED_STACK_ADDRESS_BOEHM_GC_n_kinds; kind++) {
         rlp = MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[kind].ok_reclaim_list;
@@ -745,6 +849,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
         for (sz = 1; sz <= MAXOBJGRANULES; sz++) {
             for (rlh = rlp + sz; (hbp = *rlh) != NULL; ) {
                 if (stop_func != (MANAGED_STACK_ADDRESS_BOEHM_GC_stop_func)0 && (*stop_func)()) {
+                    EVTRACE_END(sp, 0, EVTRACE_RECLAIM_ALL, FALSE, 0);
                     return FALSE;
                 }
                 hhdr = HDR(hbp);
@@ -770,6 +875,7 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
                         NS_FRAC_TIME_DIFF(done_time, start_time));
       }
 #   endif
+    EVTRACE_END(sp, 0, EVTRACE_RECLAIM_ALL, TRUE, 0);
     return TRUE;
 }
 
@@ -778,9 +884,73 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
 /* been enabled, so that any reclaimable objects have been reclaimed    */
 /* before we start marking.  This is a simplified MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_all        */
 /* restricted to kinds where ok_mark_unconditionally is true.           */
+# ifdef PARALLEL_DISCLAIM
+    struct disclaim_sweep_s {
+      volatile AO_t blocks;
+                /* The unclaimed blocks linked by hb_next.  The links   */
+                /* are not modified during the sweep.                   */
+      volatile AO_t bytes_found;
+    };
+
+    STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_sweep_task(void *client_data)
+    {
+      struct disclaim_sweep_s *t = (struct disclaim_sweep_s *)client_data;
+      word bytes_found = 0;
+
+      for (;;) {
+        struct hblk *hbp;
+        hdr *hhdr;
+        word sz;
+        void **flh;
+        ptr_t list, tail;
+        word bit_no;
+
+        /* Claim the next block.  No block is added to the list, thus   */
+        /* a claimed block never reappears at the head.                 */
+        do {
+          hbp = (struct hblk *)AO_load(&t -> blocks);
+          if (NULL == hbp) break;
+          hhdr = HDR(hbp);
+        } while (!AO_compare_and_swap(&t -> blocks, (AO_t)hbp,
+                                      (AO_t)(hhdr -> hb_next)));
+        if (NULL == hbp) break;
+
+        sz = hhdr -> hb_sz;
+        hhdr -> hb_last_reclaimed = (unsigned short)MANAGED_STACK_ADDRESS_BOEHM_GC_gc_no;
+        list = MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_generic(hbp, hhdr, sz,
+                                  MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[hhdr -> hb_obj_kind].ok_init,
+                                  NULL, &bytes_found);
+        if (NULL == list || 0 == hhdr -> hb_n_marks)
+          continue; /* the empty block is freed by the caller */
+
+        /* The objects are linked in the descending order of their      */
+        /* addresses, thus the tail is the first unmarked one.          */
+        for (bit_no = 0, tail = hbp -> hb_body;
+             mark_bit_from_hdr(hhdr, bit_no);
+             bit_no += MARK_BIT_OFFSET(sz), tail += sz) {
+          /* empty */
+        }
+        flh = &(MANAGED_STACK_ADDRESS_BOEHM_GC_obj_kinds[hhdr -> hb_obj_kind]
+                        .ok_freelist[BYTES_TO_GRANULES(sz)]);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_acquire_mark_lock();
+        obj_link(tail) = *flh;
+        *flh = list;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_release_mark_lock();
+      }
+      if (bytes_found != 0)
+        (void)AO_fetch_and_add(&t -> bytes_found, (AO_t)bytes_found);
+    }
+# endif /* PARALLEL_DISCLAIM */
+
   STATIC void MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_unconditionally_marked(void)
   {
     unsigned kind;
+#   ifdef PARALLEL_DISCLAIM
+      struct disclaim_sweep_s t;
+
+      t.blocks = 0;
+      t.bytes_found = 0;
+#   endif
 
     for (kind = 0; kind < MANAGED_STACK_ADDRESS_BOEHM_GC_n_kinds; kind++) {
         word sz;
@@ -797,10 +967,38 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER MANAGED_STACK_ADDRESS_BOEHM_GC_bool MANAGED
                 hdr *hhdr = HDR(hbp);
 
                 *rlh = hhdr -> hb_next;
+#               ifdef PARALLEL_DISCLAIM
+                  if (MANAGED_STACK_ADDRESS_BOEHM_GC_parallel_disclaim_block(hhdr, ok)) {
+                    hhdr -> hb_next = (struct hblk *)t.blocks;
+                    t.blocks = (AO_t)hbp;
+                    continue;
+                  }
+#               endif
                 MANAGED_STACK_ADDRESS_BOEHM_GC_reclaim_small_nonempty_block(hbp, hhdr -> hb_sz, FALSE);
             }
         }
     }
+
+#   ifdef PARALLEL_DISCLAIM
+      if (t.blocks != 0) {
+        struct hblk *hbp = (struct hblk *)t.blocks;
+
+        MANAGED_STACK_ADDRESS_BOEHM_GC_do_parallel_task(MANAGED_STACK_ADDRESS_BOEHM_GC_disclaim_sweep_task, &t);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_found += (signed_word)t.bytes_found;
+
+        /* Free the blocks left without objects in use. */
+        while (hbp != NULL) {
+          hdr *hhdr = HDR(hbp);
+          struct hblk *next = hhdr -> hb_next;
+
+          if (0 == hhdr -> hb_n_marks) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_bytes_found += (signed_word)HBLKSIZE;
+            MANAGED_STACK_ADDRESS_BOEHM_GC_freehblk(hbp);
+          }
+          hbp = next;
+        }
+      }
+#   endif
   }
 #endif /* !EAGER_SWEEP && ENABLE_DISCLAIM */
 
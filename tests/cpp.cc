@@ -33,6 +33,24 @@ using boehmgc::gc_allocator;
 using boehmgc::gc_allocator_ignore_off_page;
 using boehmgc::traceable_allocator;
 
+#if __cplusplus >= 201703L
+# include <vector>
+# include "gc/gc_typed_cpp.h"
+  using boehmgc::gc_typed_allocator;
+  using boehmgc::gc_typed_new;
+  using boehmgc::gc_typed_new_array;
+# if __has_include(<memory_resource>)
+#   define TEST_MEMORY_RESOURCE
+#   include "gc/gc_memory_resource.h"
+    using boehmgc::gc_arena_memory_resource;
+    using boehmgc::gc_resource;
+# endif
+#endif
+
+#ifdef ENABLE_DISCLAIM
+# include "gc/gc_finalized_cleanup.h"
+#endif
+
 # include "private/gcconfig.h"
 
 # ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_API_PRIV
@@ -240,6 +258,47 @@ int F::nFreedF = 0;
 int F::nAllocatedF = 0;
 
 
+#ifdef ENABLE_DISCLAIM
+  class G: public MANAGED_STACK_ADDRESS_BOEHM_GC_NS_QUALIFY(gc_finalized_cleanup), public A { public:
+    /* A collectible class with clean-up bound at allocation. */
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_EXPLICIT G( int iArg ): A( iArg ) {
+        nAllocated++;}
+    ~G() {
+        nFreed++;}
+    static void Test() {
+        my_assert(nFreed <= nAllocated);
+        my_assert(nFreed >= (nAllocated / 5) * 4 || MANAGED_STACK_ADDRESS_BOEHM_GC_get_find_leak());
+    }
+
+    static int nFreed;
+    static int nAllocated;};
+
+  int G::nFreed = 0;
+  int G::nAllocated = 0;
+#endif
+
+
+#if __cplusplus >= 201703L
+  struct H {
+    /* A precisely scanned list node. */
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word key;
+    H* next;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word pad[3];
+    int* values;
+  };
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_BEGIN_PTR_FIELDS(H)
+    MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_FIELD(next)
+    MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_FIELD(values)
+  MANAGED_STACK_ADDRESS_BOEHM_GC_END_PTR_FIELDS;
+
+  typedef std::pair<MANAGED_STACK_ADDRESS_BOEHM_GC_word, int*> H_pair;
+  typedef std::vector<H_pair, gc_typed_allocator<H_pair> > H_vector;
+#endif
+
+
 MANAGED_STACK_ADDRESS_BOEHM_GC_word Disguise( void* p ) {
     return MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_NZ_POINTER(p);
 }
@@ -355,6 +414,15 @@ void* Undisguise( MANAGED_STACK_ADDRESS_BOEHM_GC_word i ) {
         for (i = 0; i < 1000; i++) {
             as[ i ] = Disguise( new (MANAGED_STACK_ADDRESS_BOEHM_GC_NS_QUALIFY(NoGC)) A(i) );
             bs[ i ] = Disguise( new (MANAGED_STACK_ADDRESS_BOEHM_GC_NS_QUALIFY(NoGC)) B(i) ); }
+#       if __cplusplus >= 201703L
+            H* hl = 0;
+            H_vector hv;
+#       endif
+#       ifdef TEST_MEMORY_RESOURCE
+            gc_arena_memory_resource arena;
+            std::pmr::vector<std::pmr::vector<int> > pv(&arena);
+            std::pmr::vector<int*> gv(gc_resource());
+#       endif
 
             /* Allocate a fair number of finalizable Cs, Ds, and Fs.
             Later we'll check to make sure they've gone away. */
@@ -373,6 +441,25 @@ void* Undisguise( MANAGED_STACK_ADDRESS_BOEHM_GC_word i ) {
             delete[] fa;
             if (0 == i % 10)
                 MANAGED_STACK_ADDRESS_BOEHM_GC_CHECKED_DELETE(c);
+#           if __cplusplus >= 201703L
+              H* h = gc_typed_new<H>();
+              h->key = Disguise(h);
+              h->next = hl;
+              h->values = gc_typed_new_array<int>(2);
+              h->values[1] = i;
+              hl = h;
+              hv.push_back(H_pair(static_cast<MANAGED_STACK_ADDRESS_BOEHM_GC_word>(i), h->values));
+#           endif
+#           ifdef TEST_MEMORY_RESOURCE
+              pv.emplace_back(static_cast<std::size_t>(i % 7), i);
+              gv.push_back(gc_typed_new<int>(i));
+#           endif
+#           ifdef ENABLE_DISCLAIM
+              G* g = new G( i );
+              g->A::Test( i );
+              if (0 == i % 10)
+                  MANAGED_STACK_ADDRESS_BOEHM_GC_CHECKED_DELETE(g);
+#           endif
         }
 
             /* Allocate a very large number of collectible As and Bs and
@@ -417,11 +504,30 @@ void* Undisguise( MANAGED_STACK_ADDRESS_BOEHM_GC_word i ) {
 #           endif
             }
 
+#       if __cplusplus >= 201703L
+            /* Make sure the typed list is intact. */
+          for (i = 999; i >= 0; i--) {
+            my_assert(hl->key == Disguise(hl) && hl->values[1] == i);
+            hl = hl->next; }
+          my_assert(0 == hl);
+          for (i = 0; i < 1000; i++) {
+            my_assert(hv[i].second[1] == i); }
+#       endif
+#       ifdef TEST_MEMORY_RESOURCE
+          for (i = 0; i < 1000; i++) {
+            my_assert(pv[i].size() == static_cast<std::size_t>(i % 7)
+                      && (0 == i % 7 || pv[i][0] == i) && *gv[i] == i); }
+#       endif
+
             /* Make sure most of the finalizable Cs, Ds, and Fs have
             gone away. */
         C::Test();
         D::Test();
-        F::Test();}
+        F::Test();
+#       ifdef ENABLE_DISCLAIM
+          G::Test();
+#       endif
+    }
 
     x = *xptr;
     my_assert(29 == x[0]);
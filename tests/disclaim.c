@@ -94,6 +94,116 @@ static void test_misc_sizes(void)
     }
 }
 
+/* The objects of the kinds with a per-block disclaim procedure.  Those */
+/* with keep set are resurrected by the procedure on every cycle.       */
+struct block_obj_s {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word magic;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word keep;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word resurrected;
+};
+
+#define BLOCK_OBJS 2000
+#define BLOCK_OBJ_MAGIC ((MANAGED_STACK_ADDRESS_BOEHM_GC_word)0xfeedf00dUL)
+
+static volatile MANAGED_STACK_ADDRESS_BOEHM_GC_word block_resurrected_cnt;
+static volatile MANAGED_STACK_ADDRESS_BOEHM_GC_word block_reclaimed_cnt;
+
+static void add_block_cnt(volatile MANAGED_STACK_ADDRESS_BOEHM_GC_word *pcnt, MANAGED_STACK_ADDRESS_BOEHM_GC_word n)
+{
+    /* Called concurrently by the marker threads.       */
+#   ifdef AO_HAVE_fetch_and_add
+        (void)AO_fetch_and_add((volatile AO_t *)pcnt, (AO_t)n);
+#   else
+        *pcnt += n;
+#   endif
+}
+
+static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK block_obj_disclaim(void *hblk, size_t obj_sz,
+                                           size_t n_objs, MANAGED_STACK_ADDRESS_BOEHM_GC_word *bitmap)
+{
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word resurrected = 0, reclaimed = 0;
+    size_t i;
+
+    for (i = 0; i < n_objs; ++i) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_word bit = (MANAGED_STACK_ADDRESS_BOEHM_GC_word)1 << (i % CPP_WORDSZ);
+        struct block_obj_s *obj;
+
+        if ((bitmap[i / CPP_WORDSZ] & bit) == 0) continue;
+        obj = (struct block_obj_s *)((char *)hblk + i * obj_sz);
+        if (obj->magic != BLOCK_OBJ_MAGIC)
+            continue; /* on the free list (cleared) */
+        if (obj->keep) {
+            bitmap[i / CPP_WORDSZ] &= ~bit;
+            obj->resurrected++;
+            ++resurrected;
+        } else {
+            ++reclaimed;
+        }
+    }
+    if (resurrected > 0)
+        add_block_cnt(&block_resurrected_cnt, resurrected);
+    if (reclaimed > 0)
+        add_block_cnt(&block_reclaimed_cnt, reclaimed);
+}
+
+static int MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK block_test_dont_stop(void)
+{
+    return 0; /* unlike MANAGED_STACK_ADDRESS_BOEHM_GC_never_stop_func, causes sweeping all blocks */
+}
+
+/* Check that the objects resurrected by a per-block disclaim procedure */
+/* survive and the others are reclaimed.  The blocks of a kind with     */
+/* mark_from_all set are swept once a collection is complete (by the    */
+/* marker threads, if any), the others are swept by the client thread.  */
+static void test_disclaim_block(int mark_from_all)
+{
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word *hidden = (MANAGED_STACK_ADDRESS_BOEHM_GC_word *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(BLOCK_OBJS
+                                                  * sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word));
+    int kind = (int)MANAGED_STACK_ADDRESS_BOEHM_GC_new_kind(MANAGED_STACK_ADDRESS_BOEHM_GC_new_free_list(), MANAGED_STACK_ADDRESS_BOEHM_GC_DS_LENGTH,
+                                1 /* adjust */, 1 /* clear */);
+    int i, n;
+
+    CHECK_OUT_OF_MEMORY(hidden);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_register_disclaim_block_proc(kind, block_obj_disclaim, mark_from_all);
+    block_resurrected_cnt = 0;
+    block_reclaimed_cnt = 0;
+    for (i = 0; i < BLOCK_OBJS; ++i) {
+        struct block_obj_s *obj = (struct block_obj_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc(
+                                        sizeof(struct block_obj_s), kind);
+
+        CHECK_OUT_OF_MEMORY(obj);
+        obj->magic = BLOCK_OBJ_MAGIC;
+        obj->keep = i % 2 == 0;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_end_stubborn_change(obj);
+        hidden[i] = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj);
+    }
+
+    for (n = 0; n < 3; ++n) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_try_to_collect(block_test_dont_stop);
+        /* Reuse the memory of the reclaimed objects (if any).  */
+        for (i = 0; i < BLOCK_OBJS; ++i) {
+            struct block_obj_s *obj = (struct block_obj_s *)
+                MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc(sizeof(struct block_obj_s), kind);
+
+            CHECK_OUT_OF_MEMORY(obj);
+            obj->magic = 0;
+            obj->keep = 0;
+            MANAGED_STACK_ADDRESS_BOEHM_GC_end_stubborn_change(obj);
+        }
+        for (i = 0; i < BLOCK_OBJS; i += 2) {
+            struct block_obj_s *obj =
+                        (struct block_obj_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_REVEAL_POINTER(hidden[i]);
+
+            my_assert(obj->magic == BLOCK_OBJ_MAGIC && obj->keep);
+        }
+    }
+    my_assert(block_resurrected_cnt >= BLOCK_OBJS / 2);
+    my_assert(block_reclaimed_cnt >= BLOCK_OBJS / 4);
+    printf("Per-block disclaim (mark_from_all=%d): %u resurrected,"
+           " %u reclaimed\n", mark_from_all,
+           (unsigned)block_resurrected_cnt, (unsigned)block_reclaimed_cnt);
+}
+
 typedef struct pair_s *pair_t;
 
 struct pair_s {
@@ -238,6 +348,14 @@ int main(void)
 #   endif
     MANAGED_STACK_ADDRESS_BOEHM_GC_INIT();
     MANAGED_STACK_ADDRESS_BOEHM_GC_init_finalized_malloc();
+    if (!MANAGED_STACK_ADDRESS_BOEHM_GC_get_find_leak()) {
+        /* Let the marker threads sweep the blocks of the kind with     */
+        /* mark_from_all set (before the incremental mode is turned on, */
+        /* as it might prevent the parallel sweeping).                  */
+        MANAGED_STACK_ADDRESS_BOEHM_GC_start_mark_threads();
+        test_disclaim_block(1);
+        test_disclaim_block(0);
+    }
 #   ifndef NO_INCREMENTAL
         MANAGED_STACK_ADDRESS_BOEHM_GC_enable_incremental();
 #   endif
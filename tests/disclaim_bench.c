@@ -40,7 +40,7 @@ static MANAGED_STACK_ADDRESS_BOEHM_GC_RAND_STATE_T seed;
         } \
     } while (0)
 
-static int free_count = 0;
+static volatile MANAGED_STACK_ADDRESS_BOEHM_GC_word free_count = 0;
 
 struct testobj_s {
     struct testobj_s *keep_link;
@@ -51,16 +51,48 @@ typedef struct testobj_s *testobj_t;
 
 static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK testobj_finalize(void *obj, void *carg)
 {
-    ++*(int *)carg;
+    ++*(volatile MANAGED_STACK_ADDRESS_BOEHM_GC_word *)carg;
     my_assert(((testobj_t)obj)->i == 109);
     ((testobj_t)obj)->i = 110;
 }
 
 static const struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_closure fclos = {
     testobj_finalize,
-    &free_count
+    (void *)&free_count
 };
 
+/* The kind of the objects finalized by the per-block disclaim          */
+/* procedure.  Unlike MANAGED_STACK_ADDRESS_BOEHM_GC_finalized_malloc, it is not checked whether an */
+/* object is on the free list, as such one is cleared (i is zero).      */
+static int block_fnlz_kind;
+
+static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK testobj_disclaim_block(void *hblk, size_t obj_sz,
+                                               size_t n_objs,
+                                               MANAGED_STACK_ADDRESS_BOEHM_GC_word *bitmap)
+{
+    int cnt = 0;
+    size_t i;
+
+    for (i = 0; i < n_objs; ++i) {
+        if (((bitmap[i / CPP_WORDSZ] >> (i % CPP_WORDSZ)) & 1) != 0) {
+            testobj_t obj = (testobj_t)((char *)hblk + i * obj_sz);
+
+            if (obj->i == 109) {
+                obj->i = 110;
+                ++cnt;
+            }
+        }
+    }
+    if (cnt > 0) {
+        /* Called concurrently by the marker threads.   */
+#       ifdef AO_HAVE_fetch_and_add
+            (void)AO_fetch_and_add((volatile AO_t *)&free_count, (AO_t)cnt);
+#       else
+            free_count += cnt;
+#       endif
+    }
+}
+
 static testobj_t testobj_new(int model)
 {
     testobj_t obj;
@@ -70,7 +102,7 @@ static testobj_t testobj_new(int model)
             obj = (struct testobj_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(sizeof(struct testobj_s));
             if (obj != NULL)
               MANAGED_STACK_ADDRESS_BOEHM_GC_register_finalizer_no_order(obj, testobj_finalize,
-                                             &free_count, NULL, NULL);
+                                             (void *)&free_count, NULL, NULL);
             break;
 #     endif
         case 1:
@@ -80,6 +112,10 @@ static testobj_t testobj_new(int model)
         case 2:
             obj = (struct testobj_s *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(sizeof(struct testobj_s));
             break;
+        case 3:
+            obj = (testobj_t)MANAGED_STACK_ADDRESS_BOEHM_GC_generic_malloc(sizeof(struct testobj_s),
+                                               block_fnlz_kind);
+            break;
         default:
             exit(-1);
     }
@@ -92,46 +128,64 @@ static testobj_t testobj_new(int model)
 #define ALLOC_CNT (2*1024*1024)
 #define KEEP_CNT      (32*1024)
 
-static char const *model_str[3] = {
+#define MODEL_CNT 4
+
+static char const *model_str[MODEL_CNT] = {
    "regular finalization",
    "finalize on reclaim",
-   "no finalization"
+   "no finalization",
+   "block disclaim"
 };
 
 int main(int argc, char **argv)
 {
-    int i;
+    long i, alloc_cnt = ALLOC_CNT;
     int model, model_min, model_max;
     testobj_t *keep_arr;
 
     MANAGED_STACK_ADDRESS_BOEHM_GC_INIT();
+    /* Let the marker threads sweep the blocks of block_fnlz_kind.      */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_start_mark_threads();
     MANAGED_STACK_ADDRESS_BOEHM_GC_init_finalized_malloc();
-    if (argc == 2 && strcmp(argv[1], "--help") == 0) {
+    block_fnlz_kind = (int)MANAGED_STACK_ADDRESS_BOEHM_GC_new_kind(MANAGED_STACK_ADDRESS_BOEHM_GC_new_free_list(),
+                                       MANAGED_STACK_ADDRESS_BOEHM_GC_DS_LENGTH, 1 /* adjust */,
+                                       1 /* clear */);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_register_disclaim_block_proc(block_fnlz_kind, testobj_disclaim_block,
+                                    1 /* mark_from_all */);
+    if (argc >= 2 && strcmp(argv[1], "--help") == 0) {
         fprintf(stderr,
-                "Usage: %s [FINALIZATION_MODEL]\n"
+                "Usage: %s [FINALIZATION_MODEL [OBJECT_COUNT]]\n"
                 "\t0 -- original finalization\n"
                 "\t1 -- finalization on reclaim\n"
-                "\t2 -- no finalization\n", argv[0]);
+                "\t2 -- no finalization\n"
+                "\t3 -- finalization on reclaim by block disclaim\n"
+                "OBJECT_COUNT defaults to %ld (e.g. use 10000000 to measure"
+                " the sweep throughput)\n", argv[0], (long)ALLOC_CNT);
         return 1;
     }
-    if (argc == 2) {
+    if (argc >= 2) {
         model_min = model_max = (int)COVERT_DATAFLOW(atoi(argv[1]));
-        if (model_min < 0 || model_max > 2)
+        if (model_min < 0 || model_max >= MODEL_CNT)
             exit(2);
+        if (argc >= 3) {
+            alloc_cnt = (long)COVERT_DATAFLOW(atol(argv[2]));
+            if (alloc_cnt <= 0)
+                exit(2);
+        }
     } else {
 #     ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
         model_min = 0;
 #     else
         model_min = 1;
 #     endif
-        model_max = 2;
+        model_max = MODEL_CNT - 1;
     }
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_find_leak())
         printf("This test program is not designed for leak detection mode\n");
 
     keep_arr = (testobj_t *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(sizeof(void *) * KEEP_CNT);
     CHECK_OUT_OF_MEMORY(keep_arr);
-    printf("\t\t\tfin. ratio       time/s    time/fin.\n");
+    printf("\t\t\tfin. ratio       time/s    time/fin.       fin./s\n");
     for (model = model_min; model <= model_max; ++model) {
         double t = 0.0;
 #       ifndef NO_CLOCK
@@ -140,7 +194,7 @@ int main(int argc, char **argv)
             GET_TIME(tI);
 #       endif
         free_count = 0;
-        for (i = 0; i < ALLOC_CNT; ++i) {
+        for (i = 0; i < alloc_cnt; ++i) {
             int k = rand() % KEEP_CNT;
             keep_arr[k] = testobj_new(model);
         }
@@ -156,13 +210,14 @@ int main(int argc, char **argv)
 #       else
 #           define PRINTF_SPEC_12g "%12g"
 #       endif
-        if (model < 2 && free_count > 0) {
-            printf("%20s: %12.4f " PRINTF_SPEC_12g " " PRINTF_SPEC_12g "\n",
-                   model_str[model], free_count / (double)ALLOC_CNT,
-                   t, t / free_count);
+        if (model != 2 && free_count > 0) {
+            printf("%20s: %12.4f " PRINTF_SPEC_12g " " PRINTF_SPEC_12g
+                   " " PRINTF_SPEC_12g "\n",
+                   model_str[model], free_count / (double)alloc_cnt,
+                   t, t / free_count, t > 0.0 ? free_count / t : 0.0);
         } else {
-            printf("%20s: %12.4f " PRINTF_SPEC_12g " %12s\n",
-                   model_str[model], 0.0, t, "N/A");
+            printf("%20s: %12.4f " PRINTF_SPEC_12g " %12s %12s\n",
+                   model_str[model], 0.0, t, "N/A", "N/A");
         }
     }
     return 0;
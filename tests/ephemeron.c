@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2018 Petter A. Urkedal
+ *
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/* This tests a weak hash-consing set built on ephemeron tables: each   */
+/* bucket is a table of pairs whose value refers to the key (the set    */
+/* element), and an element is removed by the collector once it is not  */
+/* reachable other than through the set.                                */
+
+#ifdef HAVE_CONFIG_H
+  /* For MANAGED_STACK_ADDRESS_BOEHM_GC_[P]THREADS */
+# include "config.h"
+#endif
+
+#undef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_THREAD_REDIRECTS
+#include "gc/gc.h"
+
+#define NOT_GCBUILD
+#include "private/gc_priv.h"
+
+#include <string.h>
+
+#undef rand
+static MANAGED_STACK_ADDRESS_BOEHM_GC_RAND_STATE_T seed; /* concurrent update does not hurt the test */
+#define rand() MANAGED_STACK_ADDRESS_BOEHM_GC_RAND_NEXT(&seed)
+
+#ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS
+# ifndef NTHREADS
+#   define NTHREADS 5 /* Excludes main thread, which also runs a test. */
+# endif
+# include <errno.h> /* for EAGAIN */
+# include <pthread.h>
+# include "private/gc_atomic_ops.h" /* for AO_t and AO_fetch_and_add1 */
+#else
+# undef NTHREADS
+# define NTHREADS 0
+# ifndef AO_HAVE_compiler_barrier
+#   define AO_t MANAGED_STACK_ADDRESS_BOEHM_GC_word
+# endif
+#endif
+
+# define POP_SIZE 200
+# define MUTATE_CNT_BASE 700000
+
+#define MUTATE_CNT (MUTATE_CNT_BASE / (NTHREADS+1))
+#define GROW_LIMIT (MUTATE_CNT / 10)
+
+#define WEAKMAP_CAPACITY 256
+#define WEAKMAP_MUTEX_COUNT 32
+#define WEAKMAP_BUCKET_SIZE 4 /* the initial number of pairs */
+
+#define my_assert(e) \
+    if (!(e)) { \
+      fflush(stdout); \
+      fprintf(stderr, "Assertion failure, line %d: %s\n", __LINE__, #e); \
+      exit(70); \
+    }
+
+#define CHECK_OUT_OF_MEMORY(p) \
+    do { \
+        if (NULL == (p)) { \
+            fprintf(stderr, "Out of memory\n"); \
+            exit(69); \
+        } \
+    } while (0)
+
+#ifndef AO_HAVE_fetch_and_add1
+# define AO_fetch_and_add1(p) ((*(p))++)
+                /* This is used only to update counters.        */
+#endif
+
+static unsigned memhash(void *src, size_t len)
+{
+  unsigned acc = 0;
+  size_t i;
+
+  my_assert(len % sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word) == 0);
+  for (i = 0; i < len / sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word); ++i) {
+    acc = (unsigned)((2003 * (MANAGED_STACK_ADDRESS_BOEHM_GC_word)acc + ((MANAGED_STACK_ADDRESS_BOEHM_GC_word *)src)[i]) / 3);
+  }
+  return acc;
+}
+
+static volatile AO_t stat_added;
+static volatile AO_t stat_found;
+static volatile AO_t stat_grown;
+
+/* The value of an entry of the map; it refers to the key (the entry    */
+/* object), which should not prevent the removal of the entry.          */
+struct weakmap_value {
+  void *obj;
+  unsigned hash;
+};
+
+struct weakmap {
+# ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS
+    pthread_mutex_t mutex[WEAKMAP_MUTEX_COUNT];
+# endif
+  size_t key_size;
+  size_t obj_size;
+  size_t capacity;
+  void **tables; /* ephemeron tables; NULL means weakmap is destroyed */
+};
+
+static void weakmap_lock(struct weakmap *wm, unsigned h)
+{
+# ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS
+    int err = pthread_mutex_lock(&wm->mutex[h % WEAKMAP_MUTEX_COUNT]);
+    my_assert(0 == err);
+# else
+    (void)wm; (void)h;
+# endif
+}
+
+static void weakmap_unlock(struct weakmap *wm, unsigned h)
+{
+# ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS
+    int err = pthread_mutex_unlock(&wm->mutex[h % WEAKMAP_MUTEX_COUNT]);
+    my_assert(0 == err);
+# else
+    (void)wm; (void)h;
+# endif
+}
+
+/* Replace a full table of a bucket by a twice larger one.  Returns the */
+/* index of the first empty pair of the new table.                      */
+static size_t weakmap_grow(void **ptbl)
+{
+  void *tbl = *ptbl;
+  size_t i, j, n = MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_size(tbl);
+  void *new_tbl = MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_ephemeron_table(2 * n);
+
+  CHECK_OUT_OF_MEMORY(new_tbl);
+  for (i = 0, j = 0; i < n; ++i) {
+    void *value;
+    void *key = MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_get(tbl, i, &value);
+
+    if (key != NULL)
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_set(new_tbl, j++, key, value);
+  }
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ptr_store_and_dirty(ptbl, new_tbl);
+  AO_fetch_and_add1(&stat_grown);
+  return j;
+}
+
+static void *weakmap_add(struct weakmap *wm, void *obj, size_t obj_size)
+{
+  void **ptbl;
+  struct weakmap_value *value;
+  void *new_obj;
+  unsigned h;
+  size_t i, n, empty_i;
+  size_t key_size = wm->key_size;
+
+  /* Lock and look for an existing entry.       */
+  my_assert(key_size <= obj_size);
+  h = memhash(obj, key_size);
+  ptbl = &wm->tables[h % wm->capacity];
+  weakmap_lock(wm, h);
+
+  n = MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_size(*ptbl);
+  empty_i = n;
+  for (i = 0; i < n; ++i) {
+    void *v;
+    void *old_obj = MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_get(*ptbl, i, &v);
+
+    if (NULL == old_obj) {
+      if (empty_i == n) empty_i = i;
+      continue;
+    }
+    value = (struct weakmap_value *)v;
+    my_assert(value != NULL && value->obj == old_obj);
+    if (value->hash == h && memcmp(old_obj, obj, key_size) == 0) {
+      /* The rest of an element is determined by its key part.      */
+      my_assert(memcmp((char *)old_obj + key_size, (char *)obj + key_size,
+                       wm->obj_size - key_size) == 0);
+      weakmap_unlock(wm, h);
+      AO_fetch_and_add1(&stat_found);
+#     ifdef DEBUG_EPHEMERON
+        printf("Found %p, hash= %p\n", old_obj, (void *)(MANAGED_STACK_ADDRESS_BOEHM_GC_word)h);
+#     endif
+      return old_obj;
+    }
+  }
+
+  /* Create new object. */
+  new_obj = MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(wm->obj_size);
+  CHECK_OUT_OF_MEMORY(new_obj);
+  memcpy(new_obj, obj, wm->obj_size);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_end_stubborn_change(new_obj);
+  value = (struct weakmap_value *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(sizeof(struct weakmap_value));
+  CHECK_OUT_OF_MEMORY(value);
+  value->obj = new_obj;
+  value->hash = h;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_end_stubborn_change(value);
+
+  /* Add the object to the map. */
+  if (empty_i == n)
+    empty_i = weakmap_grow(ptbl);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_set(*ptbl, empty_i, new_obj, value);
+  weakmap_unlock(wm, h);
+  AO_fetch_and_add1(&stat_added);
+# ifdef DEBUG_EPHEMERON
+    printf("Added %p, hash= %p\n", new_obj, (void *)(MANAGED_STACK_ADDRESS_BOEHM_GC_word)h);
+# endif
+  return new_obj;
+}
+
+/* Return the number of the elements of the set.                        */
+static unsigned weakmap_count(struct weakmap *wm)
+{
+  size_t i, j;
+  unsigned count = 0;
+
+  for (i = 0; i < wm->capacity; ++i) {
+    size_t n = MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_size(wm->tables[i]);
+
+    for (j = 0; j < n; ++j) {
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_get(wm->tables[i], j, NULL) != NULL)
+        count++;
+    }
+  }
+  return count;
+}
+
+static struct weakmap *weakmap_new(size_t capacity, size_t key_size,
+                                   size_t obj_size)
+{
+  struct weakmap *wm = (struct weakmap *)MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(sizeof(struct weakmap));
+  size_t i;
+
+  CHECK_OUT_OF_MEMORY(wm);
+# ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS
+    for (i = 0; i < WEAKMAP_MUTEX_COUNT; ++i) {
+      int err = pthread_mutex_init(&wm->mutex[i], NULL);
+      my_assert(err == 0);
+    }
+# endif
+  wm->key_size = key_size;
+  wm->obj_size = obj_size;
+  wm->capacity = capacity;
+  MANAGED_STACK_ADDRESS_BOEHM_GC_ptr_store_and_dirty(&wm->tables, MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(sizeof(void *) * capacity));
+  CHECK_OUT_OF_MEMORY(wm->tables);
+  for (i = 0; i < capacity; ++i) {
+    void *tbl = MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_ephemeron_table(WEAKMAP_BUCKET_SIZE);
+
+    CHECK_OUT_OF_MEMORY(tbl);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_ptr_store_and_dirty(&wm->tables[i], tbl);
+  }
+  return wm;
+}
+
+static void weakmap_destroy(struct weakmap *wm)
+{
+# ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS
+    int i;
+
+    for (i = 0; i < WEAKMAP_MUTEX_COUNT; ++i) {
+      (void)pthread_mutex_destroy(&wm->mutex[i]);
+    }
+# endif
+  wm->tables = NULL; /* weakmap is destroyed */
+}
+
+struct weakmap *pair_hcset;
+
+#define PAIR_MAGIC_SIZE 16 /* should not exceed sizeof(pair_magic) */
+
+struct pair_key {
+  struct pair *car, *cdr;
+};
+
+struct pair {
+  struct pair *car;
+  struct pair *cdr;
+  char magic[PAIR_MAGIC_SIZE];
+  int checksum;
+};
+
+static const char * const pair_magic = "PAIR_MAGIC_BYTES";
+
+#define CSUM_SEED 782
+
+static struct pair *pair_new(struct pair *car, struct pair *cdr)
+{
+  struct pair tmpl;
+
+  memset(&tmpl, 0, sizeof(tmpl));   /* To clear the paddings (to avoid  */
+                                    /* a compiler warning).             */
+  tmpl.car = car;
+  tmpl.cdr = cdr;
+  memcpy(tmpl.magic, pair_magic, PAIR_MAGIC_SIZE);
+  tmpl.checksum = CSUM_SEED + (car != NULL ? car->checksum : 0)
+                        + (cdr != NULL ? cdr->checksum : 0);
+  return (struct pair *)weakmap_add(pair_hcset, &tmpl, sizeof(tmpl));
+}
+
+static void pair_check_rec(struct pair *p, int line)
+{
+  while (p != NULL) {
+    int checksum = CSUM_SEED;
+
+    if (memcmp(p->magic, pair_magic, PAIR_MAGIC_SIZE) != 0) {
+      fprintf(stderr, "Magic bytes wrong for %p at %d\n", (void *)p, line);
+      exit(70);
+    }
+    if (p->car != NULL)
+      checksum += p->car->checksum;
+    if (p->cdr != NULL)
+      checksum += p->cdr->checksum;
+    if (p->checksum != checksum) {
+      fprintf(stderr, "Checksum failure for %p: (car= %p, cdr= %p) at %d\n",
+              (void *)p, (void *)p->car, (void *)p->cdr, line);
+      exit(70);
+    }
+    p = (rand() & 1) != 0 ? p->cdr : p->car;
+  }
+}
+
+static void *test(void *data)
+{
+  int i;
+  struct pair *p0, *p1;
+  struct pair *pop[POP_SIZE];
+
+  memset(pop, 0, sizeof(pop));
+  for (i = 0; i < MUTATE_CNT; ++i) {
+    int bits = rand();
+    int t = (bits >> 3) % POP_SIZE;
+
+    switch (bits % (i > GROW_LIMIT ? 5 : 3)) {
+    case 0:
+    case 3:
+      if (pop[t] != NULL)
+        pop[t] = pop[t]->car;
+      break;
+    case 1:
+    case 4:
+      if (pop[t] != NULL)
+        pop[t] = pop[t]->cdr;
+      break;
+    case 2:
+      p0 = pop[rand() % POP_SIZE];
+      p1 = pop[rand() % POP_SIZE];
+      pop[t] = pair_new(p0, p1);
+      my_assert(pair_new(p0, p1) == pop[t]);
+      my_assert(pop[t]->car == p0);
+      my_assert(pop[t]->cdr == p1);
+      break;
+    }
+    pair_check_rec(pop[rand() % POP_SIZE], __LINE__);
+  }
+  return data;
+}
+
+int main(void)
+{
+  unsigned remains;
+# if NTHREADS > 0
+    int i, n;
+    pthread_t th[NTHREADS];
+# endif
+
+  MANAGED_STACK_ADDRESS_BOEHM_GC_set_all_interior_pointers(0); /* for a stricter test */
+# ifdef TEST_MANUAL_VDB
+    MANAGED_STACK_ADDRESS_BOEHM_GC_set_manual_vdb_allowed(1);
+# endif
+  MANAGED_STACK_ADDRESS_BOEHM_GC_INIT();
+# ifndef NO_INCREMENTAL
+    MANAGED_STACK_ADDRESS_BOEHM_GC_enable_incremental();
+# endif
+  if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_find_leak())
+    printf("This test program is not designed for leak detection mode\n");
+  pair_hcset = weakmap_new(WEAKMAP_CAPACITY, sizeof(struct pair_key),
+                           sizeof(struct pair));
+
+# if NTHREADS > 0
+    for (i = 0; i < NTHREADS; ++i) {
+      int err = pthread_create(&th[i], NULL, test, NULL);
+      if (err != 0) {
+        fprintf(stderr, "Thread #%d creation failed: %s\n",
+                i, strerror(err));
+        if (i > 1 && EAGAIN == err) break;
+        exit(1);
+      }
+    }
+    n = i;
+# endif
+  (void)test(NULL);
+# if NTHREADS > 0
+    for (i = 0; i < n; ++i) {
+      int err = pthread_join(th[i], NULL);
+      if (err != 0) {
+        fprintf(stderr, "Thread #%d join failed: %s\n", i, strerror(err));
+        exit(69);
+      }
+    }
+# endif
+  MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+  remains = weakmap_count(pair_hcset);
+  weakmap_destroy(pair_hcset);
+  printf("%u added, %u found; %u removed, %u grown; %u remains\n",
+         (unsigned)stat_added, (unsigned)stat_found,
+         (unsigned)stat_added - remains, (unsigned)stat_grown, remains);
+  if (!MANAGED_STACK_ADDRESS_BOEHM_GC_get_find_leak() && remains == (unsigned)stat_added) {
+    fprintf(stderr, "No unreachable element is removed from the set\n");
+    exit(1);
+  }
+  return 0;
+}
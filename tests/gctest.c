@@ -75,6 +75,13 @@
 # include "gc/gc_typed.h"
 #endif
 
+#ifdef ENABLE_HEAP_PROFILE
+# include "gc/gc_heap_profile.h"
+#endif
+#ifdef ENABLE_EVENT_TRACE
+# include "gc/gc_event_trace.h"
+#endif
+
 #define NOT_GCBUILD
 #include "private/gc_priv.h"    /* For output, locking,                 */
                                 /* some statistics and gcconfig.h.      */
@@ -176,7 +183,7 @@
 
 /* Call MANAGED_STACK_ADDRESS_BOEHM_GC_INIT only on platforms on which we think we really need it,  */
 /* so that we can test automatic initialization on the rest.            */
-#if defined(TEST_EXPLICIT_MANAGED_STACK_ADDRESS_BOEHM_GC_INIT) || defined(AIX) || defined(CYGWIN32) \
+#if defined(TEST_EXPLICIT_GC_INIT) || defined(AIX) || defined(CYGWIN32) \
         || defined(DARWIN) || defined(HOST_ANDROID) \
         || (defined(MSWINCE) && !defined(MANAGED_STACK_ADDRESS_BOEHM_GC_WINMAIN_REDIRECT))
 # define MANAGED_STACK_ADDRESS_BOEHM_GC_OPT_INIT MANAGED_STACK_ADDRESS_BOEHM_GC_INIT()
@@ -240,6 +247,9 @@ static void *checkOOM(void *p)
 # define AO_fetch_and_add1(p) ((*(p))++)
                 /* This is used only to update counters.        */
 #endif
+#ifndef AO_HAVE_fetch_and_add
+# define AO_fetch_and_add(p, v) ((*(p)) += (v))
+#endif
 
 /* Allocation Statistics.  Synchronization is not strictly necessary.   */
 static volatile AO_t uncollectable_count = 0;
@@ -1081,6 +1091,12 @@ static tn * mktree(int n)
         CHECK_OUT_OF_MEMORY(right);
         MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_DIRTY(&left->rchild, right->lchild);
         MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_DIRTY(&right->lchild, tmp);
+
+        /* Swap the other pair of grandchildren using the inline card   */
+        /* marking barrier.                                             */
+        tmp = left -> lchild;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_MARK_CARD(&left->lchild, right->rchild);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_MARK_CARD(&right->rchild, tmp);
     }
     if (AO_fetch_and_add1(&extra_count) % 119 == 0) {
 #       ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
@@ -1139,6 +1155,19 @@ static tn * mktree(int n)
             MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link(new_link) failed 2\n");
             FAIL;
         }
+        *new_link = (void *)MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(result);
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_GENERAL_REGISTER_DISAPPEARING_LINK(new_link, result) != 0) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_general_register_disappearing_link failed 3\n");
+            FAIL;
+        }
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link(new_link) != result) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link failed\n");
+            FAIL;
+        }
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link(new_link) == 0) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link failed 2\n");
+            FAIL;
+        }
         if (MANAGED_STACK_ADDRESS_BOEHM_GC_GENERAL_REGISTER_DISAPPEARING_LINK(
                     (void **)(&(live_indicators[my_index])), result) != 0) {
             MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_general_register_disappearing_link failed 2\n");
@@ -1326,6 +1355,206 @@ static void tree_test(void)
 #   endif
 }
 
+#ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
+# define EPHEMERON_PAIRS 64
+
+  static volatile AO_t ephemeron_dropped_count = 0;
+  static volatile AO_t ephemeron_cleared_count = 0;
+
+  /* Each value refers to its key; only the keys of the even pairs are  */
+  /* reachable otherwise.                                               */
+  static void ephemeron_test(void)
+  {
+    void *tbl = checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_ephemeron_table(EPHEMERON_PAIRS));
+    void **live_keys = (void **)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(
+                                EPHEMERON_PAIRS / 2 * sizeof(void *)));
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word cleared = 0;
+    int i;
+
+    AO_fetch_and_add1(&collectable_count);
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_size(tbl) != EPHEMERON_PAIRS) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Wrong ephemeron table size\n");
+      FAIL;
+    }
+    for (i = 0; i < EPHEMERON_PAIRS; i++) {
+      void *key = checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(sizeof(void *)));
+      void **value = (void **)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(sizeof(void *)));
+
+      AO_fetch_and_add1(&collectable_count);
+      AO_fetch_and_add1(&collectable_count);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_DIRTY(value, key);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_set(tbl, (size_t)i, key, value);
+      if (i % 2 == 0) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_DIRTY(&live_keys[i / 2], key);
+      } else {
+        AO_fetch_and_add1(&ephemeron_dropped_count);
+      }
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+    for (i = 0; i < EPHEMERON_PAIRS; i++) {
+      void *value;
+      void *key = MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_get(tbl, (size_t)i, &value);
+
+      if (i % 2 == 0) {
+        if (key != live_keys[i / 2] || NULL == value
+            || *(void **)value != key) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Ephemeron value lost - collector is broken\n");
+          FAIL;
+        }
+      } else if (NULL == key) {
+        if (value != NULL) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Ephemeron pair not cleared entirely\n");
+          FAIL;
+        }
+        cleared++;
+        AO_fetch_and_add1(&ephemeron_cleared_count);
+      }
+    }
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_ephemeron_table_cleared(tbl) != cleared) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Wrong count of cleared ephemeron pairs\n");
+      FAIL;
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_reachable_here(live_keys);
+  }
+
+# ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
+#   define TOGGLEREF_OBJS 300
+
+    static volatile AO_t toggleref_seen_count = 0;
+
+    /* The objects of toggleref_states_test (hidden), the status of the */
+    /* k-th one is STRONG, DROP or WEAK depending on k % 3.             */
+#   define TOGGLEREF_STATE_OBJS 30
+    static MANAGED_STACK_ADDRESS_BOEHM_GC_word toggleref_state_objs[TOGGLEREF_STATE_OBJS];
+    static int toggleref_state_dropped[TOGGLEREF_STATE_OBJS];
+    static int toggleref_state_last = -1;
+    static int toggleref_state_strong_seen = 0;
+
+    /* Return the status of a given object of toggleref_states_test, or */
+    /* WEAK for the other objects.  Called with the allocation lock.    */
+    static MANAGED_STACK_ADDRESS_BOEHM_GC_ToggleRefStatus toggleref_state_of(void *obj)
+    {
+      int k;
+
+      for (k = 0; k < TOGGLEREF_STATE_OBJS; k++) {
+        if (toggleref_state_objs[k] == MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(obj)) break;
+      }
+      if (TOGGLEREF_STATE_OBJS == k) return MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_WEAK;
+
+      /* The first object is strong, thus it is passed first to the     */
+      /* callback in every collection; the others should follow in the  */
+      /* order of their registration (despite the array compaction).    */
+      if (0 == k) {
+        toggleref_state_strong_seen = 0;
+      } else if (k <= toggleref_state_last) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Toggle-ref objects passed out of order: %d after %d\n",
+                  k, toggleref_state_last);
+        FAIL;
+      }
+      toggleref_state_last = k;
+      switch (k % 3) {
+      case 0:
+        toggleref_state_strong_seen++;
+        return MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_STRONG;
+      case 1:
+        if (toggleref_state_dropped[k]) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Dropped toggle-ref object passed to callback again\n");
+          FAIL;
+        }
+        toggleref_state_dropped[k] = 1;
+        return MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_DROP;
+      }
+      return MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REF_WEAK;
+    }
+
+    static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK toggleref_batch_cb(void **objs,
+                                MANAGED_STACK_ADDRESS_BOEHM_GC_ToggleRefStatus *statuses, size_t n)
+    {
+      size_t i;
+
+      for (i = 0; i < n; i++) {
+        if (NULL == objs[i]) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("NULL object passed to toggle-ref callback\n");
+          FAIL;
+        }
+        statuses[i] = toggleref_state_of(objs[i]);
+      }
+      AO_fetch_and_add(&toggleref_seen_count, (AO_t)n);
+    }
+
+    /* The objects are referenced strongly until the first collection,  */
+    /* weakly thereafter.  The number of the objects exceeds the batch  */
+    /* size (by default).                                               */
+    static void toggleref_test(void)
+    {
+      int i;
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_set_toggleref_batch_func(toggleref_batch_cb);
+      for (i = 0; i < TOGGLEREF_OBJS; i++) {
+        void *p = checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word)));
+
+        AO_fetch_and_add1(&collectable_count);
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLEREF_ADD(p, 1) == MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Out of memory in MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_add\n");
+          exit(69);
+        }
+      }
+      MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+    }
+
+    /* Check the toggle-ref states: the objects referenced strongly     */
+    /* survive, the dropped ones are not passed to the callback again,  */
+    /* the rest are passed in the order of registration.  Called when   */
+    /* no other thread registers toggle-refs.                           */
+    static void toggleref_states_test(void)
+    {
+      void **links = (void **)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(
+                                TOGGLEREF_STATE_OBJS * sizeof(void *)));
+      int k;
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_set_toggleref_batch_func(toggleref_batch_cb);
+      for (k = 0; k < TOGGLEREF_STATE_OBJS; k++) {
+        void *p = checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word)));
+
+        AO_fetch_and_add1(&collectable_count);
+        links[k] = (void *)MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(p);
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_GENERAL_REGISTER_DISAPPEARING_LINK(&links[k], p) != 0) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Disappearing link registration failed\n");
+          FAIL;
+        }
+        MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_lock();
+        toggleref_state_objs[k] = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(MANAGED_STACK_ADDRESS_BOEHM_GC_base(p));
+        MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_unlock();
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLEREF_ADD(p, 1) == MANAGED_STACK_ADDRESS_BOEHM_GC_NO_MEMORY) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Out of memory in MANAGED_STACK_ADDRESS_BOEHM_GC_toggleref_add\n");
+          exit(69);
+        }
+      }
+      for (k = 0; k < 3; k++)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_lock();
+      for (k = 0; k < TOGGLEREF_STATE_OBJS; k++) {
+        if (k % 3 == 0 && NULL == links[k]) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Strong toggle-ref object %d collected\n", k);
+          FAIL;
+        }
+        if (k % 3 == 1 && !toggleref_state_dropped[k]) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Toggle-ref object %d not passed to callback\n", k);
+          FAIL;
+        }
+      }
+      if (toggleref_state_strong_seen != (TOGGLEREF_STATE_OBJS + 2) / 3) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Toggle-ref callback saw %d strong objects, expected %d\n",
+                  toggleref_state_strong_seen,
+                  (TOGGLEREF_STATE_OBJS + 2) / 3);
+        FAIL;
+      }
+      MANAGED_STACK_ADDRESS_BOEHM_GC_alloc_unlock();
+    }
+# endif
+#endif /* !MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION */
+
 unsigned n_tests = 0;
 
 #ifndef NO_TYPED_TEST
@@ -1553,6 +1782,12 @@ static void run_one_test(void)
       }
 #   endif
     test_tinyfl();
+#   ifdef ENABLE_HEAP_PROFILE
+      MANAGED_STACK_ADDRESS_BOEHM_GC_set_heap_profile_interval(64 * 1024);
+#   endif
+#   ifdef ENABLE_EVENT_TRACE
+      MANAGED_STACK_ADDRESS_BOEHM_GC_set_event_tracing(1);
+#   endif
 #   ifndef DBG_HDRS_ALL
       x = (char *)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(7));
       AO_fetch_and_add1(&collectable_count);
@@ -1663,6 +1898,14 @@ static void run_one_test(void)
                         (unsigned)i, p);
               FAIL;
             }
+            p = checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_memalign_kind(i, 17, MANAGED_STACK_ADDRESS_BOEHM_GC_I_PTRFREE));
+            AO_fetch_and_add1(&atomic_count);
+            if ((MANAGED_STACK_ADDRESS_BOEHM_GC_word)p % i != 0
+                || MANAGED_STACK_ADDRESS_BOEHM_GC_get_kind_and_size(MANAGED_STACK_ADDRESS_BOEHM_GC_base(p), NULL) != MANAGED_STACK_ADDRESS_BOEHM_GC_I_PTRFREE) {
+              MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_memalign_kind(%u,17) produced incorrect result:"
+                        " %p\n", (unsigned)i, p);
+              FAIL;
+            }
           }
           (void)MANAGED_STACK_ADDRESS_BOEHM_GC_posix_memalign(&p, 64, 1);
           CHECK_OUT_OF_MEMORY(p);
@@ -1888,6 +2131,12 @@ static void run_one_test(void)
 #     endif
 #   endif /* !NO_TYPED_TEST */
     tree_test();
+#   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
+      ephemeron_test();
+#     ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
+        toggleref_test();
+#     endif
+#   endif
 #   ifdef TEST_WITH_SYSTEM_MALLOC
       free(checkOOM(calloc(1, 1)));
       free(checkOOM(realloc(NULL, 64)));
@@ -1952,6 +2201,183 @@ static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK reachable_objs_counter(void
   (*(unsigned *)pcounter)++;
 }
 
+#ifdef ENABLE_HEAP_PROFILE
+  struct profile_buf_s {
+    unsigned char *data;
+    size_t len;
+    size_t cap;
+  };
+
+  static int MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK save_profile_bytes(void *pbuf, const void *buf,
+                                            size_t len)
+  {
+    struct profile_buf_s *pb = (struct profile_buf_s *)pbuf;
+
+    if (NULL == buf || 0 == len) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Empty heap profile output chunk\n");
+      FAIL;
+    }
+    if (len > pb -> cap - pb -> len) {
+      size_t new_cap = 2 * (pb -> len + len);
+      unsigned char *data = (unsigned char *)checkOOM(
+                                        MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(new_cap));
+
+      if (pb -> len > 0) BCOPY(pb -> data, data, pb -> len);
+      pb -> data = data;
+      pb -> cap = new_cap;
+    }
+    BCOPY(buf, pb -> data + pb -> len, len);
+    pb -> len += len;
+    return 0;
+  }
+
+  static MANAGED_STACK_ADDRESS_BOEHM_GC_word read_profile_varint(const unsigned char *data,
+                                     size_t len, size_t *ppos)
+  {
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word v = 0;
+    unsigned shift;
+
+    for (shift = 0; shift < CPP_WORDSZ; shift += 7) {
+      unsigned char c;
+
+      if (*ppos >= len) break;
+      c = data[(*ppos)++];
+      v |= (MANAGED_STACK_ADDRESS_BOEHM_GC_word)(c & 0x7f) << shift;
+      if ((c & 0x80) == 0) return v;
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Bad varint in heap profile at offset %lu\n",
+              (unsigned long)(*ppos));
+    FAIL;
+    return 0;
+  }
+
+# define PROFILE_MAX_STRINGS 16
+
+  /* Check the protocol buffer framing of the profile, the presence of  */
+  /* samples and the names of the sample types (resolved through the    */
+  /* string table).                                                     */
+  static void check_heap_profile(const struct profile_buf_s *pb)
+  {
+    static const char * const type_names[] = {
+      "alloc_objects", "alloc_space", "inuse_objects", "inuse_space"
+    };
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word types[4];
+    size_t str_pos[PROFILE_MAX_STRINGS], str_len[PROFILE_MAX_STRINGS];
+    size_t pos = 0;
+    unsigned n_types = 0, n_strings = 0, i;
+    unsigned long n_samples = 0;
+
+    while (pos < pb -> len) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_word key = read_profile_varint(pb -> data, pb -> len, &pos);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_word len;
+
+      if ((key & 7) == 0) { /* varint */
+        (void)read_profile_varint(pb -> data, pb -> len, &pos);
+        continue;
+      }
+      if ((key & 7) != 2) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Unexpected wire type %u in heap profile\n",
+                  (unsigned)(key & 7));
+        FAIL;
+      }
+      len = read_profile_varint(pb -> data, pb -> len, &pos);
+      if (len > pb -> len - pos) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Truncated heap profile field %u\n", (unsigned)(key >> 3));
+        FAIL;
+      }
+      switch (key >> 3) {
+      case 1: /* sample_type */
+        if (n_types < 4) {
+          size_t p = pos;
+
+          types[n_types] = 0;
+          while (p < pos + (size_t)len) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_word k = read_profile_varint(pb -> data, pos + (size_t)len,
+                                            &p);
+            MANAGED_STACK_ADDRESS_BOEHM_GC_word v = read_profile_varint(pb -> data, pos + (size_t)len,
+                                            &p);
+
+            if (k == ((1 << 3) | 0)) types[n_types] = v; /* type */
+          }
+        }
+        n_types++;
+        break;
+      case 2: /* sample */
+        n_samples++;
+        break;
+      case 6: /* string_table */
+        if (n_strings < PROFILE_MAX_STRINGS) {
+          str_pos[n_strings] = pos;
+          str_len[n_strings] = (size_t)len;
+        }
+        n_strings++;
+        break;
+      }
+      pos += (size_t)len;
+    }
+
+    if (n_types != 4 || 0 == n_strings || str_len[0] != 0
+        || 0 == n_samples) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Bad heap profile: %u sample types, %u strings,"
+                " %lu samples\n", n_types, n_strings, n_samples);
+      FAIL;
+    }
+    for (i = 0; i < 4; i++) {
+      size_t name_len = strlen(type_names[i]);
+
+      if (types[i] >= n_strings || types[i] >= PROFILE_MAX_STRINGS
+          || str_len[types[i]] != name_len
+          || memcmp(pb -> data + str_pos[types[i]], type_names[i],
+                    name_len) != 0) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Heap profile sample type %u is not %s\n",
+                  i, type_names[i]);
+        FAIL;
+      }
+    }
+  }
+#endif
+
+#ifdef ENABLE_EVENT_TRACE
+  /* The beginning of a collection span.  The first character does not  */
+  /* occur elsewhere in it, thus a mismatch restarts the matching.      */
+  static const char trace_collection_span[] =
+                        "{\"name\":\"collection\",\"ph\":\"X\"";
+
+  struct trace_check_s {
+    size_t len;
+    char first;
+    char last;
+    size_t matched; /* prefix of trace_collection_span */
+    int collection_found;
+  };
+
+  static int MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK check_trace_chunk(void *pcheck, const void *buf,
+                                           size_t len)
+  {
+    struct trace_check_s *pc = (struct trace_check_s *)pcheck;
+    size_t i;
+
+    if (NULL == buf || 0 == len) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Empty event trace output chunk\n");
+      FAIL;
+    }
+    if (0 == pc -> len) pc -> first = *(const char *)buf;
+    pc -> last = ((const char *)buf)[len - 1];
+    for (i = 0; i < len && !(pc -> collection_found); i++) {
+      char c = ((const char *)buf)[i];
+
+      if (c == trace_collection_span[pc -> matched]) {
+        if (++(pc -> matched) == sizeof(trace_collection_span) - 1)
+          pc -> collection_found = 1;
+      } else {
+        pc -> matched = c == trace_collection_span[0] ? 1 : 0;
+      }
+    }
+    pc -> len += len;
+    return 0;
+  }
+#endif
+
 /* A minimal testing of LONG_MULT().    */
 static void test_long_mult(void)
 {
@@ -2022,6 +2448,13 @@ static void check_heap_stats(void)
       max_heap_sz = NUMBER_ROUND_UP(max_heap_sz, 4 * 1024 * 1024);
 #   endif
 
+    /* Do the outstanding collector work in short idle periods first.   */
+      for (i = 0; i < 1000; i++) {
+        if ((MANAGED_STACK_ADDRESS_BOEHM_GC_collect_idle(100000 /* 100 us */)
+             & ~(unsigned)MANAGED_STACK_ADDRESS_BOEHM_GC_IDLE_WORK_FINALIZE) == 0)
+          break;
+      }
+
     /* Garbage collect repeatedly so that all inaccessible objects      */
     /* can be finalized.                                                */
       while (MANAGED_STACK_ADDRESS_BOEHM_GC_collect_a_little()) { } /* should work even if disabled GC */
@@ -2083,6 +2516,36 @@ static void check_heap_stats(void)
         MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Finalized %d/%d objects - finalization is probably OK\n",
                   finalized_count, finalizable_count);
       }
+      if (ephemeron_cleared_count < ephemeron_dropped_count / 2) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Cleared %d/%d ephemeron pairs - "
+                  "ephemerons are probably broken\n",
+                  (int)ephemeron_cleared_count,
+                  (int)ephemeron_dropped_count);
+        FAIL;
+      }
+#     ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
+        toggleref_states_test();
+        if (toggleref_seen_count < TOGGLEREF_OBJS) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Toggle-ref callback saw %d objects, expected %d\n",
+                    (int)toggleref_seen_count, TOGGLEREF_OBJS);
+          FAIL;
+        }
+#     endif
+      {
+        struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_stats_s fstats;
+
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalizer_stats(&fstats, sizeof(fstats))
+                != sizeof(fstats)) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalizer_stats failed\n");
+          FAIL;
+        }
+        if (print_stats)
+          MANAGED_STACK_ADDRESS_BOEHM_GC_log_printf("Finalizers run: %lu (%lu pool batches),"
+                        " max queue depth: %lu\n",
+                        (unsigned long)fstats.finalizers_run,
+                        (unsigned long)fstats.batches_run,
+                        (unsigned long)fstats.max_queue_depth);
+      }
       for (i = 0; i < MAX_FINALIZED; i++) {
         if (live_indicators[i] != 0) {
             still_live++;
@@ -2116,6 +2579,35 @@ static void check_heap_stats(void)
               (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_get_memory_use());
     MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Final heap size is %lu bytes\n",
                   (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_get_heap_size());
+#   ifdef ENABLE_HEAP_PROFILE
+      {
+        struct profile_buf_s profile = { NULL, 0, 0 };
+
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_write_heap_profile(save_profile_bytes, &profile)
+                != MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Heap profile writing failed\n");
+          FAIL;
+        }
+        check_heap_profile(&profile);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Heap profile size is %lu bytes\n",
+                  (unsigned long)profile.len);
+      }
+#   endif
+#   ifdef ENABLE_EVENT_TRACE
+      {
+        struct trace_check_s check = { 0, 0, 0, 0, 0 };
+
+        if (!MANAGED_STACK_ADDRESS_BOEHM_GC_get_event_tracing()
+            || MANAGED_STACK_ADDRESS_BOEHM_GC_write_event_trace(check_trace_chunk, &check) != MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS
+            || check.first != '{' || check.last != '\n'
+            || !check.collection_found) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Event trace writing failed\n");
+          FAIL;
+        }
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Event trace size is %lu bytes\n",
+                  (unsigned long)check.len);
+      }
+#   endif
     if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_total_bytes() < (size_t)n_tests *
 #   ifdef VERY_SMALL_CONFIG
         2700000
@@ -2537,8 +3029,8 @@ int test(void)
     int code;
 
 #   if defined(CPPCHECK)
-      MANAGED_STACK_ADDRESS_BOEHM_GC_noop1((MANAGED_STACK_ADDRESS_BOEHM_GC_word)(MANAGED_STACK_ADDRESS_BOEHM_GC_funcptr_uint)&PCR_MANAGED_STACK_ADDRESS_BOEHM_GC_Run);
-      MANAGED_STACK_ADDRESS_BOEHM_GC_noop1((MANAGED_STACK_ADDRESS_BOEHM_GC_word)(MANAGED_STACK_ADDRESS_BOEHM_GC_funcptr_uint)&PCR_MANAGED_STACK_ADDRESS_BOEHM_GC_Setup);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_noop1((MANAGED_STACK_ADDRESS_BOEHM_GC_word)(MANAGED_STACK_ADDRESS_BOEHM_GC_funcptr_uint)&PCR_GC_Run);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_noop1((MANAGED_STACK_ADDRESS_BOEHM_GC_word)(MANAGED_STACK_ADDRESS_BOEHM_GC_funcptr_uint)&PCR_GC_Setup);
       MANAGED_STACK_ADDRESS_BOEHM_GC_noop1((MANAGED_STACK_ADDRESS_BOEHM_GC_word)(MANAGED_STACK_ADDRESS_BOEHM_GC_funcptr_uint)&test);
 #   endif
     n_tests = 0;
@@ -2564,6 +3056,7 @@ int test(void)
 
 #if defined(MANAGED_STACK_ADDRESS_BOEHM_GC_PTHREADS)
 # include <errno.h> /* for EAGAIN */
+# include <sched.h> /* for sched_yield */
 
 static void * thr_run_one_test(void *arg)
 {
@@ -2572,6 +3065,255 @@ static void * thr_run_one_test(void *arg)
     return 0;
 }
 
+#ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
+# define POOL_FNLZ_OBJS 2000
+# define POOL_FNLZ_BACKLOG 100
+# define POOL_WAIT_YIELDS 10000000L
+
+  static pthread_t pool_test_main_thread;
+  static volatile AO_t pool_fnlz_released = 0;
+  static volatile AO_t pool_fnlz_count = 0;
+
+  static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK pool_finalizer(void *obj, void *client_data)
+  {
+    long i;
+
+    UNUSED_ARG(obj);
+    UNUSED_ARG(client_data);
+    /* Hold the pool threads (for a while), so that the backlog is to   */
+    /* be run by the allocating thread.                                 */
+    for (i = 0; i < POOL_WAIT_YIELDS
+                && !pthread_equal(pthread_self(), pool_test_main_thread)
+                && !AO_load_acquire(&pool_fnlz_released); i++)
+      (void)sched_yield();
+    AO_fetch_and_add1(&pool_fnlz_count);
+  }
+
+  /* Check that the finalizers are run by the pool threads, and that    */
+  /* the ready finalizers (including those taken by the pool) do not    */
+  /* exceed the backlog limit once the allocating thread is done.       */
+  static void check_finalizer_pool(void)
+  {
+    struct MANAGED_STACK_ADDRESS_BOEHM_GC_finalizer_stats_s fstats;
+    MANAGED_STACK_ADDRESS_BOEHM_GC_word backlog_run_before, batches_before;
+    long i;
+
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_start_finalizer_threads(2, POOL_FNLZ_BACKLOG) != MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS)
+      return;
+    pool_test_main_thread = pthread_self();
+    (void)MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalizer_stats(&fstats, sizeof(fstats));
+    backlog_run_before = fstats.backlog_finalizers_run;
+    batches_before = fstats.batches_run;
+    for (i = 0; i < POOL_FNLZ_OBJS; i++) {
+      void *p = checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word)));
+
+      MANAGED_STACK_ADDRESS_BOEHM_GC_REGISTER_FINALIZER(p, pool_finalizer, NULL, NULL, NULL);
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+
+    (void)MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalizer_stats(&fstats, sizeof(fstats));
+    if (fstats.queue_depth > POOL_FNLZ_BACKLOG) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Finalizer backlog %lu exceeds limit\n",
+                (unsigned long)fstats.queue_depth);
+      FAIL;
+    }
+    if (fstats.backlog_finalizers_run == backlog_run_before) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_printf("No finalizers run because of backlog\n");
+      FAIL;
+    }
+
+    AO_store_release(&pool_fnlz_released, TRUE);
+    for (i = 0; i < POOL_WAIT_YIELDS; i++) {
+      (void)MANAGED_STACK_ADDRESS_BOEHM_GC_get_finalizer_stats(&fstats, sizeof(fstats));
+      if (0 == fstats.queue_depth && fstats.batches_run > batches_before
+          && AO_load_acquire(&pool_fnlz_count) >= POOL_FNLZ_OBJS / 2)
+        break;
+      (void)sched_yield();
+    }
+    if (i == POOL_WAIT_YIELDS || 0 == fstats.finalizer_threads) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Finalizer pool has not run finalizers: %lu of %d run\n",
+                (unsigned long)AO_load_acquire(&pool_fnlz_count),
+                POOL_FNLZ_OBJS);
+      FAIL;
+    }
+  }
+
+# define STRIPE_TEST_THREADS 4
+# define STRIPE_TEST_OBJS 1000
+# define STRIPE_TEST_ROUNDS 10
+
+  static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK stripe_test_finalizer(void *obj, void *client_data)
+  {
+    UNUSED_ARG(obj);
+    UNUSED_ARG(client_data);
+  }
+
+  /* Register, move and unregister many finalizers and disappearing     */
+  /* links concurrently with the other threads doing the same (thus     */
+  /* resizing the same stripes of the tables), and check the results.   */
+  static void *stripe_test_thread(void *arg)
+  {
+    void **objs = (void **)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(STRIPE_TEST_OBJS
+                                              * sizeof(void *)));
+    void **links = (void **)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(2 * STRIPE_TEST_OBJS
+                                                      * sizeof(void *)));
+    int n, i;
+
+    for (n = 0; n < STRIPE_TEST_ROUNDS; n++) {
+      for (i = 0; i < STRIPE_TEST_OBJS; i++) {
+        objs[i] = checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word)));
+        MANAGED_STACK_ADDRESS_BOEHM_GC_REGISTER_FINALIZER(objs[i], stripe_test_finalizer, &objs[i],
+                              NULL, NULL);
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_GENERAL_REGISTER_DISAPPEARING_LINK(&links[i], objs[i])
+                != MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Disappearing link registration failed\n");
+          FAIL;
+        }
+      }
+      for (i = 0; i < STRIPE_TEST_OBJS; i++) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_finalization_proc ofn = 0;
+        void *ocd = NULL;
+
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_GENERAL_REGISTER_DISAPPEARING_LINK(&links[i], objs[i])
+                != MANAGED_STACK_ADDRESS_BOEHM_GC_DUPLICATE
+            || MANAGED_STACK_ADDRESS_BOEHM_GC_move_disappearing_link(&links[i],
+                                         &links[STRIPE_TEST_OBJS + i])
+                != MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS
+            || MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link(&links[i])
+            || !MANAGED_STACK_ADDRESS_BOEHM_GC_unregister_disappearing_link(
+                                        &links[STRIPE_TEST_OBJS + i])) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Disappearing link lost in striped table\n");
+          FAIL;
+        }
+        MANAGED_STACK_ADDRESS_BOEHM_GC_REGISTER_FINALIZER(objs[i], 0, 0, &ofn, &ocd);
+        if (ofn != stripe_test_finalizer || ocd != &objs[i]) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Finalizer lost in striped table\n");
+          FAIL;
+        }
+      }
+      if (n % 3 == 0)
+        MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+    }
+    return arg;
+  }
+
+  static void check_striped_fnlz_tables(void)
+  {
+    pthread_t th[STRIPE_TEST_THREADS];
+    int i, code, nthreads;
+
+    for (i = 0; i < STRIPE_TEST_THREADS; i++) {
+      if ((code = pthread_create(&th[i], NULL, stripe_test_thread, 0)) != 0) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Thread creation failed, errno= %d\n", code);
+        if (i > 0 && EAGAIN == code)
+          break;
+        FAIL;
+      }
+    }
+    nthreads = i;
+    (void)stripe_test_thread(NULL);
+    for (i = 0; i < nthreads; i++) {
+      if ((code = pthread_join(th[i], NULL)) != 0) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Thread join failed, errno= %d\n", code);
+        FAIL;
+      }
+    }
+  }
+
+# define DEREF_TEST_THREADS 3
+# define DEREF_TEST_OBJS 500
+# define DEREF_TEST_WORDS 4
+# define DEREF_TEST_ROUNDS 20
+
+  static volatile AO_t deref_test_links = 0; /* the current links array */
+  static volatile AO_t deref_test_done = 0;
+
+  /* Dereference the current links repeatedly (without the lock) while  */
+  /* the main thread drops their objects and collects, and check the    */
+  /* content of the objects is intact (i.e. not reclaimed).             */
+  static void *deref_test_thread(void *arg)
+  {
+    while (!AO_load_acquire(&deref_test_done)) {
+      void **links = (void **)AO_load_acquire(&deref_test_links);
+      int i, j;
+
+      for (i = 0; i < DEREF_TEST_OBJS; i++) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_word *p = (MANAGED_STACK_ADDRESS_BOEHM_GC_word *)MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link(&links[i]);
+
+        if (NULL == p) continue;
+        for (j = 0; j < DEREF_TEST_WORDS; j++) {
+          if (p[j] != MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(p) + (MANAGED_STACK_ADDRESS_BOEHM_GC_word)j) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Dereferenced object is reclaimed: %p\n", (void *)p);
+            FAIL;
+          }
+        }
+      }
+    }
+    return arg;
+  }
+
+  static void check_deref_race(void)
+  {
+    pthread_t th[DEREF_TEST_THREADS];
+    void **keep = (void **)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(DEREF_TEST_OBJS
+                                              * sizeof(void *)));
+    int i, j, n, code, nthreads = 0;
+
+    for (n = 0; n < DEREF_TEST_ROUNDS; n++) {
+      void **links = (void **)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(DEREF_TEST_OBJS
+                                                        * sizeof(void *)));
+
+      /* Only the even objects are kept, the others are dropped.        */
+      for (i = 0; i < DEREF_TEST_OBJS; i++) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_word *p = (MANAGED_STACK_ADDRESS_BOEHM_GC_word *)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(DEREF_TEST_WORDS
+                                                   * sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word)));
+
+        for (j = 0; j < DEREF_TEST_WORDS; j++)
+          p[j] = MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(p) + (MANAGED_STACK_ADDRESS_BOEHM_GC_word)j;
+        MANAGED_STACK_ADDRESS_BOEHM_GC_END_STUBBORN_CHANGE(p);
+        links[i] = (void *)MANAGED_STACK_ADDRESS_BOEHM_GC_HIDE_POINTER(p);
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_GENERAL_REGISTER_DISAPPEARING_LINK(&links[i], p) != 0) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Disappearing link registration failed\n");
+          FAIL;
+        }
+        MANAGED_STACK_ADDRESS_BOEHM_GC_PTR_STORE_AND_DIRTY(&keep[i], i % 2 == 0 ? (void *)p : NULL);
+      }
+      AO_store_release(&deref_test_links, (AO_t)links);
+      if (0 == n) {
+        for (i = 0; i < DEREF_TEST_THREADS; i++) {
+          if ((code = pthread_create(&th[i], NULL, deref_test_thread, 0))
+                != 0) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Thread creation failed, errno= %d\n", code);
+            if (i > 0 && EAGAIN == code)
+              break;
+            FAIL;
+          }
+        }
+        nthreads = i;
+      }
+
+      /* Reuse the memory of the dropped objects.                       */
+      MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+      for (i = 0; i < DEREF_TEST_OBJS; i++)
+        (void)checkOOM(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(DEREF_TEST_WORDS * sizeof(MANAGED_STACK_ADDRESS_BOEHM_GC_word)));
+      MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+      for (i = 0; i < DEREF_TEST_OBJS; i += 2) {
+        if (MANAGED_STACK_ADDRESS_BOEHM_GC_deref_disappearing_link(&links[i]) != keep[i]) {
+          MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Link to live object is cleared\n");
+          FAIL;
+        }
+      }
+    }
+    AO_store_release(&deref_test_done, TRUE);
+    for (i = 0; i < nthreads; i++) {
+      if ((code = pthread_join(th[i], NULL)) != 0) {
+        MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Thread join failed, errno= %d\n", code);
+        FAIL;
+      }
+    }
+  }
+#endif /* !MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION */
+
 static void MANAGED_STACK_ADDRESS_BOEHM_GC_CALLBACK describe_norm_type(void *p, char *out_buf)
 {
   UNUSED_ARG(p);
@@ -2699,6 +3441,11 @@ int main(void)
       MANAGED_STACK_ADDRESS_BOEHM_GC_print_trace(0);
 #   endif
     check_heap_stats();
+#   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
+      check_striped_fnlz_tables();
+      check_deref_race();
+      check_finalizer_pool();
+#   endif
     (void)fflush(stdout);
     (void)pthread_attr_destroy(&attr);
 
@@ -2741,12 +3488,48 @@ int main(void)
 #   endif
 #   ifndef NO_CLOCK
       MANAGED_STACK_ADDRESS_BOEHM_GC_set_time_limit_tv(MANAGED_STACK_ADDRESS_BOEHM_GC_get_time_limit_tv());
+      {
+        struct MANAGED_STACK_ADDRESS_BOEHM_GC_pacer_stats_s pacer_stats;
+
+        MANAGED_STACK_ADDRESS_BOEHM_GC_get_pacer_stats(&pacer_stats);
+        MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target(pacer_stats.max_pause_us,
+                            pacer_stats.gc_percent);
+        if (0 == pacer_stats.max_pause_us) {
+          /* Check the time limit and rate are restored when the pacer  */
+          /* is turned off.                                             */
+          struct MANAGED_STACK_ADDRESS_BOEHM_GC_timeval_s tv = MANAGED_STACK_ADDRESS_BOEHM_GC_get_time_limit_tv();
+          int rate = MANAGED_STACK_ADDRESS_BOEHM_GC_get_rate();
+
+          MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target(2500 /* us */, 0);
+          if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_time_limit_tv().tv_ms != 2
+              || MANAGED_STACK_ADDRESS_BOEHM_GC_get_time_limit_tv().tv_nsec != 500000) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target has not set time limit\n");
+            FAIL;
+          }
+          /* An out-of-range share of the collector should be clamped.  */
+          MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target(2500 /* us */, 100);
+          MANAGED_STACK_ADDRESS_BOEHM_GC_get_pacer_stats(&pacer_stats);
+          if (pacer_stats.gc_percent != 99) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target has not clamped gc_percent\n");
+            FAIL;
+          }
+          MANAGED_STACK_ADDRESS_BOEHM_GC_set_rate(rate + 1);
+          MANAGED_STACK_ADDRESS_BOEHM_GC_set_pause_target(0, 0);
+          if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_time_limit_tv().tv_ms != tv.tv_ms
+              || MANAGED_STACK_ADDRESS_BOEHM_GC_get_time_limit_tv().tv_nsec != tv.tv_nsec
+              || MANAGED_STACK_ADDRESS_BOEHM_GC_get_rate() != rate) {
+            MANAGED_STACK_ADDRESS_BOEHM_GC_printf("Pacer has not restored time limit or rate\n");
+            FAIL;
+          }
+        }
+      }
 #   endif
 #   ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_NO_FINALIZATION
       MANAGED_STACK_ADDRESS_BOEHM_GC_set_await_finalize_proc(MANAGED_STACK_ADDRESS_BOEHM_GC_get_await_finalize_proc());
       MANAGED_STACK_ADDRESS_BOEHM_GC_set_interrupt_finalizers(MANAGED_STACK_ADDRESS_BOEHM_GC_get_interrupt_finalizers());
 #     ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_TOGGLE_REFS_NOT_NEEDED
         MANAGED_STACK_ADDRESS_BOEHM_GC_set_toggleref_func(MANAGED_STACK_ADDRESS_BOEHM_GC_get_toggleref_func());
+        MANAGED_STACK_ADDRESS_BOEHM_GC_set_toggleref_batch_func(MANAGED_STACK_ADDRESS_BOEHM_GC_get_toggleref_batch_func());
 #     endif
 #   endif
 #   if defined(CPPCHECK)
@@ -2,6 +2,14 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <time.h>
+#endif
+#ifdef __linux__
+# include <unistd.h> /* for rmdir, unlink */
+#endif
 
 #ifndef MANAGED_STACK_ADDRESS_BOEHM_GC_IGNORE_WARN
   /* Ignore misleading "Out of Memory!" warning (which is printed on    */
@@ -46,6 +54,46 @@
 #define MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX ((MANAGED_STACK_ADDRESS_BOEHM_GC_word)-1)
 #define MANAGED_STACK_ADDRESS_BOEHM_GC_SWORD_MAX ((MANAGED_STACK_ADDRESS_BOEHM_GC_signed_word)(MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX >> 1))
 
+#ifdef __linux__
+  static void write_cgroup_file(const char *dir, const char *name,
+                                const char *value)
+  {
+    char path[256];
+    FILE *f;
+
+    (void)snprintf(path, sizeof(path), "%s/%s", dir, name);
+    f = fopen(path, "w");
+    if (NULL == f || fputs(value, f) < 0 || fclose(f) != 0) {
+      fprintf(stderr, "Cannot write %s\n", path);
+      exit(1);
+    }
+  }
+
+  static void remove_cgroup_file(const char *dir, const char *name)
+  {
+    char path[256];
+
+    (void)snprintf(path, sizeof(path), "%s/%s", dir, name);
+    (void)unlink(path);
+  }
+
+  /* Wait (up to 5 seconds) for the memory controller to turn the       */
+  /* pressure mode on or off.                                           */
+  static int wait_memory_pressure(int on)
+  {
+    int i;
+
+    for (i = 0; i < 500 && MANAGED_STACK_ADDRESS_BOEHM_GC_get_memory_pressure() != on; i++) {
+      struct timespec ts;
+
+      ts.tv_sec = 0;
+      ts.tv_nsec = 10 * 1000 * 1000;
+      (void)nanosleep(&ts, NULL);
+    }
+    return MANAGED_STACK_ADDRESS_BOEHM_GC_get_memory_pressure() == on;
+  }
+#endif
+
 int main(void)
 {
   MANAGED_STACK_ADDRESS_BOEHM_GC_INIT();
@@ -63,6 +111,156 @@ int main(void)
     CHECK_ALLOC_FAILED(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX - 4), "WORD_MAX-4");
     CHECK_ALLOC_FAILED(MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(MANAGED_STACK_ADDRESS_BOEHM_GC_WORD_MAX), "WORD_MAX");
 # endif
+
+  /* Check that growing a huge object preserves its content (the object */
+  /* could be grown in place).                                          */
+  {
+    size_t sz = MANAGED_STACK_ADDRESS_BOEHM_GC_MAXIMUM_HEAP_SIZE / 10;
+    char *p;
+
+    /* Grow a huge object followed by the freed one (so it is likely    */
+    /* to be grown in place, though this is not guaranteed): the        */
+    /* content should be preserved, the whole result be usable.         */
+    {
+      char *q;
+
+      p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(sz);
+      q = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(sz);
+      if (p != NULL && q != NULL) {
+        if ((MANAGED_STACK_ADDRESS_BOEHM_GC_word)p > (MANAGED_STACK_ADDRESS_BOEHM_GC_word)q) {
+          char *t = p;
+
+          p = q;
+          q = t;
+        }
+        MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(q);
+        p[0] = 'a';
+        p[sz - 1] = 'z';
+        q = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_REALLOC(p, 2 * sz);
+        if (q != NULL) {
+          if (q[0] != 'a' || q[sz - 1] != 'z') {
+            fprintf(stderr, "Grown huge object content lost\n");
+            exit(1);
+          }
+          q[2 * sz - 1] = 'z';
+          p = q;
+        }
+      }
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(p);
+    }
+
+    p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(sz);
+    if (p != NULL) {
+      p[0] = 'a';
+      p[sz - 1] = 'z';
+      p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_REALLOC(p, 2 * sz);
+      if (p != NULL && (p[0] != 'a' || p[sz - 1] != 'z')) {
+        fprintf(stderr, "Huge object content lost by MANAGED_STACK_ADDRESS_BOEHM_GC_REALLOC\n");
+        exit(1);
+      }
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(p);
+    }
+
+    /* The freed memory (possibly reused) should be cleared again.    */
+    p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(sz);
+    if (p != NULL) {
+      size_t i;
+
+      for (i = 0; i < sz; i += 1024) {
+        if (p[i] != 0) {
+          fprintf(stderr, "Huge object is not cleared at offset %lu\n",
+                  (unsigned long)i);
+          exit(1);
+        }
+      }
+      if (p[sz - 1] != 0) {
+        fprintf(stderr, "Huge object is not cleared at its end\n");
+        exit(1);
+      }
+    }
+  }
+
+  /* Check that the scavenger (if supported) returns the free blocks to */
+  /* OS without any collection, and that the memory is cleared on reuse */
+  /* even if the pages are freed lazily.                                */
+# if defined(__unix__) || defined(__APPLE__)
+  {
+    size_t sz = 1024 * 1024; /* less than a huge object (those are      */
+                             /* unmapped at once by MANAGED_STACK_ADDRESS_BOEHM_GC_FREE).           */
+    char *p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(sz);
+
+    if (p != NULL && MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger(10 /* age_ms */, 0) == MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS) {
+      size_t unmapped = MANAGED_STACK_ADDRESS_BOEHM_GC_get_unmapped_bytes();
+      size_t i;
+
+      memset(p, 0x5a, sz);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(p);
+      for (i = 0; i < 200 && MANAGED_STACK_ADDRESS_BOEHM_GC_get_unmapped_bytes() <= unmapped; i++) {
+        struct timespec ts;
+
+        ts.tv_sec = 0;
+        ts.tv_nsec = 10 * 1000 * 1000;
+        (void)nanosleep(&ts, NULL);
+      }
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_unmapped_bytes() <= unmapped) {
+        fprintf(stderr, "Scavenger has not unmapped a free block\n");
+        exit(1);
+      }
+      (void)MANAGED_STACK_ADDRESS_BOEHM_GC_start_scavenger(0, 0); /* pause it */
+
+      p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(sz);
+      if (p != NULL) {
+        for (i = 0; i < sz; i += 1024) {
+          if (p[i] != 0) {
+            fprintf(stderr, "Object is not cleared after unmapping"
+                    " at offset %lu\n", (unsigned long)i);
+            exit(1);
+          }
+        }
+      }
+    }
+  }
+# endif
+
+  /* Check that the memory controller (if supported) follows the usage  */
+  /* of a fake cgroup (with 64 MiB limit), and the collector still      */
+  /* allocates under the memory pressure.                               */
+# ifdef __linux__
+  {
+    char dir[] = "/tmp/gc_cgroup_XXXXXX";
+
+    if (mkdtemp(dir) != NULL) {
+      write_cgroup_file(dir, "memory.max", "67108864\n");
+      write_cgroup_file(dir, "memory.high", "max\n");
+      write_cgroup_file(dir, "memory.current", "66060288\n"); /* 63 MiB */
+      (void)setenv("MANAGED_STACK_ADDRESS_BOEHM_GC_CGROUP_DIR", dir, 1);
+      if (MANAGED_STACK_ADDRESS_BOEHM_GC_start_memory_controller(10 /* headroom_percent */,
+                                     0 /* psi_stall_us */) == MANAGED_STACK_ADDRESS_BOEHM_GC_SUCCESS) {
+        int i;
+
+        if (!wait_memory_pressure(1)) {
+          fprintf(stderr, "Memory pressure is not detected\n");
+          exit(1);
+        }
+        for (i = 0; i < 100; i++) {
+          if (NULL == MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(100 * 1024)) {
+            fprintf(stderr, "Allocation failed under memory pressure\n");
+            exit(1);
+          }
+        }
+        write_cgroup_file(dir, "memory.current", "1048576\n");
+        if (!wait_memory_pressure(0)) {
+          fprintf(stderr, "Memory pressure is not cleared\n");
+          exit(1);
+        }
+      }
+      remove_cgroup_file(dir, "memory.max");
+      remove_cgroup_file(dir, "memory.high");
+      remove_cgroup_file(dir, "memory.current");
+      (void)rmdir(dir);
+    }
+  }
+# endif
   printf("SUCCEEDED\n");
   return 0;
 }
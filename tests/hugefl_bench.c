@@ -0,0 +1,182 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/* Measure the time of allocation of huge objects (the free blocks of   */
+/* such sizes share a single free list) as the number of the free huge  */
+/* blocks grows, and check that such blocks are reused on the best-fit  */
+/* basis.  Every free block ("hole") is of a distinct size, and every   */
+/* request is one block smaller than some hole, so that no free block   */
+/* matches it exactly but the best fit is unique.                       */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#define NOT_GCBUILD
+#include "private/gc_priv.h"
+
+#define CHECK_OUT_OF_MEMORY(p) \
+    do { \
+        if (NULL == (p)) { \
+            fprintf(stderr, "Out of memory\n"); \
+            exit(69); \
+        } \
+    } while (0)
+
+#define HUGE_BLOCKS 256 /* the smallest size of the huge free list */
+
+#if CPP_WORDSZ < 64
+# define MAX_HOLES 8
+#else
+# define MAX_HOLES 32
+#endif
+
+#define N_ALLOCS 2000 /* per each number of holes */
+
+/* The size of an object occupying exactly n heap blocks; the half of   */
+/* a block is left for the extra bytes, if any.                         */
+#define OBJ_BYTES(n) ((size_t)(n) * HBLKSIZE - HBLKSIZE / 2)
+
+/* The free lists are sorted by address, so the hole sizes are not      */
+/* ascending by address (otherwise first-fit would be the best fit).    */
+#define HOLE_BLOCKS(i) (HUGE_BLOCKS + 2 + (i) * 13 % MAX_HOLES * 2)
+#define REQUEST_BLOCKS(i) (HOLE_BLOCKS(i) - 1)
+
+static void *holes[MAX_HOLES];
+
+/* A live object follows every hole so that the holes do not coalesce.  */
+/* It is huge too, otherwise it would be placed in some smaller free    */
+/* block (not next to the hole).                                        */
+static void *separators[MAX_HOLES];
+
+static int holes_adjacent = 1;
+
+static unsigned rand_state = 1;
+
+static unsigned next_rand(void)
+{
+    rand_state = rand_state * 1103515245U + 12345U;
+    return (rand_state >> 16) & 0x7fff;
+}
+
+/* Allocate all the holes (remembering the addresses), each followed by */
+/* a separator.  The objects are expected to be carved one after        */
+/* another from the heap reserved in advance.                           */
+static void alloc_holes(void)
+{
+    unsigned i;
+
+    for (i = 0; i < MAX_HOLES; i++) {
+      holes[i] = MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(OBJ_BYTES(HOLE_BLOCKS(i)));
+      CHECK_OUT_OF_MEMORY(holes[i]);
+      separators[i] = MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(OBJ_BYTES(HUGE_BLOCKS));
+      CHECK_OUT_OF_MEMORY(separators[i]);
+      if ((char *)separators[i]
+            != (char *)holes[i] + HOLE_BLOCKS(i) * (size_t)HBLKSIZE
+          || (i > 0 && (char *)holes[i]
+                        != (char *)separators[i - 1]
+                           + HUGE_BLOCKS * (size_t)HBLKSIZE))
+        holes_adjacent = 0;
+    }
+}
+
+static void free_holes(unsigned first, unsigned last)
+{
+    unsigned i;
+
+    for (i = first; i < last; i++) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(holes[i]);
+    }
+}
+
+static void bench_alloc(unsigned n_holes)
+{
+    unsigned i;
+    double t = 0.0;
+#   ifndef NO_CLOCK
+      CLOCK_TYPE tI, tF;
+#   endif
+
+#   ifndef NO_CLOCK
+      GET_TIME(tI);
+#   endif
+    for (i = 0; i < N_ALLOCS; i++) {
+      void *p = MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(
+                        OBJ_BYTES(REQUEST_BLOCKS(next_rand() % n_holes)));
+
+      CHECK_OUT_OF_MEMORY(p);
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(p);
+    }
+#   ifndef NO_CLOCK
+      GET_TIME(tF);
+      t = (double)MS_TIME_DIFF(tF, tI) * 1e6
+          + (double)NS_FRAC_TIME_DIFF(tF, tI);
+#   endif
+    printf("%3u free huge blocks: %8.1f ns per allocation\n",
+           n_holes, t / N_ALLOCS);
+}
+
+/* Fill all the holes in a random order, each one should be taken by    */
+/* the request fitting it best.                                         */
+static void check_best_fit(unsigned n_holes)
+{
+    static void *filled[MAX_HOLES];
+    unsigned i;
+
+    for (i = 0; i < n_holes; i++) {
+      unsigned k = next_rand() % n_holes;
+
+      while (filled[k] != NULL)
+        k = (k + 1) % n_holes;
+      filled[k] = MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC_ATOMIC(OBJ_BYTES(REQUEST_BLOCKS(k)));
+      CHECK_OUT_OF_MEMORY(filled[k]);
+      if (filled[k] != holes[k]) {
+        fprintf(stderr, "Huge object of %u blocks is not placed in the"
+                " best-fit free block\n", (unsigned)REQUEST_BLOCKS(k));
+        exit(1);
+      }
+    }
+    for (i = 0; i < n_holes; i++) {
+      MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(filled[i]);
+    }
+}
+
+int main(void)
+{
+    unsigned n_holes;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INIT();
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_find_leak()) {
+      printf("This test program is not designed for leak detection mode\n");
+      return 0;
+    }
+    /* No collection should merge or unmap the holes.   */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_disable();
+    if (!MANAGED_STACK_ADDRESS_BOEHM_GC_expand_hp(MAX_HOLES * (size_t)HBLKSIZE
+                            * (2 * HUGE_BLOCKS + 2 * MAX_HOLES + 2))) {
+      fprintf(stderr, "Heap expansion failed\n");
+      exit(69);
+    }
+    alloc_holes();
+    free_holes(0, MAX_HOLES / 8);
+    for (n_holes = MAX_HOLES / 8;; n_holes *= 2) {
+      bench_alloc(n_holes);
+      if (n_holes >= MAX_HOLES) break;
+      free_holes(n_holes, 2 * n_holes);
+    }
+    if (holes_adjacent) {
+      check_best_fit(MAX_HOLES);
+    } else {
+      printf("Holes are not adjacent to live objects, best-fit not checked\n");
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_enable();
+    return 0;
+}
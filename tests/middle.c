@@ -12,6 +12,16 @@
 
 #define ALLOC_SZ 4096 /* typical page size */
 
+#define N_LIVE_NODES 300000
+
+#define N_LARGE_ALLOCS 4000
+#define LARGE_ALLOC_SZ (256 * 1024)
+
+struct node {
+  struct node *next;
+  char pad[56];
+};
+
 #define CHECK_OUT_OF_MEMORY(p) \
     do { \
         if (NULL == (p)) { \
@@ -20,6 +30,41 @@
         } \
     } while (0)
 
+/* Check that an allocator of large objects does not get ahead of the  */
+/* marker in the incremental mode, i.e. the heap is not grown much     */
+/* more than needed to hold the live data.                             */
+static void check_incremental_large_alloc(void)
+{
+  struct node *volatile live = NULL;
+  size_t heap_sz, max_heap_sz;
+  int i;
+
+  for (i = 0; i < N_LIVE_NODES; ++i) {
+    struct node *p = MANAGED_STACK_ADDRESS_BOEHM_GC_NEW(struct node);
+
+    CHECK_OUT_OF_MEMORY(p);
+    p -> next = live;
+    live = p;
+  }
+  MANAGED_STACK_ADDRESS_BOEHM_GC_set_time_limit(1 /* ms */);
+  MANAGED_STACK_ADDRESS_BOEHM_GC_enable_incremental();
+  if (!MANAGED_STACK_ADDRESS_BOEHM_GC_is_incremental_mode())
+    return;
+  heap_sz = MANAGED_STACK_ADDRESS_BOEHM_GC_get_heap_size();
+  max_heap_sz = heap_sz;
+  for (i = 0; i < N_LARGE_ALLOCS; ++i) {
+    CHECK_OUT_OF_MEMORY(MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_atomic(LARGE_ALLOC_SZ));
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_heap_size() > max_heap_sz)
+      max_heap_sz = MANAGED_STACK_ADDRESS_BOEHM_GC_get_heap_size();
+  }
+  if (max_heap_sz > 2 * heap_sz) {
+    fprintf(stderr, "Heap has grown from %lu to %lu KiB while allocating"
+            " large objects incrementally\n",
+            (unsigned long)heap_sz / 1024, (unsigned long)max_heap_sz / 1024);
+    exit(1);
+  }
+}
+
 int main(void)
 {
   int i;
@@ -42,6 +87,8 @@ int main(void)
     CHECK_OUT_OF_MEMORY(MANAGED_STACK_ADDRESS_BOEHM_GC_malloc(ALLOC_SZ / 2));
   }
 
+  check_incremental_large_alloc();
+
   printf("Final heap size is %lu\n", (unsigned long)MANAGED_STACK_ADDRESS_BOEHM_GC_get_heap_size());
   return 0;
 }
@@ -46,6 +46,28 @@ int main(void) {
       }
     }
   }
+
+  /* Check that growing of a large object (possibly in place, into the  */
+  /* free heap blocks following it) keeps the content and clears the    */
+  /* rest of the object.                                                */
+  for (i = 0; i < 100; i++) {
+    char *p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(64 * 1024);
+    char *q = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(256 * 1024);
+
+    CHECK_OUT_OF_MEMORY(p);
+    CHECK_OUT_OF_MEMORY(q);
+    p[0] = 'a';
+    p[64 * 1024 - 1] = 'z';
+    q[0] = 'q';
+    MANAGED_STACK_ADDRESS_BOEHM_GC_FREE(q);
+    p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_REALLOC(p, 200 * 1024);
+    CHECK_OUT_OF_MEMORY(p);
+    if (p[0] != 'a' || p[64 * 1024 - 1] != 'z' || p[64 * 1024] != 0
+        || p[200 * 1024 - 1] != 0) {
+      fprintf(stderr, "MANAGED_STACK_ADDRESS_BOEHM_GC_realloc of large object failed\n");
+      exit(1);
+    }
+  }
   printf("SUCCEEDED\n");
   return 0;
 }
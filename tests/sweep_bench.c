@@ -0,0 +1,220 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose, provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/* Measure the throughput of sweeping (reclaiming and clearing the      */
+/* unmarked objects of partially live blocks) and of clearing of large  */
+/* objects, and how much the mutator working set is evicted by them     */
+/* (i.e. the cache misses of a traversal of the working set right after */
+/* the sweep).  Set MANAGED_STACK_ADDRESS_BOEHM_GC_DISABLE_NT_CLEAR environment variable to compare */
+/* with the regular clearing (if the collector supports the other one). */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#define NOT_GCBUILD
+#include "private/gc_priv.h"
+
+#include <string.h>
+
+#if defined(__linux__) && !defined(NO_PERF_EVENTS)
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#define CHECK_OUT_OF_MEMORY(p) \
+    do { \
+        if (NULL == (p)) { \
+            fprintf(stderr, "Out of memory\n"); \
+            exit(69); \
+        } \
+    } while (0)
+
+#define HEAP_BYTES (32 * 1024 * 1024) /* garbage allocated per round */
+#define LARGE_OBJ_BYTES (1024 * 1024)
+#define WSET_BYTES (256 * 1024) /* mutator working set */
+#define LINE_BYTES 64
+
+static volatile unsigned char *wset;
+
+static int misses_fd = -1;
+
+static void init_misses_counter(void)
+{
+# if defined(__linux__) && !defined(NO_PERF_EVENTS)
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    misses_fd = (int)syscall(__NR_perf_event_open, &attr, 0 /* pid */,
+                             -1 /* cpu */, -1 /* group_fd */, 0);
+# endif
+}
+
+/* Touch the whole working set; return the number of cache misses  */
+/* (or -1 if not available), store the elapsed time in *pns.        */
+static long traverse_wset(double *pns)
+{
+    long misses = -1;
+    size_t i;
+#   ifndef NO_CLOCK
+      CLOCK_TYPE tI, tF;
+#   endif
+
+#   if defined(__linux__) && !defined(NO_PERF_EVENTS)
+      if (misses_fd != -1) {
+        (void)ioctl(misses_fd, PERF_EVENT_IOC_RESET, 0);
+        (void)ioctl(misses_fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+#   endif
+#   ifndef NO_CLOCK
+      GET_TIME(tI);
+#   endif
+    for (i = 0; i < WSET_BYTES; i += LINE_BYTES)
+      wset[i]++;
+#   ifndef NO_CLOCK
+      GET_TIME(tF);
+      *pns = (double)NS_FRAC_TIME_DIFF(tF, tI) + MS_TIME_DIFF(tF, tI) * 1e6;
+#   else
+      *pns = 0.0;
+#   endif
+#   if defined(__linux__) && !defined(NO_PERF_EVENTS)
+      if (misses_fd != -1) {
+        long long cnt = 0;
+
+        (void)ioctl(misses_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(misses_fd, &cnt, sizeof(cnt)) == (ssize_t)sizeof(cnt))
+          misses = (long)cnt;
+      }
+#   endif
+    return misses;
+}
+
+static void report(const char *what, double bytes, double t_ms)
+{
+    double ns;
+    long misses;
+
+    misses = traverse_wset(&ns);
+    printf("%20s: %10.1f MiB/s  %11ld  %10.1f\n", what,
+           t_ms > 0.0 ? bytes / (1024.0 * 1024.0) / (t_ms * 1e-3) : 0.0,
+           misses, ns / (WSET_BYTES / LINE_BYTES));
+}
+
+static void bench_sweep(size_t obj_sz)
+{
+    size_t n = HEAP_BYTES / obj_sz;
+    size_t i;
+    void **keep;
+    double t = 0.0;
+    char what[32];
+#   ifndef NO_CLOCK
+      CLOCK_TYPE tI, tF;
+#   endif
+
+    /* Keep every other object, so that blocks are not freed entirely. */
+    keep = (void **)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC((n / 2) * sizeof(void *));
+    CHECK_OUT_OF_MEMORY(keep);
+    for (i = 0; i < n; i++) {
+      void *p = MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(obj_sz);
+
+      CHECK_OUT_OF_MEMORY(p);
+      memset(p, 0x5a, obj_sz);
+      if (i % 2 == 0) keep[i / 2] = p;
+    }
+    MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+    (void)traverse_wset(&t); /* warm up the working set */
+
+    /* The allocations below are satisfied by the lazy sweep.   */
+#   ifndef NO_CLOCK
+      GET_TIME(tI);
+#   endif
+    for (i = 0; i < n / 2; i++) {
+      char *p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(obj_sz);
+
+      CHECK_OUT_OF_MEMORY(p);
+      if (p[obj_sz - 1] != 0) {
+        fprintf(stderr, "Reclaimed object is not cleared\n");
+        exit(1);
+      }
+    }
+#   ifndef NO_CLOCK
+      GET_TIME(tF);
+      t = (double)MS_TIME_DIFF(tF, tI)
+          + (double)NS_FRAC_TIME_DIFF(tF, tI) * 1e-6;
+#   endif
+    sprintf(what, "sweep %u-byte objs", (unsigned)obj_sz);
+    report(what, (double)(n / 2) * (double)obj_sz, t);
+    MANAGED_STACK_ADDRESS_BOEHM_GC_reachable_here(keep);
+}
+
+static void bench_large(void)
+{
+    size_t n = HEAP_BYTES / LARGE_OBJ_BYTES;
+    size_t i;
+    double t = 0.0;
+#   ifndef NO_CLOCK
+      CLOCK_TYPE tI, tF;
+#   endif
+
+    (void)traverse_wset(&t);
+#   ifndef NO_CLOCK
+      GET_TIME(tI);
+#   endif
+    for (i = 0; i < n; i++) {
+      char *p = (char *)MANAGED_STACK_ADDRESS_BOEHM_GC_MALLOC(LARGE_OBJ_BYTES);
+
+      CHECK_OUT_OF_MEMORY(p);
+      if (p[0] != 0 || p[LARGE_OBJ_BYTES - 1] != 0) {
+        fprintf(stderr, "Large object is not cleared\n");
+        exit(1);
+      }
+      p[LARGE_OBJ_BYTES / 2] = 1; /* make it dirty */
+    }
+#   ifndef NO_CLOCK
+      GET_TIME(tF);
+      t = (double)MS_TIME_DIFF(tF, tI)
+          + (double)NS_FRAC_TIME_DIFF(tF, tI) * 1e-6;
+#   endif
+    report("large objs", (double)n * LARGE_OBJ_BYTES, t);
+}
+
+int main(void)
+{
+    static const size_t obj_sizes[] = { 32, 128, 512 };
+    unsigned i;
+
+    MANAGED_STACK_ADDRESS_BOEHM_GC_INIT();
+    if (MANAGED_STACK_ADDRESS_BOEHM_GC_get_find_leak())
+        printf("This test program is not designed for leak detection mode\n");
+    wset = (volatile unsigned char *)malloc(WSET_BYTES);
+    CHECK_OUT_OF_MEMORY(wset);
+    memset((void *)wset, 0, WSET_BYTES);
+    init_misses_counter();
+
+    printf("%20s  %16s  %11s  %10s\n", "", "throughput",
+           "wset misses", "ns/line");
+    for (i = 0; i < sizeof(obj_sizes) / sizeof(obj_sizes[0]); i++)
+        bench_sweep(obj_sizes[i]);
+    /* Make large objects come from the blocks used (and dirtied) above. */
+    MANAGED_STACK_ADDRESS_BOEHM_GC_gcollect();
+    bench_large();
+    bench_large();
+    free((void *)wset);
+    return 0;
+}
@@ -124,6 +124,12 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_init_th
 #   ifdef MANAGED_STACK_ADDRESS_BOEHM_GC_GCJ_SUPPORT
         p -> gcj_freelists[0] = ERROR_FL;
 #   endif
+#   ifdef ENABLE_HEAP_PROFILE
+      /* Check whether the sampling is on at the first allocation.    */
+      p -> hprof_counter.hc_bytes_left = 0;
+      p -> hprof_counter.hc_period = 0;
+      p -> hprof_counter.hc_rng = 0;
+#   endif
 }
 
 MANAGED_STACK_ADDRESS_BOEHM_GC_INNER void MANAGED_STACK_ADDRESS_BOEHM_GC_destroy_thread_local(MANAGED_STACK_ADDRESS_BOEHM_GC_tlfs p)
@@ -170,12 +176,20 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC vo
 
 #   if MAXOBJKINDS > THREAD_FREELISTS_KINDS
       if (EXPECT(kind >= THREAD_FREELISTS_KINDS, FALSE)) {
-        return MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind_global(bytes, kind);
-      }
+        tsd = NULL;
+      } else
 #   endif
-    tsd = MANAGED_STACK_ADDRESS_BOEHM_GC_get_tlfs();
+    /* else */ {
+      tsd = MANAGED_STACK_ADDRESS_BOEHM_GC_get_tlfs();
+    }
     if (EXPECT(NULL == tsd, FALSE)) {
-        return MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind_global(bytes, kind);
+        result = MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind_global(bytes, kind);
+#       ifdef ENABLE_HEAP_PROFILE
+          /* Sampled by the global counter instead of the thread one.   */
+          if (result != NULL)
+            MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_count_global(result, bytes, MANAGED_STACK_ADDRESS_BOEHM_GC_HPROF_RA);
+#       endif
+        return result;
     }
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_initialized);
     MANAGED_STACK_ADDRESS_BOEHM_GC_ASSERT(MANAGED_STACK_ADDRESS_BOEHM_GC_is_thread_tsd_valid(tsd));
@@ -190,6 +204,12 @@ MANAGED_STACK_ADDRESS_BOEHM_GC_API MANAGED_STACK_ADDRESS_BOEHM_GC_ATTR_MALLOC vo
                          kind, MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind_global(bytes, kind),
                          (void)(kind == PTRFREE ? MALLOC_KIND_PTRFREE_INIT
                                                : (obj_link(result) = 0)));
+#   ifdef ENABLE_HEAP_PROFILE
+      if (EXPECT((((MANAGED_STACK_ADDRESS_BOEHM_GC_tlfs)tsd) -> hprof_counter.hc_bytes_left
+                  -= (signed_word)bytes) < 0, FALSE))
+        MANAGED_STACK_ADDRESS_BOEHM_GC_hprof_sample(&((MANAGED_STACK_ADDRESS_BOEHM_GC_tlfs)tsd) -> hprof_counter, result, bytes,
+                        MANAGED_STACK_ADDRESS_BOEHM_GC_HPROF_RA);
+#   endif
 #   ifdef LOG_ALLOCS
       MANAGED_STACK_ADDRESS_BOEHM_GC_log_printf("MANAGED_STACK_ADDRESS_BOEHM_GC_malloc_kind(%lu, %d) returned %p, recent GC #%lu\n",
                     (unsigned long)bytes, kind, result,